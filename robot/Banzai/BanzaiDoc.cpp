@@ -138,6 +138,8 @@ BEGIN_MESSAGE_MAP(CBanzaiDoc, CDocument)
   ON_COMMAND(ID_ENVIRON_GOTO, &CBanzaiDoc::OnEnvironGoto)
   ON_COMMAND(ID_NAV_CONFIDENCE, &CBanzaiDoc::OnNavConfidence)
   ON_COMMAND(ID_PEOPLE_VISIBILITY, &CBanzaiDoc::OnPeopleVisibility)
+  ON_COMMAND(ID_UTILITIES_RECORDSENSORS, &CBanzaiDoc::OnUtilitiesRecordsensors)
+  ON_COMMAND(ID_UTILITIES_REPLAYSENSORS, &CBanzaiDoc::OnUtilitiesReplaysensors)
 END_MESSAGE_MAP()
 
 /////////////////////////////////////////////////////////////////////////////
@@ -689,6 +691,108 @@ void CBanzaiDoc::OnUtilitiesPlayboth()
 }
 
 
+// Save all body sensor inputs to a log file while showing them
+
+void CBanzaiDoc::OnUtilitiesRecordsensors()
+{
+  jhcString sel, init("sensors.slg"), idir(cwd);
+  CFileDialog dlg(FALSE, NULL, init.Txt());
+
+  if (!ChkStream())
+    return;
+
+  // pick output file
+  (dlg.m_ofn).lpstrInitialDir = idir.Txt();
+  (dlg.m_ofn).lpstrFilter = _T("Sensor Logs\0*.slg\0All Files (*.*)\0*.*\0");
+  if (dlg.DoModal() != IDOK)
+    return;
+  sel.Set((dlg.m_ofn).lpstrFile);
+  eb->BindVideo(&v);
+  if (eb->slog.Record(sel.ch) <= 0)
+  {
+    Complain("Could not create sensor log %s", sel.ch);
+    return;
+  }
+
+  // run body normally (log is finished when loop exits)
+  v.Rewind(1);
+  sensor_loop("Recording sensors ...");
+  v.Prefetch(0);
+}
+
+
+// Feed body from a previously recorded sensor log (no hardware needed)
+
+void CBanzaiDoc::OnUtilitiesReplaysensors()
+{
+  jhcString sel, init("sensors.slg"), idir(cwd);
+  CFileDialog dlg(TRUE, NULL, init.Txt());
+
+  // pick input file
+  (dlg.m_ofn).lpstrInitialDir = idir.Txt();
+  (dlg.m_ofn).lpstrFilter = _T("Sensor Logs\0*.slg\0All Files (*.*)\0*.*\0");
+  if (dlg.DoModal() != IDOK)
+    return;
+  sel.Set((dlg.m_ofn).lpstrFile);
+  if (eb->slog.Replay(sel.ch) <= 0)
+  {
+    Complain("Could not read sensor log %s", sel.ch);
+    return;
+  }
+
+  // images come from log so camera is not needed
+  eb->BindVideo(NULL);
+  sensor_loop("Replaying sensors ...");
+  eb->BindVideo(&v);
+}
+
+
+// Show images and body state while recording or replaying sensor log
+// closes log when user stops loop or replay runs out
+
+void CBanzaiDoc::sensor_loop (const char *title)
+{
+  jhcImg d8;
+  int n = 0;
+
+  // start up robot (uses log instead of hardware if replaying)
+  d.Clear(1, title);
+  if (eb->Reset(1) <= 0)
+    if (AskNot("Problem with robot hardware. Continue?") <= 0)
+    {
+      eb->slog.Close();
+      return;
+    }
+
+  // loop until user stops or log ends
+  try
+  {
+    while (d.AnyHit() == 0)
+    {
+      // get sensor values and images
+      if (eb->Update() <= 0)
+        break;
+      if (eb->slog.Done() > 0)
+        break;
+      eb->DepthSize(d8);
+      eb->Depth8(d8);
+      n++;
+
+      // show frame on screen
+      d.ShowGrid(eb->Color(), 0, 0, 0, "Frame %d  [%4.2f secs]", n, 0.001 * eb->slog.Stamp());
+      d.ShowGrid(d8, 1, 0, 0, "Pan %3.1f  Tilt %3.1f  Lift %3.1f",
+                 eb->neck.Pan(), eb->neck.Tilt(), eb->lift.Height());
+
+      // hold current pose (nothing sent if replaying)
+      eb->Issue();
+    }
+  }
+  catch (...){Tell("Unexpected exit!");}
+  eb->slog.Close();
+  d.StatusText("Stopped after %d frames.", n);
+}
+
+
 /////////////////////////////////////////////////////////////////////////////
 //                               Saving Images                             //
 /////////////////////////////////////////////////////////////////////////////
@@ -2677,8 +2781,8 @@ void CBanzaiDoc::OnEnvironLocalpaths()
 {
   HWND me = GetForegroundWindow();
   jhcLocalOcc *nav = &((ec.rwi).nav);
-  jhcImg path;
-  int i, dev, nd, hnd, nd2, fbid = (ec.rwi).freeze;
+  jhcImg path, rt90, rt[18], lf[18];
+  int i, dev, inc, nv, nd, hnd, nd2, fbid = (ec.rwi).freeze;
 
   // make sure video is working
   if (!ChkStream())
@@ -2697,6 +2801,9 @@ void CBanzaiDoc::OnEnvironLocalpaths()
   nd  = nav->ndir;
   hnd = nd / 2;
   nd2 = 2 * nd;
+  inc = __max(ROUND(15.0 / nav->Step()), (hnd + 17) / 18);   // show about every 15 degs
+  inc = __max(1, inc);
+  nv = (hnd + inc - 1) / inc;
 
   // loop over selected set of frames  
   SetForegroundWindow(me);
@@ -2710,23 +2817,37 @@ void CBanzaiDoc::OnEnvironLocalpaths()
       if ((ec.rwi).Update() <= 0)
         break;
 
-      // make pretty pictures      
-      for (i = 0; i < nav->ndir; i++)
-        nav->RobotBody(nav->spin[i]);
-      path.Clone(nav->spin[hnd]);
+      // make pretty pictures (only a subset of headings)
+      nav->SpinView(path, 0);
+      nav->SpinView(rt90, -hnd);
+      nav->RobotBody(path);
+      nav->RobotBody(rt90);
+      for (i = 1; i < nv; i++)
+      {
+        nav->SpinView(rt[i], -i * inc);
+        nav->SpinView(lf[i], i * inc);
+        nav->RobotBody(rt[i]);
+        nav->RobotBody(lf[i]);
+      }
 
       // prompt for new sensors
       (ec.rwi).Issue();
 
       // show results
       d.ShowGrid(path, 0, 0, 2, "straight = F %3.1f, B %3.1f", nav->dist[nd], nav->dist[0]);
-      d.ShowGrid(nav->spin[0], hnd - 2, 0, 2, "rt 90.0 degs = F %3.1f, B %3.1f", nav->dist[hnd], nav->dist[nd + hnd]);
-      for (dev = 1; dev < hnd; dev++)
-        d.ShowGrid(nav->spin[hnd - dev], dev - 1, 1, 2, "rt %3.1f degs = F %3.1f,  B %3.1f", 
-                                                        dev * nav->Step(), nav->dist[nd - dev], nav->dist[nd2 - dev]); 
-      for (dev = 1; dev < hnd; dev++)
-        d.ShowGrid(nav->spin[hnd + dev], dev - 1, 2, 2, "lf %3.1f degs = F %3.1f, B %3.1f", 
-                                                        dev * nav->Step(), nav->dist[nd + dev], nav->dist[dev]); 
+      d.ShowGrid(rt90, nv - 2, 0, 2, "rt 90.0 degs = F %3.1f, B %3.1f", nav->dist[hnd], nav->dist[nd + hnd]);
+      for (i = 1; i < nv; i++)
+      {
+        dev = i * inc;
+        d.ShowGrid(rt[i], i - 1, 1, 2, "rt %3.1f degs = F %3.1f,  B %3.1f", 
+                                       dev * nav->Step(), nav->dist[nd - dev], nav->dist[nd2 - dev]); 
+      }
+      for (i = 1; i < nv; i++)
+      {
+        dev = i * inc;
+        d.ShowGrid(lf[i], i - 1, 2, 2, "lf %3.1f degs = F %3.1f, B %3.1f", 
+                                       dev * nav->Step(), nav->dist[nd + dev], nav->dist[dev]); 
+      }
     }
   }
   catch (...){Tell("Unexpected exit!");}
@@ -88,6 +88,7 @@ public:
 
   int swing_params (const char *fname =NULL);
   int interact_params (const char *fname =NULL);
+  void sensor_loop (const char *title);
 
 
 // Operations
@@ -188,6 +189,8 @@ public:
   afx_msg void OnEnvironGoto();
   afx_msg void OnNavConfidence();
   afx_msg void OnPeopleVisibility();
+  afx_msg void OnUtilitiesRecordsensors();
+  afx_msg void OnUtilitiesReplaysensors();
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -141,6 +141,8 @@
 #define ID_ENVIRON_GOTO                 32869
 #define ID_NAV_CONFIDENCE               32870
 #define ID_PEOPLE_VISIBILITY            32871
+#define ID_UTILITIES_RECORDSENSORS      32872
+#define ID_UTILITIES_REPLAYSENSORS      32873
 
 // Next default values for new objects
 // 
@@ -148,7 +150,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_3D_CONTROLS                     1
 #define _APS_NEXT_RESOURCE_VALUE        131
-#define _APS_NEXT_COMMAND_VALUE         32872
+#define _APS_NEXT_COMMAND_VALUE         32874
 #define _APS_NEXT_CONTROL_VALUE         1000
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
@@ -58,6 +58,15 @@ jhcEliArm::jhcEliArm ()
   fvec.SetSize(4);
   fsm.SetSize(4);
 
+  // warm start memory for inverse kinematics
+  for (i = 0; i < ksz; i++)
+  {
+    kpos[i].SetSize(4);
+    kdir[i].SetSize(4);
+    kang[i].SetSize(7);
+  }
+  ForgetSeeds();
+
   // set up description of joints
   for (i = 0; i < 7; i++)
   {
@@ -203,7 +212,7 @@ int jhcEliArm::iter_params (const char *fname)
   ps->SetTag("arm_ikin", 0);
   ps->NextSpec4( &tries,   3,    "Max step sizes");
   ps->NextSpec4( &loops, 150,    "Max iterations");
-  ps->Skip();
+  ps->NextSpecF( &wrad,    4.0,  "Warm start radius (in)");
   ps->NextSpecF( &step,    0.30, "Position step");   
   ps->NextSpecF( &dstep,   0.20, "Direction step");    
   ps->NextSpecF( &shrink,  0.5,  "Step shrinkage");
@@ -360,16 +369,7 @@ int jhcEliArm::Reset (int rpt, int chk)
   // announce entry
   if (rpt > 0)
     jprintf("\nArm reset ...\n");
-  clr_locks(1);
-  CfgClear();
-  ArmClear();
-  HandClear();
-
-  // set up kinematic parameters 
-  FingerTool();
-  StdTols();
-  zint = 0.0;
-  fwin = -1.0;
+  clr_state();
   
   // make sure hardware is working
   if (dyn == NULL)
@@ -455,6 +455,41 @@ int jhcEliArm::Reset (int rpt, int chk)
 }
 
 
+//= Clear software state when servo data will come from a sensor log.
+// no hardware is contacted so communications are assumed to be fine
+// replayed servo packets then determine status at each Update
+
+int jhcEliArm::ReplayReset ()
+{
+  clr_state();
+  first = 1;
+  ice = 0;
+  ice2 = 0;
+  aok = 1;
+  if (dyn == NULL)
+    aok = -1;
+  return aok;
+}
+
+
+//= Forget commands and set up standard kinematic parameters.
+
+void jhcEliArm::clr_state ()
+{
+  clr_locks(1);
+  CfgClear();
+  ArmClear();
+  HandClear();
+
+  // set up kinematic parameters 
+  FingerTool();
+  StdTols();
+  ForgetSeeds();
+  zint = 0.0;
+  fwin = -1.0;
+}
+
+
 //= Failure message for some part of initialization.
 
 int jhcEliArm::fail (int rpt) 
@@ -998,10 +1033,10 @@ double jhcEliArm::v2dps (double v, double w) const
 double jhcEliArm::pick_angles (jhcMatrix& ang, const jhcMatrix& end, const jhcMatrix& aim, 
                                double sep, const jhcMatrix *cfg, int finger)
 {
-  jhcMatrix jinv(3, 6), djinv(3, 6);
-  jhcMatrix pos(4), dir(4), diff(4), ddiff(4);
-  jhcMatrix err(4), derr(4), err0(4), derr0(4);
-  jhcMatrix ang0(7), best(7), adj(6), dadj(6);
+  jhcMatFix<3, 6> jinv, djinv;
+  jhcMatFix<1, 6> adj, dadj;
+  jhcVec4 diff, ddiff, err, derr, err0, derr0;
+  jhcMatrix pos(4), dir(4), ang0(7), best(7);
   double q, dq, bq = -1.0, f = step, df = dstep; 
   int i, n, any = 0;
 
@@ -1013,6 +1048,10 @@ double jhcEliArm::pick_angles (jhcMatrix& ang, const jhcMatrix& end, const jhcMa
 //aim.PrintVec3(", aim");
 
   // copy starting configuration (if any) and directly solve for gripper opening 
+  err.Zero();
+  derr.Zero();
+  err0.Zero();
+  derr0.Zero();
   ang0.Zero();
   if (cfg != NULL)
     ang0.Copy(*cfg);
@@ -1036,10 +1075,13 @@ double jhcEliArm::pick_angles (jhcMatrix& ang, const jhcMatrix& end, const jhcMa
         // adjust joint angles for better position and direction
         diff.ScaleVec3(f);
         adj.MatVec0(jinv, diff);
-        ang.IncVec(adj);
         ddiff.ScaleVec3(df);
         dadj.MatVec0(djinv, ddiff);
-        ang.IncVec(dadj);
+        for (i = 0; i < 6; i++)
+        {
+          ang.VInc(i, adj.VRef(i));
+          ang.VInc(i, dadj.VRef(i));
+        }
 
         // make sure joint angles respect movement limits
         for (i = 0; i < 7; i++)
@@ -1065,8 +1107,8 @@ jprintf(" initial Q = %3.1f (%3.1f %3.1f)\n", q, pq, dq);
       {
         best.Copy(ang);
         bq = q;
-        err0.Copy(err);
-        derr0.Copy(derr);
+        err0 = err;
+        derr0 = derr;
         any = 1;
       }
       if (bq <= 1.0)
@@ -1086,8 +1128,8 @@ jprintf(" initial Q = %3.1f (%3.1f %3.1f)\n", q, pq, dq);
   
   // make sure best configuration selected and save statistics of run
   ang.Copy(best);
-  miss.Copy(err0);
-  dmiss.Copy(derr0);
+  err0.Put(miss);
+  derr0.Put(dmiss);
 /*
 if (bq > 1.5)
 {
@@ -1105,9 +1147,9 @@ dmiss.PrintVec3(", derr");
 //= Find transpose of arm's Jacobian and split into position and direction parts.
 // assumes end vector (pos) and joint DH matrices up to date (i.e. call get_pose)
 
-void jhcEliArm::j_trans (jhcMatrix& jact, jhcMatrix& djact, const jhcMatrix& pos) const
+void jhcEliArm::j_trans (jhcMatFix<3, 6>& jact, jhcMatFix<3, 6>& djact, const jhcMatrix& pos) const
 {
-  jhcMatrix mv(4);
+  jhcVec4 mv;
   const jhcMatrix *axis, *orig;
   int i; 
 
@@ -1136,7 +1178,7 @@ void jhcEliArm::j_trans (jhcMatrix& jact, jhcMatrix& djact, const jhcMatrix& pos
 // computes error vector and component wise absolute errors
 // returns max coordinate difference wrt tolerance
 
-double jhcEliArm::pos_diff (jhcMatrix& fix, jhcMatrix& err, 
+double jhcEliArm::pos_diff (jhcVec4& fix, jhcVec4& err, 
                             const jhcMatrix& end, const jhcMatrix& pos) const
 { 
   double diff, scd, worst = 0.0;
@@ -1166,10 +1208,10 @@ double jhcEliArm::pos_diff (jhcMatrix& fix, jhcMatrix& err,
 // makes a vector of the angle-wise absolute errors of three orientation angles
 // returns max error relative to tolerance for that degree of freedom
 
-double jhcEliArm::dir_diff (jhcMatrix& dfix, jhcMatrix& derr, 
+double jhcEliArm::dir_diff (jhcVec4& dfix, jhcVec4& derr, 
                             const jhcMatrix& aim, const jhcMatrix& dir) const
 {
-  jhcMatrix now(4), goal(4), q1(4), q2(4), q3(4), slew(4);
+  jhcVec4 now, goal, q1, q2, q3, slew;
   double dot, degs, diff, scd, worst = 0.0;
   int i;
 
@@ -1215,7 +1257,7 @@ double jhcEliArm::dir_diff (jhcMatrix& dfix, jhcMatrix& derr,
 
 void jhcEliArm::jt3x3 (jhcMatrix& f2t) const
 {
-  jhcMatrix mv(4);
+  jhcVec4 mv;
   const jhcMatrix *axis, *orig;
   int i;
 
@@ -1697,6 +1739,154 @@ double jhcEliArm::Reachable (const jhcMatrix& pos, const jhcMatrix& dir, double
 }
 
 
+//= Solve inverse kinematics for a whole set of candidate poses in one call.
+// pos and dir are arrays of n poses (4 vectors each) as used by Reachable
+// each pose is warm-started from the closest pose solved earlier (in this batch
+//   or in recent calls) if within "wrad", else from the current configuration
+// fills q with fit quality (negative if over qlim) and optionally the joint
+//   angles in ang (7 vectors) and move times from current configuration in secs
+// if "from" <= 0 then cold starts and move times are relative to all zero angles
+// returns number of poses that can be achieved
+
+int jhcEliArm::ReachSet (double *q, const jhcMatrix *pos, const jhcMatrix *dir, int n, 
+                         jhcMatrix *ang, double *secs, double qlim, int from, double rate)
+{
+  jhcMatrix cold(7), a(7);
+  double qi;
+  int i, cnt = 0;
+
+  if ((q == NULL) || (pos == NULL) || (dir == NULL) || (n < 0))
+    Fatal("Bad input to jhcEliArm::ReachSet");
+
+  // get starting configuration
+  cold.Zero();
+  if (from > 0)
+    get_angles(cold);
+
+  // solve each pose and record results
+  for (i = 0; i < n; i++)
+  {
+    qi = reach_one(a, pos[i], dir[i], cold, qlim);
+    q[i] = qi;
+    if (ang != NULL)
+      ang[i].Copy(a);
+    if (secs != NULL)
+      secs[i] = CfgTime(a, cold, rate);
+    if (qi >= 0.0)
+      cnt++;
+  }
+  return cnt;
+}
+
+
+//= Pick the candidate pose which can be reached most quickly.
+// pos and dir are arrays of n poses (4 vectors each) as used by Reachable
+// warm starts each solution as in ReachSet, fills ang with winning configuration
+// returns index of best pose, negative if none achievable
+
+int jhcEliArm::ReachBest (jhcMatrix& ang, const jhcMatrix *pos, const jhcMatrix *dir, int n, 
+                          double qlim, int from, double rate)
+{
+  jhcMatrix cold(7), a(7);
+  double t, best = 0.0;
+  int i, win = -1;
+
+  if (!ang.Vector(7) || (pos == NULL) || (dir == NULL) || (n < 0))
+    Fatal("Bad input to jhcEliArm::ReachBest");
+
+  // get starting configuration
+  cold.Zero();
+  if (from > 0)
+    get_angles(cold);
+
+  // solve each pose and keep fastest feasible one
+  for (i = 0; i < n; i++)
+    if (reach_one(a, pos[i], dir[i], cold, qlim) >= 0.0)
+    {
+      t = CfgTime(a, cold, rate);
+      if ((win < 0) || (t < best))
+      {
+        ang.Copy(a);
+        best = t;
+        win = i;
+      }
+    }
+  return win;
+}
+
+
+//= Find joint angles for a single pose, preferring a warm start.
+// if warm start fails then retries from cold configuration (same as Reachable)
+// remembers successful solutions as seeds for later poses
+// returns fit quality (negative if over qlim)
+
+double jhcEliArm::reach_one (jhcMatrix& ang, const jhcMatrix& pos, const jhcMatrix& dir, 
+                             const jhcMatrix& cold, double qlim)
+{
+  jhcMatrix a2(7);
+  const jhcMatrix *seed;
+  double q2, q = -1.0;
+
+  if (!pos.Vector(4) || !dir.Vector(4))
+    Fatal("Bad input to jhcEliArm::reach_one");
+
+  // try starting from nearest remembered solution 
+  if ((seed = near_seed(pos, dir)) != NULL)
+    q = pick_angles(ang, pos, dir, Width(), seed, 0);
+
+  // fall back to standard starting point (keep better answer)
+  if ((q < 0.0) || (q > qlim))
+  {
+    q2 = pick_angles(a2, pos, dir, Width(), &cold, 0);
+    if ((q < 0.0) || (q2 < q))
+    {
+      ang.Copy(a2);
+      q = q2;
+    }
+  }
+
+  // save for future warm starts
+  if (q > qlim)
+    return -q;
+  add_seed(pos, dir, ang);
+  return q;
+}
+
+
+//= Find remembered solution for the pose most similar to the one given.
+// counts 10 degrees of maximum orientation difference as one inch
+// returns pointer to joint angles, NULL if nothing within "wrad"
+
+const jhcMatrix *jhcEliArm::near_seed (const jhcMatrix& pos, const jhcMatrix& dir) const
+{
+  double d, best = wrad;
+  int i, win = -1;
+
+  for (i = 0; i < nk; i++)
+  {
+    d = pos.PosDiff3(kpos[i]) + 0.1 * dir.RotDiff3(kdir[i]);
+    if (d <= best)
+    {
+      best = d;
+      win = i;
+    }
+  }
+  return((win < 0) ? NULL : kang + win);
+}
+
+
+//= Remember joint angles for some pose, overwriting oldest entry if full.
+
+void jhcEliArm::add_seed (const jhcMatrix& pos, const jhcMatrix& dir, const jhcMatrix& ang)
+{
+  kpos[kfill].Copy(pos);
+  kdir[kfill].Copy(dir);
+  kang[kfill].Copy(ang);
+  kfill = (kfill + 1) % ksz;
+  nk = __min(nk + 1, ksz);
+}
+
+
 //= Estimate time (in secs) to reach goal configurtion with common rate.
 // assumes arm is currently at zero velocity (i.e. move start)
 // negative rate does not scale acceleration (for snappier response)
@@ -30,6 +30,7 @@
 #include "Data/jhcParam.h"              // common video
 
 #include "Geometry/jhcJoint.h"          // common robot
+#include "Geometry/jhcMatFix.h"
 #include "Geometry/jhcMatrix.h"
 #include "Geometry/jhcMotRamp.h"
 #include "Peripheral/jhcDynamixel.h"
@@ -116,6 +117,12 @@ private:
   int ice;                              /** Whether arm is already in frozen mode.   */
   int ice2;                             /** Whether hand is already in frozen mode.  */
 
+  // batch inverse kinematics warm start memory
+  static const int ksz = 32;            /** Number of remembered solutions.  */
+  jhcMatrix kpos[ksz], kdir[ksz];       /** Poses with known solutions.      */
+  jhcMatrix kang[ksz];                  /** Joint angles for remembered pose. */
+  int nk, kfill;                        /** Valid entries and next to write. */
+
 
 // PUBLIC MEMBER VARIABLES
 public:
@@ -137,7 +144,7 @@ public:
   // inverse kinematics solver
   jhcParam ips;
   int tries, loops;
-  double step, dstep, shrink, close, align;
+  double wrad, step, dstep, shrink, close, align;
 
   // arm and finger force interpretation
   jhcParam fps;
@@ -162,6 +169,7 @@ public:
   // configuration
   void Bind (jhcDynamixel *ctrl);
   int Reset (int rpt =0, int chk =1);
+  int ReplayReset ();
   int Check (int rpt =0, int tries =2);
   double Voltage ();
   int Power (double vbat =0.0);
@@ -303,6 +311,11 @@ public:
   double Reachable (const jhcMatrix& pos, const jhcMatrix& dir, double qlim =30.0, int from =1);
   double CfgTime (const jhcMatrix& ang2, const jhcMatrix& ang1, double rate =1.0) const;
   double CfgTime (const jhcMatrix& ang2, const jhcMatrix& ang1, const jhcMatrix& rates) const;
+  int ReachSet (double *q, const jhcMatrix *pos, const jhcMatrix *dir, int n, 
+                jhcMatrix *ang =NULL, double *secs =NULL, double qlim =30.0, int from =1, double rate =1.0);
+  int ReachBest (jhcMatrix& ang, const jhcMatrix *pos, const jhcMatrix *dir, int n, 
+                 double qlim =30.0, int from =1, double rate =1.0);
+  void ForgetSeeds () {nk = 0; kfill = 0;}
   double PosTime (const jhcMatrix& pos2, const jhcMatrix& pos1, double rate =1.0) const
     {return pctrl.RampTime(pos2, pos1, rate);}
   double DirTime (const jhcMatrix& dir2, const jhcMatrix& dir1, double rate =1.0) const
@@ -394,6 +407,7 @@ public:
 // PRIVATE MEMBER FUNCTIONS
 private:
   // creation and configuration
+  void clr_state ();
   int fail (int rpt);
   void std_geom ();
 
@@ -421,13 +435,19 @@ private:
   double v2dps (double v, double w) const;
   double pick_angles (jhcMatrix& ang, const jhcMatrix& end, const jhcMatrix& aim, 
                       double sep, const jhcMatrix *ang0, int finger);
-  void j_trans (jhcMatrix& jact, jhcMatrix& djact, const jhcMatrix& pos) const;
-  double pos_diff (jhcMatrix& fix, jhcMatrix& err, 
+  void j_trans (jhcMatFix<3, 6>& jact, jhcMatFix<3, 6>& djact, const jhcMatrix& pos) const;
+  double pos_diff (jhcVec4& fix, jhcVec4& err, 
                    const jhcMatrix& pos, const jhcMatrix& end) const;
-  double dir_diff (jhcMatrix& dfix, jhcMatrix& derr, 
+  double dir_diff (jhcVec4& dfix, jhcVec4& derr, 
                    const jhcMatrix& dir, const jhcMatrix& aim) const; 
   void jt3x3 (jhcMatrix& f2t) const;
 
+  // batch inverse kinematics
+  double reach_one (jhcMatrix& ang, const jhcMatrix& pos, const jhcMatrix& dir, 
+                    const jhcMatrix& cold, double qlim);
+  const jhcMatrix *near_seed (const jhcMatrix& pos, const jhcMatrix& dir) const;
+  void add_seed (const jhcMatrix& pos, const jhcMatrix& dir, const jhcMatrix& ang);
+
   // arm goal specification
   void sync_xyz ();
 
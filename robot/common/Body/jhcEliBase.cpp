@@ -688,6 +688,40 @@ int jhcEliBase::UpdateFinish ()
 }
 
 
+//= Clear software state when encoder data will come from a sensor log.
+// no serial port is opened so communications are assumed to be fine
+// NOTE: counts are interpreted using the last controller version seen
+
+int jhcEliBase::ReplayReset ()
+{
+  clr_locks(1);
+  DriveClear();
+  pend = 0;
+  ice = 0;
+  berr = 0;
+  return 1;
+}
+
+
+//= Substitute recorded encoder values and status for a full update.
+// same interpretation as UpdateFinish but no communication with controller
+// returns 1 if values were good when recorded, 0 or negative for problem
+
+int jhcEliBase::ReplayEnc (UL32 r0, UL32 l0, UL32 r, UL32 l, int err)
+{
+  rt0 = r0;
+  lf0 = l0;
+  rt = r;
+  lf = l;
+  berr = err;
+  if (berr != 0)
+    return((berr < 0) ? -1 : 0);
+  cvt_cnts();
+  clr_locks(0);
+  return 1;
+}
+
+
 //= Clear winning command bids for all resources.
 // can optionally clear previous bids also
 
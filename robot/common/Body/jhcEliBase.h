@@ -148,6 +148,12 @@ public:
   int UpdateFinish ();
   int Issue (double tupd =0.033, double lead =3.0);
 
+  // sensor log replay
+  int RawEnc (UL32& r0, UL32& l0, UL32& r, UL32& l) const
+    {r0 = rt0; l0 = lf0; r = rt; l = lf; return berr;}
+  int ReplayReset ();
+  int ReplayEnc (UL32 r0, UL32 l0, UL32 r, UL32 l, int err);
+
   // --------------------- BASE MAIN ----------------------------
 
   // current base information
@@ -21,6 +21,7 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <stdio.h>
+#include <string.h>
 
 #include "Interface/jhcMessage.h"
 #include "Video/jhcKinVSrc.h"
@@ -273,6 +274,7 @@ int jhcEliBody::SetKinect (int rpt)
 // needs to be called at least once before using robot
 // if rpt > 0 then prints to log file
 // if full > 0 then clears all communications and tests hardware
+// if replaying sensor log then no hardware is touched and all parts start OK
 
 int jhcEliBody::Reset (int rpt, int full) 
 {
@@ -280,7 +282,25 @@ int jhcEliBody::Reset (int rpt, int full)
   UL32 neg5 = jms_now() - 300000;      // idle 5 minutes
   int i;
 
-  if ((full > 0) || (CommOK(0) <= 0))
+  // no hardware needed when replaying sensor log
+  if (slog.Replaying())
+  {
+    // announce entry
+    if (rpt > 0)
+    {
+      jprintf("=========================\n");
+      jprintf("BODY reset for replay ...\n");
+    }
+
+    // assume all parts are fine until log says otherwise
+    mok = 1;
+    arm.ReplayReset();
+    neck.ReplayReset();
+    base.ReplayReset();
+    lift.ReplayReset();
+    mic.ReplayReset();
+  }
+  else if ((full > 0) || (CommOK(0) <= 0))
   {
     // announce entry
     if (rpt > 0)
@@ -556,13 +576,14 @@ int jhcEliBody::ImgBig (jhcImg& dest)
 
 //= Get depth image as an 8 bit gray scale rendering.
 // generally better for display purposes
+// no video source when replaying so no extra downshift then
 
 int jhcEliBody::Depth8 (jhcImg& dest) const 
 {
   if (!rng.Valid())
     return dest.FillArr(0);
   if (!dest.Valid(2))
-    return Night8(dest, rng, vid->Shift);
+    return Night8(dest, rng, ((vid != NULL) ? vid->Shift : 0));
   return dest.CopyArr(rng);
 }
 
@@ -614,15 +635,24 @@ int jhcEliBody::Limp ()
 ///////////////////////////////////////////////////////////////////////////
 
 //= Load new images from video source (e.g. Kinect).
+// gets images from sensor log instead if replaying
 // Note: BLOCKS until frame(s) become available
 
 int jhcEliBody::UpdateImgs ()
 {
+  int rc;
+
+  if (slog.Replaying())
+    return replay_imgs();
   if (vid == NULL)
     return -1;
   if (vid->Dual() > 0)
-    return vid->DualGet(col, rng);
-  return vid->Get(col);              // sometimes useful (e.g. face enroll)
+    rc = vid->DualGet(col, rng);
+  else
+    rc = vid->Get(col);              // sometimes useful (e.g. face enroll)
+  if (slog.Recording())
+    record_imgs(rc);
+  return rc;
 }
 
 
@@ -637,9 +667,13 @@ int jhcEliBody::Update (int voice, int imgs, int bad)
     if (UpdateImgs() <= 0)
       return 0;
 
+  // possibly use recorded values instead of hardware
+  if (slog.Replaying())
+    return replay_state(voice);
+
   // possibly determine sound directions, request new servo data
   if (voice >= 0)
-    mic.Update(voice);
+    MicUpdate(voice);
   if (mega > 0)
     dyn.MegaIssue(id0, idn);
 
@@ -659,10 +693,44 @@ int jhcEliBody::Update (int voice, int imgs, int bad)
 
   // collect second base value
   base.UpdateFinish();
+  if (slog.Recording())
+    record_state(CommOK(0, bad));
   return CommOK(1, bad);
 }
 
 
+//= Determine sound direction from array microphone.
+// gets raw readings from sensor log instead if replaying
+// NOTE: use this rather than mic.Update so recording is complete
+
+int jhcEliBody::MicUpdate (int voice)
+{
+  const UC8 *pod;
+  UC8 rec[1001];
+  int n, rc;
+
+  // possibly substitute recorded readings (status in first byte)
+  if (slog.Replaying())
+  {
+    if (((pod = slog.Get("MIC ", n)) == NULL) || (n < 1) || (pod[0] <= 0))
+      return 0;
+    return mic.Replay(pod + 1, n - 1, voice);
+  }
+
+  // get fresh readings and possibly save them
+  rc = mic.Update(voice);
+  if (slog.Recording())
+  {
+    pod = mic.Raw(n);
+    n = ((rc > 0) ? __min(n, 1000) : 0);
+    rec[0] = (UC8)((rc > 0) ? 1 : 0);
+    memcpy(rec + 1, pod, n);
+    slog.Put("MIC ", rec, n + 1);
+  }
+  return rc;
+}
+
+
 //= Tell neck angles and true height of camera above floor.
 
 void jhcEliBody::CamPose (double& pan, double& tilt, double& ht)
@@ -708,11 +776,14 @@ int jhcEliBody::Issue (double lead)
     tupd = __max(tvid, __min(diff, 0.5));
   }
 
-  // tell components to issue their commands 
-  arm.Issue(tupd, lead, 0);  
-  neck.Issue(tupd, lead);          // send arm & neck servos 
-  base.Issue(tupd, lead);
-  lift.Issue(tupd, lead);
+  // tell components to issue their commands (unless replaying)
+  if (!slog.Replaying())
+  {
+    arm.Issue(tupd, lead, 0);  
+    neck.Issue(tupd, lead);        // send arm & neck servos 
+    base.Issue(tupd, lead);
+    lift.Issue(tupd, lead);
+  }
 
   // update last high bid time
   if (neck.GazeWin() >= nbid)
@@ -750,6 +821,8 @@ int jhcEliBody::InitPose (double ht)
 {
   int ok = 1;
 
+  if (slog.Replaying())
+    return ok;
   if (arm.ZeroGrip(1) <= 0)
     ok = -3;
   if (arm.Stow() <= 0)
@@ -760,4 +833,100 @@ int jhcEliBody::InitPose (double ht)
   if (neck.SetNeck(0.0, neck.gaze0) <= 0)
     ok = 0;
   return ok;
-} 
\ No newline at end of file
+} 
+
+
+///////////////////////////////////////////////////////////////////////////
+//                               Sensor Log                              //
+///////////////////////////////////////////////////////////////////////////
+
+//= Save result of image acquisition along with any new images.
+
+void jhcEliBody::record_imgs (int rc)
+{
+  int v[2] = {rc, ((vid->Dual() > 0) ? 1 : 0)};
+
+  slog.PutVals("IMGS", v, 2);
+  if (rc <= 0)
+    return;
+  slog.PutImg("COLR", col);
+  if (v[1] > 0)
+    slog.PutImg("RNGE", rng);
+}
+
+
+//= Get images (if any) and result of acquisition from log.
+// returns -2 if log is exhausted
+
+int jhcEliBody::replay_imgs ()
+{
+  int v[2];
+
+  if (slog.GetVals(v, "IMGS", 2) < 2)
+    return -2;
+  if (v[0] <= 0)
+    return v[0];
+  if (slog.GetImg(col, "COLR") <= 0)
+    return -2;
+  if (v[1] > 0)
+    if (slog.GetImg(rng, "RNGE") <= 0)
+      return -2;
+  return v[0];
+}
+
+
+//= Save raw servo, odometry, and lift data along with overall status.
+// servo states are only available if mega-update is used
+
+void jhcEliBody::record_state (int ok)
+{
+  UC8 pod[260];
+  UL32 r0, l0, r, l;
+  int v[5];
+
+  if (mega > 0)
+    slog.Put("SERV", pod, dyn.MegaSave(pod, 260));
+  v[4] = base.RawEnc(r0, l0, r, l);
+  v[0] = (int) r0;
+  v[1] = (int) l0;
+  v[2] = (int) r;
+  v[3] = (int) l;
+  slog.PutVals("ODOM", v, 5);
+  v[0] = lift.RawCount();
+  v[1] = lift.CommOK();
+  slog.PutVals("LIFT", v, 2);
+  slog.PutVals("BODY", &ok, 1);
+}
+
+
+//= Interpret recorded servo, odometry, and lift data as if just received.
+// returns recorded communication status, 0 if log is exhausted
+
+int jhcEliBody::replay_state (int voice)
+{
+  const UC8 *pod;
+  int v[5];
+  int n;
+
+  // sound direction and servo angles
+  if (voice >= 0)
+    MicUpdate(voice);
+  if (mega > 0)
+  {
+    pod = slog.Get("SERV", n);
+    dyn.MegaLoad(pod, n);
+  }
+  neck.Update();
+  arm.Update(0);
+
+  // wheel odometry and lift height
+  if (slog.GetVals(v, "ODOM", 5) == 5)
+    base.ReplayEnc((UL32) v[0], (UL32) v[1], (UL32) v[2], (UL32) v[3], v[4]);
+  if (slog.GetVals(v, "LIFT", 2) == 2)
+    lift.ReplayCount(v[0], v[1]);
+
+  // overall status when recorded
+  if (slog.GetVals(v, "BODY", 1) < 1)
+    return 0;
+  return v[0];
+}
@@ -38,6 +38,7 @@
 #include "Body/jhcEliBase.h"
 #include "Body/jhcEliLift.h"
 #include "Body/jhcEliNeck.h"
+#include "Body/jhcSensorLog.h"
 #include "Peripheral/jhcAccelXY.h"
 #include "Peripheral/jhcDirMic.h"
 #include "Peripheral/jhcDynamixel.h"
@@ -45,6 +46,8 @@
 
 //= Controls all mechanical aspects of Eli Robot (arm, neck, base, lift).
 // also interfaces to Kinect depth camera and array microphone
+// all sensor inputs can be saved in "slog" while running then replayed later
+// without any hardware (video source still needed for camera geometry)
 
 class jhcEliBody : private jhcLUT, private jhcResize
 {
@@ -76,6 +79,9 @@ public:
   jhcVideoSrc *vid;
   jhcDirMic mic;
 
+  // record or replay of sensor inputs
+  jhcSensorLog slog;
+
   // AX-12 communication parameters
   jhcParam bps;
   int dport, dbaud, mega, id0, idn;
@@ -167,6 +173,7 @@ public:
   // main functions
   int UpdateImgs ();
   int Update (int voice =0, int imgs =1, int bad =0);
+  int MicUpdate (int voice =0);
   void CamPose (double& pan, double& tilt, double& ht);
   int Issue (double lead =3.0);
 
@@ -184,6 +191,12 @@ private:
   // configuration
   void chk_vid (int start);
 
+  // sensor log
+  void record_imgs (int rc);
+  int replay_imgs ();
+  void record_state (int ok);
+  int replay_state (int voice);
+
 };
 
 
@@ -46,6 +46,7 @@ jhcEliLift::jhcEliLift ()
 {
   // communications
   lok = -1;
+  raw = 0;
 
   // profile generator
   strcpy_s(rname, "fork_ramp");
@@ -348,10 +349,35 @@ int jhcEliLift::UpdateFinish ()
   if (lcom.RxArray(pod, 2) < 2)
     return lok;
   now = (pod[1] << 8) | pod[0];
+  return ReplayCount(now, 1);
+}
+
+
+//= Clear software state when stage data will come from a sensor log.
+// no serial port is opened so communications are assumed to be fine
+
+int jhcEliLift::ReplayReset ()
+{
+  clr_lock(1);
+  LiftClear();
   lok = 1;
+  return lok;
+}
+
+
+//= Interpret a raw stage position (0-4095) as if just received.
+// also used to substitute recorded values along with their status
+// returns communication status (1 = good)
+
+int jhcEliLift::ReplayCount (int cnt, int ok)
+{
+  lok = ok;
+  if (lok <= 0)
+    return lok;
 
   // convert to inches and save
-  ht = bot + (top - bot) * now / 4095.0;
+  raw = cnt;
+  ht = bot + (top - bot) * raw / 4095.0;
 
   // set default command for next cycle
   clr_lock(0);
@@ -48,6 +48,7 @@ private:
 
   // sensor data
   double ht;                    /** Current height of fork stage. */
+  int raw;                      /** Last position reading from stage. */
 
   // actuator command
   int llock0, llock;            /** Winning bid for fork height command.   */
@@ -93,6 +94,11 @@ public:
   int UpdateFinish ();
   int Issue (double tupd =0.033, double lead =3.0);
 
+  // sensor log replay
+  int RawCount () const {return raw;}
+  int ReplayReset ();
+  int ReplayCount (int cnt, int ok);
+
   // --------------------- LIFT MAIN ----------------------------
 
   // current lift information
@@ -311,6 +311,20 @@ int jhcEliNeck::Reset (int rpt, int chk)
 }
 
 
+//= Clear software state when servo data will come from a sensor log.
+// no hardware is contacted so communications are assumed to be fine
+
+int jhcEliNeck::ReplayReset ()
+{
+  clr_locks(1);
+  GazeClear();
+  nok = 1;
+  if (dyn == NULL)
+    nok = -1;
+  return nok;
+}
+
+
 //= Failure message for some part of initialization.
 
 int jhcEliNeck::fail (int rpt) 
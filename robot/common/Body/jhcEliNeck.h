@@ -85,6 +85,7 @@ public:
   void Bind (jhcDynamixel *ctrl);
   int CommOK (int bad =0) const {return nok;}
   int Reset (int rpt =0, int chk =1);
+  int ReplayReset ();
   int Check (int rpt =0, int tries =2);
   double Voltage ();
   int Power (double vbat =0.0);
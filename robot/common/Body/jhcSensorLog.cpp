@@ -0,0 +1,545 @@
+// jhcSensorLog.cpp : time stamped record of robot sensor inputs for later replay
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "Interface/jhcMessage.h"      // common video
+#include "Interface/jms_x.h"
+
+#include "Body/jhcSensorLog.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+// finishes index if recording
+
+jhcSensorLog::~jhcSensorLog ()
+{
+  Close();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcSensorLog::jhcSensorLog ()
+{
+  offs = NULL;
+  chan = NULL;
+  stamp = NULL;
+  rlen = NULL;
+  rmax = 0;
+  nrec = 0;
+  mode = 0;
+  out = NULL;
+  fpos = 0;
+  t0 = 0;
+  speed = 1.0;
+  Rewind();
+}
+
+
+//= Get rid of record index.
+
+void jhcSensorLog::dealloc ()
+{
+  delete [] rlen;
+  delete [] stamp;
+  delete [] chan;
+  delete [] offs;
+  offs = NULL;
+  chan = NULL;
+  stamp = NULL;
+  rlen = NULL;
+  rmax = 0;
+}
+
+
+//= Double the size of the record index.
+
+void jhcSensorLog::grow ()
+{
+  __int64 *o2;
+  UL32 *c2, *s2;
+  int *r2;
+  int i, n = __max(1024, 2 * rmax);
+
+  o2 = new __int64 [n];
+  c2 = new UL32 [n];
+  s2 = new UL32 [n];
+  r2 = new int [n];
+  for (i = 0; i < nrec; i++)
+  {
+    o2[i] = offs[i];
+    c2[i] = chan[i];
+    s2[i] = stamp[i];
+    r2[i] = rlen[i];
+  }
+  dealloc();
+  offs = o2;
+  chan = c2;
+  stamp = s2;
+  rlen = r2;
+  rmax = n;
+}
+
+
+//= Start a new log file, closing any previous one.
+// returns 1 if okay, 0 if file could not be created
+
+int jhcSensorLog::Record (const char *fname)
+{
+  Close();
+  if (fname == NULL)
+    return 0;
+  if (fopen_s(&out, fname, "wb") != 0)
+  {
+    out = NULL;
+    return 0;
+  }
+  t0 = jms_now();
+  if (write_hdr(0) <= 0)
+  {
+    fclose(out);
+    out = NULL;
+    return 0;
+  }
+  fpos = 64;
+  mode = 1;
+  return 1;
+}
+
+
+//= Open an old log file for playback at some rate (0 = as fast as possible).
+// returns 1 if okay, 0 if file missing or unreadable
+
+int jhcSensorLog::Replay (const char *fname, double rate)
+{
+  __int64 ioff;
+
+  Close();
+  if (fname == NULL)
+    return 0;
+  if (mf.Open(fname) <= 0)
+    return 0;
+  if (read_hdr(ioff) > 0)
+    if ((read_index(ioff) > 0) || (scan_recs() > 0))
+    {
+      speed = rate;
+      Rewind();
+      mode = 2;
+      return 1;
+    }
+  mf.Close();
+  dealloc();
+  return 0;
+}
+
+
+//= Go back to the beginning of all replay channels.
+// pacing restarts from the time of the next record read
+
+void jhcSensorLog::Rewind ()
+{
+  nc = 0;
+  tp0 = 0;
+  sync = 0;
+  done = 0;
+  last = 0;
+}
+
+
+//= Finish up any recording (append index) or playback.
+
+void jhcSensorLog::Close ()
+{
+  __int64 ioff = fpos;
+  int i;
+
+  if (out != NULL)
+  {
+    for (i = 0; i < nrec; i++)
+    {
+      put32((UL32)(offs[i] & 0xFFFFFFFF));
+      put32((UL32)(offs[i] >> 32));
+      put32(chan[i]);
+      put32(stamp[i]);
+      put32(rlen[i]);
+    }
+    fseek(out, 0, SEEK_SET);
+    write_hdr(ioff);
+    fclose(out);
+    out = NULL;
+  }
+  mf.Close();
+  dealloc();
+  nrec = 0;
+  fpos = 0;
+  mode = 0;
+}
+
+
+//= Write file marker, record count, and index location.
+
+int jhcSensorLog::write_hdr (__int64 ioff)
+{
+  int i;
+
+  fputc('S', out);
+  fputc('L', out);
+  fputc('G', out);
+  fputc('1', out);
+  put32(nrec);
+  put32((UL32)(ioff & 0xFFFFFFFF));
+  put32((UL32)(ioff >> 32));
+  put32(t0);
+  for (i = 20; i < 64; i++)
+    fputc(0, out);
+  return((ferror(out) != 0) ? 0 : 1);
+}
+
+
+//= Check marker and get record count and index location.
+// returns 0 if not a sensor log
+
+int jhcSensorLog::read_hdr (__int64& ioff)
+{
+  const UC8 *hdr;
+
+  if ((hdr = mf.Span(0, 64)) == NULL)
+    return 0;
+  if ((hdr[0] != 'S') || (hdr[1] != 'L') || (hdr[2] != 'G') || (hdr[3] != '1'))
+    return 0;
+  nrec = (int) le32(hdr + 4);
+  ioff = (__int64) le32(hdr + 8) | ((__int64) le32(hdr + 12) << 32);
+  t0 = le32(hdr + 16);
+  return 1;
+}
+
+
+//= Load record locations, tags, times, and lengths from end of file.
+// each entry is 20 bytes: offset (64 bits), tag, time (ms), length
+// returns 1 if okay, 0 if no index present
+
+int jhcSensorLog::read_index (__int64 ioff)
+{
+  const UC8 *e;
+  int i, n = nrec;
+
+  if ((ioff <= 0) || (n <= 0))
+    return 0;
+  if ((e = mf.Span(ioff, 20 * n)) == NULL)
+    return 0;
+  nrec = 0;
+  while (rmax < n)
+    grow();
+  for (i = 0; i < n; i++, e += 20)
+  {
+    offs[i]  = (__int64) le32(e) | ((__int64) le32(e + 4) << 32);
+    chan[i]  = le32(e + 8);
+    stamp[i] = le32(e + 12);
+    rlen[i]  = (int) le32(e + 16);
+  }
+  nrec = n;
+  return 1;
+}
+
+
+//= Rebuild index by walking all complete records (e.g. if not closed).
+// returns number of records found
+
+int jhcSensorLog::scan_recs ()
+{
+  const UC8 *r;
+  __int64 len, off = 64;
+
+  nrec = 0;
+  while ((r = mf.Span(off, 16)) != NULL)
+  {
+    // check for record marker and complete payload
+    if ((r[0] != 'S') || (r[1] != 'L') || (r[2] != 'G') || (r[3] != 'R'))
+      break;
+    len = 16 + (__int64) le32(r + 12);
+    if ((off + len) > mf.Size())
+      break;
+
+    // save record details
+    if (nrec >= rmax)
+      grow();
+    offs[nrec]  = off;
+    chan[nrec]  = le32(r + 4);
+    stamp[nrec] = le32(r + 8);
+    rlen[nrec]  = (int) len;
+    off += len;
+    nrec++;
+  }
+  return nrec;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                               Recording                               //
+///////////////////////////////////////////////////////////////////////////
+
+//= Save a block of bytes on some channel (tag is 4 characters).
+// returns 1 if saved, 0 if not recording or write failed
+
+int jhcSensorLog::Put (const char *tag, const UC8 *data, int n)
+{
+  return put_rec(tag, NULL, 0, data, n);
+}
+
+
+//= Save the size and pixels of an image on some channel.
+// returns 1 if saved, 0 if not recording or write failed
+
+int jhcSensorLog::PutImg (const char *tag, const jhcImg& src)
+{
+  UC8 pre[12];
+  int i, dims[3] = {src.XDim(), src.YDim(), src.Fields()};
+
+  if (!src.Valid())
+    return put_rec(tag, NULL, 0, NULL, 0);
+  for (i = 0; i < 3; i++)
+  {
+    pre[4 * i]     = (UC8)( dims[i]        & 0xFF);
+    pre[4 * i + 1] = (UC8)((dims[i] >>  8) & 0xFF);
+    pre[4 * i + 2] = (UC8)((dims[i] >> 16) & 0xFF);
+    pre[4 * i + 3] = (UC8)((dims[i] >> 24) & 0xFF);
+  }
+  return put_rec(tag, pre, 12, src.PxlSrc(), src.PxlSize());
+}
+
+
+//= Save a short list of integers (up to 64) on some channel.
+// returns 1 if saved, 0 if not recording or write failed
+
+int jhcSensorLog::PutVals (const char *tag, const int *vals, int n)
+{
+  UC8 pod[256];
+  UL32 v;
+  int i;
+
+  if ((vals == NULL) || (n < 0) || (n > 64))
+    return Fatal("Bad input to jhcSensorLog::PutVals");
+  for (i = 0; i < n; i++)
+  {
+    v = (UL32) vals[i];
+    pod[4 * i]     = (UC8)( v        & 0xFF);
+    pod[4 * i + 1] = (UC8)((v >>  8) & 0xFF);
+    pod[4 * i + 2] = (UC8)((v >> 16) & 0xFF);
+    pod[4 * i + 3] = (UC8)((v >> 24) & 0xFF);
+  }
+  return put_rec(tag, NULL, 0, pod, 4 * n);
+}
+
+
+//= Append a record made from an optional prefix and some data.
+// the first write failure ends recording (see Recording)
+// returns 1 if saved, 0 if not recording or write failed
+
+int jhcSensorLog::put_rec (const char *tag, const UC8 *pre, int n0, const UC8 *data, int n)
+{
+  UL32 t = jms_now() - t0;
+  int len = n0 + n;
+
+  if ((mode != 1) || (tag == NULL))
+    return 0;
+
+  // record header then payload
+  fputc('S', out);
+  fputc('L', out);
+  fputc('G', out);
+  fputc('R', out);
+  put32(tag_val(tag));
+  put32(t);
+  put32(len);
+  if (n0 > 0)
+    fwrite(pre, 1, n0, out);
+  if (n > 0)
+    fwrite(data, 1, n, out);
+  if (ferror(out) != 0)
+  {
+    // file position now unknown so stop recording altogether
+    // header claims no index so replay rescans the complete records
+    clearerr(out);
+    fseek(out, 0, SEEK_SET);
+    write_hdr(0);
+    fclose(out);
+    out = NULL;
+    Close();
+    return 0;
+  }
+
+  // add to index
+  if (nrec >= rmax)
+    grow();
+  offs[nrec]  = fpos;
+  chan[nrec]  = tag_val(tag);
+  stamp[nrec] = t;
+  rlen[nrec]  = 16 + len;
+  fpos += 16 + len;
+  nrec++;
+  last = t;
+  return 1;
+}
+
+
+//= Write a 32 bit value in little-endian order.
+
+void jhcSensorLog::put32 (UL32 v)
+{
+  fputc( v        & 0xFF, out);
+  fputc((v >>  8) & 0xFF, out);
+  fputc((v >> 16) & 0xFF, out);
+  fputc((v >> 24) & 0xFF, out);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                                Replay                                 //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get payload of next record on some channel (tag is 4 characters).
+// waits (if needed) until record time is reached at current replay speed
+// returned pointer is only valid until next Get (if file not fully mapped)
+// returns NULL (and n = 0) if not replaying or no more records on channel
+
+const UC8 *jhcSensorLog::Get (const char *tag, int& n)
+{
+  const UC8 *r;
+  UL32 t;
+  int c, i;
+
+  // find next record with right tag
+  n = 0;
+  if ((mode != 2) || (tag == NULL))
+    return NULL;
+  t = tag_val(tag);
+  if ((c = channel(t)) < 0)
+    return NULL;
+  for (i = cpos[c]; i < nrec; i++)
+    if (chan[i] == t)
+      break;
+  if (i >= nrec)
+  {
+    cpos[c] = nrec;
+    done = 1;
+    return NULL;
+  }
+  cpos[c] = i + 1;
+
+  // check marker then possibly wait for proper time
+  if ((r = mf.Span(offs[i], rlen[i])) == NULL)
+    return NULL;
+  if ((r[0] != 'S') || (r[1] != 'L') || (r[2] != 'G') || (r[3] != 'R'))
+    return NULL;
+  last = stamp[i];
+  pace(last);
+  n = rlen[i] - 16;
+  return(r + 16);
+}
+
+
+//= Get next image recorded on some channel (resizes destination).
+// returns 1 if okay, 0 if no more images or invalid image recorded
+
+int jhcSensorLog::GetImg (jhcImg& dest, const char *tag)
+{
+  const UC8 *r;
+  int w, h, f, n;
+
+  if ((r = Get(tag, n)) == NULL)
+    return 0;
+  if (n < 12)
+    return 0;
+  w = (int) le32(r);
+  h = (int) le32(r + 4);
+  f = (int) le32(r + 8);
+  if ((w <= 0) || (h <= 0) || (f <= 0))
+    return 0;
+  dest.SetSize(w, h, f);
+  if (n != (12 + dest.PxlSize()))
+    return 0;
+  dest.CopyArr(r + 12);
+  return 1;
+}
+
+
+//= Get next list of integers recorded on some channel.
+// any values not found in record are set to zero
+// returns number of values actually read
+
+int jhcSensorLog::GetVals (int *vals, const char *tag, int n)
+{
+  const UC8 *r;
+  int i, cnt, len;
+
+  if ((vals == NULL) || (n <= 0))
+    return Fatal("Bad input to jhcSensorLog::GetVals");
+  r = Get(tag, len);
+  cnt = __min(n, len >> 2);
+  for (i = 0; i < cnt; i++)
+    vals[i] = (int) le32(r + 4 * i);
+  for (i = cnt; i < n; i++)
+    vals[i] = 0;
+  return cnt;
+}
+
+
+//= Find read position for channel with given tag (creates if new).
+// returns channel index, negative if too many different tags
+
+int jhcSensorLog::channel (UL32 t)
+{
+  int c;
+
+  for (c = 0; c < nc; c++)
+    if (ctag[c] == t)
+      return c;
+  if (nc >= cmax)
+    return -1;
+  ctag[nc] = t;
+  cpos[nc] = 0;
+  return nc++;
+}
+
+
+//= Wait until some record time (ms) is reached given replay speed.
+// first record read sets correspondence between recorded and real time
+
+void jhcSensorLog::pace (UL32 ms)
+{
+  UL32 dt;
+
+  if (speed <= 0.0)
+    return;
+  dt = (UL32)(ms / speed + 0.5);
+  if (sync <= 0)
+  {
+    tp0 = jms_now() - dt;
+    sync = 1;
+    return;
+  }
+  jms_resume(tp0 + dt);
+}
+
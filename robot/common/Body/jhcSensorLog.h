@@ -0,0 +1,156 @@
+// jhcSensorLog.h : time stamped record of robot sensor inputs for later replay
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCSENSORLOG_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCSENSORLOG_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include <stdio.h>
+
+#include "Data/jhcImg.h"               // common video
+#include "Interface/jhcMapFile.h"
+
+
+//= Time stamped record of robot sensor inputs for later replay.
+// each input consumed by a body (images, servo packets, odometry, etc.) is
+// saved as a record with a 4 character channel tag and the time it arrived
+// during replay each channel is read back in the same order it was written
+// so a deterministic consumer sees exactly the same inputs on every run
+// replay can be paced to match the original timing (speed = 1.0), run
+// faster or slower, or just go as fast as possible (speed = 0.0)
+// file format (all values little-endian):
+//   SLG1  = type marker and version (ASCII)
+//   nnnn  = total count of records in file (unsigned long)
+//   iiii  = byte offset of record index (64 bits, 0 if never closed)
+//   tttt  = absolute start time in ms (unsigned long)
+//   <pad> = zeroes out to 64 bytes
+// each record is:
+//   SLGR  = record marker (ASCII)
+//   cccc  = channel tag (ASCII)
+//   tttt  = time stamp in ms since start (unsigned long)
+//   llll  = length of payload (unsigned long)
+//   <D>   = payload bytes
+// index of record offsets, tags, times, and lengths is appended by Close
+// NOTE: calls must not overlap (fine for strictly alternating threads)
+// <pre>
+// typical use:
+//
+//   log.Record("run.slg");                 log.Replay("run.slg");
+//   ...                                    ...
+//   log.PutImg("COLR", col);               log.GetImg(col, "COLR");
+//   log.Put("MIC ", dirs, n);              dirs = log.Get("MIC ", n);
+//   ...                                    ...
+//   log.Close();                           log.Close();
+// </pre>
+
+class jhcSensorLog
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  static const int cmax = 16;          /** Maximum number of replay channels. */
+
+  // record index
+  __int64 *offs;
+  UL32 *chan, *stamp;
+  int *rlen;
+  int nrec, rmax, mode;
+
+  // recording
+  FILE *out;
+  __int64 fpos;
+  UL32 t0;
+
+  // replay
+  jhcMapFile mf;
+  UL32 ctag[cmax];
+  int cpos[cmax];
+  int nc, sync, done;
+  UL32 tp0, last;
+
+
+// PUBLIC MEMBER VARIABLES
+public:
+  double speed;  /** Replay rate wrt recording (0 = as fast as possible). */
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcSensorLog ();
+  jhcSensorLog ();
+  int Record (const char *fname);
+  int Replay (const char *fname, double rate =1.0);
+  void Rewind ();
+  void Close ();
+  int Recording () const {return((mode == 1) ? 1 : 0);}
+  int Replaying () const {return((mode == 2) ? 1 : 0);}
+  int Records () const   {return nrec;}                     /** Number of records in file.   */
+  UL32 Stamp () const    {return last;}                     /** Time of last record (ms).    */
+  int Done () const      {return done;}                     /** Some replay channel ran out. */
+  UL32 Duration () const {return((nrec > 0) ? stamp[nrec - 1] : 0);}
+
+  // recording
+  int Put (const char *tag, const UC8 *data, int n);
+  int PutImg (const char *tag, const jhcImg& src);
+  int PutVals (const char *tag, const int *vals, int n);
+
+  // replay
+  const UC8 *Get (const char *tag, int& n);
+  int GetImg (jhcImg& dest, const char *tag);
+  int GetVals (int *vals, const char *tag, int n);
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  void dealloc ();
+  void grow ();
+  int write_hdr (__int64 ioff);
+  int read_hdr (__int64& ioff);
+  int read_index (__int64 ioff);
+  int scan_recs ();
+
+  // recording
+  int put_rec (const char *tag, const UC8 *pre, int n0, const UC8 *data, int n);
+  void put32 (UL32 v);
+
+  // replay
+  int channel (UL32 t);
+  void pace (UL32 ms);
+
+  // encoding
+  UL32 tag_val (const char *tag) const
+    {return((UL32) tag[0] | ((UL32) tag[1] << 8) | ((UL32) tag[2] << 16) | ((UL32) tag[3] << 24));}
+  UL32 le32 (const UC8 *p) const
+    {return((UL32) p[0] | ((UL32) p[1] << 8) | ((UL32) p[2] << 16) | ((UL32) p[3] << 24));}
+
+};
+
+
+#endif  // once
+
+
+
+
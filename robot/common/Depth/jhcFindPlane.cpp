@@ -47,6 +47,11 @@ jhcFindPlane::jhcFindPlane ()
   // run silent
   noisy = 0;
 
+  // no plane to track yet
+  prev = 0;
+  tmode = 0;
+  tcnt = 0;
+
   // assume standard image size
   ilim = 0;
   SetSize(640, 480);
@@ -84,6 +89,53 @@ int jhcFindPlane::fit_params (const char *fname)
 }
 
 
+//= Parameters used for tracking plane from one frame to the next.
+// tracked estimate is abandoned if residual grows by too much (or too few points)
+// a full search is still forced every so often to catch gradual drift
+
+int jhcFindPlane::track_params (const char *fname)
+{
+  jhcParam *ps = &tps;
+  int ok;
+
+  ps->SetTag("plane_track", 0);
+  ps->NextSpec4( &track,  1,   "Track between frames");
+  ps->NextSpec4( &tsub,   2,   "Extra tracking subsample");
+  ps->NextSpecF( &tband,  1.5, "Gating band around plane (in)");
+  ps->NextSpecF( &tgrow,  1.5, "Max err increase for tracking");
+  ps->NextSpec4( &tpts,  50,   "Min tracked points");
+  ps->NextSpecF( &tfrac, 50.0, "Min pct of initial points");
+  ps->NextSpec4( &tfull, 30,   "Full search interval (frames)");
+  ok = ps->LoadDefs(fname);
+  ps->RevertAll();
+  return ok;
+}
+
+
+//= Read all relevant defaults variable values from a file.
+
+int jhcFindPlane::Defaults (const char *fname)
+{
+  int ok = 1;
+
+  ok &= fit_params(fname);
+  ok &= track_params(fname);
+  return ok;
+}
+
+
+//= Write current processing variable values to a file.
+
+int jhcFindPlane::SaveVals (const char *fname) const
+{
+  int ok = 1;
+
+  ok &= fps.SaveVals(fname);
+  ok &= tps.SaveVals(fname);
+  return ok;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                             Configuration                             //
 ///////////////////////////////////////////////////////////////////////////
@@ -100,9 +152,10 @@ void jhcFindPlane::SetSize (const jhcImg& ref)
 
 void jhcFindPlane::SetSize (int x, int y)
 {
-  // remember size
+  // remember size (old plane no longer applies)
   iw = x;
   ih = y;
+  prev = 0;
 
   // possibly rebuild point arrays
   alloc_pts(__max(x, y));
@@ -158,6 +211,7 @@ rsz.FlipV(dalt, d16);
 // if dh > 0 then constrains surface to be within dh of h value given (also needs to know t)
 // returns avg error of new estimate, negative if could not find plane
 // takes about 0.2ms (V) or 0.3ms (H) for VGA 4x4 subsample on 1.6GHz i7
+// if "track" > 0 then first tries refining previous plane (about 1/4 the time)
 // NOTE: leaves t, r, and h unchanged if unable to find a valid plane
 
 double jhcFindPlane::Fit3D (double& t, double& r, double& h, const jhcImg& d16, 
@@ -171,6 +225,23 @@ double jhcFindPlane::Fit3D (double& t, double& r, double& h, const jhcImg& d16,
     return Fatal("Bad images to jhcFindPlane::Fit3D");
   jprintf(2, noisy, "\njhcFindPlane::Fit3D with dir = %d, dh = %3.1f\n", dir, dh);
 
+  // try cheap update of last plane found (if any)
+  tmode = 0;
+  if ((track > 0) && (prev > 0) && (dir == tdir) && ((tfull <= 0) || (since < tfull)))
+  {
+    if (track_fit(d16, dir, dsc, finv) >= 0.0)
+    {
+      since++;
+      tmode = 1;
+      h = ht;
+      t = tilt;
+      r = roll;
+      return err;
+    }
+    jprintf(2, noisy, "  tracking failed -> full search\n");
+  }
+  prev = 0;
+
   // get potential seed points 
   if (dir <= 0)
     vbot_bands(d16, dsc, finv);
@@ -200,6 +271,12 @@ double jhcFindPlane::Fit3D (double& t, double& r, double& h, const jhcImg& d16,
   tilt = stats[12] - 90.0;            // 0 degs is camera horizontal
   roll = stats[13];
 
+  // remember plane for tracking on next frame
+  save_plane(stats);
+  eref = err;
+  tdir = dir;
+  since = 0;
+
   // return through variables
   h = ht;
   t = tilt;
@@ -346,6 +423,117 @@ int jhcFindPlane::try_band (double s[], int b) const
 }
 
 
+///////////////////////////////////////////////////////////////////////////
+//                        Frame-to-Frame Tracking                        //
+///////////////////////////////////////////////////////////////////////////
+
+//= Refit previous plane using only depth points close to it.
+// samples image more sparsely than seed bands and skips line fitting and cliques
+// all gated points go directly into least squares sums for a new plane
+// returns avg error of new estimate, negative if full search is needed
+// NOTE: band seed points (used by Seeds) are not updated
+
+double jhcFindPlane::track_fit (const jhcImg& d16, int dir, double dsc, double finv)
+{
+  int x0 = d16.RoiX(), y0 = d16.RoiY(), xlim = d16.RoiLimX(), ylim = d16.RoiLimY();
+  int xs = hstep * __max(1, tsub), ys = vstep * __max(1, tsub), rln = ys * (d16.Line() >> 1);
+  double hw = 0.5 * iw, hh = 0.5 * ih, lim = tband * sqrt(pa * pa + pb * pb + 1.0);
+  double kxx = 1.0, kxy = 0.0, kyx = 0.0, kyy = 1.0, fa = pa * finv, fb = pb * finv;
+  double Sx = 0.0, Sy = 0.0, Sz = 0.0, Sxx = 0.0, Syy = 0.0, Szz = 0.0;
+  double Sxy = 0.0, Sxz = 0.0, Syz = 0.0, num = 0.0;
+  double s[14], u, v, g, du, dv, dg, z, res, px, py;
+  int x, y, d;
+  const US16 *p, *r = (const US16 *) d16.RoiSrc();
+
+  // image to camera axes for each scan direction (see seed point functions)
+  if (dir == 1)
+    kyy = -1.0;
+  else if (dir >= 2)
+  {
+    kxx = 0.0;
+    kxy = 1.0;
+    kyx = ((dir == 2) ? 1.0 : -1.0);
+    kyy = 0.0;
+  }
+  du = kxx * xs;
+  dv = kyx * xs;
+  dg = -(fa * du + fb * dv);
+
+  // accumulate statistics for points within band around predicted plane
+  // camera coords are (d * u / f, d * v / f, d) so residual is d * g - pc
+  for (y = y0; y <= ylim; y += ys, r += rln)
+  {
+    u = kxx * (x0 - hw) + kxy * (y - hh);
+    v = kyx * (x0 - hw) + kyy * (y - hh);
+    g = 1.0 - fa * u - fb * v;
+    p = r;
+    for (x = x0; x <= xlim; x += xs, p += xs, u += du, v += dv, g += dg)
+    {
+      if (((d = *p) < 1760) || (d > 40000))
+        continue;
+      z = dsc * d;
+      res = z * g - pc;
+      if ((res >= lim) || (res <= -lim))
+        continue;
+      px = z * finv * u;
+      py = z * finv * v;
+      Sx  += px;
+      Sy  += py;
+      Sz  += z;
+      Sxx += px * px;
+      Syy += py * py;
+      Szz += z * z;
+      Sxy += px * py;
+      Sxz += px * z;
+      Syz += py * z;
+      num += 1.0;
+    }
+  }
+
+  // check for enough support then solve for new plane
+  tcnt = (int) num;
+  jprintf(2, noisy, "  tracking with %d points\n", tcnt);
+  if (since <= 0)
+    tref = tcnt;
+  if ((tcnt < __max(3, tpts)) || (tcnt < (0.01 * tfrac * tref)))
+    return -1.0;
+  s[0] = Sx;
+  s[1] = Sy;
+  s[2] = Sz;
+  s[3] = Sxx;
+  s[4] = Syy;
+  s[5] = Szz;
+  s[6] = Sxy;
+  s[7] = Sxz;
+  s[8] = Syz;
+  s[9] = num;
+  if (plane_err(s) > tgrow * __max(eref, 0.1))
+    return -1.0;
+
+  // accept new estimate and follow plane
+  err  = s[10];
+  ht   = s[11];
+  tilt = s[12] - 90.0;
+  roll = s[13];
+  save_plane(s);
+  return err;
+}
+
+
+//= Recover z = a * x + b * y + c plane coefficients from fitted statistics.
+// uses ht, tilt, and roll values recorded by plane_err
+
+void jhcFindPlane::save_plane (const double s[])
+{
+  double tn = tan(D2R * s[12]), rads = D2R * s[13];
+
+  pa = tn * sin(rads);
+  pb = tn * cos(rads);
+  pc = s[11] * sqrt(pa * pa + pb * pb + 1.0);
+  prev = 1;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                     Least Squares Plane Fitting                       //
 ///////////////////////////////////////////////////////////////////////////
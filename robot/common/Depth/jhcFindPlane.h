@@ -56,6 +56,10 @@ private:
   double fit[bands], ang[bands], off[bands];
   double err, ht, tilt, roll; 
 
+  // plane tracking between frames
+  double pa, pb, pc, eref;
+  int prev, tdir, since, tmode, tcnt, tref;
+
 
 // PROTECTED MEMBER VARIABLES
 protected:
@@ -73,6 +77,11 @@ public:
   int vstep, hstep, pmin, bmin;
   double fmin, dev, htol, atol;
 
+  // frame-to-frame tracking parameters
+  jhcParam tps;
+  int track, tsub, tpts, tfull;
+  double tband, tgrow, tfrac;
+
 
 // PUBLIC MEMBER FUNCTIONS
 public:
@@ -81,8 +90,8 @@ public:
   jhcFindPlane ();
 
   // processing parameter manipulation 
-  int Defaults (const char *fname =NULL) {return fit_params(fname);}
-  int SaveVals (const char *fname) const {return fps.SaveVals(fname);}
+  int Defaults (const char *fname =NULL);
+  int SaveVals (const char *fname) const;
 
   // configuration
   void SetSize (const jhcImg& ref);
@@ -99,6 +108,11 @@ public:
   double EstTilt () const {return tilt;}
   double EstRoll () const {return roll;}
 
+  // frame-to-frame tracking status
+  void Untrack () {prev = 0;}                 /** Force full search next time.   */
+  int Tracked () const {return tmode;}        /** Whether last fit was tracked.  */
+  int TrackPts () const {return tcnt;}        /** Points used by last tracking.  */
+
   // access to line merging results
   int LineKeep (int b) const   {return keep[__max(0, __min(b, bands - 1))];}
   int LineCnt (int b) const    {return  vpt[__max(0, __min(b, bands - 1))];}
@@ -120,6 +134,11 @@ public:
 private:
   // processing parameters
   int fit_params (const char *fname);
+  int track_params (const char *fname);
+
+  // plane tracking
+  double track_fit (const jhcImg& d16, int dir, double dsc, double finv);
+  void save_plane (const double s[]);
 
   // plane from lines
   int form_clique (double s[], int group[]) const;
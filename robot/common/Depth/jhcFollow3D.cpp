@@ -208,7 +208,7 @@ int jhcFollow3D::FindLeader (double gaze, double dinit)
 //= Generate candidate blobs for nearby people.
 // builds floor projection "wproj", components "wcc", and blob list "dudes"
 // blob mark: 0 = bad size, 1 = bad shape, 2 = possible
-// assumes orthogonal world coordinates already found (CacheXYZ)
+// assumes depth already bound to surface (CacheXYZ or FloorMap)
 
 void jhcFollow3D::leader_blobs ()
 {
@@ -303,7 +303,7 @@ void jhcFollow3D::AdjLeader (double dx, double dy, double da)
 
 //= Take full-sized input and mark tracked person in half-sized output.
 // input is color, output is monochrome except for person's waist
-// assumes orthogonal world coordinates already found (sf->CacheXYZ)
+// assumes depth already bound to surface (sf->CacheXYZ or FloorMap)
 
 int jhcFollow3D::TagLeader (jhcImg& dest, const jhcImg& src)
 {
@@ -349,7 +349,7 @@ int jhcFollow3D::TagLeader (jhcImg& dest, const jhcImg& src)
 //= Make a nice overhead view of target and other obstacles.
 // needs an image LeaderWid() x LeaderHt() x 1 as input
 // leader = red (230), shape = yellow (230), size = green (128), other = blue (70) 
-// assumes orthogonal world coordinates already found (CacheXYZ)
+// assumes depth already bound to surface (CacheXYZ or FloorMap)
 // does not do motion filtering step
 
 int jhcFollow3D::ProjLeader (jhcImg& dest, double foff, double dinit)
@@ -0,0 +1,417 @@
+// jhcMapFuse.cpp : merges overhead maps from several depth sensors in background
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <windows.h>
+#include <process.h>
+
+#include "Interface/jhcMessage.h"    // common video
+
+#include "Depth/jhcMapFuse.h"        // common robot
+
+
+//= Tells each background thread which sensor it serves.
+
+typedef struct
+{
+  jhcMapFuse *me;
+  int cam;
+} jhc_fuse_arg;
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcMapFuse::~jhcMapFuse ()
+{
+  Stop();
+  dealloc();
+  DeleteCriticalSection((CRITICAL_SECTION *) ilock);
+  DeleteCriticalSection((CRITICAL_SECTION *) mlock);
+  DeleteCriticalSection((CRITICAL_SECTION *) flock);
+  delete ((CRITICAL_SECTION *) ilock);
+  delete ((CRITICAL_SECTION *) mlock);
+  delete ((CRITICAL_SECTION *) flock);
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcMapFuse::jhcMapFuse ()
+{
+  // no sensors yet
+  proj = NULL;
+  in = NULL;
+  part = NULL;
+  gpend = NULL;
+  gnow = NULL;
+  tin = NULL;
+  tpart = NULL;
+  isel = NULL;
+  psel = NULL;
+  pend = NULL;
+  got = NULL;
+  zpend = NULL;
+  znow = NULL;
+  args = NULL;
+  wake = NULL;
+  fcn = NULL;
+  ns = 0;
+  run = 0;
+
+  // locks for inputs, merging, and output
+  ilock = (void *) new CRITICAL_SECTION;
+  mlock = (void *) new CRITICAL_SECTION;
+  flock = (void *) new CRITICAL_SECTION;
+  InitializeCriticalSection((CRITICAL_SECTION *) ilock);
+  InitializeCriticalSection((CRITICAL_SECTION *) mlock);
+  InitializeCriticalSection((CRITICAL_SECTION *) flock);
+
+  // default processing parameters
+  stale = 500;
+  front = 0;
+  seq = 0;
+  nsub = 0;
+  ndrop = 0;
+  nproj = 0;
+}
+
+
+//= Get rid of all per-sensor structures.
+// assumes background threads have already been stopped
+
+void jhcMapFuse::dealloc ()
+{
+  delete [] (jhc_fuse_arg *) args;
+  delete [] fcn;
+  delete [] wake;
+  delete [] znow;
+  delete [] zpend;
+  delete [] got;
+  delete [] pend;
+  delete [] psel;
+  delete [] isel;
+  delete [] tpart;
+  delete [] tin;
+  delete [] gnow;
+  delete [] gpend;
+  delete [] part;
+  delete [] in;
+  delete [] proj;
+  ns = 0;
+}
+
+
+//= Set up for n sensors of given size feeding maps like "ref" and start threads.
+// "f" and "sc" are the focal length and depth scaling shared by all sensors
+// returns 1 if okay, 0 or negative for problem
+
+int jhcMapFuse::Start (int n, const jhcImg& ref, int w, int h, double f, double sc)
+{
+  jhc_fuse_arg *a;
+  int i;
+
+  if ((n <= 0) || (n > 32) || !ref.Valid(1))
+    return Fatal("Bad input to jhcMapFuse::Start");
+
+  // get rid of any old configuration
+  Stop();
+  dealloc();
+
+  // make per-sensor structures
+  ns = n;
+  proj  = new jhcSurface3D [n];
+  in    = new jhcImg [2 * n];
+  part  = new jhcImg [2 * n];
+  gpend = new double [n * ng];
+  gnow  = new double [n * ng];
+  tin   = new UL32 [n];
+  tpart = new UL32 [n];
+  isel  = new int [n];
+  psel  = new int [n];
+  pend  = new int [n];
+  got   = new int [n];
+  zpend = new int [n];
+  znow  = new int [n];
+  wake  = new void * [n];
+  fcn   = new void * [n];
+  a = new jhc_fuse_arg [n];
+  args = (void *) a;
+
+  // size images and clear state
+  for (i = 0; i < n; i++)
+  {
+    proj[i].SetOptics(f, sc);
+    proj[i].SetSize(w, h, 1);
+    in[2 * i].SetSize(w, h, 2);
+    in[2 * i + 1].SetSize(w, h, 2);
+    part[2 * i].SetSize(ref);
+    part[2 * i + 1].SetSize(ref);
+    isel[i] = 0;
+    psel[i] = 0;
+    pend[i] = 0;
+    got[i] = 0;
+    tin[i] = 0;
+    tpart[i] = 0;
+  }
+  fused[0].InitSize(ref, 0);
+  fused[1].InitSize(ref, 0);
+  fstamp[0] = 0;
+  fstamp[1] = 0;
+  fmask[0] = 0;
+  fmask[1] = 0;
+  front = 0;
+  seq = 0;
+  nsub = 0;
+  ndrop = 0;
+  nproj = 0;
+
+  // start one worker per sensor
+  run = 1;
+  for (i = 0; i < n; i++)
+  {
+    a[i].me = this;
+    a[i].cam = i;
+    wake[i] = (void *) CreateEvent(NULL, FALSE, FALSE, NULL);  // auto-reset
+    fcn[i] = (void *) _beginthreadex(NULL, 0, fuse_backg, a + i, 0, NULL);
+  }
+  return 1;
+}
+
+
+//= Stop all background threads (keeps last fused map).
+// waits as long as needed since workers use the shared images
+
+void jhcMapFuse::Stop ()
+{
+  int i;
+
+  if (run <= 0)
+    return;
+  run = 0;
+  for (i = 0; i < ns; i++)
+    SetEvent((HANDLE) wake[i]);
+  for (i = 0; i < ns; i++)
+  {
+    if (WaitForSingleObject((HANDLE) fcn[i], INFINITE) != WAIT_OBJECT_0)
+      jprintf(">>> Never got thread termination in jhcMapFuse::Stop\n");
+    CloseHandle((HANDLE) fcn[i]);
+    CloseHandle((HANDLE) wake[i]);
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Hand over a new depth frame from some sensor along with its time of capture.
+// "geom" holds 11 values: camera x y z, view pan tilt roll, then map
+// bottom top cutoff ipp and range (as for jhcSurface3D::SetProject)
+// image is copied so caller can immediately reuse it, never blocks on projection
+// replaces any earlier frame from same sensor not yet projected (counted as dropped)
+// returns 1 if accepted, 0 if threads not running, negative for error
+
+int jhcMapFuse::Submit (int cam, const jhcImg& d16, UL32 tstamp, const double *geom, int zst)
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) ilock;
+  double *g;
+  int i;
+
+  if ((cam < 0) || (cam >= ns) || (geom == NULL) || !d16.SameFormat(in[2 * cam]))
+    return Fatal("Bad input to jhcMapFuse::Submit");
+  if (run <= 0)
+    return 0;
+
+  // copy image and geometry into slot not being projected
+  EnterCriticalSection(cs);
+  in[2 * cam + isel[cam]].CopyArr(d16);
+  g = gpend + cam * ng;
+  for (i = 0; i < ng; i++)
+    g[i] = geom[i];
+  zpend[cam] = zst;
+  tin[cam] = tstamp;
+  if (pend[cam] > 0)
+    ndrop++;
+  pend[cam] = 1;
+  nsub++;
+  LeaveCriticalSection(cs);
+
+  // tell worker it has something to do
+  SetEvent((HANDLE) wake[cam]);
+  return 1;
+}
+
+
+//= Copy the most recent complete fused map into destination.
+// can optionally return timestamp of newest frame used and bit mask of sensors
+// returns publication count (changes with each new map), 0 if nothing yet
+// NOTE: destination left unchanged if nothing has been published
+
+int jhcMapFuse::Latest (jhcImg& dest, UL32 *tstamp, UL32 *used)
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) flock;
+  int n;
+
+  if (!dest.SameFormat(fused[0]))
+    return Fatal("Bad images to jhcMapFuse::Latest");
+
+  EnterCriticalSection(cs);
+  if ((n = seq) > 0)
+  {
+    dest.CopyArr(fused[front]);
+    if (tstamp != NULL)
+      *tstamp = fstamp[front];
+    if (used != NULL)
+      *used = fmask[front];
+  }
+  LeaveCriticalSection(cs);
+  return n;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                         Background Processing                         //
+///////////////////////////////////////////////////////////////////////////
+
+//= Projection thread for one sensor.
+
+unsigned int __stdcall jhcMapFuse::fuse_backg (void *arg)
+{
+  jhc_fuse_arg *a = (jhc_fuse_arg *) arg;
+
+  return((unsigned int) (a->me)->work_loop(a->cam));
+}
+
+
+//= Wait for new frames from sensor and turn each into a partial map.
+
+int jhcMapFuse::work_loop (int cam)
+{
+  while (WaitForSingleObject((HANDLE) wake[cam], INFINITE) == WAIT_OBJECT_0)
+  {
+    if (run <= 0)
+      break;
+    project(cam);
+  }
+  return 1;
+}
+
+
+//= Project newest pending frame then publish new fused map.
+// partial map is built in unused half of sensor's pair so merging is never blocked
+
+void jhcMapFuse::project (int cam)
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) ilock, *ms = (CRITICAL_SECTION *) mlock;
+  jhcSurface3D *s = proj + cam;
+  const double *g = gnow + cam * ng;
+  UL32 t;
+  int i, src, c2 = 2 * cam;
+
+  // claim pending frame and make other slot available to Submit
+  EnterCriticalSection(cs);
+  if (pend[cam] <= 0)
+  {
+    LeaveCriticalSection(cs);
+    return;
+  }
+  src = isel[cam];
+  isel[cam] ^= 1;
+  pend[cam] = 0;
+  for (i = 0; i < ng; i++)
+    gnow[cam * ng + i] = gpend[cam * ng + i];
+  znow[cam] = zpend[cam];
+  t = tin[cam];
+  LeaveCriticalSection(cs);
+
+  // build partial map with this sensor's own projector
+  s->SetCamera(g[0], g[1], g[2]);
+  s->SetView(g[3], g[4], g[5]);
+  s->SetProject(g[6], g[7], g[8], g[9], g[10]);
+  s->FloorMap2(part[c2 + (psel[cam] ^ 1)], in[c2 + src], 1, znow[cam]);
+
+  // swap in new partial and combine with others
+  EnterCriticalSection(ms);
+  psel[cam] ^= 1;
+  tpart[cam] = t;
+  got[cam] = 1;
+  nproj++;
+  merge();
+  LeaveCriticalSection(ms);
+}
+
+
+//= Combine all recent partial maps into back buffer then make it current.
+// assumes merge lock is held, readers of front buffer are never blocked long
+
+void jhcMapFuse::merge ()
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) flock;
+  jhcImg *dest = fused + (front ^ 1);
+  UL32 newest = 0, mask = 0;
+  int i, any = 0;
+
+  // find time of most recent partial map
+  for (i = 0; i < ns; i++)
+    if (got[i] > 0)
+      if ((any++ <= 0) || ((int)(tpart[i] - newest) > 0))
+        newest = tpart[i];
+
+  // take maximum height over all partial maps not too old
+  for (i = 0; i < ns; i++)
+    if (got[i] > 0)
+      if ((stale <= 0) || ((int)(newest - tpart[i]) <= stale))
+      {
+        if (mask == 0)
+          dest->CopyArr(part[2 * i + psel[i]]);
+        else
+          max_into(*dest, part[2 * i + psel[i]]);
+        mask |= (0x01U << i);
+      }
+
+  // publish new map
+  EnterCriticalSection(cs);
+  front ^= 1;
+  fstamp[front] = newest;
+  fmask[front] = mask;
+  seq++;
+  LeaveCriticalSection(cs);
+}
+
+
+//= Keep larger of destination and source pixel values.
+
+void jhcMapFuse::max_into (jhcImg& dest, const jhcImg& src) const
+{
+  int x, y, w = dest.XDim(), h = dest.YDim(), sk = dest.Skip();
+  const UC8 *s = src.PxlSrc();
+  UC8 *d = dest.PxlDest();
+
+  for (y = h; y > 0; y--, d += sk, s += sk)
+    for (x = w; x > 0; x--, d++, s++)
+      if (*s > *d)
+        *d = *s;
+}
+
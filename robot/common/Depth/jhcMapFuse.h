@@ -0,0 +1,128 @@
+// jhcMapFuse.h : merges overhead maps from several depth sensors in background
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCMAPFUSE_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCMAPFUSE_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"             // common video
+
+#include "Depth/jhcSurface3D.h"      // common robot
+
+
+//= Merges overhead maps from several depth sensors in background threads.
+// each sensor has its own worker which projects the newest submitted frame
+// into a private partial map, then all current partial maps are combined
+// by taking the maximum height in each cell and published via a double buffer
+// consumers copy the latest complete map and never wait for a slow sensor
+// a sensor submitting faster than it can be projected simply drops frames
+// partial maps more than "stale" ms older than the newest one are left out
+// <pre>
+// typical use:
+//
+//   fuse.Start(2, map, 640, 480);
+//   fuse.Submit(0, d16a, jms_now(), geom0);     // whenever a frame arrives
+//   fuse.Submit(1, d16b, jms_now(), geom1);
+//   fuse.Latest(map);                           // whenever map is needed
+//
+// </pre>
+
+class jhcMapFuse
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  static const int ng = 11;  /** Camera geometry values per frame. */
+
+  // per sensor projection (two images each)
+  jhcSurface3D *proj;
+  jhcImg *in, *part;
+  double *gpend, *gnow;
+  UL32 *tin, *tpart;
+  int *isel, *psel, *pend, *got, *zpend, *znow;
+  void *args;
+
+  // fused double buffer
+  jhcImg fused[2];
+  UL32 fstamp[2];
+  UL32 fmask[2];
+  int front, seq;
+
+  // thread control
+  void **wake, **fcn;
+  void *ilock, *mlock, *flock;
+  volatile int run;
+  int ns;
+
+  // statistics
+  int nsub, ndrop, nproj;
+
+
+// PUBLIC MEMBER VARIABLES
+public:
+  int stale;                 /** Max age difference of partial maps (ms). */
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcMapFuse ();
+  jhcMapFuse ();
+  int Start (int n, const jhcImg& ref, int w =640, int h =480, double f =525.0, double sc =0.9659);
+  void Stop ();
+  int Running () const {return run;}
+  int Sensors () const {return ns;}
+
+  // main functions
+  int Submit (int cam, const jhcImg& d16, UL32 tstamp, const double *geom, int zst =0);
+  int Latest (jhcImg& dest, UL32 *tstamp =NULL, UL32 *used =NULL);
+
+  // statistics
+  int Submitted () const {return nsub;}   /** Frames given to Submit.        */
+  int Dropped () const   {return ndrop;}  /** Frames replaced before use.    */
+  int Projected () const {return nproj;}  /** Frames turned into maps.       */
+  int Published () const {return seq;}    /** Fused maps made available.     */
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  void dealloc ();
+
+  // background processing
+  static unsigned int __stdcall fuse_backg (void *arg);
+  int work_loop (int cam);
+  void project (int cam);
+  void merge ();
+  void max_into (jhcImg& dest, const jhcImg& src) const;
+
+
+};
+
+
+#endif  // once
+
+
+
+
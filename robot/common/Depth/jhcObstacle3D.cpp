@@ -173,7 +173,7 @@ int jhcObstacle3D::occ_params (const char *fname)
 //   da = change in heading (body) direction (wrt previous)
 //   ht = height of camera relative to floor
 // dx and dy are relative to robot wheelbase midpoint (not camera)
-// assumes orthogonal world coordinates already found (CacheXYZ)
+// assumes depth already bound to surface (CacheXYZ or FloorMap)
 // 0 = obstacle, 255 = floor, 128 = unknown
 
 void jhcObstacle3D::BuildFree (double dx, double dy, double da, double ht)
@@ -206,7 +206,7 @@ void jhcObstacle3D::BuildFree (double dx, double dy, double da, double ht)
   // threshold and shrink by robot size
   t.Threshold(fbin, fsp, 128 + fclr);
 //  t.Nearest8(fmv, fbin, 0, &fdist); 
-  t.Voronoi8(fmv, fbin, 255, &fdist); 
+  t.Euclid8(fmv, fbin, 255, &fdist); 
   t.Threshold(fmv, fdist, ROUND((0.5 * rwide + flank) / fpp));
 t.ClipScale(fdist, fdist, 128.0 * fpp / (0.5 * rwide + flank));
 
@@ -736,6 +736,76 @@ void jhcOverhead3D::Interpolate (int sc, int pmin)
 }
 
 
+///////////////////////////////////////////////////////////////////////////
+//                     Concurrent Multi-Sensor Ingest                    //
+///////////////////////////////////////////////////////////////////////////
+
+//= Start background projection of all sensors into one double buffered map.
+// "stale" is max age (ms) of a sensor's map relative to newest one for inclusion
+// call after SrcSize and SetMap, sensors then supplied asynchronously via Submit
+// returns 1 if okay, 0 or negative for problem
+
+int jhcOverhead3D::StartFuse (int stale)
+{
+  fuse.stale = stale;
+  return fuse.Start(smax, map, InputW(), InputH(), kf, ksc);
+}
+
+
+//= Queue a rightway-up depth sensor image for projection by background thread.
+// same as Ingest but returns immediately and never waits for other sensors
+// frame is combined with latest maps from all other sensors once projected
+// returns 1 if accepted, 0 if fusion not running, negative for error
+
+int jhcOverhead3D::Submit (const jhcImg& d16, UL32 tstamp, double bot, double top, int cam, int zst, double zlim)
+{
+  double geom[11];
+  int n = __max(0, __min(cam, smax - 1));
+
+  if (!d16.Valid(2))
+    return Fatal("Bad input to jhcOverhead3D::Submit");
+
+  // camera pose in map coordinates
+  geom[0] = cx[n] + x0 - 0.5 * mw;
+  geom[1] = cy[n] + y0;
+  geom[2] = cz[n];
+  geom[3] = p0[n] - 90.0;
+  geom[4] = t0[n];
+  geom[5] = ImgRoll(n);
+
+  // projection parameters 
+  geom[6] = ztab + bot;
+  geom[7] = ztab + top;
+  geom[8] = ((zlim > 0.0) ? zlim : 84.0);
+  geom[9] = ipp;
+  geom[10] = rmax[n];
+  return fuse.Submit(n, d16, tstamp, geom, zst);
+}
+
+
+//= Get most recent complete combination of all sensors into "map".
+// replaces a Reset then Ingest of each sensor, can be followed by Interpolate
+// can optionally return capture time of newest frame contributing to map
+// map is always consistent even if some sensor is slow or has stopped
+// returns number of sensors used, 0 if nothing available yet (map cleared)
+
+int jhcOverhead3D::Collect (UL32 *tstamp)
+{
+  UL32 mask = 0;
+  int i, cnt = 0;
+
+  if (fuse.Latest(map, tstamp, &mask) <= 0)
+    map.FillArr(0);
+  for (i = 0; i < smax; i++)
+  {
+    used[i] = (((mask >> i) & 0x01) ? 1 : 0);
+    cnt += used[i];
+  }
+  rasa = 0;
+  return cnt;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                             Plane Fitting                             //
 ///////////////////////////////////////////////////////////////////////////
@@ -38,7 +38,8 @@
 #include "Processing/jhcResize.h"
 #include "Processing/jhcThresh.h"
 
-#include "Depth/jhcSurface3D.h"      // common robot
+#include "Depth/jhcMapFuse.h"        // common robot
+#include "Depth/jhcSurface3D.h"
 
 
 //= Combines depth sensors into an overhead height map.
@@ -59,6 +60,7 @@ class jhcOverhead3D : public jhcSurface3D,
 // PRIVATE MEMBER VARIABLES
 private:
   jhcFill fill;
+  jhcMapFuse fuse;
   jhcImg ctmp, dmsk, mask;
   int smax;
 
@@ -164,6 +166,15 @@ public:
   int Reproject (jhcImg& dest, const jhcImg& d16, double bot, double top, int cam =0, int zst =0, double zlim =0.0, int clr =1);
   void Interpolate (int sc =9, int pmin =3);
 
+  // concurrent multi-sensor ingest
+  int StartFuse (int stale =500);
+  void StopFuse () {fuse.Stop();}
+  int Submit (const jhcImg& d16, UL32 tstamp, int cam =0, int zst =0, double zlim =0.0) 
+    {return Submit(d16, tstamp, zlo, zhi, cam, zst, zlim);}
+  int Submit (const jhcImg& d16, UL32 tstamp, double bot, double top, int cam =0, int zst =0, double zlim =0.0);
+  int Collect (UL32 *tstamp =NULL);
+  const jhcMapFuse *Fuser () const {return &fuse;}
+
   // position and size conversion routines
   double W2X (double wx) const {return((wx + x0) / ipp);}
   double W2Y (double wy) const {return((wy + y0) / ipp);}
@@ -0,0 +1,301 @@
+// jhcPointCache.cpp : lazily computed world coordinates for depth pixels
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "Interface/jhcBandPool.h"   // common video
+#include "Interface/jhcMessage.h"
+
+#include "Depth/jhcPointCache.h"     // common robot
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcPointCache::~jhcPointCache ()
+{
+  dealloc();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcPointCache::jhcPointCache ()
+{
+  int i;
+
+  px = NULL;
+  py = NULL;
+  pz = NULL;
+  done = NULL;
+  cw = 0;
+  ch = 0;
+  full = 0;
+  for (i = 0; i < 12; i++)
+    f[i] = 0.0;
+  zlim = 0;
+  nfill = 0;
+  Invalidate();
+}
+
+
+//= Get rid of all allocated arrays.
+
+void jhcPointCache::dealloc ()
+{
+  delete [] done;
+  delete [] pz;
+  delete [] py;
+  delete [] px;
+  px = NULL;
+  py = NULL;
+  pz = NULL;
+  done = NULL;
+}
+
+
+//= Set size of coordinate grid (w x h) for some depth image.
+// fsz > 0 means depth image is the same size, else it is twice as big
+
+void jhcPointCache::SetSize (int w, int h, int fsz)
+{
+  full = fsz;
+  if ((w != cw) || (h != ch))
+  {
+    dealloc();
+    cw = w;
+    ch = h;
+    if ((w > 0) && (h > 0))
+    {
+      px = new float [w * h];
+      py = new float [w * h];
+      pz = new float [w * h];
+      done = new UC8 [h];
+    }
+  }
+  Invalidate();
+}
+
+
+//= Forget source so next request must be rebound.
+
+void jhcPointCache::Invalidate ()
+{
+  img = NULL;
+  stamp = 0;
+  todo = ch;
+  if (done != NULL)
+    memset(done, 0, ch);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Associate cache with some depth image and image-to-map transform.
+// only depths from 1760 to rlim are converted, others get all zero coordinates
+// does no conversion itself, just marks all rows stale if anything changed
+// returns 2 if cache still current, 1 if invalidated, 0 or negative for error
+
+int jhcPointCache::Bind (const jhcImg& d16, const jhcMatrix& i2m, int rlim)
+{
+  if ((done == NULL) || !d16.Valid(2) || !fits(d16))
+    return Fatal("Bad images to jhcPointCache::Bind");
+
+  // record new source (all rows stale)
+  if ((img != &d16) || (stamp != d16.Stamp()) || (zlim != rlim))
+  {
+    Invalidate();
+    img = &d16;
+    stamp = d16.Stamp();
+    zlim = rlim;
+    Pose(i2m);
+    return 1;
+  }
+  return Pose(i2m);
+}
+
+
+//= Change the image-to-map transform used for the currently bound image.
+// marks all rows stale if any factor is different from before
+// returns 2 if cache still current, 1 if invalidated, 0 if not bound
+
+int jhcPointCache::Pose (const jhcMatrix& i2m)
+{
+  double v[12];
+  int i, j, same = 1;
+
+  if (img == NULL)
+    return 0;
+
+  // extract factors: ix = (a0 * x + b0 * y + c0) * z + d0 (similarly iy and iz)
+  for (i = 0, j = 0; i < 3; i++, j += 4)
+  {
+    v[j]     = i2m.MRef(0, i);
+    v[j + 1] = i2m.MRef(1, i);
+    v[j + 2] = i2m.MRef(2, i) - 0.5 * (v[j] * (cw - 1) + v[j + 1] * (ch - 1));
+    v[j + 3] = i2m.MRef(3, i);
+  }
+
+  // see if anything is different from last time
+  for (i = 0; i < 12; i++)
+    if (v[i] != f[i])
+    {
+      f[i] = v[i];
+      same = 0;
+    }
+  if (same > 0)
+    return 2;
+  todo = ch;
+  memset(done, 0, ch);
+  return 1;
+}
+
+
+//= Tell if cache is bound to the current contents of a particular image.
+
+int jhcPointCache::Current (const jhcImg& d16) const
+{
+  return(((img == &d16) && (stamp == d16.Stamp()) && fits(d16)) ? 1 : 0);
+}
+
+
+//= Make sure coordinates are valid for rows y0 up to but not including y1.
+// if source image was altered since binding then all rows are marked stale
+// unbinds if source image has changed size (must then call Bind again)
+// returns number of rows converted, negative if not bound
+
+int jhcPointCache::Rows (int y0, int y1)
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+  int y, n = 0;
+
+  if (img == NULL)
+    return -1;
+  if (!img->Valid(2) || !fits(*img))
+  {
+    Invalidate();
+    return -1;
+  }
+  if (stamp != img->Stamp())
+  {
+    todo = ch;
+    memset(done, 0, ch);
+    stamp = img->Stamp();
+  }
+  if (todo <= 0)
+    return 0;
+
+  // find span of rows actually needing work
+  ylo = __max(0, y0);
+  yhi = __min(y1, ch);
+  while ((ylo < yhi) && (done[ylo] > 0))
+    ylo++;
+  while ((yhi > ylo) && (done[yhi - 1] > 0))
+    yhi--;
+  if (ylo >= yhi)
+    return 0;
+  for (y = ylo; y < yhi; y++)
+    if (done[y] <= 0)
+      n++;
+
+  // convert in parallel bands (each only touches its own rows)
+  bp->Run(fill_rows, this, bp->Bands(yhi - ylo, 16));
+  todo -= n;
+  nfill += n;
+  return n;
+}
+
+
+//= Make sure coordinates are valid for all rows overlapping some area.
+// area is in cache grid coordinates, whole rows are always converted
+
+int jhcPointCache::Area (const jhcRoi& area)
+{
+  return Rows(area.RoiY(), area.RoiY2());
+}
+
+
+//= Get the coordinates associated with a single grid pixel (converts row if needed).
+// returns 1 if valid point, 0 if no depth there, negative for error
+
+int jhcPointCache::Point (double& x, double& y, double& z, int ix, int iy)
+{
+  int i = iy * cw + ix;
+
+  if ((ix < 0) || (ix >= cw) || (iy < 0) || (iy >= ch) || (Rows(iy, iy + 1) < 0))
+    return -1;
+  x = px[i];
+  y = py[i];
+  z = pz[i];
+  return((z > 0.0) ? 1 : 0);
+}
+
+
+//= Convert all stale rows in one band of the current request span.
+
+void jhcPointCache::fill_rows (void *ctx, int band, int nb)
+{
+  jhcPointCache *me = (jhcPointCache *) ctx;
+  int y, n = me->yhi - me->ylo;
+  int y0 = me->ylo + (band * n) / nb, y1 = me->ylo + ((band + 1) * n) / nb;
+
+  for (y = y0; y < y1; y++)
+    if (me->done[y] <= 0)
+    {
+      me->fill_row(y);
+      me->done[y] = 1;
+    }
+}
+
+
+//= Apply coordinate transform to one row of depth pixels.
+// computed in double precision then truncated to whole map units (0.02")
+
+void jhcPointCache::fill_row (int y)
+{
+  int x, zstep = ((full > 0) ? 1 : 2), zln = ((full > 0) ? img->Line() >> 1 : img->Line());
+  const US16 *z = (const US16 *) img->PxlSrc() + y * zln;
+  float *xs = px + y * cw, *ys = py + y * cw, *zs = pz + y * cw;
+  double abc0 = f[1] * y + f[2], abc1 = f[5] * y + f[6], abc2 = f[9] * y + f[10];
+
+  for (x = 0; x < cw; x++, z += zstep, abc0 += f[0], abc1 += f[4], abc2 += f[8])
+    if ((*z >= 1760) && (*z <= zlim))
+    {
+      // find world location for pixel
+      xs[x] = (float)((int)(abc0 * (*z) + f[3]));
+      ys[x] = (float)((int)(abc1 * (*z) + f[7]));
+      zs[x] = (float)((int)(abc2 * (*z) + f[11]));
+    }
+    else
+    {
+      // invalid pixel
+      xs[x] = 0.0;
+      ys[x] = 0.0;
+      zs[x] = 0.0;
+    }
+}
+
@@ -0,0 +1,125 @@
+// jhcPointCache.h : lazily computed world coordinates for depth pixels
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCPOINTCACHE_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCPOINTCACHE_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"             // common video
+#include "Data/jhcRoi.h"
+
+#include "Geometry/jhcMatrix.h"      // common robot
+
+
+//= Lazily computed world coordinates for depth pixels.
+// holds separate float arrays of X, Y, and Z for a full or half-sized grid
+// values are in map units of jhcSurface3D (32768 + 50 * inches), 0 = invalid
+// Bind only records the depth image and transform, rows are filled on demand
+// remembers source image (and its Stamp), transform, and range limit so
+// that any change marks all rows stale without needing an explicit flush
+// missing rows in a request are converted in bands on jhcBandPool
+// NOTE: only a pointer to the bound depth image is kept so it must outlive
+//       the cache (or be rebound), its pixels may change but not its size
+// <pre>
+// typical use:
+//
+//   pc.Bind(d16, i2m, zlim);
+//   pc.Rows(0, pc.YDim());
+//   for (y = 0; y < pc.YDim(); y++)
+//     {xs = pc.X(y); ys = pc.Y(y); zs = pc.Z(y); ... }
+//
+// </pre>
+
+class jhcPointCache
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  // coordinate arrays and row status
+  float *px, *py, *pz;
+  UC8 *done;
+  int cw, ch, full, todo;
+
+  // description of source
+  const jhcImg *img;
+  UL32 stamp;
+  double f[12];
+  int zlim;
+
+  // band processing
+  int ylo, yhi;
+
+  // statistics
+  int nfill;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcPointCache ();
+  jhcPointCache ();
+  void SetSize (int w, int h, int fsz =0);
+  int XDim () const {return cw;}
+  int YDim () const {return ch;}
+  void Invalidate ();
+
+  // main functions
+  int Bind (const jhcImg& d16, const jhcMatrix& i2m, int rlim =40000);
+  int Pose (const jhcMatrix& i2m);
+  int Bound () const {return((img != NULL) ? 1 : 0);}
+  int Current (const jhcImg& d16) const;
+  int Rows (int y0, int y1);
+  int Area (const jhcRoi& area);
+
+  // point access
+  const float *X (int y =0) const {return(px + y * cw);}
+  const float *Y (int y =0) const {return(py + y * cw);}
+  const float *Z (int y =0) const {return(pz + y * cw);}
+  int Point (double& x, double& y, double& z, int ix, int iy);
+
+  // statistics
+  int Filled () const  {return nfill;}   /** Rows converted since creation. */
+  int Pending () const {return todo;}    /** Rows not yet converted.        */
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  void dealloc ();
+  int fits (const jhcImg& d16) const
+    {return((d16.XDim() == ((full > 0) ? cw : 2 * cw)) && (d16.YDim() == ((full > 0) ? ch : 2 * ch)));}
+
+  // main functions
+  static void fill_rows (void *ctx, int band, int nb);
+  void fill_row (int y);
+
+
+};
+
+
+#endif  // once
+
+
+
+
@@ -21,12 +21,33 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <math.h>
+#include <string.h>
 
-#include "Interface/jhcMessage.h"   // common vision
+#include "Interface/jhcBandPool.h"  // common vision
+#include "Interface/jhcMessage.h"
 
 #include "Depth/jhcSurface3D.h"     // common robot
 
 
+//= Description of overhead map projection shared by all bands.
+
+typedef struct
+{
+  // depth image and transform factors
+  const US16 *z0;
+  float a[3], b[3], c[3], d[3];
+  int hw, hh, zln, zstep, zlim, zcut;
+
+  // STREAK - multi-fill of long range readings
+  float sc2, gr2;
+  int n, gstep, rth;
+
+  // destination and partial maps
+  UC8 *m0, *p0;
+  int dw, dh, mln, pln, np;
+} jhc_floor_job;
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                      Creation and Initialization                      //
 ///////////////////////////////////////////////////////////////////////////
@@ -64,7 +85,7 @@ void jhcSurface3D::SetSize (int x, int y, int full)
   // make internal image for caching values
   hw = ((full > 0) ? x : x / 2);
   hh = ((full > 0) ? y : y / 2);
-  wxyz.SetSize(hw, hh, 6);
+  pts.SetSize(hw, hh, full);
 }
 
 
@@ -126,6 +147,7 @@ double jhcSurface3D::CamCalib (double& t, double& r, double& h, const jhcImg& sr
 ///////////////////////////////////////////////////////////////////////////
 
 //= Set up basic coordinate transform matrices for camera pose.
+// any cached pixel coordinates are marked stale if the pose changed
 
 void jhcSurface3D::BuildMatrices (double cpan, double ctilt, double croll, double x0, double y0, double z0)
 {
@@ -150,10 +172,11 @@ void jhcSurface3D::BuildMatrices (double cpan, double ctilt, double croll, doubl
 
   // save inverse also
   m2i.Invert(i2m);
+  pts.Pose(i2m);
 }
 
 
-//= Plot depth image as vacuform surface and cache xyz values for later use.
+//= Plot depth image as vacuform surface using cached xyz values.
 // generally need to call SetMap first to describe destination image
 
 int jhcSurface3D::FloorMap0 (jhcImg& dest, const jhcImg& d16, int clr, 
@@ -168,119 +191,54 @@ int jhcSurface3D::FloorMap0 (jhcImg& dest, const jhcImg& d16, int clr,
 //= Plot depth image as vacuform surface using given parameters.
 // pixel values: 0 = less than z0, 1 = z0, 254 = z1, 255 = z1 to zmax
 // usually want to call jhcLut::Replace(dest, 255, 0) on final map
-// takes about 5.3ms at full VGA, about 1.3ms at SIF (full = 0) 
-// about 20% faster than calling CacheXYZ then Plane
+// bands of depth rows are projected in parallel into separate partial maps
+// takes about 5.3ms at full VGA, about 1.3ms at SIF (full = 0) single threaded
 // generally need to call SetMap first to describe destination image
-// Note: does NOT do CacheXYZ so functions like MapBack and Ground will not work
+// also binds depth image so functions like MapBack and Ground work afterward
 
 int jhcSurface3D::FloorMap (jhcImg& dest, const jhcImg& d16, int clr,
                             double pan, double tilt, double roll, 
                             double xcam, double ycam, double zcam)
 {
-  jhcMatrix xform(4, 4);
-  double a0, b0, c0, d0, a1, b1, c1, d1, a2, b2, c2, d2, abc0, abc1, abc2;
-  int zlim = __min(ROUND(dmax * 101.6 / ksc), 40000);  // max = 10m (32.8')    
-  int zcut = (int)(1.0 + 253.0 * (zmax - z0) / (z1 - z0));
-  int dw = dest.XDim(), dh = dest.YDim(), ln2 = d16.Line();
-  int x, y, ix, iy, iz, zstep = ((hw == iw) ? 1 : 2), zln = ((hw == iw) ? ln2 >> 1 : ln2);
-  const US16 *z, *zrow = (const US16 *) d16.PxlSrc();
-  UC8 *v;
-
-  // check for proper sized input and clear output map
+  // check for proper sized input 
   if (!dest.Valid(1) || !d16.SameFormat(iw, ih, 2))
     return Fatal("Bad images to jhcSurface3D::FloorMap");
-  if (clr > 0)
-    dest.FillArr(0);
-
-  // figure out transform (enables coordinate mapping functions)
-  // 0 degs is camera horizontal
-  BuildMatrices(pan, tilt + 90.0, roll, xcam, ycam, zcam);           
-
-  // add in conversion to overhead map with x = 0 in middle and z0 -> 1
-  xform.Copy(i2m);
-  xform.Translate(-32768.0, -32768.0, -32768.0 - 50.0 * z0);
-  xform.Magnify(0.02 / ipp, 0.02 / ipp, 0.02 * 253.0 / (z1 - z0));
-  xform.Translate(0.5 * dest.XDim(), 0.0, 1.0);
-
-  // extract factors: ix = (a0 * x + b0 * y + c0) * z + d0
-  a0 = xform.MRef(0, 0);
-  b0 = xform.MRef(1, 0);
-  c0 = xform.MRef(2, 0) - 0.5 * (a0 * (hw - 1) + b0 * (hh - 1));
-  d0 = xform.MRef(3, 0);
-
-  // extract factors: iy = (a1 * x + b1 * y + c1) * z + d1
-  a1 = xform.MRef(0, 1);
-  b1 = xform.MRef(1, 1);
-  c1 = xform.MRef(2, 1) - 0.5 * (a1 * (hw - 1) + b1 * (hh - 1));
-  d1 = xform.MRef(3, 1);
-
-  // extract factors: iz = (a2 * x + b2 * y + c2) * z + d2
-  a2 = xform.MRef(0, 2);
-  b2 = xform.MRef(1, 2);
-  c2 = xform.MRef(2, 2) - 0.5 * (a2 * (hw - 1) + b2 * (hh - 1));
-  d2 = xform.MRef(3, 2);
-
-  // apply coordinate transform to depth pixels
-  for (y = 0; y < hh; y++, zrow += zln)
-  {
-    // compute beginning values for row
-    z = zrow;
-    abc0 = b0 * y + c0;
-    abc1 = b1 * y + c1;
-    abc2 = b2 * y + c2;
-
-    // remap pixels in a row of the depth image
-    for (x = 0; x < hw; x++, z += zstep, abc0 += a0, abc1 += a1, abc2 += a2)
-      if ((*z >= 1760) && (*z <= zlim))
-      {
-        // find map location for pixel
-        ix = (int)(abc0 * (*z) + d0);
-        iy = (int)(abc1 * (*z) + d1);
-        iz = (int)(abc2 * (*z) + d2);
-
-        // convert z to appropriate pixel value
-        if ((iz > 0) && (iz < zcut))
-          if ((ix >= 0) && (ix < dw) && (iy >= 0) && (iy < dh))
-          {
-            // only change map pixel if height is greater than map
-            iz = __min(iz, 255);       
-            v = dest.APtr(ix, iy); 
-            if (iz > *v)
-              *v = (UC8) iz;                     // iz always positive
-            else if (*v == 0)
-              *v = 1;                            // clamp negative iz 
-          }
-      }
-  }
-  return 1;
+  return floor_proj(dest, d16, clr, pan, tilt, roll, xcam, ycam, zcam, 0);
 }
 
 
 //= Plot depth image as vacuform surface compensating for depth granularity.
 // tries to mark every n'th map cell when long range reading encountered
 // generally need to call SetMap first to describe destination image
-// Note: does NOT do CacheXYZ so functions like MapBack and Ground will not work
+// also binds depth image so functions like MapBack and Ground work afterward
 
 int jhcSurface3D::FloorMap2 (jhcImg& dest, const jhcImg& d16, int clr,
                              double pan, double tilt, double roll, 
                              double xcam, double ycam, double zcam, int n)
 {
-  jhcMatrix xform(4, 4);
-  double a0, b0, c0, d0, a1, b1, c1, d1, a2, b2, c2, d2, abc0, abc1, abc2;
-  double sc = 7.1e-7, sc2 = 0.5 * sc, grid = 101.6 * ipp, gr2 = 0.5 * grid + 0.5;
-  int dev, top, alt, gstep = ROUND(n * grid), rth = ROUND(sqrt((n + 1) * grid / sc));
-  int zlim = __min(ROUND(dmax * 101.6 / ksc), 40000);  // max = 10m (32.8')
-  int zcut = (int)(1.0 + 253.0 * (zmax - z0) / (z1 - z0));
-  int dw = dest.XDim(), dh = dest.YDim(), ln2 = d16.Line();
-  int x, y, ix, iy, iz, zstep = ((hw == iw) ? 1 : 2), zln = ((hw == iw) ? ln2 >> 1 : ln2);
-  const US16 *z, *zrow = (const US16 *) d16.PxlSrc();
-  UC8 *v;
-
-  // check for proper sized input and clear output map
+  // check for proper sized input 
   if (!dest.Valid(1) || !d16.SameFormat(iw, ih, 2))
     return Fatal("Bad images to jhcSurface3D::FloorMap2");
-  if (n <= 0)
-    return FloorMap(dest, d16, clr, pan, tilt, roll, xcam, ycam, zcam);
+  return floor_proj(dest, d16, clr, pan, tilt, roll, xcam, ycam, zcam, __max(0, n));
+}
+
+
+//= Project depth pixels into overhead map with optional long range streaks.
+// each band of depth rows (except first) gets its own partial map which
+// are combined at the end by taking the maximum height at each cell
+// transform is done in single precision a whole row at a time
+
+int jhcSurface3D::floor_proj (jhcImg& dest, const jhcImg& d16, int clr,
+                              double pan, double tilt, double roll, 
+                              double xcam, double ycam, double zcam, int n)
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhcMatrix xform(4, 4);
+  jhc_floor_job job;
+  double grid = 101.6 * ipp, sc = 7.1e-7;
+  int i, nb, ln2 = d16.Line();
+
+  // clear output map if desired
   if (clr > 0)
     dest.FillArr(0);
 
@@ -294,66 +252,172 @@ int jhcSurface3D::FloorMap2 (jhcImg& dest, const jhcImg& d16, int clr,
   xform.Magnify(0.02 / ipp, 0.02 / ipp, 0.02 * 253.0 / (z1 - z0));
   xform.Translate(0.5 * dest.XDim(), 0.0, 1.0);
 
-  // extract factors: ix = (a0 * x + b0 * y + c0) * z + d0
-  a0 = xform.MRef(0, 0);
-  b0 = xform.MRef(1, 0);
-  c0 = xform.MRef(2, 0) - 0.5 * (a0 * (hw - 1) + b0 * (hh - 1));
-  d0 = xform.MRef(3, 0);
-
-  // extract factors: iy = (a1 * x + b1 * y + c1) * z + d1
-  a1 = xform.MRef(0, 1);
-  b1 = xform.MRef(1, 1);
-  c1 = xform.MRef(2, 1) - 0.5 * (a1 * (hw - 1) + b1 * (hh - 1));
-  d1 = xform.MRef(3, 1);
-
-  // extract factors: iz = (a2 * x + b2 * y + c2) * z + d2
-  a2 = xform.MRef(0, 2);
-  b2 = xform.MRef(1, 2);
-  c2 = xform.MRef(2, 2) - 0.5 * (a2 * (hw - 1) + b2 * (hh - 1));
-  d2 = xform.MRef(3, 2);
-
-  // apply coordinate transform to depth pixels
-  for (y = 0; y < hh; y++, zrow += zln)
+  // extract factors: ix = (a0 * x + b0 * y + c0) * z + d0 (similarly iy and iz)
+  for (i = 0; i < 3; i++)
+  {
+    job.a[i] = (float) xform.MRef(0, i);
+    job.b[i] = (float) xform.MRef(1, i);
+    job.c[i] = (float)(xform.MRef(2, i) - 0.5 * (xform.MRef(0, i) * (hw - 1) + xform.MRef(1, i) * (hh - 1)));
+    job.d[i] = (float) xform.MRef(3, i);
+  }
+
+  // range gating and height cutoff
+  job.zlim = __min(ROUND(dmax * 101.6 / ksc), 40000);  // max = 10m (32.8')
+  job.zcut = (int)(1.0 + 253.0 * (zmax - z0) / (z1 - z0));
+  pts.Bind(d16, i2m, job.zlim);
+
+  // STREAK - parameters for multi-fill of long range readings
+  job.n = n;
+  job.sc2 = (float)(0.5 * sc);
+  job.gr2 = (float)(0.5 * grid + 0.5);
+  job.gstep = __max(1, ROUND(n * grid));
+  job.rth = ROUND(sqrt((n + 1) * grid / sc));
+
+  // depth image and destination map
+  job.z0 = (const US16 *) d16.PxlSrc();
+  job.zstep = ((hw == iw) ? 1 : 2);
+  job.zln = ((hw == iw) ? ln2 >> 1 : ln2);
+  job.hw = hw;
+  job.hh = hh;
+  job.m0 = dest.PxlDest();
+  job.dw = dest.XDim();
+  job.dh = dest.YDim();
+  job.mln = dest.Line();
+
+  // one partial map for each band after the first
+  nb = __min(bp->Lanes(), bp->Bands(hh, 16));
+  job.p0 = NULL;
+  job.pln = 0;
+  if (nb > 1)
+  {
+    part.SetSize(job.dw, job.dh * (nb - 1), 1);
+    job.p0 = part.PxlDest();
+    job.pln = part.Line();
+  }
+  job.np = nb - 1;
+
+  // project bands then merge partial maps
+  bp->Run(floor_rows, &job, nb);
+  if (nb > 1)
+    bp->Run(floor_max, &job, bp->Bands(job.dh, 16));
+  return 1;
+}
+
+
+//= Project a band of depth image rows into a private partial map.
+// first band writes directly into the destination map
+// only changes a map pixel if new height is greater (iz always positive)
+
+void jhcSurface3D::floor_rows (void *ctx, int band, int nb)
+{
+  const jhc_floor_job *job = (const jhc_floor_job *) ctx;
+  const float *a = job->a, *b = job->b, *c = job->c, *d = job->d;
+  const US16 *z;
+  UC8 *map = job->m0;
+  int *ix, *iy, *iz;
+  float r0, r1, r2, fx, fz;
+  int x, y, alt, dev, top, zv, ok, mln = job->mln, dw = job->dw, dh = job->dh;
+  int hw = job->hw, zstep = job->zstep, zlim = job->zlim, zcut = job->zcut;
+  int y0 = (band * job->hh) / nb, y1 = ((band + 1) * job->hh) / nb;
+
+  // get proper map and make sure it starts empty
+  if (band > 0)
+  {
+    mln = job->pln;
+    map = job->p0 + (band - 1) * dh * mln;
+    memset(map, 0, dh * mln);
+  }
+
+  // scratch arrays for one row of map positions
+  ix = new int [3 * hw];
+  iy = ix + hw;
+  iz = iy + hw;
+
+  for (y = y0; y < y1; y++)
   {
     // compute beginning values for row
-    z = zrow;
-    abc0 = b0 * y + c0;
-    abc1 = b1 * y + c1;
-    abc2 = b2 * y + c2;
-
-    // remap pixels in a row of the depth image
-    for (x = 0; x < hw; x++, z += zstep, abc0 += a0, abc1 += a1, abc2 += a2)
-      if ((*z >= 1760) && (*z <= zlim))
-      {
-        // STREAK - determine multi-fill range around nominal value
-        dev = 0;
-        if (*z >= rth)
-          dev = (int)(sc2 * ((*z) * (*z)) - gr2);  
-        top = *z + dev + 1;
+    z = job->z0 + y * job->zln;
+    r0 = b[0] * y + c[0];
+    r1 = b[1] * y + c[1];
+    r2 = b[2] * y + c[2];
 
-        for (alt = *z - dev; alt < top; alt += gstep)
+    // STREAK - determine multi-fill range around nominal value
+    if (job->n > 0)
+    {
+      for (x = 0; x < hw; x++, z += zstep)
+        if ((*z >= 1760) && (*z <= zlim))
         {
-          // find map location for pixel
-          ix = (int)(abc0 * alt + d0);
-          iy = (int)(abc1 * alt + d1);
-          iz = (int)(abc2 * alt + d2);
-
-          // convert z to appropriate pixel value
-          if ((iz > 0) && (iz < zcut))
-            if ((ix >= 0) && (ix < dw) && (iy >= 0) && (iy < dh))
-            {
-              // only change map pixel if height is greater than map
-              iz = __min(iz, 255);       
-              v = dest.APtr(ix, iy); 
-              if (iz > *v)
-                *v = (UC8) iz;                   // iz always positive
-              else if (*v == 0)
-                *v = 1;                          // clamp negative iz
-            }
-         }
-       }
+          fx = (float) x;
+          zv = *z;
+          dev = 0;
+          if (zv >= job->rth)
+            dev = (int)(job->sc2 * (float)(zv * zv) - job->gr2);  
+          top = zv + dev + 1;
+          for (alt = zv - dev; alt < top; alt += job->gstep)
+          {
+            fz = (float) alt;
+            floor_pel(map, mln, dw, dh, zcut, 
+                      (int)((a[0] * fx + r0) * fz + d[0]), 
+                      (int)((a[1] * fx + r1) * fz + d[1]), 
+                      (int)((a[2] * fx + r2) * fz + d[2]));
+          }
+        }
+      continue;
+    }
+
+    // find map location and height for whole row (invalid range gets zero height)
+    for (x = 0; x < hw; x++)
+    {
+      zv = z[x * zstep];
+      ok = (((zv >= 1760) && (zv <= zlim)) ? 1 : 0);
+      fx = (float) x;
+      fz = (float) zv;
+      ix[x] = (int)((a[0] * fx + r0) * fz + d[0]);
+      iy[x] = (int)((a[1] * fx + r1) * fz + d[1]);
+      iz[x] = ok * (int)((a[2] * fx + r2) * fz + d[2]);
+    }
+
+    // mark all map cells
+    for (x = 0; x < hw; x++)
+      floor_pel(map, mln, dw, dh, zcut, ix[x], iy[x], iz[x]);
   }
-  return 1;
+  delete [] ix;
+}
+
+
+//= Raise map cell at (ix iy) to height iz if it is valid and taller.
+
+void jhcSurface3D::floor_pel (UC8 *map, int mln, int dw, int dh, int zcut, int ix, int iy, int iz)
+{
+  UC8 *m;
+
+  if ((iz <= 0) || (iz >= zcut) || (ix < 0) || (ix >= dw) || (iy < 0) || (iy >= dh))
+    return;
+  m = map + iy * mln + ix;
+  iz = __min(iz, 255);
+  if (iz > *m)
+    *m = (UC8) iz;
+}
+
+
+//= Combine a band of lines from all partial maps into final map.
+
+void jhcSurface3D::floor_max (void *ctx, int band, int nb)
+{
+  const jhc_floor_job *job = (const jhc_floor_job *) ctx;
+  const UC8 *p;
+  UC8 *m;
+  int i, k, y, dw = job->dw, dh = job->dh;
+  int y0 = (band * dh) / nb, y1 = ((band + 1) * dh) / nb;
+
+  for (k = 0; k < job->np; k++)
+    for (y = y0; y < y1; y++)
+    {
+      m = job->m0 + y * job->mln;
+      p = job->p0 + (k * dh + y) * job->pln;
+      for (i = 0; i < dw; i++)
+        m[i] = __max(m[i], p[i]);
+    }
 }
 
 
@@ -389,78 +453,50 @@ int jhcSurface3D::FloorPel (double ht)
 
 //= Change depth map into world coordinate of points given camera parameters.
 // only compute coordinates for points less than dmax away (inches) 
-// saves results in "wxyz" images = 2 bytes X + 2 bytes Y + 2 bytes Z
-// all coordinates stored as 32768 + 50 * inches (to accomodate negatives)
+// coordinates are computed lazily as rows are needed by Plane, MapBack, etc.
+// all coordinates are 32768 + 50 * inches (to accomodate negatives)
 // invalid pixels have x, y, and z set to zero (outside normal range)
-// limited to about 54 feet in each direction relative to system origin
-// takes about 3.2ms for SIF on 3.2GHz Pentium
+// cache goes stale automatically if d16 is altered or pose is rebuilt
 
 int jhcSurface3D::CacheXYZ (const jhcImg& d16, double cpan, double ctilt, double croll, double dmax)
 {
   int zlim = __min(ROUND(dmax * 101.6 / ksc), 40000);    // 101.6 = 4 * 25.4, max = 10m (32.8')
-  int x, y, sk = wxyz.Skip() >> 1, ln2 = d16.Line();
-  int zstep = ((hw == iw) ? 1 : 2), zln = ((hw == iw) ? ln2 >> 1 : ln2);
-  double a0, b0, c0, d0, a1, b1, c1, d1, a2, b2, c2, d2, abc0, abc1, abc2;
-  const US16 *z, *zrow = (US16 *) d16.PxlSrc();
-  US16 *dxyz = (US16 *) wxyz.PxlDest();
 
   if (!d16.SameFormat(iw, ih, 2))
     return Fatal("Bad images to jhcSurface3D::CacheXYZ");
 
   // figure out mapping to use (no centering or perspective)
   BuildMatrices(cpan, ctilt + 90.0, croll, cx, cy, cz);             // 0 degs is camera horizontal
+  return((pts.Bind(d16, i2m, zlim) > 0) ? 1 : 0);
+}
 
-  // extract factors: ix = (a0 * x + b0 * y + c0) * z + d0
-  a0 = i2m.MRef(0, 0);
-  b0 = i2m.MRef(1, 0);
-  c0 = i2m.MRef(2, 0) - 0.5 * (a0 * (hw - 1) + b0 * (hh - 1));
-  d0 = i2m.MRef(3, 0);
-
-  // extract factors: iy = (a1 * x + b1 * y + c1) * z + d1
-  a1 = i2m.MRef(0, 1);
-  b1 = i2m.MRef(1, 1);
-  c1 = i2m.MRef(2, 1) - 0.5 * (a1 * (hw - 1) + b1 * (hh - 1));
-  d1 = i2m.MRef(3, 1);
-
-  // extract factors: iz = (a2 * x + b2 * y + c2) * z + d2
-  a2 = i2m.MRef(0, 2);
-  b2 = i2m.MRef(1, 2);
-  c2 = i2m.MRef(2, 2) - 0.5 * (a2 * (hw - 1) + b2 * (hh - 1));
-  d2 = i2m.MRef(3, 2);
-
-  // apply coordinate transform to depth pixels
-  for (y = 0; y < hh; y++, dxyz += sk, zrow += zln)
-  {
-    // compute beginning values for row
-    z = zrow;
-    abc0 = b0 * y + c0;
-    abc1 = b1 * y + c1;
-    abc2 = b2 * y + c2;
-
-    // remap pixels in a row of the depth image
-    for (x = 0; x < hw; x++, dxyz += 3, z += zstep, abc0 += a0, abc1 += a1, abc2 += a2)
-      if ((*z >= 1760) && (*z <= zlim))
-      {
-        // find world location for pixel
-        dxyz[0] = (US16)(abc0 * (*z) + d0);
-        dxyz[1] = (US16)(abc1 * (*z) + d1);
-        dxyz[2] = (US16)(abc2 * (*z) + d2);
-      }
-      else
-      {
-        // invalid pixel
-        dxyz[0] = 0;
-        dxyz[1] = 0;
-        dxyz[2] = 0;
-      }
-  }
-  return 1;
+
+//= Get access to cached world coordinates for all pixels.
+// returns NULL if no depth image has been bound yet
+
+const jhcPointCache *jhcSurface3D::Points ()
+{
+  if (pts.Rows(0, hh) < 0)
+    return NULL;
+  return &pts;
+}
+
+
+//= Get access to cached world coordinates with at least the rows in some area valid.
+// area is given in cache (XDim2 x YDim2) pixel coordinates
+// returns NULL if no depth image has been bound yet
+
+const jhcPointCache *jhcSurface3D::Points (const jhcRoi& area)
+{
+  if (pts.Area(area) < 0)
+    return NULL;
+  return &pts;
 }
 
 
 //= Map image points onto surface found previously to give overhead view.
 // always centers the origin in x direction of image and offset yoff inches forward
-// must call CacheXYZ function first to fill internal "wxyz" image
+// must call CacheXYZ (or FloorMap) first to bind a depth image
 // pixel = 128 + 127 * z / zrng, if pos > 0 then pixel = 255 * z / zrng instead
 // 0 if invalid, 1 if very low (but >= zoff), 2-254 = valid, 255 if very high (but <= zmax)
 // takes about 1.6ms on a 3.2GHz Pentium (for 144x180"/0.3)
@@ -468,36 +504,44 @@ int jhcSurface3D::CacheXYZ (const jhcImg& d16, double cpan, double ctilt, double
 int jhcSurface3D::Plane (jhcImg& dest, double ipp, double yoff, 
                          double zoff, double zrng, double zmax, int pos)
 {
-  int x, y, fx, fy, fz, w = dest.XDim(), h = dest.YDim(), psk = wxyz.Skip() >> 1; 
+  int x, y, fx, fy, fz, pz, w = dest.XDim(), h = dest.YDim(); 
   int m = ROUND(4096.0 * 0.02 / ipp), x0 = ROUND(4096.0 * 0.5 * w), y0 = ROUND(4096.0 * yoff / ipp);
   int s = ROUND(4096.0 * 127.0 * 0.02 / zrng), z0 = 32768 + ROUND(zoff / 0.02);
   int off = 128, zhi = ROUND(50.0 * zmax + 32768.0);
-  const US16 *pt = (US16 *) wxyz.PxlSrc();
+  const float *px, *py, *pt;
   UC8 *d;
 
   if (!dest.Valid(1))
     return Fatal("Bad images to jhcSurface3D::Plane");
   dest.FillArr(0);
+  if (pts.Rows(0, hh) < 0)
+    return 0;
   if (pos > 0)
   {
     // positive only deviations from ground plane
     s = ROUND(4096.0 * 255.0 * 0.02 / zrng);
     off = 0;
   }
-  for (y = 0; y < hh; y++, pt += psk)
-    for (x = 0; x < hw; x++, pt += 3)
-      if ((pt[2] > z0) && (pt[2] <= zhi))
+  for (y = 0; y < hh; y++)
+  {
+    px = pts.X(y);
+    py = pts.Y(y);
+    pt = pts.Z(y);
+    for (x = 0; x < hw; x++)
+    {
+      pz = (int) pt[x];
+      if ((pz > z0) && (pz <= zhi))
       {
         // find floor position of pixel
-        fx = (m * (pt[0] - 32768) + x0) >> 12;
+        fx = (m * ((int) px[x] - 32768) + x0) >> 12;
         if ((fx < 0) || (fx >= w))
           continue;
-        fy = (m * (pt[1] - 32768) + y0) >> 12;
+        fy = (m * ((int) py[x] - 32768) + y0) >> 12;
         if ((fy < 0) || (fy >= h))
           continue;
 
         // find height value for pixel
-        fz = ((s * (pt[2] - z0)) >> 12) + off;
+        fz = ((s * (pz - z0)) >> 12) + off;
         fz = __max(1, __min(fz, 255));
 
         // overwrite existing pixel if new value higher
@@ -505,39 +549,49 @@ int jhcSurface3D::Plane (jhcImg& dest, double ipp, double yoff,
         if (fz > *d)
           *d = (UC8) fz;
       }
+    }
+  }
   return 1;
 }
 
 
 //= Map image points in given height range onto presumed ground plane.
 // always centers the origin in x direction of image and offset yoff inches forward
-// must call CacheXYZ function first to fill internal "wxyz" image
+// must call CacheXYZ (or FloorMap) first to bind a depth image
 // pixel = sum of inc for each hit in range, 0 otherwise
 // takes about 0.3ms on a 3.2GHz Pentium (for 36-48" into 72x72"/0.3)
 
 int jhcSurface3D::Slice (jhcImg& dest, double z0, double z1, double ipp, double yoff, int inc)
 {
-  int x, y, fx, fy, v, w = dest.XDim(), h = dest.YDim(), psk = wxyz.Skip() >> 1; 
+  int x, y, fx, fy, v, pz, w = dest.XDim(), h = dest.YDim(); 
   int m = ROUND(4096.0 * 0.02 / ipp);
   int x0 = ROUND(4096.0 * 0.5 * w), y0 = ROUND(4096.0 * yoff / ipp);
   int zlo = ROUND(50.0 * z0 + 32768.0), zhi = ROUND(50.0 * z1 + 32768.0);
-  const US16 *pt = (US16 *) wxyz.PxlSrc();
+  const float *px, *py, *pt;
   UC8 *d;
 
   if (!dest.Valid(1))
     return Fatal("Bad images to jhcSurface3D::Slice");
   dest.FillArr(0);
+  if (pts.Rows(0, hh) < 0)
+    return 0;
   zlo = __max(1, zlo);
 
-  for (y = 0; y < hh; y++, pt += psk)
-    for (x = 0; x < hw; x++, pt += 3)
-      if ((pt[2] >= zlo) && (pt[2] <= zhi))
+  for (y = 0; y < hh; y++)
+  {
+    px = pts.X(y);
+    py = pts.Y(y);
+    pt = pts.Z(y);
+    for (x = 0; x < hw; x++)
+    {
+      pz = (int) pt[x];
+      if ((pz >= zlo) && (pz <= zhi))
       {
         // find floor position of pixel
-        fx = (m * (pt[0] - 32768) + x0) >> 12;
+        fx = (m * ((int) px[x] - 32768) + x0) >> 12;
         if ((fx < 0) || (fx >= w))
           continue;
-        fy = (m * (pt[1] - 32768) + y0) >> 12;
+        fy = (m * ((int) py[x] - 32768) + y0) >> 12;
         if ((fy < 0) || (fy >= h))
           continue;
 
@@ -547,6 +601,8 @@ int jhcSurface3D::Slice (jhcImg& dest, double z0, double z1, double ipp, double
         *d = (UC8) __min(v, 255);
 //        dest.ASet(fx, fy, 0, mark);
       }
+    }
+  }
   return 1;
 }
 
@@ -555,39 +611,50 @@ int jhcSurface3D::Slice (jhcImg& dest, double z0, double z1, double ipp, double
 // assumes input centered in x direction of image and offset yoff inches forward
 // takes a half-sized (SIF) destination image, input images has ipp inches per pixel
 // only copies src pixels in z0 to z1 range (rest are left as "fill" value)
-// must call CacheXYZ function first to fill internal "wxyz" image
+// must call CacheXYZ (or FloorMap) first to bind a depth image
 
 int jhcSurface3D::MapBack (jhcImg& dest, const jhcImg& src, double z0, double z1, 
                            double ipp, double yoff, int fill)
 {
-  int x, y, fx, fy, w = src.XDim(), h = src.YDim();
-  int  dsk = dest.Skip(), psk = wxyz.Skip() >> 1, m = ROUND(4096.0 * 0.02 / ipp);
+  int x, y, fx, fy, pz, w = src.XDim(), h = src.YDim();
+  int  dln = dest.Line(), m = ROUND(4096.0 * 0.02 / ipp);
   int x0 = ROUND(4096.0 * 0.5 * w), y0 = ROUND(4096.0 * yoff / ipp);
   int zlo = ROUND(50.0 * z0 + 32768.0), zhi = ROUND(50.0 * z1 + 32768.0);
-  const US16 *pt = (US16 *) wxyz.PxlSrc();
-  UC8 *d = dest.PxlDest();
+  const float *px, *py, *pt;
+  UC8 *d, *d0 = dest.PxlDest();
 
   if (!dest.SameFormat(hw, hh, 1) || !src.Valid(1))
     return Fatal("Bad images to jhcSurface3D::MapBack");
   if (fill >= 0)
     dest.FillArr(fill);
+  if (pts.Rows(0, hh) < 0)
+    return 0;
   zlo = __max(1, zlo);
 
-  for (y = 0; y < hh; y++, d += dsk, pt += psk)
-    for (x = 0; x < hw; x++, d++, pt += 3)
-      if ((pt[2] >= zlo) && (pt[2] <= zhi))
+  for (y = 0; y < hh; y++)
+  {
+    px = pts.X(y);
+    py = pts.Y(y);
+    pt = pts.Z(y);
+    d = d0 + y * dln;
+    for (x = 0; x < hw; x++)
+    {
+      pz = (int) pt[x];
+      if ((pz >= zlo) && (pz <= zhi))
       {
         // find floor position of pixel
-        fx = (m * (pt[0] - 32768) + x0) >> 12;
+        fx = (m * ((int) px[x] - 32768) + x0) >> 12;
         if ((fx < 0) || (fx >= w))
           continue;
-        fy = (m * (pt[1] - 32768) + y0) >> 12;
+        fy = (m * ((int) py[x] - 32768) + y0) >> 12;
         if ((fy < 0) || (fy >= h))
           continue;
 
         // copy floor pixel
-        *d = (UC8) src.ARef(fx, fy, 0);
+        d[x] = (UC8) src.ARef(fx, fy, 0);
       }
+    }
+  }
   return 1;
 }
 
@@ -937,18 +1004,20 @@ double jhcSurface3D::ImgScale (double wx, double wy, double wz, double sc, doubl
 //= Given the current plane description find height of each pixel.
 // a point on the plane has output value 128 (or 0 if pos > 0)
 // a positive deviation of "zrng" leads to 255 (zero if unknown)
-// must call CacheXYZ function first to fill internal "wxyz" image
+// must call CacheXYZ (or FloorMap) first to bind a depth image
 
 int jhcSurface3D::Heights (jhcImg& dest, double zoff, double zrng, int pos)
 {
-  int dsk = dest.Skip(), zsk = wxyz.Skip() >> 1; 
-  int x, y, v, z0 = 32768 + ROUND(zoff / 0.02);
+  int dsk = dest.Skip(); 
+  int x, y, v, iz, z0 = 32768 + ROUND(zoff / 0.02);
   double sc = 127.0 * 0.02 / zrng, off = 128.5;
-  const US16 *z = (US16 *) wxyz.PxlSrc() + 2;
+  const float *z;
   UC8 *d = dest.PxlDest();
 
   if (!dest.SameFormat(hw, hh, 1))
     return Fatal("Bad images to jhcSurface3D::Heights");
+  if (pts.Rows(0, hh) < 0)
+    return 0;
   if (pos > 0)
   {
     // positive only deviations from ground plane
@@ -956,44 +1025,56 @@ int jhcSurface3D::Heights (jhcImg& dest, double zoff, double zrng, int pos)
     off = 0.5;
   }
 
-  for (y = 0; y < hh; y++, d += dsk, z += zsk)
-    for (x = 0; x < hw; x++, d++, z += 3)
-      if (*z <= z0)
+  for (y = 0; y < hh; y++, d += dsk)
+  {
+    z = pts.Z(y);
+    for (x = 0; x < hw; x++, d++)
+    {
+      iz = (int) z[x];
+      if (iz <= z0)
         *d = 0;
       else
       {
-        v = (int)(sc * ((*z) - z0) + off);
+        v = (int)(sc * (iz - z0) + off);
         *d = (UC8) __max(1, __min(v, 255));
       }
+    }
+  }
   return 1;
 }
 
 
 //= Mark areas which are consistent with found plane (within +/- th).
 // converts image to grayscale then shades some areas green
-// must call CacheXYZ function first to fill internal "wxyz" image
+// must call CacheXYZ (or FloorMap) first to bind a depth image
 
 int jhcSurface3D::Ground (jhcImg& dest, double th)
 {
-  int x, y, i, dsk = dest.Skip(), zsk = wxyz.Skip() >> 1;
+  int x, y, i, iz, dsk = dest.Skip();
   int zlo = ROUND(-50.0 * th + 32768.0), zhi = ROUND(50.0 * th + 32768.0);
-  const US16 *z = (US16 *) wxyz.PxlSrc() + 2;
+  const float *z;
   UC8 *d = dest.PxlDest();
 
   if (!dest.SameFormat(hw, hh, 3))
     return Fatal("Bad images to jhcSurface3D::Ground");
+  if (pts.Rows(0, hh) < 0)
+    return 0;
 
   zlo = __max(1, zlo);
-  for (y = 0; y < hh; y++, d += dsk, z += zsk)
-    for (x = 0; x < hw; x++, d += 3, z += 3)
+  for (y = 0; y < hh; y++, d += dsk)
+  {
+    z = pts.Z(y);
+    for (x = 0; x < hw; x++, d += 3)
     {
+      iz = (int) z[x];
       i = (d[0] + d[1] + d[2] + 2) >> 2;
       d[0] = (UC8) i;
       d[2] = (UC8) i;
-      if ((*z >= zlo) && (*z <= zhi))
+      if ((iz >= zlo) && (iz <= zhi))
         d[1] = 255;
       else
         d[1] = (UC8) i;
     }
+  }
   return 1;
 }     
@@ -29,7 +29,8 @@
 
 #include "Data/jhcImg.h"             // common vision
 
-#include "Geometry/jhcMatrix.h"      // common robot
+#include "Depth/jhcPointCache.h"     // common robot
+#include "Geometry/jhcMatrix.h"
 #include "Geometry/jhcPlaneEst.h"
 
 
@@ -41,12 +42,13 @@ class jhcSurface3D : protected jhcPlaneEst
 private:
   jhcMatrix i2m;               // transform from image to map
   int iw, ih, hw, hh;          // expected image size
+  jhcImg part;                 // partial maps for bands
 
 
 // PROTECTED MEMBER VARIABLES
 protected:
   jhcMatrix m2i;               // transform from map to image
-  jhcImg wxyz;                 // cached pixel coordinates
+  jhcPointCache pts;           // lazily cached pixel coordinates
 
 
 // PUBLIC MEMBER VARIABLES
@@ -119,6 +121,8 @@ public:
              double ipp =0.3, double yoff =0.0, int inc =255);
   int MapBack (jhcImg& dest, const jhcImg& src, double z0 =-500.0, double z1 =500.0, 
                double ipp =0.3, double yoff =0.0, int fill =0);
+  const jhcPointCache *Points ();
+  const jhcPointCache *Points (const jhcRoi& area);
 
   // coordinate transformations
   void ToCache (double& mx, double& my, double& mz, 
@@ -167,6 +171,16 @@ public:
                    double ipp =0.3, double yoff =0.0);
 
 
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // standard overhead map
+  int floor_proj (jhcImg& dest, const jhcImg& d16, int clr, double pan, double tilt, double roll, 
+                  double xcam, double ycam, double zcam, int n);
+  static void floor_rows (void *ctx, int band, int nb);
+  static void floor_pel (UC8 *map, int mln, int dw, int dh, int zcut, int ix, int iy, int iz);
+  static void floor_max (void *ctx, int band, int nb);
+
+
 };
 
 
@@ -359,9 +359,13 @@ jtimer(1, "jhcEliGrok::Update");
   if (jhcBackgRWI::Update(0) <= 0)
     return 0;
 
+  // stop at end of sensor log replay (if any)
+  if ((body != NULL) && (body->slog.Done() > 0))
+    return 0;
+
   // do fast sound processing in foreground (needs voice)
   if (mic != NULL)
-    mic->Update(voice);
+    body->MicUpdate(voice);
   tk.Analyze(voice);
 
   // create pretty picture then enforce min wait (to simulate robot)
@@ -336,7 +336,7 @@ int jhcLocalOcc::RefineMaps (const jhcImg& d16, const jhcMatrix& pos, const jhcM
   erase_blips(obst, bad);
 
   // analyze travel directions and check doormat
-  build_spin(obst);
+  cast_rays(obst);
   fresh = known_ahead(conf);
   return 1;
 }
@@ -459,7 +459,7 @@ void jhcLocalOcc::mixin_scan (jhcImg& obs, jhcImg& cf, const jhcImg& junk, const
 
 
 //= Set area corresponding to robot (with padding) in rotated map to be floor.
-// needs 1 pixel extra padding all around to guarantee clr_paths succeeds 
+// needs 1 pixel extra padding all around to guarantee ray_paths succeeds 
 
 void jhcLocalOcc::block_bot (jhcImg& obs, jhcImg& cf) const
 {
@@ -534,23 +534,27 @@ double jhcLocalOcc::Behind (double end) const
 }
 
 
-//= Make up a bunch of local maps for various robot orientations.
+//= Make up ray tables for various robot orientations relative to current heading.
+// heading spacing can be as fine as 1 degree since no rotated maps are built
 
 void jhcLocalOcc::set_spin (double da)
 {
-  double s = rside + pad, f = __max(rfwd, rback) + lead + pad;
-  int i, nd, sz = ROUND(2.0 * sqrt(s * s + f * f) / ipp) + 3;
+  double s = rside + pad, f = __max(rfwd, rback) + lead + pad, step;
+  int i, hnd;
  
-  // figure out number of orientations and pixel size
-  nd = ROUND(180.0 / da) & 0xFE;
-  nd = __min(nd, 18);
-  if ((nd == ndir) && (sz == spin[0].XDim()))
-    return;
-
-  // make individual maps
-  for (i = 0; i < nd; i++)
-    spin[i].SetSize(sz, sz, 1);
-  ndir = nd;
+  // figure out number of orientations and size of equivalent rotated view
+  ndir = ROUND(180.0 / da) & 0xFE;
+  ndir = __max(2, __min(ndir, 180));
+  vdim = ROUND(2.0 * sqrt(s * s + f * f) / ipp) + 3;
+
+  // direction vector for each heading offset
+  hnd = ndir / 2;
+  step = D2R * 180.0 / ndir;
+  for (i = 0; i < ndir; i++)
+  {
+    hc[i] = cos((i - hnd) * step);
+    hs[i] = sin((i - hnd) * step);
+  }
 }
 
 
@@ -559,7 +563,7 @@ void jhcLocalOcc::set_spin (double da)
 // <pre>
 // given ndir = 12 (hnd = 6):
 //
-// spin images
+// ray headings
 //   abs =  0                      hnd                     ndir
 //   dev = -hnd                     0                      +hnd
 //   idx =  0   1   2   3   4   5   6   7   8   9  10  11  (12)
@@ -573,20 +577,19 @@ void jhcLocalOcc::set_spin (double da)
 //   src =   B6   B7   B8   B9  B10  B11  F0  F1  F2  F3  F4  F5  F6  F7  F8  F9 F10 F11  B0  B1  B2  B3  B4  B5  
 //
 // </pre>
-// takes about 1.6ms for 15 deg spacing with 18" lookahead @ 0.3" resolution
+// sweeps robot footprint directly through map instead of rotating map copies
+// at 2 deg spacing takes about half the time that 15 deg rotated maps did (1.6ms)
 
-void jhcLocalOcc::build_spin (const jhcImg& env) 
+void jhcLocalOcc::cast_rays (const jhcImg& env) 
 {
-  double ang, step = 180.0 / ndir;
+  double c0 = cos(D2R * raim), s0 = sin(D2R * raim);
   int dev, hnd = ndir / 2, nd2 = 2 * ndir;
 
-  // rotate local portion of map and measure robot free path length
-  ang = raim - hnd * step;
-  for (dev = -hnd; dev < hnd; dev++, ang += step)
-  {
-    rigid_samp(spin[hnd + dev], env, -ang);
-    clr_paths(dist[ndir + dev], dist[(nd2 + dev) % nd2], spin[hnd + dev]);
-  }
+  // rotate ray tables by robot heading and measure free path lengths
+  block_max(env);
+  for (dev = -hnd; dev < hnd; dev++)
+    ray_paths(dist[ndir + dev], dist[(nd2 + dev) % nd2], env, 
+              c0 * hc[hnd + dev] - s0 * hs[hnd + dev], -(s0 * hc[hnd + dev] + c0 * hs[hnd + dev]));
   dist[ndir] = __max(0.0, dist[ndir]);
   dist[0]    = __max(0.0, dist[0]);
 
@@ -602,8 +605,175 @@ void jhcLocalOcc::build_spin (const jhcImg& env)
 }
 
 
+//= Find forward and backward drivable distances along one heading.
+// "c" and "s" are cosine and sine of negative heading (as for rigid_samp)
+// reads rows of robot-wide swath in map that rigid_samp would have put in a view
+// distances are in inches straight forward or straight reverse in map
+
+void jhcLocalOcc::ray_paths (double& fwd, double& rev, const jhcImg& env, double c, double s) const
+{
+  double cx = 0.5 * (vdim - 1), cy = cx, scan = lead / ipp;
+  double rs = (rside + pad) / ipp, rb = (rback + pad) / ipp, rf = (rfwd + pad) / ipp;
+  double rx0 = (rx + x0) / ipp, ry0 = (ry + y0) / ipp;
+  int yrev = (int) floor(cy - rb - scan), ymid = ROUND(cy), yfwd = (int) ceil(cy + rf + scan); 
+  int xlf = (int) floor(cx - rs), xrt = (int) ceil(cx + rs), rw = xrt - xlf + 1;
+  int isx0 = ROUND(65536.0 * (rx0 - cx * c - cy * s)), is = ROUND(65536.0 * s);
+  int isy0 = ROUND(65536.0 * (ry0 + cx * s - cy * c)), ic = ROUND(65536.0 * c);
+  int x, y, isx, isy, ln = env.Line();
+  const UC8 *m0 = env.PxlSrc();
+
+  // start of each row is at left side of robot
+  isx0 += xlf * ic + 32768;
+  isy0 -= xlf * is - 32768;
+
+  // scan forward from middle of robot
+  for (y = ymid; y <= yfwd; y++)
+  {
+    isx = isx0 + y * is;
+    isy = isy0 + y * ic;
+    if (row_clear(isx, isy, ic, is, rw))
+      continue;
+    for (x = rw; x > 0; x--, isx += ic, isy -= is)
+      if (m0[(isy >> 16) * ln + (isx >> 16)] > 80)
+        break;
+    if (x > 0)
+      break;
+  }
+  fwd = (__min(y, yfwd) - (cy + rf)) * ipp;
+  fwd = __min(fwd, lead);
+
+  // scan backward from middle of robot
+  for (y = ymid - 1; y >= yrev; y--)
+  {
+    isx = isx0 + y * is;
+    isy = isy0 + y * ic;
+    if (row_clear(isx, isy, ic, is, rw))
+      continue;
+    for (x = rw; x > 0; x--, isx += ic, isy -= is)
+      if (m0[(isy >> 16) * ln + (isx >> 16)] > 80)
+        break;
+    if (x > 0)
+      break;
+  }
+  rev = ((cy - rb) - __max(y, yrev)) * ipp;
+  rev = __min(rev, lead);
+}
+
+
+//= Find maximum value in blocks of map near robot so most swath rows can be skipped.
+// "blk" holds max of each 8x8 block, "blk3" holds max of 3x3 blocks around each
+// any pixel within 8 of some point in a block whose "blk3" is 80 or less is clear
+// blocks touching the edge of the map are never considered clear
+
+void jhcLocalOcc::block_max (const jhcImg& env)
+{
+  int half = vdim / 2 + 16, nb = (2 * half) / 8 + 1;
+  int i, j, x, y, px, py, v, mx, bln, ew = env.XDim(), eh = env.YDim(), ln = env.Line();
+  const UC8 *m0 = env.PxlSrc(), *m, *b;
+  UC8 *d;
+
+  // block grid centered on robot
+  bx0 = ROUND((rx + x0) / ipp) - half;
+  by0 = ROUND((ry + y0) / ipp) - half;
+  blk.SetSize(nb, nb, 1);
+  blk3.SetSize(nb, nb, 1);
+  bln = blk.Line();
+
+  // simple maximum over each block
+  d = blk.PxlDest();
+  for (j = 0, py = by0; j < nb; j++, py += 8, d += bln - nb)
+    for (i = 0, px = bx0; i < nb; i++, px += 8, d++)
+    {
+      if ((px < 0) || (py < 0) || ((px + 8) > ew) || ((py + 8) > eh))
+      {
+        *d = 255;
+        continue;
+      }
+      mx = 0;
+      m = m0 + py * ln + px;
+      for (y = 8; y > 0; y--, m += ln - 8)
+        for (x = 8; x > 0; x--, m++)
+          mx = __max(mx, *m);
+      *d = (UC8) mx;
+    }
+
+  // maximum over 3x3 neighborhood of blocks
+  b = blk.PxlSrc();
+  d = blk3.PxlDest();
+  for (j = 0; j < nb; j++)
+    for (i = 0; i < nb; i++)
+    {
+      mx = 255;
+      if ((i > 0) && (j > 0) && (i < (nb - 1)) && (j < (nb - 1)))
+      {
+        m = b + (j - 1) * bln + (i - 1);
+        mx = 0;
+        for (y = 3; y > 0; y--, m += bln - 3)
+          for (x = 3; x > 0; x--, m++)
+            if ((v = *m) > mx)
+              mx = v;
+      }
+      d[j * bln + i] = (UC8) mx;
+    }
+}
+
+
+//= Tell if row of swath is certainly clear based on block maximum map.
+// "isx" and "isy" are 16.16 map coordinates of first pixel (including rounding)
+// checks every 8th sample and relies on margin in "blk3" for ones in between
+
+bool jhcLocalOcc::row_clear (int isx, int isy, int ic, int is, int rw) const
+{
+  int j, bx, by, nb = blk3.XDim(), bln = blk3.Line();
+  const UC8 *b = blk3.PxlSrc();
+
+  isx += 4 * ic;
+  isy -= 4 * is;
+  for (j = 4; (j - 4) < rw; j += 8, isx += 8 * ic, isy -= 8 * is)
+  {
+    bx = ((isx >> 16) - bx0) >> 3;
+    by = ((isy >> 16) - by0) >> 3;
+    if ((bx < 0) || (bx >= nb) || (by < 0) || (by >= nb) || (b[by * bln + bx] > 80))
+      return false;
+  }
+  return true;
+}
+
+
+//= Make a view of the map rotated to some heading deviation with scanned paths marked.
+// robot is in center pointing up, forward path is yellow and backward is orange
+// only needed for debugging since distances are found directly from map
+// returns 1 if okay, 0 for bad deviation
+
+int jhcLocalOcc::SpinView (jhcImg& dest, int dev) const
+{
+  double cx = 0.5 * (vdim - 1), cy = cx, fwd = dist[ndir + dev], rev = dist[(2 * ndir + dev) % (2 * ndir)];
+  double rs = (rside + pad) / ipp, rb = (rback + pad) / ipp, rf = (rfwd + pad) / ipp;
+  int ymid = ROUND(cy), yfwd = ROUND(cy + rf + fwd / ipp), yrev = ROUND(cy - rb - rev / ipp); 
+  int xlf = (int) floor(cx - rs), xrt = (int) ceil(cx + rs);
+  int x, y, hnd = ndir / 2;
+  UC8 *s;
+
+  if ((dev < -hnd) || (dev >= hnd))
+    return 0;
+  dest.SetSize(vdim, vdim, 1);
+  rigid_samp(dest, obst, -(raim + dev * Step()));
+
+  // mark clear pixels along forward and backward paths
+  for (y = __max(0, yrev); y <= __min(yfwd, vdim - 1); y++)
+  {
+    s = dest.RoiDest(__max(0, xlf), y);
+    for (x = __max(0, xlf); x <= __min(xrt, vdim - 1); x++, s++)
+      if (*s <= 80)
+        *s = (UC8)((y >= ymid) ? 230 : 180);
+  }
+  return 1;
+}
+
+
 //= Sample main map into smaller map after recentering and rotating.
 // variant of jhcResize::Rigid without source pixel check or scaling
+// only used to make debugging views now
 
 void jhcLocalOcc::rigid_samp (jhcImg& dest, const jhcImg& src, double degs) const
 {
@@ -625,47 +795,6 @@ void jhcLocalOcc::rigid_samp (jhcImg& dest, const jhcImg& src, double degs) cons
 }
 
 
-//= Fill in forward and backward drivable distances at various angles.
-// distances are in inches straight forward or straight reverse in map
-// marks up projection with scanned path (for debugging)
-// returns 1 for valid data, 0 if robot cannot exist in given view
-
-int jhcLocalOcc::clr_paths (double& fwd, double& rev, jhcImg& view) const
-{
-  double cx = 0.5 * view.XLim(), cy = 0.5 * view.YLim(), scan = lead / ipp;
-  double rs = (rside + pad) / ipp, rb = (rback + pad) / ipp, rf = (rfwd + pad) / ipp;
-  int yrev = (int) floor(cy - rb - scan), ymid = ROUND(cy), yfwd = (int) ceil(cy + rf + scan); 
-  int xlf = (int) floor(cx - rs), xrt = (int) ceil(cx + rs), rw = xrt - xlf + 1;
-  int x, y, sk = view.RoiSkip(rw), ln = view.Line();
-  UC8 *s0, *s;
-
-  // scan forward from middle of robot
-  x = 0;
-  s = view.RoiDest(xlf, ymid);
-  for (y = ymid; (y <= yfwd) && (x <= 0); y++, s += sk)
-    for (x = rw; x > 0; x--, s++)
-      if (*s > 80)
-        break;
-      else
-        *s = 230;                          // yellow
-  fwd = ((y - 1) - (cy + rf)) * ipp;
-  fwd = __min(fwd, lead);
-
-  // scan backward from middle of robot
-  x = 0;
-  s0 = view.RoiDest(xlf, ymid - 1);
-  for (y = ymid - 1; (y >= yrev) && (x <= 0); y--, s0 -= ln)
-    for (s = s0, x = rw; x > 0; x--, s++)
-      if (*s > 80)
-        break;
-      else
-        *s = 180;                          // orange
-  rev = ((cy - rb) - (y + 1)) * ipp;
-  rev = __min(rev, lead);
-  return 1;
-}
-
-
 //= See what fraction of pixels in front of robot are relatively fresh.
 // variant of jhcResize::Rigid without source pixel check or scaling
 
@@ -762,7 +891,7 @@ double jhcLocalOcc::Avoid (double& trav, double& head, double tx, double ty)
 
 double jhcLocalOcc::pick_dir (double td, double ta) const
 {
-  double prog[36];
+  double prog[360];
   double trads = D2R * ta, dr = PI / ndir, step = 180.0 / ndir;
   double rd, len, sum, adv, best = 0.0, win = -360.0;
   int dev;
@@ -811,7 +940,7 @@ double jhcLocalOcc::pick_dir (double td, double ta) const
 
 int jhcLocalOcc::Swerve (double& trav, double& head, double td, double ta) const
 {
-  double prog[36];
+  double prog[360];
   double trads = D2R * ta, dr = PI / ndir, step = 180.0 / ndir;
   double rd, len, sum, adv, diff, off, best = 0.0;
   int dev, i, nd2 = 2 * ndir;
@@ -59,10 +59,10 @@ private:
   UC8 cmax, ctmp;
 
   // travel clearance
-  jhcImg spin[18];
-  double dist[36];
+  jhcImg blk, blk3;
+  double dist[360], hc[180], hs[180];
   double fresh;
-  int ndir, rt0, lf1;
+  int ndir, rt0, lf1, vdim, bx0, by0;
 
   // navigation
   int trip, stuck;
@@ -119,6 +119,7 @@ public:
   double Path (int dev, int pos =1) const;
   double Ahead (double end =0.0) const;
   double Behind (double end =0.0) const;
+  int SpinView (jhcImg& dest, int dev) const;
 
   // navigation
   bool Blind ();
@@ -158,9 +159,11 @@ private:
 
   // synthetic sensors
   void set_spin (double da);
-  void build_spin (const jhcImg& env);
+  void cast_rays (const jhcImg& env);
+  void block_max (const jhcImg& env);
+  void ray_paths (double& fwd, double& rev, const jhcImg& env, double c, double s) const;
+  bool row_clear (int isx, int isy, int ic, int is, int rw) const;
   void rigid_samp (jhcImg& dest, const jhcImg& src, double degs) const;
-  int clr_paths (double& fwd, double& rwv, jhcImg& view) const;
   double known_ahead (const jhcImg& cf) const;
 
   // navigation
@@ -0,0 +1,580 @@
+// jhcAssign.cpp : gated sparse assignment of tracks to detections
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+
+#include "Geometry/jhcAssign.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcAssign::~jhcAssign ()
+{
+  dealloc();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcAssign::jhcAssign ()
+{
+  null_ptrs();
+  emax = 0;
+  rmax = 0;
+  cmax = 0;
+  hsz = 0;
+  amax = 0;
+  gsz = 1.0;
+  Clear(0, 0);
+}
+
+
+//= Get rid of all allocated arrays.
+
+void jhcAssign::dealloc ()
+{
+  delete [] cmap;
+  delete [] rmap;
+  delete [] ci;
+  delete [] ri;
+  delete [] used;
+  delete [] way;
+  delete [] p;
+  delete [] mv;
+  delete [] v;
+  delete [] u;
+  delete [] a;
+  delete [] cand;
+  delete [] gy;
+  delete [] gx;
+  delete [] link;
+  delete [] head;
+  delete [] back;
+  delete [] fwd;
+  delete [] ord;
+  delete [] col;
+  delete [] row;
+  delete [] cost;
+  null_ptrs();
+  emax = 0;
+  rmax = 0;
+  cmax = 0;
+}
+
+
+//= Mark all arrays as unallocated.
+
+void jhcAssign::null_ptrs ()
+{
+  cost = NULL;
+  row = NULL;
+  col = NULL;
+  ord = NULL;
+  fwd = NULL;
+  back = NULL;
+  head = NULL;
+  link = NULL;
+  gx = NULL;
+  gy = NULL;
+  cand = NULL;
+  a = NULL;
+  u = NULL;
+  v = NULL;
+  mv = NULL;
+  p = NULL;
+  way = NULL;
+  used = NULL;
+  ri = NULL;
+  ci = NULL;
+  rmap = NULL;
+  cmap = NULL;
+}
+
+
+//= Make sure enough room for a problem with some number of rows and columns.
+// returns 1 if successful, 0 for allocation failure
+
+int jhcAssign::SetSize (int rows, int cols)
+{
+  int m = rows + cols;
+
+  if ((rows <= rmax) && (cols <= cmax))
+    return 1;
+  dealloc();
+
+  // sparse costs and pairings
+  emax = rows * cols;
+  cost = new double [emax];
+  row  = new int [emax];
+  col  = new int [emax];
+  ord  = new int [emax];
+  fwd  = new int [rows];
+  back = new int [cols];
+
+  // hash grid (at least twice as many bins as columns)
+  for (hsz = 16; hsz < (2 * cols); hsz <<= 1);
+  head = new int [hsz];
+  link = new int [cols];
+  gx   = new int [cols];
+  gy   = new int [cols];
+  cand = new int [cols];
+
+  // dense solver for compacted problem (columns include one dummy per row)
+  amax = rows * m;
+  a    = new double [amax];
+  u    = new double [rows + 1];
+  v    = new double [m + 1];
+  mv   = new double [m + 1];
+  p    = new int [m + 1];
+  way  = new int [m + 1];
+  used = new int [m + 1];
+  ri   = new int [rows];
+  ci   = new int [cols];
+  rmap = new int [rows];
+  cmap = new int [cols];
+
+  // check for success
+  if ((cmap == NULL) || (a == NULL) || (cost == NULL))
+  {
+    dealloc();
+    return 0;
+  }
+  rmax = rows;
+  cmax = cols;
+  Clear(0, 0);
+  return 1;
+}
+
+
+//= Start a new problem with n rows (tracks) and m columns (detections).
+// removes all costs and pairings, sizes are clipped to capacity
+
+void jhcAssign::Clear (int n, int m)
+{
+  int i;
+
+  nr = __max(0, __min(n, rmax));
+  nc = __max(0, __min(m, cmax));
+  for (i = 0; i < nr; i++)
+    fwd[i] = -1;
+  for (i = 0; i < nc; i++)
+    back[i] = -1;
+  ne = 0;
+  sorted = 0;
+  scan = 0;
+  last = -1.0;
+  ncand = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                                Gating                                 //
+///////////////////////////////////////////////////////////////////////////
+
+//= Set size of grid cells for binning columns and empty all bins.
+// sz should be at least the largest allowed x or y difference in a pair
+
+void jhcAssign::Grid (double sz)
+{
+  int i;
+
+  gsz = __max(sz, 1e-6);
+  for (i = 0; i < hsz; i++)
+    head[i] = -1;
+}
+
+
+//= Record the planar location of some column (detection).
+
+void jhcAssign::BinCol (int j, double x, double y)
+{
+  int h;
+
+  if ((j < 0) || (j >= nc))
+    return;
+  gx[j] = (int) floor(x / gsz);
+  gy[j] = (int) floor(y / gsz);
+  h = hash(gx[j], gy[j]);
+  link[j] = head[h];
+  head[h] = j;
+}
+
+
+//= Find all columns binned in the 3x3 grid cells around some location.
+// candidates are sorted by increasing column number, retrieve with Cand
+// returns number of candidates found
+
+int jhcAssign::Near (double x, double y)
+{
+  int cx = (int) floor(x / gsz), cy = (int) floor(y / gsz);
+  int dx, dy, j, k, val;
+
+  ncand = 0;
+  for (dy = -1; dy <= 1; dy++)
+    for (dx = -1; dx <= 1; dx++)
+      for (j = head[hash(cx + dx, cy + dy)]; j >= 0; j = link[j])
+        if ((gx[j] == (cx + dx)) && (gy[j] == (cy + dy)))
+        {
+          // insert in order
+          for (k = ncand; k > 0; k--)
+          {
+            if ((val = cand[k - 1]) < j)
+              break;
+            cand[k] = val;
+          }
+          cand[k] = j;
+          ncand++;
+        }
+  return ncand;
+}
+
+
+//= Pick hash bin for some grid cell.
+
+int jhcAssign::hash (int cx, int cy) const
+{
+  return((int)(((UL32) cx * 73856093) ^ ((UL32) cy * 19349663)) & (hsz - 1));
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Sparse Costs                              //
+///////////////////////////////////////////////////////////////////////////
+
+//= Declare that row i can be paired with column j for some cost (non-negative).
+// for exact greedy tie-breaking add pairs in increasing row then column order
+// returns 1 if okay, 0 if no more room or bad indices
+
+int jhcAssign::Add (int i, int j, double c)
+{
+  if ((i < 0) || (i >= nr) || (j < 0) || (j >= nc) || (ne >= emax))
+    return 0;
+  cost[ne] = c;
+  row[ne] = i;
+  col[ne] = j;
+  ne++;
+  sorted = 0;
+  return 1;
+}
+
+
+//= Get the cost of pairing row i with column j (negative if not allowed).
+
+double jhcAssign::Cost (int i, int j) const
+{
+  int e;
+
+  for (e = 0; e < ne; e++)
+    if ((row[e] == i) && (col[e] == j))
+      return cost[e];
+  return -1.0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                                Pairing                                //
+///////////////////////////////////////////////////////////////////////////
+
+//= Bind all free rows with rank at least th (if given) to some free column.
+// optim > 0 minimizes total cost, else repeatedly binds cheapest free pair
+// miss is cost of leaving an eligible row unbound (only used if optim > 0)
+// returns number of new pairs made
+
+int jhcAssign::Solve (int optim, const int *rank, int th, double miss)
+{
+  int i, j, n = 0;
+
+  if (optim > 0)
+    return optimal(rank, th, miss);
+  Sweep();
+  while (NextPair(i, j, rank, th) > 0)
+  {
+    Bind(i, j);
+    n++;
+  }
+  return n;
+}
+
+
+//= Get cheapest remaining pair with both row and column free.
+// continues from last pair returned since Sweep (pairs never become free again)
+// ties go to lowest row number then lowest column number
+// cost of pair found is available afterwards from PairCost
+// returns 1 if some pair found, 0 if none left
+
+int jhcAssign::NextPair (int& i, int& j, const int *rank, int th)
+{
+  int e;
+
+  if (sorted <= 0)
+    sort_edges();
+  while (scan < ne)
+  {
+    e = ord[scan++];
+    if ((fwd[row[e]] < 0) && (back[col[e]] < 0))
+      if ((rank == NULL) || (rank[row[e]] >= th))
+      {
+        i = row[e];
+        j = col[e];
+        last = cost[e];
+        return 1;
+      }
+  }
+  return 0;
+}
+
+
+//= Find the free row (other than skip) with the lowest cost for column j.
+// ties go to the lowest row number, binds cost of best pair to c
+// returns row index, negative if none
+
+int jhcAssign::BestInCol (double& c, int j, int skip, const int *rank, int th) const
+{
+  int e, i, win = -1;
+
+  for (e = 0; e < ne; e++)
+    if ((col[e] == j) && ((i = row[e]) != skip) && (fwd[i] < 0))
+      if ((rank == NULL) || (rank[i] >= th))
+        if ((win < 0) || (cost[e] < c) || ((cost[e] == c) && (i < win)))
+        {
+          c = cost[e];
+          win = i;
+        }
+  return win;
+}
+
+
+//= Record that row i is now paired with column j.
+
+void jhcAssign::Bind (int i, int j)
+{
+  if ((i < 0) || (i >= nr) || (j < 0) || (j >= nc))
+    return;
+  fwd[i] = j;
+  back[j] = i;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Greedy Pairing                             //
+///////////////////////////////////////////////////////////////////////////
+
+//= Heap sort edge indices by increasing cost, then row, then column.
+
+void jhcAssign::sort_edges ()
+{
+  int e, tmp;
+
+  for (e = 0; e < ne; e++)
+    ord[e] = e;
+  for (e = (ne >> 1) - 1; e >= 0; e--)
+    sift_down(e, ne);
+  for (e = ne - 1; e > 0; e--)
+  {
+    tmp = ord[0];
+    ord[0] = ord[e];
+    ord[e] = tmp;
+    sift_down(0, e);
+  }
+  sorted = 1;
+  scan = 0;
+}
+
+
+//= Tell if edge e0 should come strictly before edge e1.
+
+int jhcAssign::edge_before (int e0, int e1) const
+{
+  if (cost[e0] != cost[e1])
+    return((cost[e0] < cost[e1]) ? 1 : 0);
+  if (row[e0] != row[e1])
+    return((row[e0] < row[e1]) ? 1 : 0);
+  return((col[e0] < col[e1]) ? 1 : 0);
+}
+
+
+//= Restore max-heap property for sub-tree rooted at top (only first n entries).
+
+void jhcAssign::sift_down (int top, int n)
+{
+  int kid, tmp, i = top;
+
+  while ((kid = 2 * i + 1) < n)
+  {
+    if (((kid + 1) < n) && edge_before(ord[kid], ord[kid + 1]))
+      kid++;
+    if (!edge_before(ord[i], ord[kid]))
+      return;
+    tmp = ord[i];
+    ord[i] = ord[kid];
+    ord[kid] = tmp;
+    i = kid;
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Optimal Pairing                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Find minimum total cost pairing of eligible free rows and free columns.
+// only rows and columns mentioned in some allowed pair are considered
+// each row gets a private dummy column with cost "miss" for staying unbound
+// default miss (<= 0) is big enough that more pairs is always better
+// returns number of new pairs made
+
+int jhcAssign::optimal (const int *rank, int th, double miss)
+{
+  double big, c, worst = 0.0;
+  int e, i, j, r, m, n = 0, k = 0, cnt = 0;
+
+  // compact problem to rows and columns with some allowed pair
+  for (i = 0; i < nr; i++)
+    rmap[i] = -1;
+  for (j = 0; j < nc; j++)
+    cmap[j] = -1;
+  for (e = 0; e < ne; e++)
+  {
+    i = row[e];
+    j = col[e];
+    if ((fwd[i] >= 0) || (back[j] >= 0) || ((rank != NULL) && (rank[i] < th)))
+      continue;
+    if (rmap[i] < 0)
+    {
+      ri[n] = i;
+      rmap[i] = n++;
+    }
+    if (cmap[j] < 0)
+    {
+      ci[k] = j;
+      cmap[j] = k++;
+    }
+    worst = __max(worst, cost[e]);
+  }
+  if (n <= 0)
+    return 0;
+
+  // build dense cost matrix (forbidden pairs are too expensive to ever use)
+  if (miss <= 0.0)
+    miss = (worst + 1.0) * n;
+  big = (miss + worst + 1.0) * (n + 1);
+  m = k + n;
+  for (e = n * m - 1; e >= 0; e--)
+    a[e] = big;
+  for (e = 0; e < ne; e++)
+    if (((r = rmap[row[e]]) >= 0) && ((j = cmap[col[e]]) >= 0))
+      a[r * m + j] = __min(a[r * m + j], cost[e]);
+  for (r = 0; r < n; r++)
+    a[r * m + k + r] = miss;
+
+  // solve and record real pairings
+  hungarian(n, m);
+  for (j = 1; j <= k; j++)
+    if ((r = p[j]) > 0)
+    {
+      c = a[(r - 1) * m + (j - 1)];
+      if (c < big)
+      {
+        Bind(ri[r - 1], ci[j - 1]);
+        cnt++;
+      }
+    }
+  return cnt;
+}
+
+
+//= Shortest augmenting path assignment for dense n x m matrix "a" (n <= m).
+// leaves row (1 based) assigned to each column (1 based) in array "p"
+// takes O(n^2 m) time, uses row and column potentials in "u" and "v"
+
+void jhcAssign::hungarian (int n, int m)
+{
+  double cur, delta, inf = 1e300;
+  int i, j, i0, j0, j1;
+
+  for (i = 0; i <= n; i++)
+    u[i] = 0.0;
+  for (j = 0; j <= m; j++)
+  {
+    v[j] = 0.0;
+    p[j] = 0;
+    way[j] = 0;
+  }
+
+  for (i = 1; i <= n; i++)
+  {
+    // grow alternating tree from new row
+    p[0] = i;
+    j0 = 0;
+    for (j = 0; j <= m; j++)
+    {
+      mv[j] = inf;
+      used[j] = 0;
+    }
+    do
+    {
+      used[j0] = 1;
+      i0 = p[j0];
+      delta = inf;
+      j1 = 0;
+      for (j = 1; j <= m; j++)
+        if (used[j] <= 0)
+        {
+          cur = a[(i0 - 1) * m + (j - 1)] - u[i0] - v[j];
+          if (cur < mv[j])
+          {
+            mv[j] = cur;
+            way[j] = j0;
+          }
+          if (mv[j] < delta)
+          {
+            delta = mv[j];
+            j1 = j;
+          }
+        }
+      for (j = 0; j <= m; j++)
+        if (used[j] > 0)
+        {
+          u[p[j]] += delta;
+          v[j] -= delta;
+        }
+        else
+          mv[j] -= delta;
+      j0 = j1;
+    }
+    while (p[j0] != 0);
+
+    // flip pairings along augmenting path
+    do
+    {
+      j1 = way[j0];
+      p[j0] = p[j1];
+      j0 = j1;
+    }
+    while (j0 != 0);
+  }
+}
+
@@ -0,0 +1,133 @@
+// jhcAssign.h : gated sparse assignment of tracks to detections
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCASSIGN_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCASSIGN_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+
+//= Gated sparse assignment of tracks (rows) to detections (columns).
+// only plausible pairs are stored, found by binning detections in a hash grid
+// greedy mode binds globally cheapest free pair first, ties going to lowest
+// row then lowest column, exactly like a full matrix rescan but in one sweep
+// optimal mode minimizes total cost (Hungarian / Jonker-Volgenant style) where
+// leaving a row unbound costs "miss" (default prefers most pairs, then cost)
+// rows can be ranked so that higher classes are bound before lower ones
+// <pre>
+// typical use:
+//
+//   asg.Clear(nt, nd);
+//   asg.Grid(gate);
+//   for (j = 0; j < nd; j++)
+//     asg.BinCol(j, dx[j], dy[j]);
+//   for (i = 0; i < nt; i++)
+//     for (k = asg.Near(tx[i], ty[i]) - 1; k >= 0; k--) ...
+//       asg.Add(i, asg.Cand(k), cost);
+//   asg.Solve(optim);
+//
+// </pre>
+
+class jhcAssign
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  // sparse costs (in order added) and sorted order
+  double *cost;
+  int *row, *col, *ord;
+  double last;
+  int ne, emax, sorted, scan;
+
+  // current pairing
+  int *fwd, *back;
+  int nr, nc, rmax, cmax;
+
+  // gating grid
+  int *head, *link, *gx, *gy, *cand;
+  int hsz, ncand;
+  double gsz;
+
+  // optimal solver scratch
+  double *a, *u, *v, *mv;
+  int *p, *way, *used, *ri, *ci, *rmap, *cmap;
+  int amax;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcAssign ();
+  jhcAssign ();
+  int SetSize (int rows, int cols);
+  void Clear (int n, int m);
+  int Rows () const  {return nr;}
+  int Cols () const  {return nc;}
+  int Edges () const {return ne;}
+
+  // gating
+  void Grid (double sz);
+  void BinCol (int j, double x, double y);
+  int Near (double x, double y);
+  int Cand (int k) const {return(((k < 0) || (k >= ncand)) ? -1 : cand[k]);}
+
+  // sparse costs
+  int Add (int i, int j, double c);
+  double Cost (int i, int j) const;
+
+  // pairing
+  int Solve (int optim =0, const int *rank =NULL, int th =0, double miss =-1.0);
+  void Sweep () {scan = 0;}
+  int NextPair (int& i, int& j, const int *rank =NULL, int th =0);
+  double PairCost () const {return last;}
+  int BestInCol (double& c, int j, int skip =-1, const int *rank =NULL, int th =0) const;
+  void Bind (int i, int j);
+  int ColFor (int i) const {return(((i < 0) || (i >= nr)) ? -1 : fwd[i]);}
+  int RowFor (int j) const {return(((j < 0) || (j >= nc)) ? -1 : back[j]);}
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  void null_ptrs ();
+  void dealloc ();
+  int hash (int cx, int cy) const;
+
+  // greedy pairing
+  void sort_edges ();
+  int edge_before (int e0, int e1) const;
+  void sift_down (int top, int n);
+
+  // optimal pairing
+  int optimal (const int *rank, int th, double miss);
+  void hungarian (int n, int m);
+
+
+};
+
+
+#endif  // once
+
+
+
+
@@ -0,0 +1,279 @@
+// jhcMatFix.h : small matrices and vectors with sizes fixed at compile time
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCMATFIX_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCMATFIX_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include <math.h>
+
+#include "Geometry/jhcMatrix.h"
+
+
+//= Small matrix or vector with NC columns and NR rows fixed at compile time.
+// values held directly in object (no heap, no size fields, no bounds checks)
+// storage is column-major exactly like jhcMatrix so 4-vectors are contiguous
+// all loop limits are constants so compiler can unroll and vectorize them
+// vector functions mirror jhcMatrix versions and give bit-identical results
+// arguments of most vector functions can be either jhcMatFix or jhcMatrix
+// NOTE: constructor does not clear values (use Zero if needed)
+// <pre>
+// typical use:
+//
+//   jhcVec4 mv;
+//   mv.DiffVec3(pos, *orig);
+//   mv.CrossVec3(*axis, mv);
+//   mv.Put(result);
+//
+// </pre>
+
+template <int NC, int NR> class jhcMatFix
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  double vals[NC * NR];
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and conversion
+  jhcMatFix () {}
+  jhcMatFix (const jhcMatrix& src) {Get(src);}
+  int Cols () const {return NC;}
+  int Rows () const {return NR;}
+
+  //= Copy overlapping part of a general matrix into self.
+  void Get (const jhcMatrix& src)
+  {
+    int i, j, cw = __min(NC, src.Cols()), rh = __min(NR, src.Rows());
+
+    for (i = 0; i < cw; i++)
+      for (j = 0; j < rh; j++)
+        vals[i * NR + j] = src.MRef(i, j);
+  }
+
+  //= Copy self into overlapping part of a general matrix.
+  void Put (jhcMatrix& dest) const
+  {
+    int i, j, cw = __min(NC, dest.Cols()), rh = __min(NR, dest.Rows());
+
+    for (i = 0; i < cw; i++)
+      for (j = 0; j < rh; j++)
+        dest.MSet(i, j, vals[i * NR + j]);
+  }
+
+  //= Clear all entries, if homogeneous write a value in lower right corner.
+  void Zero (double homo =0.0)
+  {
+    int i;
+
+    for (i = 0; i < NC * NR; i++)
+      vals[i] = 0.0;
+    vals[NC * NR - 1] = homo;
+  }
+
+  //= Put 1's on major diagonal (only for square matrices).
+  void Identity ()
+  {
+    int i;
+
+    Zero();
+    for (i = 0; i < NC; i++)
+      vals[i * NR + i] = 1.0;
+  }
+
+  // value access and modification
+  const double *Vals () const          {return vals;}
+  double *VPtr (int y)                 {return(vals + y);}
+  double VRef (int y) const            {return vals[y];}
+  void VSet (int y, double v)          {vals[y] = v;}
+  void VInc (int y, double dv)         {vals[y] += dv;}
+  double MRef (int x, int y) const     {return vals[x * NR + y];}
+  void MSet (int x, int y, double v)   {vals[x * NR + y] = v;}
+  void MInc (int x, int y, double dv)  {vals[x * NR + y] += dv;}
+
+  // 3D vector conventions
+  double X () const {return vals[0];}
+  double Y () const {return vals[1];}
+  double Z () const {return vals[2];}
+  double P () const {return vals[0];}
+  double T () const {return vals[1];}
+  double R () const {return vals[2];}
+
+  //= Set up a 3D column vector with specific values of X, Y, and Z.
+  void SetVec3 (double x, double y, double z, double homo =1.0)
+  {
+    vals[0] = x;
+    vals[1] = y;
+    vals[2] = z;
+    if (NR == 4)
+      vals[3] = homo;
+  }
+
+  //= Add corresponding elements of some other vector (shorter length governs).
+  template <class V> void IncVec (const V& ref)
+  {
+    int i, n = __min(NR, ref.Rows());
+
+    for (i = 0; i < n; i++)
+      vals[i] += ref.VRef(i);
+  }
+
+  //= Multiply all 3D coordinates of self by some value.
+  void ScaleVec3 (double sc, double homo =1.0)
+    {SetVec3(sc * vals[0], sc * vals[1], sc * vals[2], homo);}
+
+  //= Multiply all 3D coordinates of reference by some value.
+  template <class V> void ScaleVec3 (const V& ref, double sc, double homo =1.0)
+    {SetVec3(sc * ref.VRef(0), sc * ref.VRef(1), sc * ref.VRef(2), homo);}
+
+  //= Returns the length of a homogeneous coordinate 3D vector.
+  double LenVec3 () const
+    {return sqrt(vals[0] * vals[0] + vals[1] * vals[1] + vals[2] * vals[2]);}
+
+  //= Returns the dot product of self with some other 3D vector.
+  template <class V> double DotVec3 (const V& ref) const
+    {return(vals[0] * ref.VRef(0) + vals[1] * ref.VRef(1) + vals[2] * ref.VRef(2));}
+
+  //= Set self to be the difference of two 3D vectors (a - b).
+  template <class A, class B> void DiffVec3 (const A& a, const B& b, double homo =1.0)
+    {SetVec3(a.X() - b.X(), a.Y() - b.Y(), a.Z() - b.Z(), homo);}
+
+  //= Set self to cross product of two 3D vectors (a x b), okay if self is a or b.
+  template <class A, class B> void CrossVec3 (const A& a, const B& b, double homo =1.0)
+  {
+    double x, y, z;
+
+    x = a.VRef(1) * b.VRef(2) - a.VRef(2) * b.VRef(1);
+    y = a.VRef(2) * b.VRef(0) - a.VRef(0) * b.VRef(2);
+    z = a.VRef(0) * b.VRef(1) - a.VRef(1) * b.VRef(0);
+    SetVec3(x, y, z, homo);
+  }
+
+  //= Set self to a 3D unit vector based on input, returns original length.
+  template <class V> double UnitVec3 (const V& ref, double homo =1.0)
+  {
+    double len = ref.LenVec3();
+
+    if (len > 0.0)
+      ScaleVec3(ref, 1.0 / len, homo);
+    return len;
+  }
+
+  //= Convert self to a 3D unit vector, returns original length.
+  double UnitVec3 (double homo =1.0)
+    {return UnitVec3(*this, homo);}
+
+  //= Make a unit pointing vector from yaw (pan) and pitch (tilt) in degrees.
+  void EulerVec3 (double yaw, double pitch, double homo =0.0)
+  {
+    double yaw_r = D2R * yaw, pitch_r = D2R * pitch, flat = cos(pitch_r);
+
+    SetVec3(flat * cos(yaw_r), flat * sin(yaw_r), sin(pitch_r), homo);
+  }
+
+  //= Make quaternion for rotating some number of degrees around an axis.
+  template <class V> void Quaternion (const V& axis, double degs)
+  {
+    double ha = 0.5 * D2R * degs;
+
+    ScaleVec3(axis, sin(ha) / axis.LenVec3());
+    vals[3] = cos(ha);
+  }
+
+  //= Make quaternion equivalent to applying q1 then q2 (okay if self is either).
+  template <class A, class B> void CascadeQ (const A& q1, const B& q2)
+  {
+    double x1 = q1.X(), y1 = q1.Y(), z1 = q1.Z(), w1 = q1.VRef(3);
+    double x2 = q2.X(), y2 = q2.Y(), z2 = q2.Z(), w2 = q2.VRef(3);
+
+    vals[0] =  w2 * x1 + z2 * y1 - y2 * z1 + x2 * w1;
+    vals[1] = -z2 * x1 + w2 * y1 + x2 * z1 + y2 * w1;
+    vals[2] =  y2 * x1 - x2 * y1 + w2 * z1 + z2 * w1;
+    vals[3] = -x2 * x1 - y2 * y1 - z2 * z1 + w2 * w1;
+  }
+
+  //= Convert quaternion to rotation axis scaled by rotation amount in degrees.
+  template <class V> void RotatorQ (const V& q)
+  {
+    double hcos = q.VRef(3);
+
+    if (hcos == 1.0)
+    {
+      Zero(0.0);
+      return;
+    }
+    hcos = __max(-1.0, __min(hcos, 1.0));
+    ScaleVec3(q, 2.0 * R2D * acos(hcos) / q.LenVec3(), 0.0);
+  }
+
+  //= Left multiply a vector by a matrix, only using first K vector entries.
+  // self must not be the same as input vector
+  template <int K, class V> void MatVec0 (const jhcMatFix<K, NR>& mat, const V& vec)
+  {
+    double a;
+    int i, j;
+
+    for (j = 0; j < NR; j++)
+    {
+      a = 0.0;
+      for (i = 0; i < K; i++)
+        a += mat.MRef(i, j) * vec.VRef(i);
+      vals[j] = a;
+    }
+  }
+
+  //= Set self to matrix product of lf and rt (self must not be either one).
+  template <int K> void MatMat (const jhcMatFix<K, NR>& lf, const jhcMatFix<NC, K>& rt)
+  {
+    double v;
+    int i, j, k;
+
+    for (i = 0; i < NC; i++)
+      for (j = 0; j < NR; j++)
+      {
+        v = 0.0;
+        for (k = 0; k < K; k++)
+          v += lf.MRef(k, j) * rt.MRef(i, k);
+        vals[i * NR + j] = v;
+      }
+  }
+
+
+};
+
+
+//= Common small types: 3D point, homogeneous point, and homogeneous transform.
+
+typedef jhcMatFix<1, 3> jhcVec3;
+typedef jhcMatFix<1, 4> jhcVec4;
+typedef jhcMatFix<4, 4> jhcMat4;
+
+
+#endif  // once
+
+
+
+
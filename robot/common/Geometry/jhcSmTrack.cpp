@@ -45,6 +45,7 @@ jhcSmTrack::jhcSmTrack (int n)
   // processing values
   bin_sz = 0.5;
   SetTrack(1.0, 1.0, 1.0, 0.2, 0.0, 0.0, 2.0);
+  optim = 0;
   SetFilter(3.0, 3.0, 3.0, 0.1, 0.1, 0.1, 5, 5);
 
   // read values from file and clear state
@@ -94,24 +95,24 @@ int jhcSmTrack::SetSize (int n)
     return 0;
   if ((var = new double * [n]) == NULL)
     return 0;
-  if ((dist = new double * [n]) == NULL)
-    return 0;
   if ((tag = new char * [n]) == NULL)
     return 0;
 
-  // create positions, variances, and match distances
+  // create positions and variances
   for (i = 0; i < n; i++)
   {
     if ((pos[i] = new double [3]) == NULL)
       ok = 0;
     if ((var[i] = new double [3]) == NULL)
       ok = 0;
-    if ((dist[i] = new double [n]) == NULL)
-      ok = 0;
     if ((tag[i] = new char [80]) == NULL)
       ok = 0;
   }
 
+  // sparse match distances
+  if (asg.SetSize(n, n) <= 0)
+    ok = 0;
+
   // check for success
   if (ok > 0)
     total = n;
@@ -129,9 +130,6 @@ void jhcSmTrack::dealloc ()
   if (tag != NULL)
     for (i = total - 1; i >= 0; i--)
       delete [] tag[i];
-  if (dist != NULL)
-    for (i = total - 1; i >= 0; i--)
-      delete [] dist[i];
   if (var != NULL)
     for (i = total - 1; i >= 0; i--)
       delete [] var[i];
@@ -141,7 +139,6 @@ void jhcSmTrack::dealloc ()
 
   // get rid of base arrays
   delete [] tag;
-  delete [] dist;
   delete [] var;
   delete [] pos;
 
@@ -156,7 +153,6 @@ void jhcSmTrack::dealloc ()
   // clear previous pointers 
   pos  = NULL;
   var  = NULL;
-  dist = NULL;
   ena  = NULL;
   id   = NULL;
   cnt  = NULL;
@@ -217,6 +213,7 @@ int jhcSmTrack::track_params (const char *fname)
   ps->NextSpecF( &daf,      "Angle diff wt (deg/in)");
 
   ps->NextSpecF( &rival,    "Elder preference ratio");
+  ps->NextSpec4( &optim,    "Optimal assignment");
   ok = ps->LoadDefs(fname);
   ps->RevertAll();
   return ok;
@@ -351,6 +348,7 @@ void jhcSmTrack::SetEnable (int i, int active)
 // updates match positions and validity, can optionally delete bad tracks
 // only pays attention to first "total" detections, even if "n" is bigger
 // always sets "state" to zero and "tag" to empty for newly added tracks
+// optim > 0 minimizes total distance, else uses greedy pairing (with elders)
 
 void jhcSmTrack::MatchAll (const double * const *detect, int n, int rem, const double * const *shp)
 {
@@ -358,8 +356,16 @@ void jhcSmTrack::MatchAll (const double * const *detect, int n, int rem, const d
 
   // link all reasonable pairs and penalize unlinked tracks
   score_all(detect, nt, shp);
-  greedy_pair(detect, nt, 1);    // match established tracks first
-  greedy_pair(detect, nt, 0);    // probationary tracks get leftovers
+  if (optim > 0)
+  {
+    optimal_pair(detect, 1);     // match established tracks first
+    optimal_pair(detect, 0);     // probationary tracks get leftovers
+  }
+  else
+  {
+    greedy_pair(detect, nt, 1);  
+    greedy_pair(detect, nt, 0);  
+  }
   if (rem > 0)
     Prune();
 
@@ -374,11 +380,13 @@ void jhcSmTrack::MatchAll (const double * const *detect, int n, int rem, const d
 }
 
 
-//= Clear detection assignments and compute compatibilities with all tracks.
+//= Clear detection assignments and compute compatibilities with nearby tracks.
+// detections are binned in an x-y grid so each track only checks a few
 
 void jhcSmTrack::score_all (const double * const *detect, int n, const double * const *shp)
 {
-  int i, j;
+  double d2;
+  int i, j, k;
 
   // clear all match linkages
   for (i = 0; i < total; i++)
@@ -386,23 +394,38 @@ void jhcSmTrack::score_all (const double * const *detect, int n, const double *
   for (j = 0; j < total; j++)
     back[j] = -1;
 
-  // cache pair distance (squared) if position change is acceptable.
-  if (shp == NULL) 
-  {
-    // just use position difference
-    for (i = 0; i < valid; i++)
-      if ((id[i] >= 0) && (ena[i] > 0))
-        for (j = 0; j < n; j++)
-          (dist[i])[j] = get_d2(i, detect[j]);
-  }
-  else
-  {
-    // use shape differences also
-    for (i = 0; i < valid; i++)
-      if ((id[i] >= 0) && (ena[i] > 0))
-        for (j = 0; j < n; j++)
-          (dist[i])[j] = get_d2s(i, detect[j], shp[j]);
-  }
+  // bin detections by position
+  asg.Clear(valid, n);
+  asg.Grid(gate_size(n, shp));
+  for (j = 0; j < n; j++)
+    asg.BinCol(j, detect[j][0], detect[j][1]);
+
+  // cache pair distance (squared) if position change is acceptable
+  for (i = 0; i < valid; i++)
+    if ((id[i] >= 0) && (ena[i] > 0))
+    {
+      asg.Near(pos[i][0], pos[i][1]);
+      for (k = 0; (j = asg.Cand(k)) >= 0; k++)
+      {
+        d2 = ((shp == NULL) ? get_d2(i, detect[j]) : get_d2s(i, detect[j], shp[j]));
+        if (d2 >= 0.0)
+          asg.Add(i, j, d2);
+      }
+    }
+}
+
+
+//= Find the largest x or y position change that could be accepted.
+
+double jhcSmTrack::gate_size (int n, const double * const *shp) const
+{
+  double sz = __max(close[0], close[1]);
+  int j;
+
+  if ((shp != NULL) && (frac > 0.0))
+    for (j = 0; j < n; j++)
+      sz = __max(sz, frac * __max(shp[j][0], shp[j][1]));
+  return sz;
 }
 
 
@@ -479,59 +502,49 @@ double jhcSmTrack::get_d2s (int i, const double *item, const double *shp) const
 
 //= Let tracked people grab closest new detection.
 // can optionally restrict matching to establishied (numbered) tracks
-// "dist" searched to find pair which is recorded in "fwd" and "back"
+// pairs are taken in order of increasing distance and recorded in "fwd" and "back"
 
 void jhcSmTrack::greedy_pair (const double * const *detect, int n, int solid)
 {
-  double best, best2, r2 = rival * rival;
-  int i, j, jwin, iwin, alt, th = ((solid > 0) ? 1 : 0);
+  double best2, r2 = rival * rival;
+  int jwin, iwin, alt, th = ((solid > 0) ? 1 : 0);
 
-  while (1)
+  asg.Sweep();
+  while (asg.NextPair(iwin, jwin, id, th) > 0)
   {
-    // find smallest remaining distance between unpaired items
-    best = -1.0;
-    for (i = 0; i < valid; i++)
-      if ((id[i] >= th) && (ena[i] > 0))
-        if (fwd[i] < 0)
-          for (j = 0; j < n; j++)
-            if ((back[j] < 0) && ((dist[i])[j] >= 0.0))
-              if ((best < 0.0) || ((dist[i])[j] < best))
-              {
-                best = (dist[i])[j];
-                iwin = i;
-                jwin = j;
-              }
-
-     // stop if one set or other exhausted
-     if (best < 0.0)
-       return;
-
      if (rival > 0.0)
      {
        // find second best solid track for selected detection
-       best2 = -1.0;
-       for (i = 0; i < valid; i++)
-         if ((id[i] > 0) && (ena[i] > 0))
-           if ((fwd[i] < 0) && (i != iwin))
-             if ((dist[i])[jwin] >= 0.0)
-               if ((best2 < 0.0) || ((dist[i])[jwin] < best2))
-               {
-                 best2 = (dist[i])[jwin];
-                 alt = i;
-               }
+       alt = asg.BestInCol(best2, jwin, iwin, id, 1);
 
        // prefer older track if almost as good (or candidate not solid)
-       if (best2 >= 0.0) 
-         if (((id[iwin] == 0) || (id[alt] < id[iwin])) && (best2 <= (r2 * best)))
+       if (alt >= 0) 
+         if (((id[iwin] == 0) || (id[alt] < id[iwin])) && (best2 <= (r2 * asg.PairCost())))
            iwin = alt;
      }
 
      // record pairing and update tracking info
+     asg.Bind(iwin, jwin);
      PairUp(iwin, detect, jwin);
   }
 }
 
 
+//= Pair tracks and detections so the total squared distance is minimized.
+// can optionally restrict matching to establishied (numbered) tracks
+// a track only goes unmatched if this lets more other tracks be matched
+
+void jhcSmTrack::optimal_pair (const double * const *detect, int solid)
+{
+  int i, j;
+
+  asg.Solve(1, id, ((solid > 0) ? 1 : 0));
+  for (i = 0; i < valid; i++)
+    if ((fwd[i] < 0) && ((j = asg.ColFor(i)) >= 0))
+      PairUp(i, detect, j);
+}
+
+
 //= Force pairing of some detection to a particular track.
 // remove items from further consideration
 
@@ -32,6 +32,8 @@
 #include "Data/jhcArr.h"
 #include "Data/jhcParam.h"
 
+#include "Geometry/jhcAssign.h"
+
 
 //= Tracks objects in 3D with simple smoothing.
 
@@ -39,7 +41,8 @@ class jhcSmTrack
 {
 // PRIVATE MEMBER VARIABLES
 private:
-  double **pos, **var, **dist;
+  jhcAssign asg;
+  double **pos, **var;
   int *ena, *id, *cnt, *fwd, *back;
   int total, valid, last_id, stats;
   char name[40];
@@ -59,6 +62,7 @@ public:
   jhcParam tps;
   double close[3];
   double frac, dsf, daf, rival;
+  int optim;
 
   // filtering parameters
   jhcParam fps;
@@ -121,9 +125,11 @@ private:
 
   // main functions
   void score_all (const double * const *detect, int n, const double * const *shp);
+  double gate_size (int n, const double * const *shp) const;
   double get_d2 (int i, const double *item) const;
   double get_d2s (int i, const double *item, const double *shp) const;
   void greedy_pair (const double * const *detect, int n, int solid);
+  void optimal_pair (const double * const *detect, int solid);
   int add_track (const double *item);
   int shift_pos (int i, const double *item);
   int mark_hit (int i);
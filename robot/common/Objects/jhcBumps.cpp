@@ -204,6 +204,27 @@ int jhcBumps::target_params (const char *fname)
 }
 
 
+//= Parameters used for deciding how much of map to re-analyze each cycle.
+
+int jhcBumps::incr_params (const char *fname)
+{
+  char tag[40];
+  jhcParam *ps = &ips;
+  int ok;
+
+  sprintf_s(tag, "%s_inc", name);
+  ps->SetTag(tag, 0);
+  ps->NextSpec4( &inc,    0,    "Incremental update");
+  ps->NextSpecF( &dchg,   0.5,  "Cell change threshold (in)");
+  ps->NextSpecF( &dfrac,  0.3,  "Max changed fraction");
+  ps->NextSpec4( &fcyc,  30,    "Full update interval");
+  ps->NextSpecF( &sdev,   0.05, "Surface refit fraction");
+  ok = ps->LoadDefs(fname);
+  ps->RevertAll();
+  return ok;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                           Parameter Bundles                           //
 ///////////////////////////////////////////////////////////////////////////
@@ -219,6 +240,7 @@ int jhcBumps::Defaults (const char *fname)
   ok &= shape_params(fname);
   ok &= pos.Defaults(fname);
   ok &= target_params(fname);
+  ok &= incr_params(fname);
   return ok;
 }
 
@@ -234,6 +256,7 @@ int jhcBumps::SaveVals (const char *fname, int geom) const
   ok &= sps.SaveVals(fname);
   ok &= pos.SaveVals(fname);
   ok &= tps.SaveVals(fname);
+  ok &= ips.SaveVals(fname);
   return ok;
 }
 
@@ -257,6 +280,9 @@ void jhcBumps::Reset (int notop)
   hand.SetSize(map);
   cc.SetSize(map, 2);
   hcc.SetSize(cc);
+  ref.SetSize(map);
+  sref.SetSize(map);
+  chg.SetSize(map);
  
   // see if valid surface image is loaded
   surf = 0;
@@ -272,6 +298,13 @@ void jhcBumps::Reset (int notop)
   nr = 0;
   nr2 = 0;
 
+  // force full analysis and surface fit next time
+  chg.FillArr(0);
+  fresh = 0;
+  sfit = 0;
+  cyc = 0;
+  nchg = -1;
+
   // clear tracking
   pos.Reset();
 }
@@ -285,15 +318,24 @@ void jhcBumps::Surface (int trk)
 {
   double mix = 0.1, stol = 0.75, side = 18.0;   // stol was 0.5
   jhcImg *src = &det;
-  int big = ROUND(I2P(side) * I2P(side));
+  int n, big = ROUND(I2P(side) * I2P(side));
 
   // make sure surface image is correct size
   if (!top.SameFormat(map))
   {
     top.SetSize(map);
     top.FillArr(0);
+    sfit = 0;
   }
 
+  // keep previous fit if only a little of the table area has changed
+  if ((inc > 0) && (sfit > 0) && ((n = CountOver(top, 128)) > 0))
+    if (changes(sref, &top, NULL) <= (sdev * n))
+      return;
+  sref.CopyArr(map);
+  sfit = 1;
+  fresh = 0;                         // poisoning of blobs may differ
+
   // determine likely table area
   Interpolate(sm, pmin);
   Between(det, map2, DI2Z(-stol), DI2Z(stol));
@@ -337,12 +379,18 @@ int jhcBumps::AnyTouch () const
 
 //= Find and track all objects on the table.
 // assumes all sensors have already been ingested
+// in incremental mode only re-segments map where heights have changed
 // returns number of raw object detections (may not be tracked yet)
 
 int jhcBumps::Analyze (int trk)
 {
-  // detect clearly separated objects
-  raw_objs(trk);
+  int mode = update_mode();
+
+  // detect clearly separated objects (blobs are kept if nothing changed)
+  if (mode >= 2)
+    raw_objs(trk);
+  else if (mode == 1)
+    part_objs(trk);
   obj_boxes();
 
   // match detections to tracks then salvage grabbed objects
@@ -362,6 +410,132 @@ int jhcBumps::Analyze (int trk)
 }
 
 
+//= Decide how much of the map needs to be segmented again.
+// forces full analysis periodically and when too many blob labels are in use
+// remembers analyzed heights in "ref" and sets "droi" for partial case
+// returns 2 for full analysis, 1 for just changed area, 0 if nothing changed
+
+int jhcBumps::update_mode ()
+{
+  int area = map.XDim() * map.YDim();
+
+  // see if partial analysis is even possible
+  if ((inc > 0) && (fresh > 0) && (++cyc < fcyc) && (blob.Active() <= (blob.Size() / 2)))
+  {
+    // find where map has changed since last analyzed
+    if ((nchg = changes(ref, NULL, &chg)) <= 0)
+      return 0;
+    if (nchg <= (dfrac * area))
+    {
+      // include any objects touched and context for smoothing
+      grow_dirty();
+      if (droi.RoiArea() <= (dfrac * area))
+      {
+        ref.CopyArr(map, droi);
+        return 1;
+      }
+    }
+  }
+
+  // whole map needs to be analyzed
+  ref.CopyArr(map);
+  chg.FillArr(255);
+  fresh = 1;
+  cyc = 0;
+  nchg = -1;
+  return 2;
+}
+
+
+//= Expand dirty area to cover all overlapping blobs plus a smoothing border.
+// border ensures filters near edges only see unchanged background
+
+void jhcBumps::grow_dirty ()
+{
+  jhcRoi pad, box;
+  int i, any, n = blob.Active(), bd = sm + 2 * sc;
+
+  do
+  {
+    // get region of influence of current area
+    pad.CopyRoi(droi);
+    pad.GrowRoi(bd, bd);
+    pad.RoiClip(map);
+
+    // absorb all old blobs (including arms) that might be affected
+    any = 0;
+    for (i = 1; i < n; i++)
+      if (blob.GetStatus(i) >= 0)        // not already replaced
+      {
+        blob.GetRoi(box, i);
+        if ((pad.RoiOverlap(box) > 0) && (droi.RoiContains(box) <= 0))
+        {
+          droi.AbsorbRoi(box);
+          any = 1;
+        }
+      }
+  }
+  while (any > 0);
+  droi.CopyRoi(pad);
+}
+
+
+//= Count map cells which differ from reference by more than change threshold.
+// only considers cells where gate is over 128 (if gate is given)
+// can optionally record a binary change mask, always sets "droi" to changes
+// returns number of cells changed
+
+int jhcBumps::changes (const jhcImg& last, const jhcImg *gate, jhcImg *mask)
+{
+  int x, y, d, cnt = 0, w = map.XDim(), h = map.YDim(), ln = map.Line();
+  int x0 = w, x1 = -1, y0 = h, y1 = -1, th = __max(1, ROUND(253.0 * dchg / (zhi - zlo)));
+  const UC8 *m = map.PxlSrc(), *r = last.PxlSrc(), *g = NULL;
+  UC8 *c = NULL;
+
+  if (!last.SameFormat(map) || ((gate != NULL) && !gate->SameFormat(map)) || 
+      ((mask != NULL) && !mask->SameFormat(map)))
+    return Fatal("Bad images to jhcBumps::changes");
+  if (gate != NULL)
+    g = gate->PxlSrc();
+  if (mask != NULL)
+    c = mask->PxlDest();
+
+  // compare each cell
+  for (y = 0; y < h; y++, m += ln, r += ln)
+  {
+    for (x = 0; x < w; x++)
+    {
+      d = (int) m[x] - (int) r[x];
+      if (((d > th) || (d < -th)) && ((g == NULL) || (g[x] > 128)))
+      {
+        // record change and extend bounding box
+        if (c != NULL)
+          c[x] = 255;
+        x0 = __min(x0, x);
+        x1 = __max(x1, x);
+        y0 = __min(y0, y);
+        y1 = __max(y1, y);
+        cnt++;
+      }
+      else if (c != NULL)
+        c[x] = 0;
+    }
+    if (g != NULL)
+      g += ln;
+    if (c != NULL)
+      c += ln;
+  }
+
+  // save extent of changes
+  droi.RoiClip(map);
+  if (cnt > 0)
+    droi.SetRoiLims(x0, y0, x1, y1);
+  else
+    droi.ClearRoi();
+  return cnt;
+}
+
+
 //= Find candidate objects on table for later tracking.
 // information is in "cc" image and "blob" analyzer
 // returns number found
@@ -392,6 +566,61 @@ void jhcBumps::raw_objs (int trk)
 }
 
 
+//= Find candidate objects but only in the changed area "droi" of the map.
+// old blobs overlapping area are forgotten and area is segmented again
+// new blobs get fresh labels so "cc" and "blob" stay valid for whole map
+// images keep old values outside area (full ROIs restored at end)
+
+void jhcBumps::part_objs (int trk)
+{
+  jhcRoi box;
+  jhcImg *src = &det;
+  int i, n = blob.Active(), label0 = __max(0, n - 1);
+
+  // invalidate old blobs being replaced (no longer have any pixels)
+  for (i = 1; i < n; i++)
+  {
+    blob.GetRoi(box, i);
+    if (droi.RoiContains(box) > 0)
+      blob.SetStatus(i, -1);
+  }
+
+  // restrict processing (ROIs propagate from sources to destinations)
+  map.CopyRoi(droi);
+  prev.CopyRoi(droi);
+
+  // find objects above table in changed part of map
+  Interpolate(sm, pmin);
+  RampOver(det, map2, DI2Z(hobj - htol), DI2Z(hobj + htol));
+
+  // smooth evidence in time then in space
+  if (trk > 0)
+  {
+    AvgFcn(obj, prev, det);
+    prev.CopyArr(det);
+    src = &obj;
+  }
+  BoxThresh(obj, *src, sc, sth);
+
+  // thin out then label new components after all old ones
+  BoxAvg(obj, obj, sc);
+  if (CComps4(cc, obj, amin, 180, label0) > label0)
+  {
+    blob.FindParams(cc, 1);
+    if (surf > 0)
+      blob.PoisonOver(cc, top, -128);
+  }
+
+  // go back to processing whole images
+  map.MaxRoi();
+  map2.MaxRoi();
+  det.MaxRoi();
+  prev.MaxRoi();
+  obj.MaxRoi();
+  cc.MaxRoi();
+}
+
+
 //= Get real coordinates of bounding boxes for all detections.
 // detections stored in "raw" (xyz[11]) array (x, y, z, w, l, h, maj, min, ang, ex, ey)
 
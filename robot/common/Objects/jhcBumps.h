@@ -80,6 +80,11 @@ private:
   jhcRoi troi;
   int surf, nr, nr2;
 
+  // incremental analysis
+  jhcImg ref, sref;
+  jhcRoi droi;
+  int fresh, sfit, cyc, nchg;
+
   // object tracking
   jhcSmTrack pos;
   double **raw;
@@ -116,6 +121,14 @@ public:
   int tcnt, hold;
   double tlen1, tlen0, twid1, twid0, tht1, tht0;
 
+  // incremental update parameters
+  jhcParam ips;
+  int inc, fcyc;
+  double dchg, dfrac, sdev;
+
+  // change mask (255 = differs from last analyzed map)
+  jhcImg chg;
+
   // tracking flag for background thread
   int trk_bg;
 
@@ -138,6 +151,7 @@ public:
   int Analyze (int trk =1);
   int CntTracked () const {return pos.Count();}
   int CntValid (int trk =1) const {return((trk > 0) ? CntTracked() : nr2);}
+  int Changed () const {return nchg;}
   int AnyTouch () const;
 
   // read-only object properties 
@@ -190,9 +204,14 @@ private:
   int detect_params (const char *fname);
   int shape_params (const char *fname);
   int target_params (const char *fname);
+  int incr_params (const char *fname);
 
   // main functions
+  int update_mode ();
+  void grow_dirty ();
+  int changes (const jhcImg& last, const jhcImg *gate, jhcImg *mask);
   void raw_objs (int trk);
+  void part_objs (int trk);
   void obj_boxes ();
   double find_max (const jhcImg& val, const jhcImg& comp, int i, const jhcRoi& area);
   void adj_shapes ();
@@ -162,11 +162,15 @@ int jhcHeadGaze::SaveCfg (const char *fname) const
 
 void jhcHeadGaze::Reset ()
 {
-  int i;
+  int i, c;
 
   // no one is looking at attention spot yet
   for (i = 0; i < pmax; i++)
+  {
     gcnt[i] = 0;
+    for (c = 0; c < cmax; c++)
+      fid[i][c] = 0;
+  }
 
   // reset face finder
   jhcFrontal::Reset();
@@ -174,51 +178,114 @@ void jhcHeadGaze::Reset ()
 
 
 //= Look for tracked people in a roll-corrected color input image.
+// only a few heads get a full face search each cycle (see jhcFrontal::FullPri)
+// others just follow their face from last time in a small predicted window
 // assumes all depth images have already been loaded with "Ingest"
 // assumes composite floor map has been processed with "Analyze"
 // needs corrected depthmap in order to extract face distance
 
 void jhcHeadGaze::ScanRGB (const jhcImg& src, const jhcImg& d16, int cam, int trk)
 {
-  jhcRoi probe;
-  jhcMatrix mid(4), rel(4), fc(4), dir(4);
+  jhcRoi probe[pmax];
+  jhcMatrix mid[pmax];
+  jhcMatrix fc(4), dir(4);
+  double rot[pmax];
+  int pri[pmax];
   jhcBodyData *guy;
-  double rot, fx, fy, sc = ((src.YDim() > 640) ? 2.0 : 1.0);
-  int p, n;
+  double fx, fy, sc = ((src.YDim() > 640) ? 2.0 : 1.0);
+  int p, n, f;
 
+  // Fatal does not exit so bail before fid[p][cam] gets touched
   if (s3 == NULL)
+  {
     Fatal("Unbound person detector in jhcHeadGaze::ScanRGB");
+    return;
+  }
   if ((cam < 0) || (cam >= cmax) || !src.Valid(1, 3))
+  {
     Fatal("Bad input to jhcHeadGaze::ScanRGB");
+    return;
+  }
     
   // consider all potential people as viewed from this camera
   s3->AdjGeometry(cam);
-  n = s3->PersonLim(trk);
+  n = __min(s3->PersonLim(trk), pmax);
   for (p = 0; p < n; p++)
-    if (s3->PersonOK(p, trk))
+  {
+    // make sure head track has not changed
+    pri[p] = -1;
+    if (!s3->PersonOK(p, trk))
+      continue;
+    guy = s3->RefPerson(p, trk);
+    if (guy->id != fid[p][cam])
     {
-      // set search area around rotational midpoint of head
-      guy = s3->RefPerson(p, trk);
-      head_mid(mid, *guy, cam);
-      if (search_area(probe, rot, mid, src) <= 0)
+      DropTrack(p, cam);
+      fid[p][cam] = guy->id;
+    }
+
+    // set search area around rotational midpoint of head
+    mid[p].SetSize(4);
+    head_mid(mid[p], *guy, cam);
+    if (search_area(probe[p], rot[p], mid[p], src) > 0)
+      pri[p] = FullPri(p, cam);
+  }
+
+  // look for faces in search areas (only some get full search)
+  pick_full(pri, n);
+  for (p = 0; p < n; p++)
+    if (pri[p] >= 0)
+    {
+      if (pri[p] == 0)
+        f = FaceTrack(p, src, probe[p], rot[p], cam);
+      else
+        f = FaceChk(p, src, probe[p], rot[p], cam);
+      if (f < 0)
         continue;
 
-      // look for face in search area
-      if (FaceChk(p, src, probe, rot, cam) >= 0)
+      // get realworld face center location
+      FaceMid(fx, fy, p, cam, sc);                   // was 0.5 * sc ?
+      if (face_pt(fc, fx, fy, d16, sc) > 0)
       {
-        // get realworld face center location
-        FaceMid(fx, fy, p, cam, sc);                 // was 0.5 * sc ?
-        if (face_pt(fc, fx, fy, d16, sc) > 0)
-        {
-          // accumulate vector sum of estimates
-          dir.DirVec3(fc, mid);
-          guy->GazeEst(dir);
-        }
+        // accumulate vector sum of estimates
+        guy = s3->RefPerson(p, trk);
+        dir.DirVec3(fc, mid[p]);
+        guy->GazeEst(dir);
       }
     }
 }
 
 
+//= Allot this cycle's budget of full face searches to the most urgent heads.
+// takes priorities from FullPri (negative = no search area)
+// winners keep a positive priority while others are set to zero for tracking
+
+void jhcHeadGaze::pick_full (int *pri, int n) const
+{
+  int ok[pmax];
+  int i, p, win;
+
+  // choose heads with biggest priorities 
+  for (p = 0; p < n; p++)
+    ok[p] = 0;
+  for (i = 0; (tnum <= 0) || (i < tnum); i++)
+  {
+    win = -1;
+    for (p = 0; p < n; p++)
+      if ((ok[p] <= 0) && (pri[p] > 0))
+        if ((win < 0) || (pri[p] > pri[win]))
+          win = p;
+    if (win < 0)
+      break;
+    ok[win] = 1;
+  }
+
+  // all others will only be tracked
+  for (p = 0; p < n; p++)
+    if ((pri[p] > 0) && (ok[p] <= 0))
+      pri[p] = 0;
+}
+
+
 //= Adjust nominal head position for more accurate results.
 // "hadj" shifts expected eye position relative to head center
 // "dadj" moves center back from front shell (mostly for single camera) 
@@ -40,7 +40,7 @@
 // class tree and parameters:
 //
 //   HeadGaze          zps vps
-//     Frontal         dps
+//     Frontal         dps kps
 //       +FFindOCV     fps
 //         FFind
 //     >Stare3D        ips
@@ -57,6 +57,7 @@ class jhcHeadGaze : public jhcFrontal
 // PRIVATE MEMBER VARIABLES
 private:
   int gcnt[pmax];
+  int fid[pmax][cmax];
 
 
 // PROTECTED MEMBER VARIABLES
@@ -126,6 +127,7 @@ private:
   // main functions
   void head_mid (jhcMatrix& mid, const jhcMatrix& head, int cam) const;
   int search_area (jhcRoi& probe, double& rot, const jhcMatrix& mid, const jhcImg& src) const;
+  void pick_full (int *pri, int n) const;
   int face_pt (jhcMatrix& fc, double fx, double fy, const jhcImg& d16, double sc) const;
   void attn_hits (int trk);
 
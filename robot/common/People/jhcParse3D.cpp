@@ -22,6 +22,7 @@
 
 #include <math.h>
 
+#include "Interface/jhcBandPool.h"
 #include "Interface/jhcMessage.h"
 
 #include "jhcParse3D.h"
@@ -40,23 +41,25 @@ jhcParse3D::jhcParse3D ()
   // make body data entries
   raw = (jhcBodyData *) new jhcBodyData[rmax];
 
-  // global and local connected components
-  box.SetSize(2 * rmax);
-  blob.SetSize(50);
-  blob2.SetSize(50);
+  // global and coarse connected components
+  box.SetSize(cmax);
+  sbox.SetSize(cmax);
   nr = 0;
+  nz = 0;
+
+  // per-candidate head positions
+  for (i = 0; i < cmax; i++)
+    cpos[i].SetSize(4);
 
   // coordinate transform matrices
   m2w.SetSize(4, 4);
   w2m.SetSize(4, 4);
 
   // radial histograms for arm finding
-  star0.SetSize(360);
   for (i = 0; i < rmax; i++)
     star[i].SetSize(360);
 
-  // head peak histogram, no head step recording
-  hist.SetSize(256);
+  // no head step recording
   dbg = 0;
 
   // initial parameter values
@@ -66,6 +69,8 @@ jhcParse3D::jhcParse3D ()
   SetArm(30.0, 1.5, 180, 10.0, 0, 20.0, 50.0);
   SetHand(11, 0.1, 2.0, 0.9, 12.0, 16.0, 40.0, 0.0);
   SetAim(0.0, 1.0, 15.0, 4.0, 22.0);
+  crs = 0;
+  np = 4;
 
   // processing parameters
   Defaults();
@@ -86,6 +91,8 @@ jhcParse3D::~jhcParse3D ()
 
 void jhcParse3D::MapSize (int x, int y)
 {
+  int i;
+
   // remember dimensions
   mw = x;
   mh = y;
@@ -93,14 +100,19 @@ void jhcParse3D::MapSize (int x, int y)
   // build versions of overhead map
   floor.SetSize(x, y, 1);
   chest.SetSize(floor);
-  mid.SetSize(floor);
   arm.SetSize(floor);
 
   // build connected component images
   cc.SetSize(x, y, 2);
-  cc0.SetSize(cc);
   cc2.SetSize(cc);
 
+  // scratch images for each candidate checking lane
+  for (i = 0; i < lmax; i++)
+  {
+    lane[i].mid.SetSize(floor);
+    lane[i].cc0.SetSize(cc);
+  }
+
   // intermediate head steps
   step.SetSize(cc, 1);
 }
@@ -268,6 +280,22 @@ int jhcParse3D::finger_params (const char *fname)
 }
 
 
+//= Parameters for coarse-to-fine search and parallel candidate checking.
+
+int jhcParse3D::fast_params (const char *fname)
+{
+  jhcParam *ps = &fps;
+  int ok;
+
+  ps->SetTag("p3d_fast", 0);
+  ps->NextSpec4( &crs, "Coarse detection factor");     // 0 = full map
+  ps->NextSpec4( &np,  "Parallel person lanes");       // 1 = serial
+  ok = ps->LoadDefs(fname);
+  ps->RevertAll();
+  return ok;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                           Parameter Bundles                           //
 ///////////////////////////////////////////////////////////////////////////
@@ -284,6 +312,7 @@ int jhcParse3D::Defaults (const char *fname)
   ok &= arm_params(fname);
   ok &= hand_params(fname);
   ok &= finger_params(fname);
+  ok &= fast_params(fname);
   return ok;
 }
 
@@ -300,6 +329,7 @@ int jhcParse3D::SaveVals (const char *fname) const
   ok &= aps.SaveVals(fname);
   ok &= gps.SaveVals(fname);
   ok &= eps.SaveVals(fname);
+  ok &= fps.SaveVals(fname);
   return ok;
 }
 
@@ -313,6 +343,7 @@ int jhcParse3D::SaveVals (const char *fname) const
 // also needs height for pel = 1 (z0) and height for pel = 254 (z1)
 // generates world coordinates such that middle of bottom = (xmid, ybot)
 // takes about 3.6ms on (624 576) x 0.5", 1.8ms on (446 411) x 0.7"
+// if crs > 1 then only examines full map near blobs found on a reduced map
 // returns number of people detected
 
 int jhcParse3D::FindPeople (const jhcImg& map)
@@ -331,8 +362,13 @@ int jhcParse3D::FindPeople (const jhcImg& map)
   // get inverse transform for graphics
   w2m.Invert(m2w);
 
-  // remove very tall objects (walls) then parse overhead human forms
+  // remove very tall objects (walls) then possibly find person areas 
   ZeroOver(floor, map, ht2pel(wall));
+  nz = 0;
+  if (crs > 1)
+    coarse_zones(floor);
+
+  // parse overhead human forms
   nr = find_heads(floor);
   find_arms(floor, nr);
   return nr;
@@ -384,25 +420,171 @@ int jhcParse3D::BlobAt (double wx, double wy) const
 }
 
 
+///////////////////////////////////////////////////////////////////////////
+//                          Person Neighborhoods                         //
+///////////////////////////////////////////////////////////////////////////
+
+//= Determine how many parallel lanes to use for examining n candidates.
+// debugging graphics write to a shared image so these force serial operation
+
+int jhcParse3D::lanes (int n) const
+{
+  if ((dbg > 0) || (np <= 1))
+    return __min(n, 1);
+  return __min(n, __min(np, __min(lmax, jhcBandPool::Shared()->Lanes())));
+}
+
+
+//= Find neighborhoods of potential people using a reduced resolution map.
+// chest blobs found on block maximum of map (so never thinner than original)
+// size and height tests are loose so no real person should be rejected
+// each zone covers blob plus arm reach and smoothing borders at full resolution
+// overlapping zones are merged so final zones in member "zone" are disjoint
+// returns number of zones found (and sets "nz")
+
+int jhcParse3D::coarse_zones (const jhcImg& ohd)
+{
+  jhcRoi b;
+  int pk[cmax];
+  double ipp2 = crs * crs * ipp * ipp;
+  int iw = mw / crs, ih = mh / crs, zval = __max(0, ht2pel(ch)), hth = ht2pel(h0);
+  int ism = ROUND(sm / (crs * ipp)) | 0x01, a0 = ROUND(0.5 * amin / ipp2), a1 = ROUND(2.0 * amax / ipp2);
+  int bd = ROUND((__max(ext1, agrab) + __max(sm, sm2)) / ipp) + crs;
+  int i, j, x, y, n, lab, ssk, csk, any;
+  const UC8 *s;
+  const US16 *c;
+
+  // make reduced version of map
+  if (!sub.SameFormat(iw, ih, 1))
+  {
+    sub.SetSize(iw, ih, 1);
+    sub2.SetSize(sub);
+    scc.SetSize(sub, 2);
+  }
+  block_max(sub, ohd, crs);
+
+  // find big enough blobs at chest height (but not way too big)
+  Threshold(sub2, sub, zval);
+  BoxAvg(sub2, sub2, ism);
+  n = __min(CComps4(scc, sub2, a0, sth), cmax - 1);
+  sbox.FindBBox(scc);
+  sbox.PixelThresh(-a1);
+
+  // get peak height in each blob
+  for (i = 0; i <= n; i++)
+    pk[i] = 0;
+  s = sub.PxlSrc();
+  c = (const US16 *) scc.PxlSrc();
+  ssk = sub.Line() - iw;
+  csk = (scc.Line() >> 1) - iw;
+  for (y = ih; y > 0; y--, s += ssk, c += csk)
+    for (x = iw; x > 0; x--, s++, c++)
+      if (((lab = *c) > 0) && (lab <= n) && (*s > pk[lab]))
+        pk[lab] = *s;
+
+  // make full resolution zones for blobs that could have a head
+  nz = 0;
+  for (i = 1; i <= n; i++)
+    if ((sbox.GetStatus(i) > 0) && (pk[i] >= hth))
+    {
+      sbox.GetRoi(b, i);
+      zone[nz].RoiClip(ohd);
+      zone[nz].SetRoi(crs * b.RoiX(), crs * b.RoiY(), crs * b.RoiW(), crs * b.RoiH());
+      zone[nz].GrowRoi(bd, bd);
+      if (++nz >= rmax)
+        break;
+    }
+
+  // combine any zones that overlap
+  do
+  {
+    any = 0;
+    for (i = 0; i < nz; i++)
+      for (j = nz - 1; j > i; j--)
+        if (zone[i].RoiOverlap(zone[j]) > 0)
+        {
+          zone[i].AbsorbRoi(zone[j]);
+          zone[j].CopyRoi(zone[--nz]);
+          any = 1;
+        }
+  }
+  while (any > 0);
+  return nz;
+}
+
+
+//= Make reduced image where each pixel is the maximum of an f x f block.
+// destination should be (w / f) x (h / f), partial blocks at edges ignored
+
+void jhcParse3D::block_max (jhcImg& dest, const jhcImg& src, int f) const
+{
+  int x, y, i, j, v, w = dest.XDim(), h = dest.YDim(), dsk = dest.Line() - w, sln = src.Line();
+  const UC8 *s0 = src.PxlSrc(), *s;
+  UC8 *d = dest.PxlDest();
+
+  for (y = 0; y < h; y++, d += dsk, s0 += f * sln)
+    for (x = 0; x < w; x++, d++)
+    {
+      v = 0;
+      s = s0 + x * f;
+      for (j = 0; j < f; j++, s += sln)
+        for (i = 0; i < f; i++)
+          v = __max(v, s[i]);
+      *d = (UC8) v;
+    }
+}
+
+
+//= Slice map at some height then smooth and find connected components.
+// if coarse zones were found then only processes map inside these areas
+// labels of successive zones follow each other, "comp" is zero elsewhere
+// returns highest label used
+
+int jhcParse3D::slice_comps (jhcImg& comp, jhcImg& bin, const jhcImg& ohd, int zval, int ism, int amin, int th)
+{
+  int i, n = 0;
+
+  // possibly do whole map
+  if (crs <= 1)
+  {
+    Threshold(bin, ohd, zval);
+    BoxAvg(bin, bin, ism);
+    return CComps4(comp, bin, amin, th);
+  }
+
+  // process each zone in turn
+  comp.FillArr(0);
+  for (i = 0; i < nz; i++)
+  {
+    Threshold(bin, ohd, zone[i], zval);
+    bin.CopyRoi(zone[i]);
+    BoxAvg(bin, bin, ism);
+    n = __max(n, CComps4(comp, bin, amin, th, n));
+  }
+
+  // restore normal processing areas
+  bin.MaxRoi();
+  comp.MaxRoi();
+  return n;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                              Head Finding                             //
 ///////////////////////////////////////////////////////////////////////////
 
 //= Finds head given overhead map with walls suppressed.
 // global "cc" holds person blobs and "box" holds some analysis of them
+// candidates are checked in parallel then gathered in original order
 // returns number of people detected, "raw" holds details
 
 int jhcParse3D::find_heads (const jhcImg& ohd)
 {
-  jhcRoi area;
-  double h;
   int zval = ht2pel(ch), ism = ROUND(sm / ipp) | 0x01;
-  int i, j, k, nc, bv = 40, n = 0;
+  int i, nc, bv = 40, n = 0;
 
   // cut overhead map at chest height to separate people
-  Threshold(chest, ohd, __max(0, zval));
-  BoxAvg(chest, chest, ism);
-  CComps4(cc, chest, ROUND(amin / (ipp * ipp)), sth);
+  slice_comps(cc, chest, ohd, __max(0, zval), ism, ROUND(amin / (ipp * ipp)), sth);
 
   // throw out anything way too big to be a person
   // potential head blobs have status 1, all others are 0
@@ -413,45 +595,89 @@ int jhcParse3D::find_heads (const jhcImg& ohd)
 
   // find best head for each potential person component
   nc = box.Active();
+  if (nc > 1)
+    jhcBandPool::Shared()->Run(head_lane, this, lanes(nc - 1));
+
+  // collect good candidates
   for (i = 1; i < nc; i++)
-    if (box.GetStatus(i) > 0)
+    if (cok[i] > 0)
     {
-      // get height of initial head candidate 
-      box.GetRoi(area, i);
-      h = find_max(ohd, cc, i, area);
-      box.SetAux(i, h);                                      // save for tracker
-      if ((h < h0) || (h > h1))
-        continue;
-
-      // test for proper head size and shape
-      area.GrowRoi(ism, ism);
-      area.RoiClip(ohd);                                     // added 6/17
-      if ((j = chk_head(n, h, ohd, cc, i, area)) < 0)
-        continue;
-
-      // make sure not touching beam edges then check for shoulders underneath
-      if (visible(raw[n], margin) <= 0)
-        continue;
-      if ((ring > 0.0) && (raw[n].PlaneVec3() > ring))       // Dataspace reflections
-        continue;
-      if ((k = chk_shoulder(n, blob.BlobLength(j), blob.BlobArea(j), ohd, cc, i, area)) < 0)
-        continue;
-
-      // determine star center: blob[j] = head ellipse, blob2[k] = shoulder ellipse
-      mid_back(stx[n], sty[n], j, k);
+      raw[n].Copy(cpos[i]);
+      raw[n].id = n + 1;
+      xlink[n] = cxl[i];
+      ylink[n] = cyl[i];
+      stx[n] = csx[i];
+      sty[n] = csy[i];
       if (++n >= rmax)       
-        break;                 // already recorded, but stop if end of list
+        break;                 
     }
   return n;
 }
 
 
+//= Check a subset of chest blobs using scratch space of one lane.
+// overhead map is always member "floor"
+
+void jhcParse3D::head_lane (void *ctx, int band, int nb)
+{
+  jhcParse3D *me = (jhcParse3D *) ctx;
+  int i, nc = me->box.Active();
+
+  for (i = band + 1; i < nc; i += nb)
+    me->chk_person(me->lane[band], me->floor, i);
+}
+
+
+//= See if chest blob i has a suitable head and shoulders.
+// saves results in candidate arrays (cpos, cxl, cyl, csx, csy, cok)
+// returns 1 if a person, 0 if fails some test
+
+int jhcParse3D::chk_person (jhcParseLane& ln, const jhcImg& ohd, int i)
+{
+  jhcRoi area;
+  double h;
+  int j, k, ism = ROUND(sm / ipp) | 0x01;
+
+  cok[i] = 0;
+  if (box.GetStatus(i) <= 0)
+    return 0;
+
+  // get height of initial head candidate 
+  box.GetRoi(area, i);
+  h = find_max(ln.hist, ohd, cc, i, area);
+  box.SetAux(i, h);                                      // save for tracker
+  if ((h < h0) || (h > h1))
+    return 0;
+
+  // test for proper head size and shape
+  area.GrowRoi(ism, ism);
+  area.RoiClip(ohd);                                     // added 6/17
+  if ((j = chk_head(ln, cpos[i], cxl[i], cyl[i], h, ohd, cc, i, area)) < 0)
+    return 0;
+
+  // make sure not touching beam edges then check for shoulders underneath
+  if (visible(cpos[i], margin) <= 0)
+    return 0;
+  if ((ring > 0.0) && (cpos[i].PlaneVec3() > ring))      // Dataspace reflections
+    return 0;
+  if ((k = chk_shoulder(ln, cpos[i], cxl[i], cyl[i], ln.blob.BlobLength(j), ln.blob.BlobArea(j), 
+                        ohd, cc, i, area)) < 0)
+    return 0;
+
+  // determine star center: blob[j] = head ellipse, blob2[k] = shoulder ellipse
+  mid_back(csx[i], csy[i], ln, j, k);
+  cok[i] = 1;
+  return 1;
+}
+
+
 //= Checks shape of potential head denoted by component of given label.
 // binds head's center in world coordinates and first non-zero pixel in map 
-// returns index of head in new blob array, -1 if fails some test
+// uses scratch images and blob analyzer "blob" of given lane
+// returns index of head in lane's blob array, -1 if fails some test
 
-int jhcParse3D::chk_head (int n, double h, const jhcImg& view, 
-                          const jhcImg& comp, int i, const jhcRoi& area) 
+int jhcParse3D::chk_head (jhcParseLane& ln, jhcMatrix& head, int& lx, int& ly, double h, 
+                          const jhcImg& view, const jhcImg& comp, int i, const jhcRoi& area)
 {
   jhcMatrix pos(4);
   jhcRoi area2;
@@ -459,67 +685,67 @@ int jhcParse3D::chk_head (int n, double h, const jhcImg& view,
   int j, hv = 128;
 
   // re-slice overhead map at presumed eye level to find heads
-  thresh_within(mid, view, ht2pel(h - chop), comp, i, area);
-  BoxAvg(mid, mid, ROUND(sm / ipp) | 0x01);
+  thresh_within(ln.mid, view, ht2pel(h - chop), comp, i, area);
+  ln.BoxAvg(ln.mid, ln.mid, ROUND(sm / ipp) | 0x01);
   if (dbg > 0)
   {
-    UnderGate(step, step, mid, sth, hv);  
+    UnderGate(step, step, ln.mid, sth, hv);  
     step.MaxRoi();
   }
-  if (CComps4(cc0, mid, ROUND(hmin / (ipp * ipp)), sth) <= 0)
+  if (ln.CComps4(ln.cc0, ln.mid, ROUND(hmin / (ipp * ipp)), sth) <= 0)
     return -1;
 
   // keep only blobs with reasonable shape and size to be heads
-  blob.FindParams(cc0);
-  blob.AspectThresh(-hecc);
-  blob.LengthThresh( w0 / ipp); 
-  blob.LengthThresh(-w1 / ipp); 
+  ln.blob.FindParams(ln.cc0);
+  ln.blob.AspectThresh(-hecc);
+  ln.blob.LengthThresh( w0 / ipp); 
+  ln.blob.LengthThresh(-w1 / ipp); 
 
   // find most likely head blob and get height again (if multiple)
-  if ((j = blob.Nearest(area.RoiAvgX(), area.RoiAvgY())) <= 0)
+  if ((j = ln.blob.Nearest(area.RoiAvgX(), area.RoiAvgY())) <= 0)
     return -1;
-  blob.GetRoi(area2, j);
-  if ((h2 = find_max(view, cc0, j, area2)) < h0)
+  ln.blob.GetRoi(area2, j);
+  if ((h2 = find_max(ln.hist, view, ln.cc0, j, area2)) < h0)
     return -1;
 
   // convert image coordinates to world coordinates and store
-  blob.BlobCentroid(&xc, &yc, j);
+  ln.blob.BlobCentroid(&xc, &yc, j);
   pos.SetVec3(xc, yc, h2 - edn);
-  raw[n].MatVec(m2w, pos);
-  raw[n].id = n + 1;
+  head.MatVec(m2w, pos);
 
   // find good pixel for linking blobs then return chosen blob number
-  first_nz(xlink[n], ylink[n], view, cc0, j, area2);
+  first_nz(lx, ly, view, ln.cc0, j, area2);
   return j;
 }
 
 
 //= Given a potential head make sure it is supported by something like shoulders.
-// returns shoulder blob number if seems reasonable, -1 if fails some test
+// head link point (lx ly) should be a pixel of the head in the original map
+// returns shoulder blob number in lane's "blob2" if reasonable, -1 if fails some test
 
-int jhcParse3D::chk_shoulder (int n, double w, double a, const jhcImg& view, 
-                              const jhcImg& comp, int i, const jhcRoi& area) 
+int jhcParse3D::chk_shoulder (jhcParseLane& ln, const jhcMatrix& head, int lx, int ly, double w, double a, 
+                              const jhcImg& view, const jhcImg& comp, int i, const jhcRoi& area)
 {
   int j, sv = 50, ccth = 45, bv = 40;
 
   // re-slice overhead map at presumed shoulder level
-  thresh_within(mid, view, ht2pel(raw[n].Z() - shdn), comp, i, area);
-  BoxThresh(mid, mid, ROUND(sm / ipp) | 0x01, sth, sv, bv);
+  thresh_within(ln.mid, view, ht2pel(head.Z() - shdn), comp, i, area);
+  ln.BoxThresh(ln.mid, ln.mid, ROUND(sm / ipp) | 0x01, sth, sv, bv);
   if (dbg > 0)
   {
-    SubstKey(step, mid, step, bv);
+    SubstKey(step, ln.mid, step, bv);
     step.MaxRoi();
   }
-  if (CComps4(cc0, mid, ROUND(smin / (ipp * ipp)), ccth) <= 0)
+  if (ln.CComps4(ln.cc0, ln.mid, ROUND(smin / (ipp * ipp)), ccth) <= 0)
     return -1;
 
   // test component attached to head for reasonable shape and width
-  blob2.FindParams(cc0);
-  j = cc0.ARef(xlink[n], ylink[n]);
-  if ((blob2.BlobAspect(j) > secc) || 
-      (blob2.BlobLength(j) < (sw0 / ipp)) ||
-      (blob2.BlobLength(j) < (wrel * w)) ||
-      (blob2.BlobArea(j)   > (arel * a)))
+  ln.blob2.FindParams(ln.cc0);
+  j = ln.cc0.ARef(lx, ly);
+  if ((ln.blob2.BlobAspect(j) > secc) || 
+      (ln.blob2.BlobLength(j) < (sw0 / ipp)) ||
+      (ln.blob2.BlobLength(j) < (wrel * w)) ||
+      (ln.blob2.BlobArea(j)   > (arel * a)))
     return -1; 
   return j;
 }
@@ -527,9 +753,10 @@ int jhcParse3D::chk_shoulder (int n, double w, double a, const jhcImg& view,
 
 //= Find maximum value inside some component given its bounding box.
 // used to find single max, now uses histogram for noise robustness
+// histogram array passed in so that several lanes can work at once
 // returns height above floor in inches (not pixel value)
 
-double jhcParse3D::find_max (const jhcImg& val, const jhcImg& comp, int i, const jhcRoi& area) 
+double jhcParse3D::find_max (jhcArr& hist, const jhcImg& val, const jhcImg& comp, int i, const jhcRoi& area) const
 {
   int vsk = val.RoiSkip(area), csk = comp.RoiSkip(area) >> 1;
   int x, y, rw = area.RoiW(), rh = area.RoiH();
@@ -604,20 +831,21 @@ double jhcParse3D::pel2ht (int pel) const
 
 
 //= Determine middle of back for finding arms as radial extensions.
-// blob[hd] should be head ellipse while blob2[sh] is shoulder ellipse
+// lane's blob[hd] should be head ellipse while blob2[sh] is shoulder ellipse
 // old version used blob.BlobCentroid(&hx, &hy, hd) as center
 
-void jhcParse3D::mid_back (int& cx, int& cy, int hd, int sh) const
+void jhcParse3D::mid_back (int& cx, int& cy, const jhcParseLane& ln, int hd, int sh) const
 {
+  const jhcBlob *blob = &(ln.blob), *blob2 = &(ln.blob2);
   double hx, hy, ha, sx, sy, sa, mx, my, dx, dy, len, wlen, f;
 
   // get center of head blob and shoulder-plus-head blob
-  blob.BlobCentroid(&hx, &hy, hd);
-  blob2.BlobCentroid(&sx, &sy, sh);
+  blob->BlobCentroid(&hx, &hy, hd);
+  blob2->BlobCentroid(&sx, &sy, sh);
 
   // adjust to get center of shoulder-only blob
-  ha = (double) blob.BlobArea(hd);
-  sa = (double) blob2.BlobArea(sh);
+  ha = (double) blob->BlobArea(hd);
+  sa = (double) blob2->BlobArea(sh);
   mx = (sa * sx - ha * hx) / (sa - ha);
   my = (sa * sy - ha * hy) / (sa - ha);
 
@@ -643,7 +871,7 @@ void jhcParse3D::mid_back (int& cx, int& cy, int hd, int sh) const
   else
   {
     // shift by width (of combined) in opposite direction from head
-    f = 0.5 * blob2.BlobWidth(sh) / len;
+    f = 0.5 * blob2->BlobWidth(sh) / len;
     cx = ROUND(mx + f * dx);
     cy = ROUND(my + f * dy);
   }
@@ -656,20 +884,18 @@ void jhcParse3D::mid_back (int& cx, int& cy, int hd, int sh) const
 
 //= Given valid head detections try to find ends of associated arms.
 // reads global "raw" array to get head candidates, writes to store hand detections
+// detached arms are claimed in order then each person is examined in parallel
 // largely copied from jhcScreenPos class in Muriel project
 
 void jhcParse3D::find_arms (const jhcImg& ohd, int nh) 
 {
-  jhcRoi body, tip;
   jhcMatrix pos(4);
   jhcBodyData *item;
   int zval = ht2pel(alev), ism2 = ROUND(sm2 / ipp) | 0x01;
-  int i, side, bnum, hx, hy, ix, iy, iz, pk, alt;
+  int i, alt;
 
   // chop person pillars lower than chest separation level
-  Threshold(arm, ohd, __max(0, zval));
-  BoxAvg(arm, arm, ism2);
-  CComps4(cc2, arm, ROUND(arm0 / (ipp * ipp)), sth2);  // arm0 not needed below
+  slice_comps(cc2, arm, ohd, __max(0, zval), ism2, ROUND(arm0 / (ipp * ipp)), sth2);  // arm0 not needed below
   box.FindBBox(cc2);
 
   for (i = 0; i < nh; i++)
@@ -677,73 +903,101 @@ void jhcParse3D::find_arms (const jhcImg& ohd, int nh)
     // get new blob number associated with head
     item = raw + i;
     pos.MatVec(w2m, *item);
-    bnum = cc2.ARef16(ROUND(pos.X()), ROUND(pos.Y()));
-    item->bnum = bnum;
-
-    // assume no arms 
-    item->hok[0] = 0;
-    item->hok[1] = 0;
+    item->bnum = cc2.ARef16(ROUND(pos.X()), ROUND(pos.Y()));
 
-    // find candidates based on radial plot
-    hx = stx[i];
-    hy = sty[i];
-    alt = arm_peaks(cc2, box, hx, hy, bnum, i);
+    // possibly add in detached arm (blob cannot be used twice)
+    alt = -1;
+    if (ret > 0)
+      if ((alt = grab_arm(stx[i], sty[i], cc2, box, item->bnum)) > 0)
+        box.SetStatus(alt, 2);                             
     item->alt = alt;
+  }
 
-    // get combined blob and alternate blob search area
-    box.GetRoi(body, bnum);
-    if (alt > 0)
-      body.AbsorbRoi(*(box.ReadRoi(alt)));
+  // find hands of each person
+  if (nh > 0)
+    jhcBandPool::Shared()->Run(arm_lane, this, lanes(nh));
+}
 
-    // look for left and right arms
-    for (side = 0; side <= 1; side++)
-    {
-      // see if candidate arm detected
-      pk = ((side > 0) ? rpk[i] : lpk[i]);
-      if (pk < 0)
-        continue;
-
-      // figure out fingertip location and height
-      finger_area(tip, hx, hy, star[i], pk);
-      tip.MergeRoi(body);
-      iz = finger_loc(ix, iy, hx, hy, ohd, cc2, bnum, alt, tip);
-
-      // check for reasonable arm length then find pointing direction
-      if (arm_coords(item, ix, iy, iz, hx, hy, side) <= 0.0)
-        continue;
-      if (est_ray(item, side, ohd, ix, iy, iz, cc2, bnum, alt, body) > 0)
-        item->hok[side] = 1;
-    }
 
-    // fix order of arms if needed
-    swap_arms(i);
+//= Find hands for a subset of people using scratch space of one lane.
+// overhead map is always member "floor"
+
+void jhcParse3D::arm_lane (void *ctx, int band, int nb)
+{
+  jhcParse3D *me = (jhcParse3D *) ctx;
+  int i;
+
+  for (i = band; i < me->nr; i += nb)
+    me->person_arms(me->lane[band], me->floor, i);
+}
+
+
+//= Look for left and right hands of person i given arm blobs.
+// "bnum" and "alt" of raw[i] must already be filled in
+
+void jhcParse3D::person_arms (jhcParseLane& ln, const jhcImg& ohd, int i)
+{
+  jhcRoi body, tip;
+  jhcBodyData *item = raw + i;
+  int side, ix, iy, iz, pk, hx = stx[i], hy = sty[i], bnum = item->bnum, alt = item->alt;
+
+  // assume no arms 
+  item->hok[0] = 0;
+  item->hok[1] = 0;
+
+  // find candidates based on radial plot
+  arm_peaks(ln.star0, cc2, box, hx, hy, bnum, alt, i);
+
+  // get combined blob and alternate blob search area
+  box.GetRoi(body, bnum);
+  if (alt > 0)
+    body.AbsorbRoi(*(box.ReadRoi(alt)));
+
+  // look for left and right arms
+  for (side = 0; side <= 1; side++)
+  {
+    // see if candidate arm detected
+    pk = ((side > 0) ? rpk[i] : lpk[i]);
+    if (pk < 0)
+      continue;
+
+    // figure out fingertip location and height
+    finger_area(tip, hx, hy, star[i], pk);
+    tip.MergeRoi(body);
+    iz = finger_loc(ix, iy, hx, hy, ohd, cc2, bnum, alt, tip);
+
+    // check for reasonable arm length then find pointing direction
+    if (arm_coords(item, ix, iy, iz, hx, hy, side) <= 0.0)
+      continue;
+    if (est_ray(item, side, ohd, ix, iy, iz, cc2, bnum, alt, body) > 0)
+      item->hok[side] = 1;
   }
+
+  // fix order of arms if needed
+  swap_arms(i);
 }
 
 
 //= Locate potential hand peaks in radial histogram.
 // decodes left and right hand indices into globals "lpk[i]" and "rpk[i]"
 // writes smoothed radial histogram to global "star[i]"
+// includes reattached arm blob "alt" (if positive), needs scratch array "plot0"
 // peaks are reversed and shifted by -90 degs for nice screen plots
-// returns blob number of any reattached arm used
 
-int jhcParse3D::arm_peaks (const jhcImg& comp, jhcBBox& b, int hx, int hy, int bnum, int i) 
+void jhcParse3D::arm_peaks (jhcArr& plot0, const jhcImg& comp, const jhcBBox& b, 
+                            int hx, int hy, int bnum, int alt, int i) 
 {
   jhcArr *plot = star + i;
-  int lo, hi, last = star0.Last(), alt = -1;
+  int lo, hi, last = plot0.Last();
 
   // build radial histogram of person blob 
-  star0.Fill(0);
-  radial_plot(star0, hx, hy, comp, b, bnum);
+  plot0.Fill(0);
+  radial_plot(plot0, hx, hy, comp, b, bnum);
 
   // possibly add in detached arm then smooth
-  if (ret > 0)
-    if ((alt = grab_arm(hx, hy, comp, b, bnum)) > 0)
-    {
-      b.SetStatus(alt, 2);                             // blob cannot be used twice
-      radial_plot(star0, hx, hy, comp, b, alt);
-    }
-  plot->Boxcar(star0, ssm);
+  if (alt > 0)
+    radial_plot(plot0, hx, hy, comp, b, alt);
+  plot->Boxcar(plot0, ssm);
 
   // find biggest overall peak (assume this is the right hand)
   // then look for secondary peak outside slopes of main peak
@@ -751,7 +1005,6 @@ int jhcParse3D::arm_peaks (const jhcImg& comp, jhcBBox& b, int hx, int hy, int b
   if ((rpk[i] = plot->TrueMax(0, last, 1)) >= 0)
     if (plot->CycBounds(lo, hi, rpk[i], afall) > 0)
       lpk[i] = plot->TrueMax(hi, lo);
-  return alt;
 }
 
 
@@ -950,7 +1203,7 @@ int jhcParse3D::swap_arms (int i)
 { 
   jhcMatrix tmp(4);
   jhcBodyData *item = raw + i;
-  int diff, val, sz = star0.Size(), hsz = sz >> 1;
+  int diff, val, sz = star[i].Size(), hsz = sz >> 1;
 
   // make sure two valid arms found
   if ((item->hok[0] <= 0) || (item->hok[1] <= 0))
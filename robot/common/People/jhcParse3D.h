@@ -41,6 +41,28 @@
 #include "People/jhcBodyData.h"   // common robot
 
 
+//= Scratch space for examining one candidate person at a time.
+// each parallel lane gets its own copy so candidates can be checked concurrently
+// also holds image processing objects since these keep internal buffers
+
+class jhcParseLane : public jhcArea, public jhcGroup
+{
+// PUBLIC MEMBER VARIABLES
+public:
+  jhcImg mid, cc0;
+  jhcBlob blob, blob2;
+  jhcArr hist, star0;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  jhcParseLane () 
+    {blob.SetSize(50); blob2.SetSize(50); hist.SetSize(256); star0.SetSize(360);}
+
+
+};
+
+
 //= Find head and hands of people using overhead map.
 // <pre>
 // Head finding steps:
@@ -56,6 +78,9 @@
 //   now finds major axis of pixels in the fingertips to wrist zone (ray_est)
 // All detection information stored in array of jhcBodyData called "raw"
 // jhcBodyData class has more functionality than needed but subsumes old jhcBodyParts
+// Coarse-to-fine mode first finds chest blobs on a reduced map then only
+//   slices full resolution map in neighborhoods around these candidates
+// Head checks and hand finding for separate candidates can run in parallel lanes
 // </pre>
 
 class jhcParse3D : protected jhcArea, protected jhcGroup, protected jhcLabel, protected jhcThresh,
@@ -63,7 +88,9 @@ class jhcParse3D : protected jhcArea, protected jhcGroup, protected jhcLabel, pr
 {
 // PROTECTED MEMBER VARIABLES
 protected:
-  static const int rmax = 50;          /** Maximum number of detections. */
+  static const int rmax = 50;          /** Maximum number of detections.  */
+  static const int cmax = 2 * rmax;    /** Maximum number of chest blobs. */
+  static const int lmax = 8;           /** Maximum parallel lanes.        */
 
   // map coordinate transform and size
   jhcMatrix w2m; 
@@ -74,18 +101,24 @@ protected:
 // PRIVATE MEMBER VARIABLES
 private:
   // head finding
-  jhcImg floor, chest, mid, arm, step;
-  jhcImg cc, cc2, cc0;
+  jhcImg floor, chest, arm, step;
+  jhcImg cc, cc2;
   jhcBBox box;
-  jhcBlob blob, blob2;
-  jhcArr hist;
   jhcMatrix m2w;
   int xlink[rmax], ylink[rmax];        /** Head centers in map. */
   double z0, z1, rot, x0, y0;
   int nr;
 
-  // arm finding
-  jhcArr star0;
+  // coarse person neighborhoods
+  jhcImg sub, sub2, scc;
+  jhcBBox sbox;
+  jhcRoi zone[rmax];
+  int nz;
+
+  // per-candidate head results (indexed by chest blob)
+  jhcParseLane lane[lmax];
+  jhcMatrix cpos[cmax];
+  int cok[cmax], cxl[cmax], cyl[cmax], csx[cmax], csy[cmax];
 
 
 // PROTECTED MEMBER VARIABLES
@@ -135,6 +168,10 @@ public:
   int ref, fit;
   double flen, fecc, flat, dip, plen;
 
+  // parameters for speeding up search
+  jhcParam fps;
+  int crs, np;
+
 
 // PUBLIC MEMBER FUNCTIONS
 public:
@@ -227,25 +264,37 @@ private:
   int arm_params (const char *fname);
   int hand_params (const char *fname);
   int finger_params (const char *fname);
+  int fast_params (const char *fname);
+
+  // person neighborhoods
+  int lanes (int n) const;
+  int coarse_zones (const jhcImg& ohd);
+  void block_max (jhcImg& dest, const jhcImg& src, int f) const;
+  int slice_comps (jhcImg& comp, jhcImg& bin, const jhcImg& ohd, int zval, int ism, int amin, int th);
 
   // head finding
   int find_heads (const jhcImg& ohd);
-  int chk_head (int n, double h, const jhcImg& view, 
-                const jhcImg& comp, int i, const jhcRoi& area);
-  int chk_shoulder (int n, double w, double a, const jhcImg& view, 
-                    const jhcImg& comp, int i, const jhcRoi& area);
-  double find_max (const jhcImg& val, const jhcImg& comp, int i, const jhcRoi& area);
+  static void head_lane (void *ctx, int band, int nb);
+  int chk_person (jhcParseLane& ln, const jhcImg& ohd, int i);
+  int chk_head (jhcParseLane& ln, jhcMatrix& head, int& lx, int& ly, double h, 
+                const jhcImg& view, const jhcImg& comp, int i, const jhcRoi& area);
+  int chk_shoulder (jhcParseLane& ln, const jhcMatrix& head, int lx, int ly, double w, double a, 
+                    const jhcImg& view, const jhcImg& comp, int i, const jhcRoi& area);
+  double find_max (jhcArr& hist, const jhcImg& val, const jhcImg& comp, int i, const jhcRoi& area) const;
   void thresh_within (jhcImg& dest, const jhcImg& src, int th, 
                       const jhcImg& comp, int i, const jhcRoi& area) const;
   void first_nz (int& x, int& y, const jhcImg& src, 
                  const jhcImg& comp, int i, const jhcRoi& area) const;
   int ht2pel (double ht) const;
   double pel2ht (int pel) const;
-  void mid_back (int& cx, int& cy, int hd, int sh) const;
+  void mid_back (int& cx, int& cy, const jhcParseLane& ln, int hd, int sh) const;
 
   // arm finding
   void find_arms (const jhcImg& ohd, int nh);
-  int arm_peaks (const jhcImg& comp, jhcBBox& b, int hx, int hy, int bnum, int i);
+  static void arm_lane (void *ctx, int band, int nb);
+  void person_arms (jhcParseLane& ln, const jhcImg& ohd, int i);
+  void arm_peaks (jhcArr& plot0, const jhcImg& comp, const jhcBBox& b, 
+                  int hx, int hy, int bnum, int alt, int i);
   void radial_plot (jhcArr& plot, int hx, int hy, const jhcImg& comp, const jhcBBox& b, int i) const;
   int grab_arm (int hx, int hy, const jhcImg& comp, const jhcBBox& b, int i) const;
   void finger_area (jhcRoi& tip, int hx, int hy, const jhcArr& plot, int pk) const;
@@ -36,6 +36,7 @@
 jhcTrack3D::jhcTrack3D ()
 {
   dude = (jhcBodyData *) new jhcBodyData[tmax];
+  mate.SetSize(tmax, rmax);
   Defaults();
   Reset();
 }
@@ -66,7 +67,7 @@ int jhcTrack3D::htrk_params (const char *fname)
   ps->NextSpec4( &hit0,   5,   "Hits to add person");          // was 20
   ps->NextSpec4( &miss0, 15,   "Misses to remove person");     // was 30
   ps->NextSpec4( &anchor, 1,   "No penalty if person blob");     
-  ps->Skip();
+  ps->NextSpec4( &optim,  0,   "Optimal assignment");
 
   ps->NextSpec4( &hit2,   5, "Hits to add gaze");  
   ps->NextSpec4( &miss2,  5, "Misses to remove gaze");  
@@ -167,15 +168,25 @@ int jhcTrack3D::TrackPeople (const jhcImg& map)
   dist_matrix(dude, nt, raw, m);
 
   // match sure tracked items first then tentative ones
-  while (best_match(i, j, 1) > 0)
+  if (optim > 0)
   {
-    last_id = dude[i].UpdateHead(raw[j], last_id);
-    match_hands(dude[i], raw[j]);
+    all_match(1);
+    all_match(0);
   }
-  while (best_match(i, j, 0) > 0)
+  else
   {
-    last_id = dude[i].UpdateHead(raw[j], last_id);
-    match_hands(dude[i], raw[j]);
+    mate.Sweep();
+    while (best_match(i, j, 1) > 0)
+    {
+      last_id = dude[i].UpdateHead(raw[j], last_id);
+      match_hands(dude[i], raw[j]);
+    }
+    mate.Sweep();
+    while (best_match(i, j, 0) > 0)
+    {
+      last_id = dude[i].UpdateHead(raw[j], last_id);
+      match_hands(dude[i], raw[j]);
+    }
   }
 
   // penalize unmatched tracks (unless solid on top of person blob)
@@ -203,13 +214,15 @@ int jhcTrack3D::TrackPeople (const jhcImg& map)
 }
 
 
-//= Find the distances of all new detections from all old tracks.
-// leaves results in internal array "mate", clear "fwd" and "back"
+//= Find the distances of all new detections from nearby old tracks.
+// only keeps pairs within dmax0 (detections binned by x and y to find them)
+// leaves results in internal structure "mate", clear "fwd" and "back"
 
 void jhcTrack3D::dist_matrix (const jhcBodyData *t, int n, const jhcBodyData *d, int m)
 {
   jhcMatrix diff(4);
-  int i, j;
+  double d2, lim = dmax0 * dmax0;
+  int i, j, k;
 
   // clear usage indicators
   for (i = 0; i < n; i++)
@@ -217,49 +230,65 @@ void jhcTrack3D::dist_matrix (const jhcBodyData *t, int n, const jhcBodyData *d,
   for (j = 0; j < m; j++)
     back[j] = -1;
 
-  // get pairwise distances
+  // bin detections by floor position
+  mate.Clear(n, m);
+  mate.Grid(dmax0);
+  for (j = 0; j < m; j++)
+    mate.BinCol(j, d[j].X(), d[j].Y());
+
+  // get pairwise distances for close enough items
   for (i = 0; i < n; i++)
-    if (t[i].TrackID() >= 0)
-      for (j = 0; j < m; j++)
+    if ((tid[i] = t[i].TrackID()) >= 0)
+    {
+      mate.Near(t[i].X(), t[i].Y());
+      for (k = 0; (j = mate.Cand(k)) >= 0; k++)
       {
         diff.DiffVec3(t[i], d[j]);
-        mate[i][j] = diff.Len2Vec3();
+        if ((d2 = diff.Len2Vec3()) <= lim)
+          mate.Add(i, j, d2);
       }
+    }
 }
 
 
 //= Find raw to track pairing smallest remaining distance.
 // track must have id >= threshold (0 = unsure, 1 = sure)
+// call mate.Sweep() before first call in a series
 // returns 1 if good pair indices bound, 0 if none
 
 int jhcTrack3D::best_match (int& iwin, int& jwin, int th) 
 {
-  double best, d2 = dmax0 * dmax0;
-  int i, j, m = NumRaw(), any = 0;
-
-  // look for best overall match
-  for (i = 0; i < nt; i++)
-    if ((dude[i].TrackID() >= th) && (fwd[i] < 0))
-      for (j = 0; j < m; j++)
-        if ((back[j] < 0) && ((any <= 0) || (mate[i][j] < best)))
-        {
-          best = mate[i][j];
-          iwin = i;
-          jwin = j;
-          any = 1;
-        }
-
-  // make sure some reasonable pairing found
-  if ((any <= 0) || (best > d2))
+  if (mate.NextPair(iwin, jwin, tid, th) <= 0)
     return 0;
 
   // invalidate pairing in next search
+  mate.Bind(iwin, jwin);
   back[jwin] = iwin;
   fwd[iwin] = jwin;
   return 1;
 }
 
 
+//= Bind raw detections to tracks so that total squared distance is minimized.
+// track must have id >= threshold (0 = unsure, 1 = sure)
+// updates head and hands of each newly matched track
+
+void jhcTrack3D::all_match (int th) 
+{
+  int i, j;
+
+  mate.Solve(1, tid, th);
+  for (i = 0; i < nt; i++)
+    if ((fwd[i] < 0) && ((j = mate.ColFor(i)) >= 0))
+    {
+      back[j] = i;
+      fwd[i] = j;
+      last_id = dude[i].UpdateHead(raw[j], last_id);
+      match_hands(dude[i], raw[j]);
+    }
+}
+
+
 //= Find first unused entry in track array.
 // updates max index of tracking array if needed
 
@@ -27,6 +27,7 @@
 
 #include "jhcGlobal.h"
 
+#include "Geometry/jhcAssign.h"
 #include "People/jhcBodyData.h"
 #include "People/jhcParse3D.h"
 
@@ -35,9 +36,9 @@
 // Does assignment of newly detected heads to old tracks then,
 // for a head, does assignment of detected hands to tracked hands.
 // Same general algorithm for both parts:
-//   find all track (verified or speculative) to detection distances
-//   sequentially bind smallest verified track to detection pairs
-//   sequentially bind smallest speculative track to detection pairs
+//   find all nearby track (verified or speculative) to detection distances
+//   bind verified tracks to detections (greedy smallest first or optimal)
+//   bind speculative tracks to detections (greedy smallest first or optimal)
 //   penalize any tracks without binds on this cycle
 //   start new tracks for any unbound detections
 
@@ -51,8 +52,8 @@ private:
   int last_id, nt;
 
   // head matching
-  double mate[tmax][rmax];
-  int back[rmax];
+  jhcAssign mate;
+  int tid[tmax], back[rmax];
 
   // hand matching
   double dh[2][2];
@@ -67,7 +68,7 @@ public:
 
   // parameters for tracking overall people
   jhcParam tps;
-  int hit0, miss0, hit2, miss2, anchor;
+  int hit0, miss0, hit2, miss2, anchor, optim;
   double dmax0, pmix0;
 
   // parameters for tracking hands of a person
@@ -115,6 +116,7 @@ private:
   // main functions
   void dist_matrix (const jhcBodyData *t, int n, const jhcBodyData *d, int m);
   int best_match (int& iwin, int& jwin, int th);
+  void all_match (int th);
   int first_open ();
 
   // hand matching
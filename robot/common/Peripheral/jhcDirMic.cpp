@@ -21,6 +21,7 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 #include "Interface/jhcMessage.h"
@@ -39,6 +40,7 @@ jhcDirMic::jhcDirMic ()
   // no serial port yet
   mok = -1;
   unit = -1;
+  nh = 0;
 
   // 3D homogeneous vectors
   loc.SetSize(4);
@@ -256,22 +258,70 @@ mok = -1;
 
 int jhcDirMic::Update (int voice)
 {
-  int dir, up = 100;
+  int dir;
 
   if (mok <= 0)
     return 0;
 
+  // collect all responses since last call
+  nh = 0;
+  while (mcom.Check() > 0)
+    if (((dir = mcom.Rcv()) >= 0) && (nh < hmax))
+      hits[nh++] = (UC8) dir;
+  return interpret(voice);
+}
+
+
+//= Clear smoothed directions when raw responses will come from a sensor log.
+// no serial port is opened so communications are assumed to be fine
+
+int jhcDirMic::ReplayReset ()
+{
+  loc.SetVec3(x0, y0, z0);
+  axis.SetPanTilt3(pan, tilt);
+  spcnt = 0;
+  beam = 0.0;
+  slow = 0.0;
+  talk = 0.0;
+  mok = 1;
+  return mok;
+}
+
+
+//= Substitute previously recorded raw responses for those from serial port.
+// interprets just like Update even if there is no real sensor
+// always returns 1 for convenience
+
+int jhcDirMic::Replay (const UC8 *dirs, int n, int voice)
+{
+  nh = 0;
+  if (dirs != NULL)
+  {
+    nh = __max(0, __min(n, hmax));
+    memcpy(hits, dirs, nh);
+  }
+  return interpret(voice);
+}
+
+
+//= Find direction from raw responses then update smoothed versions.
+// always returns 1 for convenience
+
+int jhcDirMic::interpret (int voice)
+{
+  int i, up = 100;
+
   // clear histogram and final smooth version (for display)
   snd.Fill(0);
   raw.Fill(0);
   pk = 125;
   cnt = 0;
 
-  // fill histogram with responses since last call
-  while (mcom.Check() > 0)
-    if ((dir = mcom.Rcv()) <= 250)   // 255 = invalid
+  // fill histogram with valid responses
+  for (i = 0; i < nh; i++)
+    if (hits[i] <= 250)              // 255 = invalid
     {
-      raw.AInc(dir, up);
+      raw.AInc(hits[i], up);
       cnt++;
     }
 
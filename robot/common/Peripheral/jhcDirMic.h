@@ -40,8 +40,11 @@ class jhcDirMic
 {
 // PRIVATE MEMBER VARIABLES
 private:
+  static const int hmax = 1000;        /** Maximum readings per update. */
+
   jhcArr ssm;
-  int mok, spcnt;
+  UC8 hits[hmax];
+  int nh, mok, spcnt;
   double beam, slow, talk;
 
 
@@ -97,6 +100,9 @@ public:
 
   // main functions
   int Update (int voice =0);
+  const UC8 *Raw (int& n) const {n = nh; return hits;}
+  int ReplayReset ();
+  int Replay (const UC8 *dirs, int n, int voice =0);
   double ClosestPt (jhcMatrix *pt, const jhcMatrix& ref, int src =0, int chk =1) const;
   double OffsetAng (const jhcMatrix& ref, int src =0) const;
 
@@ -105,6 +111,7 @@ public:
 private:
   int geom_params (const char *fname);
   int mic_params (const char *fname);
+  int interpret (int voice);
 
 };
 
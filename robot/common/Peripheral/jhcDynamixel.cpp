@@ -21,6 +21,7 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 #include "Interface/jhcMessage.h"
@@ -96,6 +97,8 @@ void jhcDynamixel::Reset ()
 
   // MegaUpdate values
   m0 = 0;
+  acc = 0;
+  nup = 0;
   mcnt = 0;
   mpod = 0;
   mfail = 0;
@@ -425,6 +428,49 @@ int jhcDynamixel::MegaCollect ()
 }
 
 
+//= Copy last mega-update response along with its decoding info.
+// layout is first ID, accelerometer size, expected size (16 bits), then data
+// returns number of bytes written to pod (at most ssz)
+
+int jhcDynamixel::MegaSave (UC8 *pod, int ssz) const
+{
+  int n = __max(0, mcnt);
+
+  if ((pod == NULL) || (ssz < (n + 4)))
+    return 0;
+  pod[0] = (UC8) m0;
+  pod[1] = (UC8) acc;
+  pod[2] = (UC8)( nup       & 0xFF);
+  pod[3] = (UC8)((nup >> 8) & 0xFF);
+  memcpy(pod + 4, up, n);
+  return(n + 4);
+}
+
+
+//= Substitute a saved mega-update response for a MegaIssue:MegaCollect pair.
+// servo states are then extracted as usual by GetState and RawAccel
+// returns 1 if response was complete when saved, 0 if it was too short
+
+int jhcDynamixel::MegaLoad (const UC8 *pod, int n)
+{
+  rc = 0;
+  err = 0;
+  mcnt = 0;
+  if ((pod == NULL) || (n < 4) || (n > 260))
+    return 0;
+  m0  = pod[0];
+  acc = pod[1];
+  nup = pod[2] | (pod[3] << 8);
+  mcnt = n - 4;
+  memcpy(up, pod + 4, mcnt);
+  mpod++;
+  if (mcnt == nup)
+    return 1;
+  mfail++;
+  return 0;
+}
+
+
 //= Looks in mega-response pod for information about this servo.
 // returns 1 if all info found, 0 or negative if failed
 
@@ -88,6 +88,8 @@ public:
   int MegaIssue (int id0, int idn, int base =0);
   int MegaCollect ();
   int RawAccel (int& xpk, int& ypk, int& xav4, int& yav4) const;
+  int MegaSave (UC8 *pod, int ssz) const;
+  int MegaLoad (const UC8 *pod, int n);
   int RobotID ();
 
   // joint status functions
@@ -25,11 +25,17 @@
 #include <malloc.h>                      // needed for MMX aligned malloc
 
 #include "Data/jhcBitMacros.h"
+#include "Data/jhcImgPool.h"
 #include "Interface/jhcMessage.h"
 
 #include "Data/jhcImg.h"
 
 
+//= Source of initial stamps so a new image never looks like a recent one.
+
+UL32 jhcImg::births = 0;
+
+
 //////////////////////////////////////////////////////////////////////////////
 //                     Basic creation and deletion                          //
 //////////////////////////////////////////////////////////////////////////////
@@ -138,28 +144,40 @@ jhcImg *jhcImg::SetSize (int wd, int ht, int fields, double a)
   }
 
   // see if old pixel buffer can be re-used (vsz added in 2017)
-  if ((vsz <= 0) || (bsize > asize))
+  if (((vsz <= 0) && (pool <= 0)) || (bsize > asize) || 
+      ((pool > 0) && (vsz <= 0) && (bsize < (asize >> 1))))
   {
     // make up array to hold pixel values 
     dealloc_img();
-    if (bsize > 0)
+    if (pool > 0)
+    {
+      // recycled buffer (size class may be larger than requested)
+      Buffer = jhcImgPool::Shared()->Get(bsize, &asize);
+      pooled = 1;
+    }
+    else
+    {
 #ifdef JHC_MMX
-      Buffer = (UC8 *) _mm_malloc(bsize, 16);  // needed for SSE2
+      Buffer = (UC8 *) _mm_malloc(bsize, 64);  // needed for SSE2 and AVX
 #else
       Buffer = new UC8 [bsize];
 #endif
+      asize = bsize;
+    }
 
     // check that allocation succeeded (record full buffer size in asize)
-    if ((bsize > 0) && (Buffer == NULL))
+    if (Buffer == NULL)
     {
       record_sizes(0, 0, 0);
+      asize = 0;
       Fatal("jhcImg::SetSize - Pixel buffer (%d %d) x %d allocation failed!", wd, ht, fields);
+      return this;
     }
-    asize = bsize;
   }
 
   // clear all pixels when first allocated (added in 2013)
   memset(Buffer, 0, bsize);
+  mod++;
   return this;
 }
 
@@ -360,6 +378,7 @@ jhcImg *jhcImg::Wrap (UC8 *raw, int wid, int ht, int fields)
   dealloc_img();
   Buffer = raw;
   wrap = 1;
+  mod++;
   return this;
 }
 
@@ -385,6 +404,13 @@ void jhcImg::record_sizes (int wd, int ht, int fields)
 
 void jhcImg::dealloc_img ()
 {
+  // recycled buffers go back to the pool
+  if ((wrap <= 0) && (pooled > 0) && (Buffer != NULL))
+  {
+    jhcImgPool::Shared()->Put(Buffer);
+    Buffer = NULL;
+  }
+
 #ifdef JHC_MMX
   // special alignment needed for SSE2 operations
   if ((wrap <= 0) && (Buffer != NULL))
@@ -398,16 +424,17 @@ void jhcImg::dealloc_img ()
   if ((sep > 0) && (Stacked != NULL))
     delete [] Stacked;
 #endif
-  init_img(vsz);
+  init_img(vsz, pool);
 }
 
 
 //= Set default values, but not any sizing parameters.
 
-void jhcImg::init_img (int v0)
+void jhcImg::init_img (int v0, int p0)
 {
   status  = 1;
   wrap    = 0;
+  pooled  = 0;
   sep     = 0;
   norm    = 1;
 
@@ -419,7 +446,9 @@ void jhcImg::init_img (int v0)
 
   Buffer  = NULL;
   asize   = 0;
+  mod     = (births += 0x10000);   // distinct from recent images
   vsz     = v0;
+  pool    = p0;
   aspect  = 1.0;
 }
 
@@ -466,6 +495,7 @@ return PxlDest(split);
 
 UC8 *jhcImg::PxlDest (int split)
 {
+  mod++;
   if (nf != 3)
     return Buffer;
   if (split > 0)
@@ -520,6 +550,7 @@ void jhcImg::ForceMix (int bad_sep)
   if (norm <= 0)
   {
     deswizz(Buffer, Stacked);
+    mod++;
     norm = 1;
   }
   if (bad_sep > 0)
@@ -591,7 +622,7 @@ void jhcImg::alloc_rgb ()
   if (ssize > 0)
   {
 #ifdef JHC_MMX
-    Stacked = (UC8 *) _mm_malloc(ssize, 16);  // needed for SSE2
+    Stacked = (UC8 *) _mm_malloc(ssize, 64);  // needed for SSE2 and AVX
 #else
     Stacked = new UC8 [ssize];
 #endif
@@ -967,6 +998,7 @@ void jhcImg::LoadAll (const UC8 *src)
 {
   if (Valid() && (Buffer != src))
     memcpy(Buffer, src, bsize);
+  mod++;
   norm = 1;
   sep = 0;
 }
@@ -989,6 +1021,7 @@ void jhcImg::LoadFlip (const UC8 *src)
       s += line_len;
       d -= line_len;
     }
+  mod++;
   norm = 1;
   sep = 0;
 }
@@ -1015,6 +1048,7 @@ int jhcImg::LoadAll (const jhcImg& src)
   else
   {
     memcpy(Buffer, src.Buffer, bsize);
+    mod++;
     norm = 1;
     sep = 0;
   }
@@ -1244,6 +1278,7 @@ int jhcImg::FillArr (int v)
       memset(Stacked, val, ssize);
     else
       memset(Buffer, val, bsize);
+    mod++;
     return 1;
   }
   if (RoiMod4() != 0)
@@ -1634,7 +1669,7 @@ int jhcImg::aref_16 (int x, int y) const
 
 void jhcImg::aset_16 (int x, int y, int val)
 {
-  US16 *loc = (US16 *)(PxlSrc() + y * line_len + x * nf);
+  US16 *loc = (US16 *)(PxlDest() + y * line_len + x * nf);
 
   *loc = (US16) val;
 }
@@ -1654,7 +1689,7 @@ UL32 jhcImg::aref_32 (int x, int y) const
 
 void jhcImg::aset_32 (int x, int y, UL32 val)
 {
-  UL32 *loc = (UL32 *)(PxlSrc() + y * line_len + x * nf);
+  UL32 *loc = (UL32 *)(PxlDest() + y * line_len + x * nf);
 
   *loc = val;
 }
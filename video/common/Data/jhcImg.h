@@ -64,12 +64,21 @@
 //
 // If vsz > 0 then if size changed to smaller one, keeps larger buffer (no alloc).
 // Useful if repeatedly extracting some varying size portion of a larger image.
+//
+// If pool > 0 then pixel buffer is borrowed from and returned to jhcImgPool.
+// Buffer is 64 byte aligned and resizing usually recycles instead of allocating.
+// Useful for scratch images in classes that see several different resolutions.
+//
+// Stamp changes every time write access to pixels is granted (e.g. PxlDest, ASet).
+// Lets caches of derived data (e.g. jhcIntegral) notice new image contents.
+// Call Touch after writing into an external buffer attached with Wrap.
 
 class jhcImg : public jhcRoi
 {
 // PRIVATE MEMBER VARIABLES
 private:
-  int wrap, nf, end_skip, line_len;
+  static UL32 births;
+  int wrap, pooled, nf, end_skip, line_len;
   int norm, sep, sskip, sline;
   int bsize, asize;
   int ssize, psize;
@@ -77,12 +86,14 @@ private:
   char msg[20];
   UC8 *Buffer;   // actual bytes for pixels
   UC8 *Stacked;
+  UL32 mod;      // changes whenever pixels might be altered
 
 
 // PUBLIC MEMBER VARIABLES
 public:
   int status;  /** Whether image should be displayed.   */
   int vsz;     /** Whether to reuse buffer if possible. */
+  int pool;    /** Whether to use shared buffer pool.   */
 
 
 // PUBLIC MEMBER FUNCTIONS
@@ -164,10 +175,12 @@ public:
   int Square () const;
 
   const UC8 *PxlSrc () const {return Buffer;}  /** Ignore any potential swizzling. */
-  UC8 *PxlDest () {return Buffer;}             /** Ignore any potential swizzling. */
+  UC8 *PxlDest () {mod++; return Buffer;}      /** Ignore any potential swizzling. */
   const UC8 *PxlSrc (int split);
   UC8 *PxlDest (int split);
   int PxlSize (int split =0) const;
+  UL32 Stamp () const {return mod;}            /** Value changes when pixels might be altered. */
+  void Touch () {mod++;}                       /** Note pixels altered by outside code.        */
   void ForceSep (int bad_norm =0);
   void ForceMix (int bad_sep =0);
 
@@ -245,7 +258,7 @@ public:
 private:
   void record_sizes (int wd, int ht, int fields);
   void dealloc_img();
-  void init_img (int v0);
+  void init_img (int v0, int p0 =0);
   void null_img ();
 
   // fast helper functions for aligned ROIs
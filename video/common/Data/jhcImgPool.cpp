@@ -0,0 +1,326 @@
+// jhcImgPool.cpp : recycles aligned pixel buffers to avoid allocator churn
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <windows.h>
+#include <stdlib.h>
+
+#include "Data/jhcImgPool.h"
+
+
+//= Bookkeeping stored just before each aligned buffer.
+
+typedef struct
+{
+  UC8 *raw;          /** Pointer actually returned by malloc.      */
+  UC8 *next;         /** Link to next buffer when in a free list. */
+  int cls;           /** Size class (or -1 if not pooled).        */
+  int cap;           /** Usable bytes (excluding tail slack).     */
+} jhc_pool_hdr;
+
+
+//= Get bookkeeping header for some aligned buffer.
+
+#define POOL_HDR(b)  ((jhc_pool_hdr *)((b) - sizeof(jhc_pool_hdr)))
+
+
+//= Per-thread free lists so most recycling needs no lock (size = ncls).
+// buffers left here when a thread exits are never reclaimed (at most tcache each)
+
+#ifdef _MSC_VER
+  #define JHC_TLS __declspec(thread)
+#else
+  #define JHC_TLS __thread
+#endif
+
+static JHC_TLS UC8 *t_head[72];
+static JHC_TLS int t_cnt[72];
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+// only shared lists are freed, other threads' caches are already gone
+
+jhcImgPool::~jhcImgPool ()
+{
+  Trim();
+  DeleteCriticalSection((CRITICAL_SECTION *) lock);
+  delete ((CRITICAL_SECTION *) lock);
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcImgPool::jhcImgPool ()
+{
+  int c;
+
+  for (c = 0; c < ncls; c++)
+  {
+    head[c] = NULL;
+    cnt[c] = 0;
+  }
+  lock = (void *) new CRITICAL_SECTION;
+  InitializeCriticalSection((CRITICAL_SECTION *) lock);
+  now = 0;
+  most = 0;
+  held = 0;
+  fresh = 0;
+}
+
+
+//= Get the process-wide pool used by all images.
+// created on first use and never destroyed since static images may
+// still be returning buffers during program exit
+
+jhcImgPool *jhcImgPool::Shared ()
+{
+  static jhcImgPool *pool = new jhcImgPool;
+
+  return pool;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get a buffer of at least sz bytes, possibly recycled, 64 byte aligned.
+// can optionally return actual usable size in cap
+// contents are NOT cleared, returns NULL if allocation fails
+
+UC8 *jhcImgPool::Get (int sz, int *cap)
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) lock;
+  UC8 *buf = NULL;
+  int c = size_class(sz), csz = ((c < 0) ? sz : class_size(c));
+
+  // try recycling (this thread first then shared list)
+  if (c >= 0)
+  {
+    if ((buf = t_head[c]) != NULL)
+    {
+      t_head[c] = POOL_HDR(buf)->next;
+      t_cnt[c] -= 1;
+    }
+    else if (cnt[c] > 0)
+    {
+      EnterCriticalSection(cs);
+      if ((buf = head[c]) != NULL)
+      {
+        head[c] = POOL_HDR(buf)->next;
+        cnt[c] -= 1;
+      }
+      LeaveCriticalSection(cs);
+    }
+    if (buf != NULL)
+      InterlockedExchangeAdd(&held, -(csz >> 10));
+  }
+
+  // get a new block if needed
+  if (buf == NULL)
+    if ((buf = make_blk(c, csz)) == NULL)
+      return NULL;
+  note_out(csz >> 10);
+  if (cap != NULL)
+    *cap = csz;
+  return buf;
+}
+
+
+//= Give back a buffer previously obtained with Get.
+// keeps a few in this thread's free list, rest go on shared list
+
+void jhcImgPool::Put (UC8 *buf)
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) lock;
+  jhc_pool_hdr *hdr;
+  int c;
+
+  if (buf == NULL)
+    return;
+  hdr = POOL_HDR(buf);
+  c = hdr->cls;
+  InterlockedExchangeAdd(&now, -(hdr->cap >> 10));
+
+  // odd sized buffers are never recycled
+  if (c < 0)
+  {
+    kill_blk(buf);
+    return;
+  }
+  InterlockedExchangeAdd(&held, hdr->cap >> 10);
+
+  // prefer local list (no locking)
+  if (t_cnt[c] < tcache)
+  {
+    hdr->next = t_head[c];
+    t_head[c] = buf;
+    t_cnt[c] += 1;
+    return;
+  }
+
+  // otherwise add to shared list
+  EnterCriticalSection(cs);
+  hdr->next = head[c];
+  head[c] = buf;
+  cnt[c] += 1;
+  LeaveCriticalSection(cs);
+}
+
+
+//= Free all buffers waiting in shared lists and this thread's lists.
+// call after a big resolution change to give memory back to the heap
+
+void jhcImgPool::Trim ()
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) lock;
+  UC8 *buf;
+  int c;
+
+  // local lists for calling thread
+  for (c = 0; c < ncls; c++)
+    while ((buf = t_head[c]) != NULL)
+    {
+      t_head[c] = POOL_HDR(buf)->next;
+      InterlockedExchangeAdd(&held, -(class_size(c) >> 10));
+      kill_blk(buf);
+    }
+  for (c = 0; c < ncls; c++)
+    t_cnt[c] = 0;
+
+  // shared lists
+  EnterCriticalSection(cs);
+  for (c = 0; c < ncls; c++)
+  {
+    while ((buf = head[c]) != NULL)
+    {
+      head[c] = POOL_HDR(buf)->next;
+      InterlockedExchangeAdd(&held, -(class_size(c) >> 10));
+      kill_blk(buf);
+    }
+    cnt[c] = 0;
+  }
+  LeaveCriticalSection(cs);
+}
+
+
+//= Tell how many bytes are usable in a buffer from Get.
+
+int jhcImgPool::Capacity (const UC8 *buf)
+{
+  if (buf == NULL)
+    return 0;
+  return POOL_HDR(buf)->cap;
+}
+
+
+//= Print a summary of memory usage to log.
+
+void jhcImgPool::Report (const char *tag) const
+{
+  jprintf("%s pixel pool: %d KB out (%d KB peak), %d KB idle, %d KB from heap\n",
+          ((tag != NULL) ? tag : ""), (int) now, (int) most, (int) held, (int) fresh);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                              Size Classes                             //
+///////////////////////////////////////////////////////////////////////////
+
+//= Find smallest size class which can hold sz bytes.
+// returns -1 if too large for any class
+
+int jhcImgPool::size_class (int sz)
+{
+  int c = 0;
+
+  while (c < ncls)
+  {
+    if (class_size(c | 3) < sz)        // skip whole octave
+      c += 4;
+    else if (class_size(c) < sz)
+      c++;
+    else
+      return c;
+  }
+  return -1;
+}
+
+
+//= Number of bytes in a particular size class.
+// 4K 5K 6K 7K 8K 10K 12K 14K 16K 20K ... (at most 25% wasted)
+
+int jhcImgPool::class_size (int c)
+{
+  return((4 + (c & 3)) << (10 + (c >> 2)));
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                              Raw Blocks                               //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get a new 64 byte aligned block from heap with room for header and slack.
+
+UC8 *jhcImgPool::make_blk (int c, int cap)
+{
+  jhc_pool_hdr *hdr;
+  UC8 *raw, *buf;
+
+  if ((raw = (UC8 *) malloc(cap + 192)) == NULL)
+    return NULL;
+  buf = (UC8 *)((((size_t) raw) + 127) & ~((size_t) 63));   // header fits below
+  hdr = POOL_HDR(buf);
+  hdr->raw = raw;
+  hdr->next = NULL;
+  hdr->cls = c;
+  hdr->cap = cap;
+  InterlockedExchangeAdd(&fresh, cap >> 10);
+  return buf;
+}
+
+
+//= Return some block to the heap.
+
+void jhcImgPool::kill_blk (UC8 *buf)
+{
+  jhc_pool_hdr *hdr = POOL_HDR(buf);
+
+  InterlockedExchangeAdd(&fresh, -(hdr->cap >> 10));
+  free(hdr->raw);
+}
+
+
+//= Record some buffer being handed out and update peak usage.
+
+void jhcImgPool::note_out (int kb)
+{
+  long cur = InterlockedExchangeAdd(&now, kb) + kb, pk;
+
+  while ((pk = most) < cur)
+    if (InterlockedCompareExchange(&most, cur, pk) == pk)
+      break;
+}
+
@@ -0,0 +1,108 @@
+// jhcImgPool.h : recycles aligned pixel buffers to avoid allocator churn
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCIMGPOOL_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCIMGPOOL_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+
+//= Recycles aligned pixel buffers to avoid allocator churn.
+// buffers start on a 64 byte boundary and have at least 64 bytes of slack
+// after the requested size so SIMD loads running off the last row are safe
+// sizes are rounded up to classes (4 per octave, 4K minimum) so that
+// switching between a few resolutions quickly stops hitting the heap
+// each thread keeps a few freed buffers per class before using shared lists
+// all statistics are in kilobytes of capacity, not bytes requested
+// NOTE: only one shared instance exists since thread lists are global
+// <pre>
+// typical use:
+//
+//   jhcImg tmp;
+//   tmp.pool = 1;                  // borrow and return buffers via pool
+//   tmp.SetSize(src);
+//
+//   jhcImgPool::Shared()->Report();
+// </pre>
+
+class jhcImgPool
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  static const int ncls = 72;          /** Number of pooled size classes.  */
+  static const int tcache = 4;         /** Buffers per class per thread.   */
+
+  // shared free lists
+  UC8 *head[ncls];
+  int cnt[ncls];
+  void *lock;
+
+  // usage statistics (KB)
+  volatile long now, most, held, fresh;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  static jhcImgPool *Shared ();
+
+  // main functions
+  UC8 *Get (int sz, int *cap =NULL);
+  void Put (UC8 *buf);
+  void Trim ();
+  static int Capacity (const UC8 *buf);
+
+  // usage statistics
+  int CurKB () const  {return((int) now);}    /** Capacity handed out and not returned. */
+  int PeakKB () const {return((int) most);}   /** Most capacity ever handed out.        */
+  int HeldKB () const {return((int) held);}   /** Capacity sitting in free lists.       */
+  int NewKB () const  {return((int) fresh);}  /** Capacity obtained from the heap.      */
+  void ResetPeak () {most = now;}
+  void Report (const char *tag =NULL) const;
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  ~jhcImgPool ();
+  jhcImgPool ();
+
+  // size classes
+  static int size_class (int sz);
+  static int class_size (int c);
+
+  // raw blocks
+  UC8 *make_blk (int c, int cap);
+  void kill_blk (UC8 *buf);
+  void note_out (int kb);
+
+
+};
+
+
+#endif  // once
+
+
+
+
@@ -0,0 +1,405 @@
+// jhcImgSaver.cpp : saves image files in the background so callers never stall
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <windows.h>
+#include <process.h>
+#include <string.h>
+
+#include "Interface/jhcMessage.h"
+#include "Interface/jms_x.h"
+
+#include "Data/jhcImgSaver.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+// finishes writing anything still queued
+
+jhcImgSaver::~jhcImgSaver ()
+{
+  int i;
+
+  Stop(1);
+  for (i = 0; i < smax; i++)
+    delete [] aux[i];
+  DeleteCriticalSection((CRITICAL_SECTION *) lock);
+  delete ((CRITICAL_SECTION *) lock);
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcImgSaver::jhcImgSaver ()
+{
+  int i;
+
+  // request slots borrow pixels from shared pool
+  for (i = 0; i < smax; i++)
+  {
+    img[i].pool = 1;
+    img2[i].pool = 1;
+    aux[i] = NULL;
+    asz[i] = 0;
+  }
+  depth = 0;
+  clr_slots();
+
+  // no threads yet
+  lock = (void *) new CRITICAL_SECTION;
+  InitializeCriticalSection((CRITICAL_SECTION *) lock);
+  for (i = 0; i < wmax; i++)
+    fcn[i] = NULL;
+  items = NULL;
+  room = NULL;
+  nid = 0;
+  busy = 0;
+  nw = 0;
+  run = 0;
+
+  // default processing
+  policy = 0;
+  ResetStats();
+}
+
+
+//= Make all request slots available again.
+
+void jhcImgSaver::clr_slots ()
+{
+  int i;
+
+  for (i = 0; i < smax; i++)
+  {
+    *(fname[i]) = '\0';
+    alen[i] = 0;
+    dual[i] = 0;
+    fifo[i] = 0;
+    spare[i] = i;
+  }
+  head = 0;
+  nq = 0;
+  nfree = depth;
+}
+
+
+//= Create a queue with room for n requests and nt writer threads.
+// any previous queue is flushed and shut down first
+// returns number of writers started
+
+int jhcImgSaver::Start (int n, int nt)
+{
+  int i;
+
+  // set up queue
+  Stop(1);
+  depth = __max(1, __min(n, smax));
+  nw = __max(1, __min(nt, wmax));
+  clr_slots();
+  items = (void *) CreateSemaphore(NULL, 0, smax, NULL);
+  room  = (void *) CreateSemaphore(NULL, depth, smax, NULL);
+
+  // make up writers
+  nid = 0;
+  busy = 0;
+  run = 1;
+  for (i = 0; i < nw; i++)
+    fcn[i] = (void *) _beginthreadex(NULL, 0, write_backg, this, 0, NULL);
+  return nw;
+}
+
+
+//= Shut down all writer threads, possibly finishing queued requests first.
+// any requests still waiting when flush = 0 are counted as dropped
+
+void jhcImgSaver::Stop (int flush)
+{
+  int i;
+
+  if (run <= 0)
+    return;
+  if (flush > 0)
+    Flush();
+
+  // ask every writer politely to exit (must finish before slots are freed)
+  run = 0;
+  ReleaseSemaphore((HANDLE) items, nw, NULL);
+  for (i = 0; i < nw; i++)
+  {
+    if (WaitForSingleObject((HANDLE) fcn[i], INFINITE) != WAIT_OBJECT_0)
+      jprintf(">>> Never got thread termination in jhcImgSaver::Stop\n");
+    CloseHandle((HANDLE) fcn[i]);
+    fcn[i] = NULL;
+  }
+  nw = 0;
+
+  // clean up queue
+  CloseHandle((HANDLE) items);
+  CloseHandle((HANDLE) room);
+  items = NULL;
+  room = NULL;
+  drop += nq;
+  for (i = 0; i < smax; i++)
+  {
+    img[i].Release();
+    img2[i].Release();
+  }
+  clr_slots();
+}
+
+
+//= Wait until all queued requests have been written (ms < 0 waits forever).
+// returns 1 if everything done, 0 if timed out
+
+int jhcImgSaver::Flush (int ms)
+{
+  UL32 t0 = jms_now();
+
+  while (Pending() > 0)
+  {
+    if ((ms >= 0) && (jms_diff(jms_now(), t0) >= ms))
+      return 0;
+    Sleep(1);
+  }
+  return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Queue a copy of an image to be saved like jhcImgIO::Save.
+// file name is resolved immediately using current default directory
+// returns 1 if queued (or saved), 0 if dropped, negative for error
+
+int jhcImgSaver::Save (const char *file_spec, const jhcImg& src, int full,
+                       int extras, const UC8 *aux_data)
+{
+  return submit(file_spec, full, src, NULL, extras, aux_data);
+}
+
+
+//= Queue copies of color and depth images to be saved like jhcImgIO::SaveDual.
+// returns 1 if queued (or saved), 0 if dropped, negative for error
+
+int jhcImgSaver::SaveDual (const char *cname, const jhcImg& col, const jhcImg& dist,
+                           int extras, const UC8 *aux_data)
+{
+  return submit(cname, -1, col, &dist, extras, aux_data);
+}
+
+
+//= Copy request into a free slot and let writers know about it.
+// saves directly if no writer threads are running
+// returns 1 if queued (or saved), 0 if dropped, negative for error
+
+int jhcImgSaver::submit (const char *file_spec, int full, const jhcImg& src, const jhcImg *src2,
+                         int extras, const UC8 *aux_data)
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) lock;
+  char fn[250];
+  int s;
+
+  if ((file_spec == NULL) || !src.Valid() || ((src2 != NULL) && !src2->Valid()))
+    return -1;
+
+  // get complete name using defaults
+  EnterCriticalSection(cs);
+  names.BuildName(file_spec, full);
+  strcpy_s(fn, names.File());
+  LeaveCriticalSection(cs);
+
+  // possibly just save now
+  if (run <= 0)
+  {
+    if (src2 != NULL)
+      return io[0].SaveDual(fn, src, *src2, extras, aux_data);
+    return io[0].Save(fn, src, 1, extras, aux_data);
+  }
+
+  // find a place to put request (might replace oldest)
+  if ((s = grab_slot()) < 0)
+  {
+    if (policy != 1)
+    {
+      InterlockedIncrement(&drop);
+      return 0;
+    }
+    EnterCriticalSection(cs);
+    if (nq <= 0)
+    {
+      LeaveCriticalSection(cs);
+      InterlockedIncrement(&drop);
+      return 0;
+    }
+    s = fifo[head];
+    head = (head + 1) % smax;
+    fill_slot(s, fn, src, src2, extras, aux_data);
+    fifo[(head + nq - 1) % smax] = s;
+    LeaveCriticalSection(cs);
+    InterlockedIncrement(&drop);
+    InterlockedIncrement(&sub);
+    return 1;
+  }
+
+  // copy data then append to queue
+  fill_slot(s, fn, src, src2, extras, aux_data);
+  EnterCriticalSection(cs);
+  fifo[(head + nq) % smax] = s;
+  nq++;
+  most = __max(most, nq);
+  LeaveCriticalSection(cs);
+  InterlockedIncrement(&sub);
+  ReleaseSemaphore((HANDLE) items, 1, NULL);
+  return 1;
+}
+
+
+//= Get an unused request slot, waiting for one only if policy is 2.
+// returns slot index, negative if queue is full
+
+int jhcImgSaver::grab_slot ()
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) lock;
+  int s;
+
+  if (WaitForSingleObject((HANDLE) room, ((policy >= 2) ? INFINITE : 0)) != WAIT_OBJECT_0)
+    return -1;
+  EnterCriticalSection(cs);
+  s = spare[--nfree];
+  LeaveCriticalSection(cs);
+  return s;
+}
+
+
+//= Copy name, images, and auxilliary data into some request slot.
+
+void jhcImgSaver::fill_slot (int s, const char *fn, const jhcImg& src, const jhcImg *src2,
+                             int extras, const UC8 *aux_data)
+{
+  int n = (((aux_data != NULL) && (extras > 0)) ? __min(extras, 65535) : 0);
+
+  // pixels
+  strcpy_s(fname[s], fn);
+  img[s].Clone(src);
+  dual[s] = 0;
+  if (src2 != NULL)
+  {
+    img2[s].Clone(*src2);
+    dual[s] = 1;
+  }
+
+  // extra data
+  if (n > asz[s])
+  {
+    delete [] aux[s];
+    aux[s] = new UC8 [n];
+    asz[s] = n;
+  }
+  if (n > 0)
+    memcpy(aux[s], aux_data, n);
+  alen[s] = n;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Writer Threads                             //
+///////////////////////////////////////////////////////////////////////////
+
+//= Wait for requests and write them out (run as a separate thread).
+// each writer has its own jhcImgIO since formatters keep some state
+
+int jhcImgSaver::write_loop ()
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) lock;
+  jhcImgIO *out = io + ((int) InterlockedIncrement(&nid) - 1);
+  int s;
+
+  while (WaitForSingleObject((HANDLE) items, INFINITE) == WAIT_OBJECT_0)
+  {
+    if (run <= 0)
+      return 1;
+
+    // take oldest request
+    EnterCriticalSection(cs);
+    s = fifo[head];
+    head = (head + 1) % smax;
+    nq--;
+    InterlockedIncrement(&busy);
+    LeaveCriticalSection(cs);
+
+    // write then recycle slot
+    if (write_slot(*out, s) > 0)
+      InterlockedIncrement(&wr);
+    else
+      InterlockedIncrement(&fail);
+    EnterCriticalSection(cs);
+    spare[nfree++] = s;
+    InterlockedDecrement(&busy);
+    LeaveCriticalSection(cs);
+    ReleaseSemaphore((HANDLE) room, 1, NULL);
+  }
+  return 0;
+}
+
+
+//= Save contents of some request slot using given formatter.
+// returns positive if successful
+
+int jhcImgSaver::write_slot (jhcImgIO& out, int s)
+{
+  const UC8 *data = ((alen[s] > 0) ? aux[s] : NULL);
+
+  if (dual[s] > 0)
+    return out.SaveDual(fname[s], img[s], img2[s], alen[s], data);
+  return out.Save(fname[s], img[s], 1, alen[s], data);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                              Statistics                               //
+///////////////////////////////////////////////////////////////////////////
+
+//= Clear all request counters and the queue high water mark.
+
+void jhcImgSaver::ResetStats ()
+{
+  sub = 0;
+  wr = 0;
+  drop = 0;
+  fail = 0;
+  most = nq;
+}
+
+
+//= Print a summary of how well logging is keeping up.
+
+void jhcImgSaver::Report (const char *tag) const
+{
+  jprintf("%s image saver: %d queued (%d max of %d), %d written, %d dropped, %d failed\n",
+          ((tag != NULL) ? tag : ""), nq, most, depth, (int) wr, (int) drop, (int) fail);
+}
+
+
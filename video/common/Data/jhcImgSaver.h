@@ -0,0 +1,149 @@
+// jhcImgSaver.h : saves image files in the background so callers never stall
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCIMGSAVER_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCIMGSAVER_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"
+#include "Data/jhcImgIO.h"
+
+
+//= Saves image files in the background so callers never stall.
+// Save and SaveDual copy the images (into pooled buffers) and return at once
+// while one or more writer threads do the actual file formatting and output
+// queue holds a bounded number of requests, when full "policy" decides
+// whether to drop the new frame, drop the oldest waiting one, or wait
+// several writers allow slow formats (e.g. JPEG) to be encoded in parallel
+// but then files may be finished in a slightly different order than queued
+// if not started then Save and SaveDual just write directly like jhcImgIO
+// <pre>
+// typical use:
+//
+//   jhcImgSaver log;
+//   log.Start(16, 2);
+//   log.SetDir("C:/frames/");
+//   ...
+//   log.SaveDual("cam.bmp", col, rng);     // in perception loop
+//   ...
+//   log.Report();
+//   log.Stop();
+// </pre>
+
+class jhcImgSaver
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  static const int smax = 64;          /** Maximum number of queued requests. */
+  static const int wmax = 8;           /** Maximum number of writer threads.  */
+
+  // request slots
+  jhcImg img[smax], img2[smax];
+  char fname[smax][250];
+  UC8 *aux[smax];
+  int alen[smax], asz[smax], dual[smax];
+
+  // queue and free list
+  int fifo[smax], spare[smax];
+  int depth, head, nq, nfree;
+
+  // writer threads
+  jhcImgIO io[wmax], names;
+  void *fcn[wmax];
+  void *items, *room, *lock;
+  volatile long nid, busy;
+  int nw, run;
+
+  // statistics
+  volatile long sub, wr, drop, fail;
+  int most;
+
+
+// PUBLIC MEMBER VARIABLES
+public:
+  int policy;    /** When full: 0 = drop new, 1 = drop oldest, 2 = wait. */
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcImgSaver ();
+  jhcImgSaver ();
+  int Start (int n =16, int nt =1);
+  void Stop (int flush =1);
+  int Active () const {return run;}
+  int Flush (int ms =-1);
+
+  // file naming
+  void SetDir (const char *path) {names.SetDir(path);}   /** Set the default directory.      */
+  void SetExt (const char *end) {names.SetExt(end);}     /** Set the default file extension. */
+
+  // main functions
+  int Save (const char *file_spec, const jhcImg& src, int full =-1,
+            int extras =0, const UC8 *aux_data =NULL);
+  int SaveDual (const char *cname, const jhcImg& col, const jhcImg& dist,
+                int extras =0, const UC8 *aux_data =NULL);
+
+  // statistics
+  int Queued () const    {return nq;}                   /** Requests waiting for a writer.    */
+  int Pending () const   {return(nq + (int) busy);}     /** Requests not yet finished.        */
+  int MaxQueue () const  {return most;}                 /** Most requests ever waiting.       */
+  int Submitted () const {return((int) sub);}           /** Requests accepted into queue.     */
+  int Written () const   {return((int) wr);}            /** Requests successfully saved.      */
+  int Dropped () const   {return((int) drop);}          /** Frames discarded due to overflow. */
+  int Failed () const    {return((int) fail);}          /** Requests where file write failed. */
+  void ResetStats ();
+  void Report (const char *tag =NULL) const;
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  void clr_slots ();
+
+  // main functions
+  int submit (const char *file_spec, int full, const jhcImg& src, const jhcImg *src2,
+              int extras, const UC8 *aux_data);
+  int grab_slot ();
+  void fill_slot (int s, const char *fn, const jhcImg& src, const jhcImg *src2,
+                  int extras, const UC8 *aux_data);
+
+  // writer threads
+  int write_loop ();
+  int write_slot (jhcImgIO& out, int s);
+
+  // background thread
+  static unsigned int __stdcall write_backg (void *inst)
+    {jhcImgSaver *me = (jhcImgSaver *) inst; return me->write_loop();}
+
+
+};
+
+
+#endif  // once
+
+
+
+
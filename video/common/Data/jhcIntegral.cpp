@@ -0,0 +1,378 @@
+// jhcIntegral.cpp : summed area tables for fast box statistics
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "Interface/jhcBandPool.h"
+#include "Interface/jhcMessage.h"
+
+#include "Data/jhcIntegral.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcIntegral::~jhcIntegral ()
+{
+  delete [] nz;
+  delete [] s2;
+  delete [] s1;
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcIntegral::jhcIntegral ()
+{
+  s1 = NULL;
+  s2 = NULL;
+  nz = NULL;
+  n1 = 0;
+  n2 = 0;
+  nn = 0;
+  ln = 0;
+  iw = 0;
+  ih = 0;
+  Invalidate();
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Make tables for the ROI of a monochrome image unless already current.
+// sqr > 0 also builds table of squared values, bg >= 0 counts pixels != bg
+// returns 2 if tables were already valid, 1 if rebuilt, 0 or negative for error
+
+int jhcIntegral::Build (const jhcImg& src, int sqr, int bg)
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+  int w = src.RoiW(), h = src.RoiH();
+
+  if (!src.Valid(1))
+    return Fatal("Bad image to jhcIntegral::Build");
+  if (Cached(src, sqr, bg))
+    return 2;
+  if (Cached(src))                    // keep tables already present
+  {
+    sqr = __max(sqr, sq);
+    if (bg < 0)
+      bg = zbg;
+  }
+  if ((w * h) > 0x01010101)           // 32 bit overflow beyond (2^32 - 1) / 255
+    return Fatal("Image too big (%d %d) for jhcIntegral::Build", w, h);
+  if (alloc_tabs(w, h, sqr, bg) <= 0)
+    return Fatal("Could not allocate tables in jhcIntegral::Build");
+
+  // remember image source and extent
+  img = NULL;
+  rx = src.RoiX();
+  ry = src.RoiY();
+  iw = w;
+  ih = h;
+  sq = sqr;
+  zbg = bg;
+  a0 = src.RoiSrc();
+  lsk = src.Line();
+
+  // top row of every table is zero then do rows followed by columns
+  memset(s1, 0, ln * sizeof(UL32));
+  if (sq > 0)
+    memset(s2, 0, ln * sizeof(unsigned __int64));
+  if (zbg >= 0)
+    memset(nz, 0, ln * sizeof(UL32));
+  bp->Run(row_sums, this, bp->Bands(ih));
+  bp->Run(col_sums, this, bp->Bands(iw, 64));
+
+  // mark as valid for this particular image contents
+  img = &src;
+  stamp = src.Stamp();
+  return 1;
+}
+
+
+//= Tell if current tables match image contents and ROI.
+// having more tables than requested is fine, as is any other background
+
+int jhcIntegral::Cached (const jhcImg& src, int sqr, int bg) const
+{
+  if ((img != &src) || (stamp != src.Stamp()))
+    return 0;
+  if ((rx != src.RoiX()) || (ry != src.RoiY()) || (iw != src.RoiW()) || (ih != src.RoiH()))
+    return 0;
+  if ((sqr > 0) && (sq <= 0))
+    return 0;
+  if ((bg >= 0) && (bg != zbg))
+    return 0;
+  return 1;
+}
+
+
+//= Sum of values in rectangle from (x0 y0) up to but not including (x1 y1).
+// rectangle is clipped to the ROI used when building tables
+
+UL32 jhcIntegral::RectSum (int x0, int y0, int x1, int y1) const
+{
+  const UL32 *lo, *hi;
+  int cx0, cy0, cx1, cy1;
+
+  clip_rect(cx0, cy0, cx1, cy1, x0, y0, x1, y1);
+  if ((cx1 <= cx0) || (cy1 <= cy0))
+    return 0;
+  lo = s1 + cy0 * ln;
+  hi = s1 + cy1 * ln;
+  return(hi[cx1] - hi[cx0] - lo[cx1] + lo[cx0]);
+}
+
+
+//= Sum of squared values in rectangle from (x0 y0) up to but not including (x1 y1).
+// rectangle is clipped to the ROI used when building tables
+
+unsigned __int64 jhcIntegral::RectSq (int x0, int y0, int x1, int y1) const
+{
+  const unsigned __int64 *lo, *hi;
+  int cx0, cy0, cx1, cy1;
+
+  if (sq <= 0)
+    return 0;
+  clip_rect(cx0, cy0, cx1, cy1, x0, y0, x1, y1);
+  if ((cx1 <= cx0) || (cy1 <= cy0))
+    return 0;
+  lo = s2 + cy0 * ln;
+  hi = s2 + cy1 * ln;
+  return(hi[cx1] - hi[cx0] - lo[cx1] + lo[cx0]);
+}
+
+
+//= Number of non-background pixels in rectangle from (x0 y0) up to but not including (x1 y1).
+// rectangle is clipped to the ROI used when building tables
+
+UL32 jhcIntegral::RectCnt (int x0, int y0, int x1, int y1) const
+{
+  const UL32 *lo, *hi;
+  int cx0, cy0, cx1, cy1;
+
+  if (zbg < 0)
+    return 0;
+  clip_rect(cx0, cy0, cx1, cy1, x0, y0, x1, y1);
+  if ((cx1 <= cx0) || (cy1 <= cy0))
+    return 0;
+  lo = nz + cy0 * ln;
+  hi = nz + cy1 * ln;
+  return(hi[cx1] - hi[cx0] - lo[cx1] + lo[cx0]);
+}
+
+
+//= Sum of values in rectangle where parts outside ROI repeat the nearest edge pixel.
+// rectangle from (x0 y0) up to but not including (x1 y1) must overlap ROI
+// matches running sum style box filters which duplicate border values
+
+UL32 jhcIntegral::EdgeSum (int x0, int y0, int x1, int y1) const
+{
+  int cx0, cy0, cx1, cy1, lf, rt, bot, top, xe = iw - 1, ye = ih - 1;
+  UL32 sum;
+
+  clip_rect(cx0, cy0, cx1, cy1, x0, y0, x1, y1);
+  sum = RectSum(cx0, cy0, cx1, cy1);
+  if ((lf = cx0 - x0) > 0)
+    sum += lf * RectSum(0, cy0, 1, cy1);
+  if ((rt = x1 - cx1) > 0)
+    sum += rt * RectSum(xe, cy0, iw, cy1);
+  if ((bot = cy0 - y0) > 0)
+  {
+    sum += bot * RectSum(cx0, 0, cx1, 1);
+    sum += bot * (lf * RectSum(0, 0, 1, 1) + rt * RectSum(xe, 0, iw, 1));
+  }
+  if ((top = y1 - cy1) > 0)
+  {
+    sum += top * RectSum(cx0, ye, cx1, ih);
+    sum += top * (lf * RectSum(0, ye, 1, ih) + rt * RectSum(xe, ye, iw, ih));
+  }
+  return sum;
+}
+
+
+//= Sum of squared values in rectangle where parts outside ROI repeat the nearest edge pixel.
+// rectangle from (x0 y0) up to but not including (x1 y1) must overlap ROI
+
+unsigned __int64 jhcIntegral::EdgeSq (int x0, int y0, int x1, int y1) const
+{
+  int cx0, cy0, cx1, cy1, lf, rt, bot, top, xe = iw - 1, ye = ih - 1;
+  unsigned __int64 ssq;
+
+  clip_rect(cx0, cy0, cx1, cy1, x0, y0, x1, y1);
+  ssq = RectSq(cx0, cy0, cx1, cy1);
+  if ((lf = cx0 - x0) > 0)
+    ssq += lf * RectSq(0, cy0, 1, cy1);
+  if ((rt = x1 - cx1) > 0)
+    ssq += rt * RectSq(xe, cy0, iw, cy1);
+  if ((bot = cy0 - y0) > 0)
+  {
+    ssq += bot * RectSq(cx0, 0, cx1, 1);
+    ssq += bot * (lf * RectSq(0, 0, 1, 1) + rt * RectSq(xe, 0, iw, 1));
+  }
+  if ((top = y1 - cy1) > 0)
+  {
+    ssq += top * RectSq(cx0, ye, cx1, ih);
+    ssq += top * (lf * RectSq(0, ye, 1, ih) + rt * RectSq(xe, ye, iw, ih));
+  }
+  return ssq;
+}
+
+
+//= Restrict rectangle corners to lie within the area covered by tables.
+
+void jhcIntegral::clip_rect (int& cx0, int& cy0, int& cx1, int& cy1,
+                             int x0, int y0, int x1, int y1) const
+{
+  cx0 = __max(0, x0);
+  cy0 = __max(0, y0);
+  cx1 = __min(x1, iw);
+  cy1 = __min(y1, ih);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                           Table Construction                          //
+///////////////////////////////////////////////////////////////////////////
+
+//= Make sure tables are big enough for a ROI of the given size.
+// only reallocates if larger than before, returns 0 if failed
+
+int jhcIntegral::alloc_tabs (int w, int h, int sqr, int bg)
+{
+  int n = (w + 1) * (h + 1);
+
+  ln = w + 1;
+  if (n > n1)
+  {
+    delete [] s1;
+    s1 = new UL32 [n];
+    n1 = n;
+  }
+  if ((sqr > 0) && (n > n2))
+  {
+    delete [] s2;
+    s2 = new unsigned __int64 [n];
+    n2 = n;
+  }
+  if ((bg >= 0) && (n > nn))
+  {
+    delete [] nz;
+    nz = new UL32 [n];
+    nn = n;
+  }
+  if ((s1 == NULL) || ((sqr > 0) && (s2 == NULL)) || ((bg >= 0) && (nz == NULL)))
+    return 0;
+  return 1;
+}
+
+
+//= Running sums along each row of a horizontal band of the image.
+// source line y goes into table line y + 1 with first entry zero
+
+void jhcIntegral::row_sums (void *ctx, int band, int nb)
+{
+  jhcIntegral *me = (jhcIntegral *) ctx;
+  int x, y, v, w = me->iw, ln = me->ln;
+  int y0 = (band * me->ih) / nb, y1 = ((band + 1) * me->ih) / nb;
+  const UC8 *a = me->a0 + y0 * me->lsk;
+  UL32 *r = me->s1 + (y0 + 1) * ln, *c = me->nz + (y0 + 1) * ln;
+  unsigned __int64 *q = me->s2 + (y0 + 1) * ln;
+  UL32 sum, cnt;
+  unsigned __int64 ssq;
+
+  for (y = y0; y < y1; y++, a += me->lsk, r += ln, q += ln, c += ln)
+  {
+    // basic sums
+    sum = 0;
+    r[0] = 0;
+    for (x = 0; x < w; x++)
+    {
+      sum += a[x];
+      r[x + 1] = sum;
+    }
+
+    // squared values
+    if (me->sq > 0)
+    {
+      ssq = 0;
+      q[0] = 0;
+      for (x = 0; x < w; x++)
+      {
+        v = a[x];
+        ssq += v * v;
+        q[x + 1] = ssq;
+      }
+    }
+
+    // non-background counts
+    if (me->zbg >= 0)
+    {
+      cnt = 0;
+      c[0] = 0;
+      for (x = 0; x < w; x++)
+      {
+        if (a[x] != me->zbg)
+          cnt++;
+        c[x + 1] = cnt;
+      }
+    }
+  }
+}
+
+
+//= Accumulate row sums down a vertical strip of table columns.
+// inner loops run across the strip so they vectorize well
+
+void jhcIntegral::col_sums (void *ctx, int band, int nb)
+{
+  jhcIntegral *me = (jhcIntegral *) ctx;
+  int x, y, h = me->ih, ln = me->ln;
+  int x0 = 1 + (band * me->iw) / nb, x1 = 1 + ((band + 1) * me->iw) / nb;
+  UL32 *r, *c;
+  unsigned __int64 *q;
+
+  for (y = 2; y <= h; y++)
+  {
+    r = me->s1 + y * ln;
+    for (x = x0; x < x1; x++)
+      r[x] += r[x - ln];
+    if (me->sq > 0)
+    {
+      q = me->s2 + y * ln;
+      for (x = x0; x < x1; x++)
+        q[x] += q[x - ln];
+    }
+    if (me->zbg >= 0)
+    {
+      c = me->nz + y * ln;
+      for (x = x0; x < x1; x++)
+        c[x] += c[x - ln];
+    }
+  }
+}
+
@@ -0,0 +1,107 @@
+// jhcIntegral.h : summed area tables for fast box statistics
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCINTEGRAL_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCINTEGRAL_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"
+
+
+//= Summed area tables for fast box statistics.
+// holds sums of pixels, sums of squared pixels, and counts of non-background
+// pixels over the ROI of some 8 bit image so any rectangle takes O(1) time
+// table entry (x, y) covers all ROI pixels left of x and below y, so tables
+// are one bigger than ROI in each dimension with a zero first row and column
+// sums are 32 bits (ROI up to 16M pixels), squares are 64 bits
+// remembers which image (and image Stamp) it was built from to tell if stale
+// rows are done in bands on jhcBandPool then columns are done in strips
+
+class jhcIntegral
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  // tables
+  UL32 *s1, *nz;
+  unsigned __int64 *s2;
+  int n1, n2, nn, ln;
+
+  // description of source
+  const jhcImg *img;
+  UL32 stamp;
+  int rx, ry, iw, ih, sq, zbg;
+
+  // band processing
+  const UC8 *a0;
+  int lsk;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcIntegral ();
+  jhcIntegral ();
+  void Invalidate () {img = NULL;}   /** Force rebuild on next request. */
+
+  // main functions
+  int Build (const jhcImg& src, int sqr =0, int bg =-1);
+  int Cached (const jhcImg& src, int sqr =0, int bg =-1) const;
+  int XDim () const {return iw;}     /** Width of ROI covered.  */
+  int YDim () const {return ih;}     /** Height of ROI covered. */
+  int Line () const {return ln;}     /** Entries per table row. */
+
+  // raw table access
+  const UL32 *Sums (int y =0) const             {return(s1 + y * ln);}
+  const unsigned __int64 *Squares (int y =0) const {return(s2 + y * ln);}
+  const UL32 *Counts (int y =0) const           {return(nz + y * ln);}
+
+  // rectangle statistics
+  UL32 RectSum (int x0, int y0, int x1, int y1) const;
+  unsigned __int64 RectSq (int x0, int y0, int x1, int y1) const;
+  UL32 RectCnt (int x0, int y0, int x1, int y1) const;
+  UL32 EdgeSum (int x0, int y0, int x1, int y1) const;
+  unsigned __int64 EdgeSq (int x0, int y0, int x1, int y1) const;
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // main functions
+  void clip_rect (int& cx0, int& cy0, int& cx1, int& cy1,
+                  int x0, int y0, int x1, int y1) const;
+
+  // table construction
+  int alloc_tabs (int w, int h, int sqr, int bg);
+  static void row_sums (void *ctx, int band, int nb);
+  static void col_sums (void *ctx, int band, int nb);
+
+
+};
+
+
+#endif  // once
+
+
+
+
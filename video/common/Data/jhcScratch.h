@@ -0,0 +1,61 @@
+// jhcScratch.h : temporary image whose pixels are leased from shared pool
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCSCRATCH_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCSCRATCH_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"
+
+
+//= Temporary image whose pixels are leased from shared pool.
+// buffer is returned to jhcImgPool when variable goes out of scope
+// <pre>
+//   {
+//     jhcScratch tmp(src, 1);      // 64 byte aligned, usually recycled
+//     BoxAvg(tmp, src, 5);
+//     ...
+//   }                              // pixels handed back here
+// </pre>
+
+class jhcScratch : public jhcImg
+{
+// PUBLIC MEMBER FUNCTIONS
+public:
+  jhcScratch () 
+    {pool = 1;}
+  jhcScratch (int wd, int ht, int fields =1) 
+    {pool = 1; SetSize(wd, ht, fields);}
+  jhcScratch (const jhcImg& ref, int fields =0) 
+    {pool = 1; SetSize(ref, fields);}
+
+};
+
+
+#endif  // once
+
+
+
+
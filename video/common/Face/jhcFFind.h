@@ -38,7 +38,7 @@
 // <pre>
 // class tree and parameters:
 //
-//   Frontal         dps
+//   Frontal         dps kps
 //     +FFindOCV     fps
 //       FFind
 //
@@ -260,7 +260,7 @@ int jhcFFindOCV::ffind_roi (const unsigned char *img, int w, int h, int f,
   std::vector<cv::Rect> faces;
   cv::Mat gray;
   jhcRoi area;
-  int w0 = __max(wlim, wmin), w1 = ((wmax > 0) ? wmax : __min(w, h));
+  int w0 = __max(wlim, wmin), w1;
   int i, n;
 
   // check if cascade loaded then test arguments
@@ -271,6 +271,14 @@ int jhcFFindOCV::ffind_roi (const unsigned char *img, int w, int h, int f,
   area.SetRoi(rx, ry, rw, rh);
   area.RoiClip(w, h);
 
+  // no scales bigger than region searched
+  w1 = __min(area.RoiW(), area.RoiH());
+  if (wmax > 0)
+    w1 = __min(wmax, w1);
+  nface = 0;
+  if (w1 < w0)
+    return 0;
+
   // ingest jhcImg and crop to some subregion
   cv::Mat frame(h, w, CV_8UC3, (void *) img);
   cv::Rect r(area.RoiX(), area.RoiY(), area.RoiW(), area.RoiH());
@@ -40,6 +40,8 @@ jhcFRecoDLL::~jhcFRecoDLL ()
   freco_done();
   freco_cleanup();
   ClrDB();
+  delete [] hit;
+  delete [] ppl;
   delete probe;
 }
 
@@ -52,6 +54,12 @@ jhcFRecoDLL::jhcFRecoDLL ()
   strcpy_s(dir, "faces");
   db = NULL;
   vsz = 256;
+  ppl = NULL;
+  np = 0;
+  pmax = 0;
+  hit = NULL;
+  hsz = 0;
+  ranked = 0;
 
   // initialize DLL
   Defaults();
@@ -59,6 +67,7 @@ jhcFRecoDLL::jhcFRecoDLL ()
 
   // record proper sizes for things
   vsz = freco_vsize();
+  gal.SetSize(vsz);
   probe = new jhcFaceVect(vsz);
   (probe->thumb).SetSize(freco_mug_w(), freco_mug_h(), 3);
 
@@ -91,6 +100,23 @@ int jhcFRecoDLL::match_params (const char *fname)
 }
 
 
+//= Parameters used for fast searching of large databases.
+
+int jhcFRecoDLL::search_params (const char *fname)
+{
+  jhcParam *ps = &sps;
+  int ok;
+
+  ps->SetTag("freco_srch", 0);
+  ps->NextSpec4( &nx,            16,   "Exact distance shortlist");  
+  ps->NextSpec4( &(gal.big),   4000,   "Index above vects (0 = never)");
+  ps->NextSpec4( &(gal.probe),    8,   "Index clusters to check");
+  ok = ps->LoadDefs(fname);
+  ps->RevertAll();
+  return ok;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                           Parameter Bundles                           //
 ///////////////////////////////////////////////////////////////////////////
@@ -105,6 +131,7 @@ int jhcFRecoDLL::Defaults (const char *fname, int data)
     if (LoadDB() < 0)
       ok = 0;
   ok &= match_params(fname);
+  ok &= search_params(fname);
   ok &= freco_setup(fname);
   return ok;
 }
@@ -121,6 +148,7 @@ int jhcFRecoDLL::SaveVals (const char *fname, int data)
     if (SaveDB() < 0)
       ok = 0;
   ok &= mps.SaveVals(fname);
+  ok &= sps.SaveVals(fname);
   return ok;
 }
 
@@ -133,9 +161,7 @@ int jhcFRecoDLL::SaveVals (const char *fname, int data)
 
 void jhcFRecoDLL::Reset ()
 {
-  win = NULL;
-  best = NULL;
-  ranked = 0;
+  drop_hits();
   busy = 0;
 }
 
@@ -151,6 +177,9 @@ const jhcFaceVect *jhcFRecoDLL::Enroll (const char *name, const jhcImg& src, con
   const UC8 *s = src.PxlSrc();
   int lf, rt, bot, top, iw = src.XDim(), ih = src.YDim();
 
+  // old vectors might get removed
+  drop_hits();
+
   // get thumbnail for this face presentation
   v = new jhcFaceVect(vsz);
   (v->thumb).SetSize(freco_mug_w(), freco_mug_h(), 3);
@@ -175,6 +204,7 @@ const jhcFaceVect *jhcFRecoDLL::Enroll (const char *name, const jhcFaceVect *ref
   jhcFaceOwner *dude = get_person(name);
   jhcFaceVect *v = new jhcFaceVect(vsz);
 
+  drop_hits();
   v->Copy(ref);
   dude->AddVect(v, ((rem <= 0) ? 0 : vcnt));
   return v;
@@ -207,15 +237,38 @@ jhcFaceOwner *jhcFRecoDLL::get_person (const char *name)
   }
 
   // make new person and add to end of list 
-  dude = new jhcFaceOwner(name, vsz);
+  dude = new jhcFaceOwner(name, vsz, &gal, np);
   if (last == NULL)
     db = dude;
   else
     last->next = dude;
+  list_person(dude);
   return dude;
 }
 
 
+//= Remember person in table so owner of a search matrix row can be found.
+// assumes person was created with the current value of "np" as its index
+
+void jhcFRecoDLL::list_person (jhcFaceOwner *dude)
+{
+  jhcFaceOwner **p2;
+  int i;
+
+  // possibly enlarge table
+  if (np >= pmax)
+  {
+    pmax = __max(64, 2 * pmax);
+    p2 = new jhcFaceOwner * [pmax];
+    for (i = 0; i < np; i++)
+      p2[i] = ppl[i];
+    delete [] ppl;
+    ppl = p2;
+  }
+  ppl[np++] = dude;
+}
+
+
 //= Compare face in image to whole database and find best match.
 // use Name() and Distance() with choice rank for additional details 
 // returns 2 for sure, 1 for okay, 0 for poor or no match
@@ -271,46 +324,83 @@ int jhcFRecoDLL::Check ()
 
   
 //= Score every vector for every person.
+// quickly finds a shortlist of rows in the search matrix which are then
+// rescored with the DLL metric and sorted (guarantees enough for chk_sure)
 // marks highest and saves pointer to person and vector
 
 void jhcFRecoDLL::score_all (const double *query) 
 {
-  jhcFaceOwner *dude = NULL;
-  jhcFaceVect *v;
-  double dmin = -1.0;
+  int i, n;
 
   // set up default results (e.g. no database)
+  drop_hits();
+
+  // get true distances for most likely matches and sort them
+  n = gal.Search(query, __max(sure, nx));
+  for (i = 0; i < n; i++)
+    add_hit(gal.Top(i), query, 1);
+  if (ranked <= 0)
+    return;
+
+  // mark best choice (others get ranks as they are visited)
+  best = gal.Vect(hit[0]);
+  best->rank = 1;
+  win = ppl[gal.Owner(hit[0])];
+}
+
+
+//= Clear rank markings from last search and forget all results.
+// must be called before any vectors are added or removed
+
+void jhcFRecoDLL::drop_hits ()
+{
+  jhcFaceVect *v;
+  int i;
+
+  for (i = 0; i < ranked; i++)
+    if ((v = gal.Vect(hit[i])) != NULL)
+      v->rank = 0;
   win = NULL;
   best = NULL;
   ranked = 0;
+}
 
-  // scan through all people
-  while ((dude = NextDude(dude)) != NULL)
-  {
-    // scan through all vectors
-    v = NULL;
-    while ((v = dude->NextVect(v)) != NULL)
-    {
-      // save score but assume not best
-      v->dist = freco_dist(query, v->data);
-      v->rank = 0;
 
-      // see if best so far
-      if ((dmin < 0.0) || (v->dist < dmin))
-      {
-        win = dude;
-        best = v;
-        dmin = v->dist;
-      }
-    } 
-  }
+//= Find true distance for some search matrix row and add it to results.
+// if "sort" > 0 then inserts in order of distance, else just adds to end
+// returns associated vector (NULL if bad row)
 
-  // go back and mark best choice
-  if (best != NULL)
+jhcFaceVect *jhcFRecoDLL::add_hit (int r, const double *query, int sort)
+{
+  jhcFaceVect *v = gal.Vect(r);
+  int *h2;
+  int i;
+
+  if (v == NULL)
+    return NULL;
+
+  // possibly enlarge list
+  if (ranked >= hsz)
   {
-    best->rank = 1;
-    ranked = 1;
+    hsz = __max(32, 2 * hsz);
+    h2 = new int [hsz];
+    for (i = 0; i < ranked; i++)
+      h2[i] = hit[i];
+    delete [] hit;
+    hit = h2;
   }
+
+  // get real distance then find proper position
+  v->dist = freco_dist(query, v->data);
+  i = ranked++;
+  if (sort > 0)
+    while ((i > 0) && ((gal.Vect(hit[i - 1]))->dist > v->dist))
+    {
+      hit[i] = hit[i - 1];
+      i--;
+    }
+  hit[i] = r;
+  return v;
 }
 
 
@@ -427,50 +517,33 @@ const jhcImg *jhcFRecoDLL::Mugshot (int i)
 
 
 //= Lookup or search for Nth best match and return vector with name.
+// ranks beyond the shortlist come from the next most likely matrix rows
 // returns NULL if nothing found
 
 jhcFaceVect *jhcFRecoDLL::mark_rank (const char **name, int i)
 {
-  jhcFaceOwner *dude;
-  jhcFaceVect *top, *v;
-  double low;
+  jhcFaceVect *v;
+  int j, r, n = __min(i, ranked - 1);
 
-  // see if ranking already done
+  // see if any ranking done
   if (ranked <= 0)
     return NULL;
+
+  // mark sorted choices up through this one as they get visited
+  for (j = 1; j <= n; j++)
+    (gal.Vect(hit[j]))->rank = j + 1;
   if (i < ranked)
     return find_rank(name, i);
 
-  // rank some more choices
+  // rank some more choices (always for probe vector)
   while (ranked <= i)
   {
-    // initialize search for this rank level
-    top = NULL;
-    *name = NULL;
-    low = -1.0;
-
-    // scan through vectors for next best match
-    dude = NULL;
-    while ((dude = NextDude(dude)) != NULL)
-    {
-      v = NULL;
-      while ((v = dude->NextVect(v)) != NULL)
-        if (v->rank <= 0)
-          if ((low < 0.0) || (v->dist < low))
-          {
-            // remember best unranked one
-            top = v;
-            low = v->dist;
-            *name = dude->Who();
-          }
-    }
-
-    // go back and mark this instance (for later use)
-    if (top == NULL)
-      break;
-    top->rank = ++ranked;    // mark with 1 higher than search
+    if ((r = gal.Next()) < 0)
+      return NULL;
+    v = add_hit(r, probe->data, 0);
+    v->rank = ranked;
   }
-  return top;                // name should already have been set
+  return find_rank(name, i);
 }
 
 
@@ -480,29 +553,10 @@ jhcFaceVect *jhcFRecoDLL::mark_rank (const char **name, int i)
 
 jhcFaceVect *jhcFRecoDLL::find_rank (const char **name, int i) const
 {
-  jhcFaceOwner *dude = NULL;
-  jhcFaceVect *v;
-  int ri = i + 1;            // marked as 1 higher than search
-
-  // check simplest case of topmost match
-  if (i <= 0)
-  {
-    *name = ((win != NULL) ? win->Who() : NULL);
-    return best;
-  }
+  int r = hit[__max(0, i)];
 
-  // seach for desired rank
-  while ((dude = NextDude(dude)) != NULL)
-  {
-    v = NULL;
-    while ((v = dude->NextVect(v)) != NULL)
-      if (v->rank == ri)
-      {
-        *name = dude->Who();
-        return v;
-      }
-  }
-  return NULL;               // should never get here
+  *name = ppl[gal.Owner(r)]->Who();
+  return gal.Vect(r);
 }
 
 
@@ -545,15 +599,18 @@ void jhcFRecoDLL::ClrDB ()
 {
   jhcFaceOwner *rest, *dude = db;
 
+  drop_hits();
   if (db == NULL)
     return;
   while (dude != NULL)
   {
     rest = dude->next;
-    delete dude;
+    delete dude;                       // also removes matrix rows
     dude = rest;
   }
   db = NULL;
+  np = 0;
+  gal.Clear();
 }
 
 
@@ -587,6 +644,7 @@ int jhcFRecoDLL::LoadDB (const char *fname, int append)
   int n, cnt = 0;
 
   // possibly erase old data then try opening names file
+  drop_hits();
   if (append <= 0)
     ClrDB();
   if (fname == NULL)
@@ -607,7 +665,7 @@ int jhcFRecoDLL::LoadDB (const char *fname, int append)
         // try to load data for person (initializes vectors)
         if (line[n - 1] == '\n')
           line[n - 1] = '\0';
-        dude = new jhcFaceOwner(line, vsz);
+        dude = new jhcFaceOwner(line, vsz, &gal, np);
         if (dude->Load(dir) < 0)
         {
           delete dude;
@@ -631,6 +689,7 @@ int jhcFRecoDLL::LoadDB (const char *fname, int append)
         else
           last->next = dude;
         last = dude;
+        list_person(dude);
         cnt++;
       }
 
@@ -30,12 +30,15 @@
 #include "Data/jhcImg.h"
 #include "Data/jhcImgIO.h"
 #include "Data/jhcParam.h"
+#include "Face/jhcFaceGallery.h"
 #include "Face/jhcFaceOwner.h"
 
 #include "Face/freco_nkr.h"       // generic fcns but specific lib file
 
 
 //= Holds gallery of faces and matches probe image to them.
+// all vectors are also kept in a contiguous matrix (jhcFaceGallery) which is
+// searched quickly to get a shortlist that is then rescored using the DLL
 // NOTE: file "freco_nkr.wts" must be in executable directory
 
 class jhcFRecoDLL : private jhcImgIO
@@ -50,6 +53,11 @@ private:
   jhcFaceOwner *db;
   int vsz;
 
+  // fast search matrix and owner for each index
+  jhcFaceGallery gal;
+  jhcFaceOwner **ppl;
+  int np, pmax;
+
   // pending background operation
   jhcFaceVect *probe;
   int busy;
@@ -57,7 +65,8 @@ private:
   // status and results
   const jhcFaceOwner *win;
   jhcFaceVect *best;
-  int verdict, ranked;
+  int *hit;
+  int verdict, ranked, hsz;
 
 
 // PUBLIC MEMBER VARIABLES
@@ -67,6 +76,10 @@ public:
   int sure, vcnt, boost, ucap;
   double mth;
 
+  // search parameters
+  jhcParam sps;
+  int nx;
+
 
 // PUBLIC MEMBER FUNCTIONS
 public:
@@ -114,10 +127,14 @@ public:
 private:
   // processing parameters
   int match_params (const char *fname);
+  int search_params (const char *fname);
 
   // main functions
   jhcFaceOwner *get_person (const char *name);
+  void list_person (jhcFaceOwner *dude);
   void score_all (const double *query);
+  void drop_hits ();
+  jhcFaceVect *add_hit (int r, const double *query, int sort);
   int chk_sure ();
 
   // result browsing
@@ -37,7 +37,11 @@
 jhcFRecoLBP::jhcFRecoLBP ()
 {
   // current code version
-  ver = 1.00;
+  ver = 1.10;
+
+  // no arrays yet
+  lab = NULL;
+  np = 0;
 
   // set processing parameters
   Defaults();
@@ -48,6 +52,16 @@ jhcFRecoLBP::jhcFRecoLBP ()
 
 jhcFRecoLBP::~jhcFRecoLBP ()
 {
+  dealloc();
+}
+
+
+//= Get rid of pattern label table.
+
+void jhcFRecoLBP::dealloc ()
+{
+  delete [] lab;
+  lab = NULL;
 }
 
 
@@ -80,7 +94,8 @@ int jhcFRecoLBP::SaveVals (const char *fname) const
 }
 
 
-//= Parameters used for something.
+//= Parameters used for computing LBP face representation vector.
+// SetSizes should be called any time basic parameters change
 
 int jhcFRecoLBP::lbp_params (const char *fname)
 {
@@ -90,7 +105,7 @@ int jhcFRecoLBP::lbp_params (const char *fname)
   ps->SetTag("face_lbp", 0);
   ps->NextSpec4( &radius,  1, "LBP radius (pels)");  
   ps->NextSpec4( &pts,     8, "LBP sampling pts");  
-  ps->NextSpec4( &uni,     0, "Drop uniform patterns");  
+  ps->NextSpec4( &uni,     1, "Only uniform patterns");  
   ps->Skip();
   ps->NextSpec4( &xgrid,   5, "Face X grid divisions");  
   ps->NextSpec4( &ygrid,   9, "Face Y grid divisions");  
@@ -105,9 +120,102 @@ int jhcFRecoLBP::lbp_params (const char *fname)
 
 void jhcFRecoLBP::SetSizes ()
 {
-  nlbp = (int) pow(2.0, pts);
-  hsz = xgrid * ygrid * nlbp;
+  int n;
+
+  // icon and code image dimensions
   jhcFaceNorm::SetSizes();
+  np = __max(1, __min(pts, pmax));
+  rad = __max(1, radius);
+  ln = ((iw + 3) >> 2) << 2;
+  lw = __max(0, iw - 2 * rad);
+  lh = __max(0, ih - 2 * rad);
+  cw = lw / __max(1, xgrid);
+  ch = lh / __max(1, ygrid);
+
+  // number of distinct labels and signature length
+  n = 1 << np;
+  nlbp = ((uni > 0) ? np * (np - 1) + 3 : n);
+  hsz = xgrid * ygrid * nlbp;
+
+  // make up tables
+  dealloc();
+  lab = new UC8 [n];
+  samp_pts();
+  uni_labels();
+}
+
+
+//= Find pixel offsets and fixed point weights for interpolating circle samples.
+// point n is at angle 2 pi n / np going from straight down toward left
+// notes whether sample falls exactly on a pixel (only first weight used)
+
+void jhcFRecoLBP::samp_pts ()
+{
+  double ang, x, y, tx, ty, tiny = 1e-6;
+  int n, fx, fy, cx, cy;
+
+  for (n = 0; n < np; n++)
+  {
+    // sample position and surrounding pixels
+    ang = 2.0 * PI * n / np;
+    x = -rad * sin(ang);
+    y =  rad * cos(ang);
+    if (fabs(x - ROUND(x)) < tiny)
+      x = ROUND(x);
+    if (fabs(y - ROUND(y)) < tiny)
+      y = ROUND(y);
+    fx = (int) floor(x);
+    fy = (int) floor(y);
+    cx = (int) ceil(x);
+    cy = (int) ceil(y);
+    off[n][0] = fy * ln + fx;
+    off[n][1] = fy * ln + cx;
+    off[n][2] = cy * ln + fx;
+    off[n][3] = cy * ln + cx;
+
+    // bilinear mixing weights (sum to 256)
+    tx = x - fx;
+    ty = y - fy;
+    wt[n][1] = ROUND(256.0 * tx * (1.0 - ty));
+    wt[n][2] = ROUND(256.0 * (1.0 - tx) * ty);
+    wt[n][3] = ROUND(256.0 * tx * ty);
+    wt[n][0] = 256 - wt[n][1] - wt[n][2] - wt[n][3];
+    exact[n] = ((wt[n][0] == 256) ? 1 : 0);
+  }
+}
+
+
+//= Assign histogram bin to every raw code.
+// uniform codes get consecutive bins, all others share the last bin
+
+void jhcFRecoLBP::uni_labels ()
+{
+  int i, n = 1 << np, cnt = 0;
+
+  if (uni <= 0)
+    return;
+  for (i = 0; i < n; i++)
+    if (transitions(i) <= 2)
+      lab[i] = (UC8) cnt++;
+    else
+      lab[i] = (UC8)(nlbp - 1);
+}
+
+
+//= Count number of bit changes going once around a circular code.
+
+int jhcFRecoLBP::transitions (int code) const
+{
+  int i, b, last = (code >> (np - 1)) & 0x01, cnt = 0;
+
+  for (i = 0; i < np; i++)
+  {
+    b = (code >> i) & 0x01;
+    if (b != last)
+      cnt++;
+    last = b;
+  }
+  return cnt;
 }
 
 
@@ -127,20 +235,133 @@ const char *jhcFRecoLBP::freco_version (char *spec, int ssz) const
 
 //= Computes a signature vector given a cropped grayscale face image.
 // image is 8 bit gray scanned left-to-right, bottom up
+// code image is local so several threads can compute signatures at once
 // returns negative for error, else vector size
 
 int jhcFRecoLBP::freco_vect (float *hist, const unsigned char *img) const
 {
-
+  US16 *codes;
+
+  if ((hist == NULL) || (img == NULL) || (lab == NULL))
+    return -1;
+  if ((cw <= 0) || (ch <= 0))
+    return -1;
+  codes = new US16 [lw * lh];
+  lbp_codes(codes, img);
+  cell_hists(hist, codes);
+  delete [] codes;
   return hsz;
 }
 
 
+//= Find local binary pattern code for every pixel away from icon border.
+// handles one neighbor at a time across a whole line so inner loops are simple
+// a neighbor sets its bit if interpolated value is at least as big as center
+
+void jhcFRecoLBP::lbp_codes (US16 *codes, const UC8 *img) const
+{
+  const UC8 *c, *a, *b, *d, *e;
+  US16 *code;
+  int x, y, n, w0, w1, w2, w3;
+  US16 bit;
+
+  for (y = 0; y < lh; y++)
+  {
+    c = img + (y + rad) * ln + rad;
+    code = codes + y * lw;
+    for (x = 0; x < lw; x++)
+      code[x] = 0;
+
+    // compare against each neighbor in turn
+    for (n = 0; n < np; n++)
+    {
+      bit = (US16)(0x01 << n);
+      a = c + off[n][0];
+      if (exact[n] > 0)
+      {
+        for (x = 0; x < lw; x++)
+          code[x] |= ((a[x] >= c[x]) ? bit : 0);
+        continue;
+      }
+      b = c + off[n][1];
+      d = c + off[n][2];
+      e = c + off[n][3];
+      w0 = wt[n][0];
+      w1 = wt[n][1];
+      w2 = wt[n][2];
+      w3 = wt[n][3];
+      for (x = 0; x < lw; x++)
+        code[x] |= (((w0 * a[x] + w1 * b[x] + w2 * d[x] + w3 * e[x]) >= (c[x] << 8)) ? bit : 0);
+    }
+
+    // possibly collapse to uniform patterns
+    if (uni > 0)
+      for (x = 0; x < lw; x++)
+        code[x] = lab[code[x]];
+  }
+}
+
+
+//= Build normalized code histogram for each cell of grid over code image.
+// cells go left to right then up, each histogram sums to one
+// counts are exact as floats since cells have far fewer than 2^24 pixels
+
+void jhcFRecoLBP::cell_hists (float *hist, const US16 *codes) const
+{
+  const US16 *code;
+  float *h = hist;
+  float norm = (float)(1.0 / (cw * ch));
+  int i, j, x, y, k;
+
+  for (i = 0; i < ygrid; i++)
+    for (j = 0; j < xgrid; j++, h += nlbp)
+    {
+      // count codes in cell
+      for (k = 0; k < nlbp; k++)
+        h[k] = 0.0f;
+      for (y = i * ch; y < (i + 1) * ch; y++)
+      {
+        code = codes + y * lw + j * cw;
+        for (x = 0; x < cw; x++)
+          h[code[x]] += 1.0f;
+      }
+
+      // convert to fractions
+      for (k = 0; k < nlbp; k++)
+        h[k] *= norm;
+    }
+}
+
+
 //= Computes a distance between two signature vectors (small is good).
+// uses symmetric chi-squared: 2 * sum[ (p - g)^2 / (p + g) ]
+// four partial sums and no branches so compiler can vectorize it
 // assumes signatures are both of correct length
 
 double jhcFRecoLBP::freco_dist (const float *probe, const float *gallery) const
 {
-
-  return 0.0;
+  float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f, d0, d1, d2, d3, tiny = 1e-20f;
+  int i, n4 = hsz & ~0x03;
+
+  if ((probe == NULL) || (gallery == NULL))
+    return -1.0;
+
+  // bins where both are zero contribute nothing
+  for (i = 0; i < n4; i += 4)
+  {
+    d0 = probe[i]     - gallery[i];
+    d1 = probe[i + 1] - gallery[i + 1];
+    d2 = probe[i + 2] - gallery[i + 2];
+    d3 = probe[i + 3] - gallery[i + 3];
+    s0 += d0 * d0 / (probe[i]     + gallery[i]     + tiny);
+    s1 += d1 * d1 / (probe[i + 1] + gallery[i + 1] + tiny);
+    s2 += d2 * d2 / (probe[i + 2] + gallery[i + 2] + tiny);
+    s3 += d3 * d3 / (probe[i + 3] + gallery[i + 3] + tiny);
+  }
+  for (i = n4; i < hsz; i++)
+  {
+    d0 = probe[i] - gallery[i];
+    s0 += d0 * d0 / (probe[i] + gallery[i] + tiny);
+  }
+  return(2.0 * ((s0 + s1) + (s2 + s3)));
 }
\ No newline at end of file
@@ -33,13 +33,27 @@
 
 
 //= Face recognition based on uniform local binary patterns.
+// needs no external libraries, same basic method as jhcFRecoOCV
+// codes come from interpolated samples on a circle around each pixel
+// and are optionally collapsed to uniform patterns (at most 2 transitions)
+// signature is normalized code histograms over a grid of icon cells
+// compared with a symmetric chi-squared distance
 
 class jhcFRecoLBP : public jhcFaceNorm
 {
 // PRIVATE MEMBER VARIABLES
 private:
+  static const int pmax = 16;          /** Maximum number of sample points. */
+
+  // sizes
   double ver;
-  int nlbp, hsz;
+  int nlbp, hsz, np, rad, ln, lw, lh, cw, ch;
+
+  // neighbor sampling
+  int off[pmax][4], wt[pmax][4], exact[pmax];
+
+  // pattern labels
+  UC8 *lab;
 
 
 // PUBLIC MEMBER VARIABLES
@@ -82,7 +96,17 @@ public:
 
 // PRIVATE MEMBER FUNCTIONS
 private:
+  // creation and configuration
+  void dealloc ();
   int lbp_params (const char *fname);
+  void samp_pts ();
+  void uni_labels ();
+  int transitions (int code) const;
+
+  // signature functions
+  void lbp_codes (US16 *codes, const UC8 *img) const;
+  void cell_hists (float *hist, const US16 *codes) const;
+
 
 };
 
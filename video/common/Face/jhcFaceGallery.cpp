@@ -0,0 +1,559 @@
+// jhcFaceGallery.cpp : contiguous matrix of face signatures for fast search
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <string.h>
+
+#include "Interface/jhcBandPool.h"
+
+#include "Face/jhcFaceGallery.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcFaceGallery::~jhcFaceGallery ()
+{
+  dealloc();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcFaceGallery::jhcFaceGallery (int sz)
+{
+  // no storage yet
+  mat = NULL;
+  mu = NULL;
+  sdi = NULL;
+  sc = NULL;
+  src = NULL;
+  own = NULL;
+  lab = NULL;
+  q = NULL;
+  cent = NULL;
+  top = NULL;
+  nmax = 0;
+  tmax = 0;
+
+  // default index parameters
+  big = 4000;
+  probe = 8;
+  SetSize(sz);
+}
+
+
+//= Get rid of all rows and the query buffer.
+
+void jhcFaceGallery::dealloc ()
+{
+  delete [] top;
+  delete [] cent;
+  delete [] q;
+  delete [] lab;
+  delete [] own;
+  delete [] src;
+  delete [] sc;
+  delete [] sdi;
+  delete [] mu;
+  delete [] mat;
+  mat = NULL;
+  mu = NULL;
+  sdi = NULL;
+  sc = NULL;
+  src = NULL;
+  own = NULL;
+  lab = NULL;
+  q = NULL;
+  cent = NULL;
+  top = NULL;
+  nmax = 0;
+  tmax = 0;
+  n = 0;
+  nc = 0;
+  nbuilt = 0;
+  ntop = 0;
+}
+
+
+//= Set the length of signature vectors (erases any current rows).
+
+void jhcFaceGallery::SetSize (int sz)
+{
+  dealloc();
+  vsz = __max(1, sz);
+  q = new float [vsz];
+  qm = 0.0f;
+  qsdi = 0.0f;
+}
+
+
+//= Double the number of rows that can be held.
+
+void jhcFaceGallery::grow ()
+{
+  float *m2, *mu2, *sdi2, *sc2;
+  jhcFaceVect **src2;
+  int *own2, *lab2;
+  int n2 = __max(256, 2 * nmax);
+
+  // make bigger arrays
+  m2   = new float [n2 * vsz];
+  mu2  = new float [n2];
+  sdi2 = new float [n2];
+  sc2  = new float [n2];
+  src2 = new jhcFaceVect * [n2];
+  own2 = new int [n2];
+  lab2 = new int [n2];
+
+  // copy current rows
+  if (n > 0)
+  {
+    memcpy(m2, mat, n * vsz * sizeof(float));
+    memcpy(mu2, mu, n * sizeof(float));
+    memcpy(sdi2, sdi, n * sizeof(float));
+    memcpy(sc2, sc, n * sizeof(float));
+    memcpy(src2, src, n * sizeof(jhcFaceVect *));
+    memcpy(own2, own, n * sizeof(int));
+    memcpy(lab2, lab, n * sizeof(int));
+  }
+
+  // swap in new arrays
+  delete [] lab;
+  delete [] own;
+  delete [] src;
+  delete [] sc;
+  delete [] sdi;
+  delete [] mu;
+  delete [] mat;
+  mat = m2;
+  mu  = mu2;
+  sdi = sdi2;
+  sc  = sc2;
+  src = src2;
+  own = own2;
+  lab = lab2;
+  nmax = n2;
+}
+
+
+//= Convert a signature to unit length floats for a dot product cosine.
+// also gets mean of elements "m" and inverse length "si" after mean removal
+// these let the correlation be found from the same dot product later
+
+void jhcFaceGallery::unit_vect (float *dest, float& m, float& si, const double *v) const
+{
+  double d, f, sum = 0.0, avg = 0.0, var = 0.0;
+  int i;
+
+  // scale to unit length
+  for (i = 0; i < vsz; i++)
+    sum += v[i] * v[i];
+  f = ((sum > 0.0) ? 1.0 / sqrt(sum) : 0.0);
+  for (i = 0; i < vsz; i++)
+  {
+    dest[i] = (float)(f * v[i]);
+    avg += dest[i];
+  }
+
+  // get statistics for correlation
+  avg /= vsz;
+  for (i = 0; i < vsz; i++)
+  {
+    d = dest[i] - avg;
+    var += d * d;
+  }
+  m = (float) avg;
+  si = (float)((var > 1e-12) ? 1.0 / sqrt(var) : 0.0);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Gallery Contents                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Forget all rows but keep storage and query size.
+// detaches all vectors so they must still exist
+
+void jhcFaceGallery::Clear ()
+{
+  int r;
+
+  for (r = 0; r < n; r++)
+    src[r]->slot = -1;
+  n = 0;
+  nc = 0;
+  nbuilt = 0;
+  ntop = 0;
+}
+
+
+//= Append a row for some face vector belonging to owner number "who".
+// records row in vector's "slot" variable (does nothing if already there)
+// returns row number, negative for problem
+
+int jhcFaceGallery::Add (jhcFaceVect *v, int who)
+{
+  int r;
+
+  if (v == NULL)
+    return -1;
+  if ((v->slot >= 0) && (v->slot < n) && (src[v->slot] == v))
+    return v->slot;
+
+  // make normalized copy of signature
+  if (n >= nmax)
+    grow();
+  r = n++;
+  unit_vect(mat + r * vsz, mu[r], sdi[r], v->data);
+
+  // fill in other columns
+  src[r] = v;
+  own[r] = who;
+  sc[r] = 2.0f;                                  // not scored
+  lab[r] = ((nc > 0) ? nearest(mat + r * vsz) : 0);
+  v->slot = r;
+  return r;
+}
+
+
+//= Remove the row associated with some face vector.
+// moves last row into the vacated spot (and updates its vector)
+// invalidates any current shortlist since row numbers change
+
+void jhcFaceGallery::Remove (jhcFaceVect *v)
+{
+  int r, last = n - 1;
+
+  if (v == NULL)
+    return;
+  r = v->slot;
+  if ((r < 0) || (r >= n) || (src[r] != v))
+    return;
+
+  // fill hole with final row
+  if (r != last)
+  {
+    memcpy(mat + r * vsz, mat + last * vsz, vsz * sizeof(float));
+    mu[r]  = mu[last];
+    sdi[r] = sdi[last];
+    sc[r]  = sc[last];
+    src[r] = src[last];
+    own[r] = own[last];
+    lab[r] = lab[last];
+    src[r]->slot = r;
+  }
+
+  // shrink matrix
+  v->slot = -1;
+  ntop = 0;
+  n--;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Score all rows against a query signature and find the k most similar.
+// score is average of cosine distance and correlation distance (0 to 1)
+// only rows in nearby clusters are scored if gallery is big enough for index
+// use Top to get shortlisted rows (best first) and Next for more after these
+// returns number of rows in shortlist
+
+int jhcFaceGallery::Search (const double *query, int k)
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+
+  // check for empty gallery
+  ntop = 0;
+  if ((query == NULL) || (n <= 0) || (k <= 0))
+    return 0;
+
+  // possibly make or refresh approximate index
+  if ((big <= 0) || (n < big))
+    nc = 0;
+  else if ((nc <= 0) || (n > 2 * nbuilt) || ((2 * n) < nbuilt))
+    build_index();
+
+  // normalize query then score selected rows
+  unit_vect(q, qm, qsdi, query);
+  qm *= vsz;
+  pick_clusters();
+  bp->Run(score_rows, this, bp->Bands(n, 64));
+  shortlist(k);
+  return ntop;
+}
+
+
+//= Mark which clusters of the approximate index should be scored.
+
+void jhcFaceGallery::pick_clusters ()
+{
+  float hi = 0.0f;
+  int i, c, win, np = __min(probe, nc);
+
+  if (nc <= 0)
+    return;
+
+  // get similarity of query to each cluster center
+  for (c = 0; c < nc; c++)
+  {
+    cdot[c] = dot(q, cent + c * vsz);
+    use[c] = 0;
+  }
+
+  // select several most similar clusters
+  for (i = __max(1, np); i > 0; i--)
+  {
+    win = -1;
+    for (c = 0; c < nc; c++)
+      if (use[c] <= 0)
+        if ((win < 0) || (cdot[c] > hi))
+        {
+          win = c;
+          hi = cdot[c];
+        }
+    if (win < 0)
+      break;
+    use[win] = 1;
+  }
+}
+
+
+//= Compute the distance to the query for a band of rows.
+// uses only the dot product of unit vectors plus precomputed row statistics
+// rows in unselected index clusters are marked as unscored (2.0)
+
+void jhcFaceGallery::score_rows (void *ctx, int band, int nb)
+{
+  const jhcFaceGallery *me = (const jhcFaceGallery *) ctx;
+  const float *m = me->mat, *mu = me->mu, *sdi = me->sdi;
+  const int *lab = me->lab, *use = me->use;
+  float *sc = me->sc;
+  float d, qm = me->qm, qsdi = me->qsdi;
+  int r, vsz = me->vsz, idx = me->nc;
+  int r0 = (band * me->n) / nb, r1 = ((band + 1) * me->n) / nb;
+
+  for (r = r0; r < r1; r++)
+  {
+    if ((idx > 0) && (use[lab[r]] <= 0))
+    {
+      sc[r] = 2.0f;
+      continue;
+    }
+    d = me->dot(me->q, m + r * vsz);
+    sc[r] = 0.25f * (2.0f - d - (d - qm * mu[r]) * qsdi * sdi[r]);
+  }
+}
+
+
+//= Find k lowest scoring rows and sort them from best to worst.
+// marks these rows as taken (3.0) so Next skips them
+
+void jhcFaceGallery::shortlist (int k)
+{
+  float s;
+  int r, i;
+
+  // make sure list is big enough
+  if (k > tmax)
+  {
+    delete [] top;
+    top = new int [k];
+    tmax = k;
+  }
+
+  // insert rows better than current k'th best
+  ntop = 0;
+  for (r = 0; r < n; r++)
+  {
+    s = sc[r];
+    if (s >= 1.5f)
+      continue;
+    if ((ntop >= k) && (s >= sc[top[ntop - 1]]))
+      continue;
+    i = ((ntop < k) ? ntop++ : ntop - 1);
+    while ((i > 0) && (sc[top[i - 1]] > s))
+    {
+      top[i] = top[i - 1];
+      i--;
+    }
+    top[i] = r;
+  }
+
+  // remove from further consideration
+  for (i = 0; i < ntop; i++)
+    sc[top[i]] = 3.0f;
+}
+
+
+//= Get the best scoring row from last search not already returned.
+// used to extend the ranking beyond the shortlist (slow)
+// returns row number, negative if no more candidates
+
+int jhcFaceGallery::Next ()
+{
+  float low = 1.5f;
+  int r, win = -1;
+
+  for (r = 0; r < n; r++)
+    if (sc[r] < low)
+    {
+      win = r;
+      low = sc[r];
+    }
+  if (win >= 0)
+    sc[win] = 3.0f;
+  return win;
+}
+
+
+//= Dot product of two signature length float vectors.
+// several partial sums allow compiler to use vector instructions
+
+float jhcFaceGallery::dot (const float *a, const float *b) const
+{
+  float s0 = 0.0f, s1 = 0.0f, s2 = 0.0f, s3 = 0.0f;
+  int i, n4 = vsz & ~0x03;
+
+  for (i = 0; i < n4; i += 4)
+  {
+    s0 += a[i]     * b[i];
+    s1 += a[i + 1] * b[i + 1];
+    s2 += a[i + 2] * b[i + 2];
+    s3 += a[i + 3] * b[i + 3];
+  }
+  for (; i < vsz; i++)
+    s0 += a[i] * b[i];
+  return((s0 + s1) + (s2 + s3));
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                           Approximate Index                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Group rows into about sqrt(n) clusters using a few rounds of k-means.
+// clusters are seeded with evenly spaced rows so results are repeatable
+// later additions just join the nearest cluster until the gallery doubles
+
+void jhcFaceGallery::build_index ()
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+  int c, i;
+
+  // pick number of clusters and seed centers
+  nc = __max(1, __min(ROUND(sqrt((double) n)), cmax));
+  if (cent == NULL)
+    cent = new float [cmax * vsz];
+  for (c = 0; c < nc; c++)
+    memcpy(cent + c * vsz, mat + ((c * n) / nc) * vsz, vsz * sizeof(float));
+
+  // alternately label rows and recompute centers
+  for (i = 0; i < 4; i++)
+  {
+    bp->Run(label_rows, this, bp->Bands(n, 64));
+    fit_centers();
+  }
+  bp->Run(label_rows, this, bp->Bands(n, 64));
+  nbuilt = n;
+}
+
+
+//= Set each cluster center to the normalized average of its rows.
+// clusters with no rows keep their old center
+
+void jhcFaceGallery::fit_centers ()
+{
+  float *acc = new float [nc * vsz];
+  int cnt[cmax];
+  const float *m;
+  float *a;
+  double sum;
+  float f;
+  int r, c, i;
+
+  // sum up rows in each cluster
+  memset(acc, 0, nc * vsz * sizeof(float));
+  for (c = 0; c < nc; c++)
+    cnt[c] = 0;
+  for (r = 0; r < n; r++)
+  {
+    a = acc + lab[r] * vsz;
+    m = mat + r * vsz;
+    for (i = 0; i < vsz; i++)
+      a[i] += m[i];
+    cnt[lab[r]] += 1;
+  }
+
+  // scale to unit length
+  for (c = 0; c < nc; c++)
+    if (cnt[c] > 0)
+    {
+      a = acc + c * vsz;
+      sum = dot(a, a);
+      if (sum <= 0.0)
+        continue;
+      f = (float)(1.0 / sqrt(sum));
+      for (i = 0; i < vsz; i++)
+        cent[c * vsz + i] = f * a[i];
+    }
+  delete [] acc;
+}
+
+
+//= Find the index cluster whose center is most similar to some row.
+
+int jhcFaceGallery::nearest (const float *row) const
+{
+  float d, hi = 0.0f;
+  int c, win = 0;
+
+  for (c = 0; c < nc; c++)
+  {
+    d = dot(row, cent + c * vsz);
+    if ((c == 0) || (d > hi))
+    {
+      win = c;
+      hi = d;
+    }
+  }
+  return win;
+}
+
+
+//= Assign each row in a band to its nearest index cluster.
+
+void jhcFaceGallery::label_rows (void *ctx, int band, int nb)
+{
+  jhcFaceGallery *me = (jhcFaceGallery *) ctx;
+  int r, r0 = (band * me->n) / nb, r1 = ((band + 1) * me->n) / nb;
+
+  for (r = r0; r < r1; r++)
+    me->lab[r] = me->nearest(me->mat + r * me->vsz);
+}
+
+
@@ -0,0 +1,136 @@
+// jhcFaceGallery.h : contiguous matrix of face signatures for fast search
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCFACEGALLERY_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCFACEGALLERY_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Face/jhcFaceVect.h"
+
+
+//= Contiguous matrix of face signatures for fast search.
+// each jhcFaceVect also gets a row here holding a unit length float copy
+// of its signature plus columns for element mean, owner index, etc.
+// Search scores all rows in one pass (in parallel bands) with a cosine
+// and correlation measure then keeps the k best rows as a shortlist
+// caller should rescore the shortlist with the true metric if needed
+// rows are removed by moving the last row into the hole (order changes)
+// for large galleries an approximate index of signature clusters can be
+// built so only rows in the "probe" clusters nearest the query are scored
+// <pre>
+// typical use:
+//
+//   gal.Add(v, person);
+//   ...
+//   n = gal.Search(query, 8);
+//   for (i = 0; i < n; i++)
+//     r = gal.Top(i);          // gal.Vect(r) and gal.Owner(r) give details
+// </pre>
+
+class jhcFaceGallery
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  static const int cmax = 256;         /** Maximum number of index clusters. */
+
+  // signature matrix and extra columns
+  float *mat, *mu, *sdi, *sc;
+  jhcFaceVect **src;
+  int *own, *lab;
+  int vsz, n, nmax;
+
+  // normalized query
+  float *q;
+  float qm, qsdi;
+
+  // approximate index
+  float *cent;
+  float cdot[cmax];
+  int use[cmax];
+  int nc, nbuilt;
+
+  // shortlist
+  int *top;
+  int ntop, tmax;
+
+
+// PUBLIC MEMBER VARIABLES
+public:
+  int big;       /** Build index when at least this many rows (0 = never). */
+  int probe;     /** Number of index clusters searched for each query.     */
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcFaceGallery ();
+  jhcFaceGallery (int sz =256);
+  void SetSize (int sz);
+  int Rows () const {return n;}                    /** Number of signatures stored.     */
+  int Clusters () const {return nc;}               /** Size of index (0 if none).       */
+
+  // gallery contents
+  void Clear ();
+  int Add (jhcFaceVect *v, int who);
+  void Remove (jhcFaceVect *v);
+
+  // main functions
+  int Search (const double *query, int k);
+  int Next ();
+  int Top (int i) const {return(((i < 0) || (i >= ntop)) ? -1 : top[i]);}
+  jhcFaceVect *Vect (int r) const {return(((r < 0) || (r >= n)) ? NULL : src[r]);}
+  int Owner (int r) const {return(((r < 0) || (r >= n)) ? -1 : own[r]);}
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  void dealloc ();
+  void grow ();
+  void unit_vect (float *dest, float& m, float& si, const double *v) const;
+
+  // main functions
+  void pick_clusters ();
+  void shortlist (int k);
+  float dot (const float *a, const float *b) const;
+
+  // approximate index
+  void build_index ();
+  void fit_centers ();
+  int nearest (const float *row) const;
+
+  // parallel bands
+  static void score_rows (void *ctx, int band, int nb);
+  static void label_rows (void *ctx, int band, int nb);
+
+
+};
+
+
+#endif  // once
+
+
+
+
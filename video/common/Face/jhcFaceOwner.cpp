@@ -38,7 +38,7 @@ jhcFaceOwner::~jhcFaceOwner ()
 }
 
 
-//= Get rid of all instance vectors.
+//= Get rid of all instance vectors (and their search matrix rows).
 
 void jhcFaceOwner::clr_vect ()
 {
@@ -47,6 +47,8 @@ void jhcFaceOwner::clr_vect ()
   while (v != NULL)
   {
     rest = v->next;
+    if (gal != NULL)
+      gal->Remove(v);
     delete v;
     v = rest;
   }
@@ -56,12 +58,15 @@ void jhcFaceOwner::clr_vect ()
 
 
 //= Default constructor initializes certain values.
+// vectors are also entered in search matrix "g" (if any) with owner number "idx"
 
-jhcFaceOwner::jhcFaceOwner (const char *who, int sz)
+jhcFaceOwner::jhcFaceOwner (const char *who, int sz, jhcFaceGallery *g, int idx)
 {
   // basic info
   strcpy_s(name, who);
   vsz = sz;
+  gal = g;
+  id = idx;
 
   // data and people list
   vect = NULL;
@@ -99,6 +104,8 @@ int jhcFaceOwner::AddVect (jhcFaceVect *v, int vcnt)
   else
     v0->next = v;
   nv++;
+  if (gal != NULL)
+    gal->Add(v, id);
 
   // possibly assign image number
   if ((v->thumb).Valid())
@@ -135,6 +142,8 @@ void jhcFaceOwner::rem_weakest ()
     vect = weak->next;
   else
     prev->next = weak->next;
+  if (gal != NULL)
+    gal->Remove(weak);
   delete weak;
   nv--;
 }
@@ -181,6 +190,8 @@ int jhcFaceOwner::Load (const char *dir)
       last->next = v;
     last = v;
     nv++;
+    if (gal != NULL)
+      gal->Add(v, id);
   }
 
   // clean up
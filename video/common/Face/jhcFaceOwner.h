@@ -27,6 +27,7 @@
 
 #include "jhcGlobal.h"
 
+#include "Face/jhcFaceGallery.h"
 #include "Face/jhcFaceVect.h"
 
 
@@ -44,6 +45,10 @@ private:
   jhcFaceVect *vect;
   int nv;
 
+  // fast search matrix
+  jhcFaceGallery *gal;
+  int id;
+
 
 // PUBLIC MEMBER VARIABLES
 public:
@@ -56,8 +61,9 @@ public:
 public:
   // creation and initialization
   ~jhcFaceOwner ();
-  jhcFaceOwner (const char *who, int sz =256);
+  jhcFaceOwner (const char *who, int sz =256, jhcFaceGallery *g =NULL, int idx =0);
   const char *Who () const {return name;}
+  int Index () const {return id;}
   int NumVec () const {return nv;} 
 
   // main functions
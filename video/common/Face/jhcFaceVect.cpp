@@ -46,12 +46,13 @@ jhcFaceVect::jhcFaceVect (int vsz)
   sz = vsz;
   inum = 0;
   util = 0;
+  slot = -1;
   next = NULL;
 }
 
 
 //= Fill self with recognition vector and thumbnail from reference.
-// does not change member variables "inum", "next", or "util"
+// does not change member variables "inum", "next", "util", or "slot"
 // returns 1 if successful, 0 if some problem
 
 int jhcFaceVect::Copy (const jhcFaceVect *ref)
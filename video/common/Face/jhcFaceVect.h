@@ -53,6 +53,9 @@ public:
   double dist;
   int util, rank;
 
+  // row in search matrix (-1 if none)
+  int slot;
+
 
 // PUBLIC MEMBER FUNCTIONS
 public:
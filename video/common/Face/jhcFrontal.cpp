@@ -43,6 +43,7 @@ jhcFrontal::~jhcFrontal ()
 jhcFrontal::jhcFrontal ()
 {
   SetFront(0.3, 0.5, 0.5, 0.2, 0.1);
+  SetTrack(15, 2, 1.8, 0.3);
   Defaults();
   Reset();
 }
@@ -71,6 +72,24 @@ int jhcFrontal::front_params (const char *fname)
 }
 
 
+//= Parameters used for following faces between full searches.
+
+int jhcFrontal::track_params (const char *fname)
+{
+  jhcParam *ps = &kps;
+  int ok;
+
+  ps->SetTag("face_track", 0);
+  ps->NextSpec4( &tfull, "Full search interval (0 = always)");
+  ps->NextSpec4( &tnum,  "Full searches per cycle (0 = all)");
+  ps->NextSpecF( &twin,  "Track window wrt face");
+  ps->NextSpecF( &tsc,   "Track size change");
+  ok = ps->LoadDefs(fname);
+  ps->RevertAll();
+  return ok;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                           Parameter Bundles                           //
 ///////////////////////////////////////////////////////////////////////////
@@ -83,6 +102,7 @@ int jhcFrontal::Defaults (const char *fname)
 
   ok &= ff.Defaults(fname);
   ok &= front_params(fname);
+  ok &= track_params(fname);
   return ok;
 }
 
@@ -95,6 +115,7 @@ int jhcFrontal::SaveVals (const char *fname) const
 
   ok &= ff.SaveVals(fname);
   ok &= dps.SaveVals(fname);
+  ok &= kps.SaveVals(fname);
   return ok;
 }
 
@@ -118,6 +139,8 @@ void jhcFrontal::Reset ()
     {
       tried[p][c] = 0;  
       fcnt[p][c] = -1;
+      tok[p][c] = 0;
+      age[p][c] = 0;
     }
 }
 
@@ -128,18 +151,97 @@ void jhcFrontal::Reset ()
 // return -1 for no face, 0 for non-frontal, else frontal count
 
 int jhcFrontal::FaceChk (int p, const jhcImg& src, const jhcRoi& area, double ang, int cam)
+{
+  // check input values
+  if ((p < 0) || (p >= pmax) || (cam < 0) || (cam >= cmax) || !src.Valid(1, 3))
+    return Fatal("Bad input to jhcFrontal::ChkFace");
+
+  // search whole head area for a wide range of sizes
+  age[p][cam] = 0;
+  return chk_area(p, src, area, area, ang, fsz, 1.0, cam);
+}
+
+
+//= Look for a previously found face in a small window where it should be now.
+// area and angle are for the whole head, found the same way as for FaceChk
+// window is set by offset of face from head when last seen and only sizes
+// near the old one are tried (offset and size scale with the head area)
+// if no face is being tracked then just records that none was found
+// return -1 for no face, 0 for non-frontal, else frontal count
+
+int jhcFrontal::FaceTrack (int p, const jhcImg& src, const jhcRoi& area, double ang, int cam)
+{
+  jhcRoi win;
+  double fw, sz, aw = area.RoiW();
+
+  // check input values
+  if ((p < 0) || (p >= pmax) || (cam < 0) || (cam >= cmax) || !src.Valid(1, 3))
+    return Fatal("Bad input to jhcFrontal::FaceTrack");
+
+  // see if anything to follow
+  age[p][cam] += 1;
+  if (tok[p][cam] <= 0)
+  {
+    tried[p][cam] = 1;
+    fcnt[p][cam] = -1;
+    return -1;
+  }
+
+  // predict face position and size from current head area
+  fw = tw[p][cam] * aw;
+  sz = __min(twin * fw, aw);
+  win.SetCenter(area.RoiAvgX() + tx[p][cam] * aw, area.RoiAvgY() + ty[p][cam] * aw, sz);
+  return chk_area(p, src, win, area, ang, (1.0 - tsc) * fw / sz, (1.0 + tsc) * fw / sz, cam);
+}
+
+
+//= Tells how urgently a full search of the head area is needed for some person.
+// lost or never found faces come first, then tracks overdue for a refresh
+// returns 0 if face can just be tracked, else priority (bigger is more urgent)
+
+int jhcFrontal::FullPri (int p, int cam) const
+{
+  if (!ok_idx(p, cam))
+    return 0;
+  if (tok[p][cam] <= 0)
+    return(1000 + __min(age[p][cam], 999));
+  if ((tfull > 0) && (age[p][cam] < tfull))
+    return 0;
+  return(1 + __min(age[p][cam], 998));
+}
+
+
+//= Forget about any face being tracked for some person (e.g. new head track).
+
+void jhcFrontal::DropTrack (int p, int cam)
+{
+  if (!ok_idx(p, cam))
+    return;
+  tok[p][cam] = 0;
+  age[p][cam] = 0;
+}
+
+
+//= Search some window of the image for a face and check if it is frontal.
+// window is searched at the given angle but frontal offset is wrt head "area"
+// face width must be between fmin and fmax of window width
+// remembers position and size of any face found (wrt area) for tracking
+// return -1 for no face, 0 for non-frontal, else frontal count
+
+int jhcFrontal::chk_area (int p, const jhcImg& src, const jhcRoi& win, const jhcRoi& area, 
+                          double ang, double fmin, double fmax, int cam)
 {
   jhcRoi mid;
   jhcRoi *det;
   jhcImg *clip;
-  double midx = area.RoiAvgX(), midy = area.RoiAvgY();
-  double x0 = xoff * area.RoiW(), y0 = yoff * area.RoiH();
+  double midx = win.RoiAvgX(), midy = win.RoiAvgY(), aw = area.RoiW();
+  double x0 = xoff * aw, y0 = yoff * area.RoiH();
+  double rads = -D2R * ang, c = cos(rads), s = sin(rads);
+  double ix = midx - area.RoiAvgX(), iy = midy - area.RoiAvgY();
+  double px = c * ix + s * iy + 0.5 * (aw - 1.0), py = c * iy - s * ix + 0.5 * (area.RoiH() - 1.0);
+  double fx, fy;
   int n;
 
-  // check input values
-  if ((p < 0) || (p >= pmax) || (cam > cmax) || !src.Valid(1, 3))
-    return Fatal("Bad input to jhcFrontal::ChkFace");
-
   // set status and get current frontal count
   cx[p][cam] = midx;
   cy[p][cam] = midy;
@@ -147,11 +249,12 @@ int jhcFrontal::FaceChk (int p, const jhcImg& src, const jhcRoi& area, double an
   tried[p][cam] = 1;
   n = __max(0, fcnt[p][cam]);
   fcnt[p][cam] = -1;
+  tok[p][cam] = 0;
 
   // carve out rotated image patch 
   clip = &(crop[p][cam]);
   clip->vsz = 1;
-  clip->SetSize(area.RoiW(), area.RoiH(), src.Fields());
+  clip->SetSize(win.RoiW(), win.RoiH(), src.Fields());
   ExtRotateRGB(*clip, src, midx, midy, ang);
 
   // stretch contrast based on middle portion
@@ -160,14 +263,21 @@ int jhcFrontal::FaceChk (int p, const jhcImg& src, const jhcRoi& area, double an
 
   // get bounding box from face finder
   det = &(face[p][cam]);
-  if (ff.FindWithin(*det, *clip, *clip, fsz) > 0)
+  if (ff.FindWithin(*det, *clip, *clip, fmin, fmax) > 0)
   {
-    // check position of detection (wrt full image)
-    fdx[p][cam] = (det->RoiAvgX() - x0) / det->RoiW();
-    fdy[p][cam] = (det->RoiAvgY() - y0) / det->RoiH();
+    // check position of detection (wrt rotated head area)
+    fdx[p][cam] = (det->RoiAvgX() - clip->RoiAvgX() + px - x0) / det->RoiW();
+    fdy[p][cam] = (det->RoiAvgY() - clip->RoiAvgY() + py - y0) / det->RoiH();
     fcnt[p][cam] = 0;
     if ((fabs(fdx[p][cam]) <= xsh) && (fabs(fdy[p][cam]) <= ysh))
       fcnt[p][cam] = n + 1;
+
+    // remember face location and size relative to head area
+    FaceMid(fx, fy, p, cam);
+    tx[p][cam] = (fx - area.RoiAvgX()) / aw;
+    ty[p][cam] = (fy - area.RoiAvgY()) / aw;
+    tw[p][cam] = det->RoiW() / aw;
+    tok[p][cam] = 1;
   }
   return fcnt[p][cam];
 }
@@ -191,6 +301,7 @@ int jhcFrontal::DoneChk ()
       {
         tried[p][c] = 0;
         fcnt[p][c] = -1;
+        tok[p][c] = 0;
         continue;
       }
 
@@ -240,7 +351,7 @@ int jhcFrontal::FrontCnt (int p, int cam) const
 {
   int c, best = -1;
 
-  if ((p < 0) || (p >= pmax) || (cam > cmax))
+  if ((p < 0) || (p >= pmax) || (cam >= cmax))
     return Fatal("Bad input to jhcFrontal::FrontCnt");
 
   if (cam >= 0)
@@ -49,6 +49,9 @@
 // person numbers are indices into jhcStare3D array, not unique IDs
 // useful for determining eye contact and vetting face reco images
 // should be usable with other face finders besides OpenCV
+// once found, a face can be followed by FaceTrack in a small window near
+// where the head motion predicts it should be with a narrow range of sizes
+// FullPri tells caller when a full search of the head area is due instead
 
 class jhcFrontal : protected jhcDraw, private jhcHist, private jhcResize, protected jhcStats
 {
@@ -68,6 +71,13 @@ private:
   int tried[pmax][cmax];         /** Whether any image areas checked.   */ 
   int fcnt[pmax][cmax];          /** Consecutive frontal face count.    */
 
+  // face tracking
+  double tx[pmax][cmax];         /** X offset of face wrt head area.    */
+  double ty[pmax][cmax];         /** Y offset of face wrt head area.    */
+  double tw[pmax][cmax];         /** Width of face wrt head area.       */
+  int tok[pmax][cmax];           /** Whether face can be tracked.       */
+  int age[pmax][cmax];           /** Cycles since last full search.     */
+
 
 // PUBLIC MEMBER VARIABLES
 public:
@@ -86,6 +96,11 @@ public:
   jhcParam dps;
   double fsz, xoff, yoff, xsh, ysh;
 
+  // parameters for face tracking
+  jhcParam kps;
+  double twin, tsc;
+  int tfull, tnum;
+
 
 // PUBLIC MEMBER FUNCTIONS
 public:
@@ -96,6 +111,8 @@ public:
   // parameter utilities
   void SetFront (double sz, double xc, double yc, double dx, double dy)
     {fsz = sz; xoff = xc; yoff = yc; xsh = dx; ysh = dy;}
+  void SetTrack (int n, int fmax, double wf, double ds)
+    {tfull = n; tnum = fmax; twin = wf; tsc = ds;}
 
   // processing parameter bundles 
   int Defaults (const char *fname =NULL);
@@ -104,6 +121,9 @@ public:
   // main functions
   void Reset ();
   int FaceChk (int p, const jhcImg& src, const jhcRoi& area, double ang =0.0, int cam =0);
+  int FaceTrack (int p, const jhcImg& src, const jhcRoi& area, double ang =0.0, int cam =0);
+  int FullPri (int p, int cam =0) const;
+  void DropTrack (int p, int cam =0);
   int DoneChk ();
 
   // result browsing
@@ -145,6 +165,11 @@ public:
 private:
   // processing parameters
   int front_params (const char *fname);
+  int track_params (const char *fname);
+
+  // main functions
+  int chk_area (int p, const jhcImg& src, const jhcRoi& win, const jhcRoi& area, 
+                double ang, double fmin, double fmax, int cam);
 
   // result browsing
   bool ok_idx (int p, int cam) const;
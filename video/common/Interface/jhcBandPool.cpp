@@ -0,0 +1,258 @@
+// jhcBandPool.cpp : runs a function over image bands using background threads
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <windows.h>
+#include <process.h>
+
+#include "Interface/jhcBandPool.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcBandPool::~jhcBandPool ()
+{
+  stop_all();
+  CloseHandle((HANDLE) go);
+  CloseHandle((HANDLE) done);
+  CloseHandle((HANDLE) busy);
+}
+
+
+//= Default constructor initializes certain values.
+// n < 0 means one less worker than the number of cores (caller is a lane)
+
+jhcBandPool::jhcBandPool (int n)
+{
+  int i;
+
+  // thread control items
+  go   = (void *) CreateSemaphore(NULL, 0, tmax, NULL);
+  done = (void *) CreateEvent(NULL, FALSE, FALSE, NULL);  // auto-reset
+  busy = (void *) CreateMutex(NULL, FALSE, NULL);
+  for (i = 0; i < tmax; i++)
+    fcn[i] = NULL;
+  nt = 0;
+  run = 0;
+
+  // no current job
+  job = NULL;
+  info = NULL;
+  total = 0;
+  next = 0;
+  active = 0;
+
+  // make up workers
+  par = 1;
+  SetThreads(n);
+}
+
+
+//= Change the number of background workers (blocks until idle).
+// n < 0 means one less worker than the number of cores
+// returns number of workers actually started
+
+int jhcBandPool::SetThreads (int n)
+{
+  int want = n;
+
+  if (want < 0)
+    want = Cores() - 1;
+  want = __max(0, __min(want, tmax));
+  if ((want == nt) && (run > 0))
+    return nt;
+
+  // make sure no job is running then swap out threads
+  if (WaitForSingleObject((HANDLE) busy, INFINITE) != WAIT_OBJECT_0)
+    return nt;
+  stop_all();
+  start_all(want);
+  ReleaseMutex((HANDLE) busy);
+  return nt;
+}
+
+
+//= Get the process-wide pool used by most image processing routines.
+// created on first use, lives until program exit
+
+jhcBandPool *jhcBandPool::Shared ()
+{
+  static jhcBandPool pool;
+
+  return &pool;
+}
+
+
+//= Number of logical processors available on this machine.
+
+int jhcBandPool::Cores ()
+{
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+  return __max(1, (int) info.dwNumberOfProcessors);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Call function f for each band 0 to nb - 1 and wait until all are done.
+// caller's thread participates so there is never a context switch penalty
+// for nb = 1, and a nested or concurrent Run simply falls back to serial
+// returns number of lanes used (1 means serial)
+
+int jhcBandPool::Run (jhcBandFcn f, void *ctx, int nb)
+{
+  int b, nw;
+
+  if ((f == NULL) || (nb <= 0))
+    return 0;
+
+  // see if workers are free (mutex is recursive so a nested call
+  // from the caller's own thread is caught by job already being set)
+  nw = __min(nt, nb - 1);
+  if ((par > 0) && (nw > 0))
+  {
+    if (WaitForSingleObject((HANDLE) busy, 0) != WAIT_OBJECT_0)
+      nw = 0;
+    else if (job != NULL)
+    {
+      ReleaseMutex((HANDLE) busy);
+      nw = 0;
+    }
+  }
+
+  // possibly do everything on caller's thread
+  if ((par <= 0) || (nw <= 0))
+  {
+    for (b = 0; b < nb; b++)
+      (*f)(ctx, b, nb);
+    return 1;
+  }
+
+  // describe job then wake up just enough workers
+  job = f;
+  info = ctx;
+  total = nb;
+  next = 0;
+  active = nw;
+  ResetEvent((HANDLE) done);
+  ReleaseSemaphore((HANDLE) go, nw, NULL);
+
+  // help out then wait for stragglers
+  claim_bands();
+  if (WaitForSingleObject((HANDLE) done, INFINITE) != WAIT_OBJECT_0)
+    jprintf(">>> Never got workers done in jhcBandPool::Run\n");
+  job = NULL;
+  info = NULL;
+  ReleaseMutex((HANDLE) busy);
+  return(nw + 1);
+}
+
+
+//= Suggest a number of bands for an image of some height.
+// gives a few bands per lane for balance but keeps at least hmin lines each
+
+int jhcBandPool::Bands (int ht, int hmin) const
+{
+  int nb = 4 * Lanes();
+
+  return __max(1, __min(nb, ht / __max(1, hmin)));
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Worker Threads                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Create some number of background worker threads.
+
+void jhcBandPool::start_all (int n)
+{
+  int i;
+
+  run = 1;
+  for (i = 0; i < n; i++)
+    fcn[i] = (void *) _beginthreadex(NULL, 0, work_backg, this, 0, NULL);
+  nt = n;
+}
+
+
+//= Cleanly exit all background worker threads.
+
+void jhcBandPool::stop_all ()
+{
+  int i;
+
+  if (run <= 0)
+    return;
+
+  // ask every worker politely to exit
+  run = 0;
+  if (nt > 0)
+    ReleaseSemaphore((HANDLE) go, nt, NULL);
+
+  // clean up threads
+  for (i = 0; i < nt; i++)
+  {
+    if (WaitForSingleObject((HANDLE) fcn[i], 1000) != WAIT_OBJECT_0)
+      jprintf(">>> Never got thread termination in jhcBandPool::stop_all\n");
+    CloseHandle((HANDLE) fcn[i]);
+    fcn[i] = NULL;
+  }
+  nt = 0;
+}
+
+
+//= Keep grabbing the next unprocessed band until none are left.
+
+void jhcBandPool::claim_bands ()
+{
+  int b;
+
+  while ((b = (int) InterlockedIncrement(&next) - 1) < total)
+    (*job)(info, b, total);
+}
+
+
+//= Wait for a job then help process its bands (run as a separate thread).
+// every semaphore count consumed is matched by one decrement of active
+// so done is only signalled after the last band has been finished
+
+int jhcBandPool::work_loop ()
+{
+  while (WaitForSingleObject((HANDLE) go, INFINITE) == WAIT_OBJECT_0)
+  {
+    if (run <= 0)
+      return 1;
+    claim_bands();
+    if (InterlockedDecrement(&active) == 0)
+      SetEvent((HANDLE) done);
+  }
+  return 0;
+}
+
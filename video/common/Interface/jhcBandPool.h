@@ -0,0 +1,113 @@
+// jhcBandPool.h : runs a function over image bands using background threads
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCBANDPOOL_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCBANDPOOL_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+
+//= Function applied to one band out of nb total (band = 0 to nb - 1).
+
+typedef void (*jhcBandFcn)(void *ctx, int band, int nb);
+
+
+//= Runs a function over image bands using background threads.
+// threads are created once then sleep between jobs so Run has low overhead
+// caller's thread also processes bands so pool with 0 threads is serial
+// bands are claimed dynamically so uneven workloads still balance well
+// if pool is already busy (e.g. nested call) Run just executes serially
+// <pre>
+// typical use:
+//
+//   static void blur_band (void *ctx, int band, int nb)
+//   {
+//     jhcFoo *me = (jhcFoo *) ctx;
+//     int y0 = (band * me->ht) / nb, y1 = ((band + 1) * me->ht) / nb;
+//     ... process rows y0 to y1 - 1 ...
+//   }
+//
+//   jhcBandPool::Shared()->Run(blur_band, this, 8);
+// </pre>
+
+class jhcBandPool
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  static const int tmax = 32;          /** Maximum number of worker threads. */
+
+  // worker threads and control signals
+  void *fcn[tmax];
+  void *go, *done, *busy;
+  int nt, run;
+
+  // current job description
+  jhcBandFcn job;
+  void *info;
+  int total;
+  volatile long next, active;
+
+
+// PUBLIC MEMBER VARIABLES
+public:
+  int par;                             /** Whether to use threads at all.   */
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcBandPool ();
+  jhcBandPool (int n =-1);
+  int SetThreads (int n =-1);
+  int Threads () const {return nt;}                                /** Number of background workers. */
+  int Lanes () const {return(((par > 0) ? nt : 0) + 1);}           /** Max bands worked on at once.  */
+  static jhcBandPool *Shared ();
+  static int Cores ();
+
+  // main functions
+  int Run (jhcBandFcn f, void *ctx, int nb);
+  int Bands (int ht, int hmin =16) const;
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // worker threads
+  void start_all (int n);
+  void stop_all ();
+  void claim_bands ();
+  int work_loop ();
+
+  // background thread
+  static unsigned int __stdcall work_backg (void *inst)
+    {jhcBandPool *me = (jhcBandPool *) inst; return me->work_loop();}
+
+
+};
+
+
+#endif  // once
+
+
+
+
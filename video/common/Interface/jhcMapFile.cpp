@@ -0,0 +1,153 @@
+// jhcMapFile.cpp : read-only memory mapped access to a large file
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <windows.h>
+
+#include "Interface/jhcMapFile.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcMapFile::~jhcMapFile ()
+{
+  Close();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcMapFile::jhcMapFile ()
+{
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+  gran = (int) info.dwAllocationGranularity;
+  fh = NULL;
+  mh = NULL;
+  base = NULL;
+  win = NULL;
+  fsz = 0;
+  woff = 0;
+  wsz = 0;
+  whole = 0;
+}
+
+
+//= Open some file for reading and try to map all of it.
+// returns 2 if whole file mapped, 1 if mapped in windows, 0 for failure
+
+int jhcMapFile::Open (const char *fname)
+{
+  LARGE_INTEGER sz;
+  HANDLE f;
+
+  // get file and its size
+  Close();
+  f = CreateFileA(fname, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+  if (f == INVALID_HANDLE_VALUE)
+    return 0;
+  fh = (void *) f;
+  if ((GetFileSizeEx(f, &sz) == 0) || (sz.QuadPart <= 0))
+  {
+    Close();
+    return 0;
+  }
+  fsz = sz.QuadPart;
+
+  // make mapping object then try for single view
+  if ((mh = (void *) CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL)
+  {
+    Close();
+    return 0;
+  }
+  if ((sizeof(void *) >= 8) || (fsz < 0x10000000))
+    if ((base = (const UC8 *) MapViewOfFile((HANDLE) mh, FILE_MAP_READ, 0, 0, 0)) != NULL)
+      whole = 1;
+  return((whole > 0) ? 2 : 1);
+}
+
+
+//= Release all views and close file.
+
+void jhcMapFile::Close ()
+{
+  if (win != NULL)
+    UnmapViewOfFile((LPCVOID) win);
+  if (base != NULL)
+    UnmapViewOfFile((LPCVOID) base);
+  if (mh != NULL)
+    CloseHandle((HANDLE) mh);
+  if (fh != NULL)
+    CloseHandle((HANDLE) fh);
+  fh = NULL;
+  mh = NULL;
+  base = NULL;
+  win = NULL;
+  fsz = 0;
+  woff = 0;
+  wsz = 0;
+  whole = 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get pointer to "n" bytes starting at some offset in the file.
+// if only windows are mapped then pointer is valid until next call
+// returns NULL if span is not completely within file
+
+const UC8 *jhcMapFile::Span (__int64 off, int n)
+{
+  __int64 start;
+  DWORD len;
+
+  if ((mh == NULL) || (off < 0) || (n < 0) || ((off + n) > fsz))
+    return NULL;
+  if (whole > 0)
+    return(base + off);
+
+  // see if current window already covers request
+  if ((win != NULL) && (off >= woff) && ((off + n) <= (woff + wsz)))
+    return(win + (off - woff));
+
+  // map new window starting at allocation boundary
+  if (win != NULL)
+    UnmapViewOfFile((LPCVOID) win);
+  start = off - (off % gran);
+  len = (DWORD)(off + n - start);
+  win = (const UC8 *) MapViewOfFile((HANDLE) mh, FILE_MAP_READ, (DWORD)(start >> 32),
+                                    (DWORD)(start & 0xFFFFFFFF), len);
+  if (win == NULL)
+    return NULL;
+  woff = start;
+  wsz = (int) len;
+  return(win + (off - woff));
+}
+
+
@@ -0,0 +1,78 @@
+// jhcMapFile.h : read-only memory mapped access to a large file
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCMAPFILE_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCMAPFILE_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+
+//= Read-only memory mapped access to a large file.
+// tries to map whole file at once (normal for 64 bit programs) so that all
+// spans stay valid until Close, otherwise maps a window around each request
+// in which case a span is only valid until the next call to Span
+// pages are brought in by the OS on first touch and shared with file cache
+// <pre>
+// typical use:
+//
+//   mf.Open("big.mbm");
+//   pix = mf.Span(off, n);
+//   ...
+//   mf.Close();
+//
+// </pre>
+
+class jhcMapFile
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  void *fh, *mh;
+  const UC8 *base, *win;
+  __int64 fsz, woff;
+  int wsz, gran, whole;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcMapFile ();
+  jhcMapFile ();
+  int Open (const char *fname);
+  void Close ();
+  int Valid () const {return((mh != NULL) ? 1 : 0);}
+  __int64 Size () const {return fsz;}
+  int Whole () const {return whole;}
+
+  // main functions
+  const UC8 *Span (__int64 off, int n);
+
+
+};
+
+
+#endif  // once
+
+
+
+
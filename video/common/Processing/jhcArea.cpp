@@ -22,6 +22,7 @@
 
 #include <math.h>
 #include <basetsd.h>                 // for __int64 type
+#include "Interface/jhcBandPool.h"
 #include "Interface/jhcMessage.h"
 
 #include "Processing/jhcArea.h"
@@ -29,6 +30,22 @@
 // Note: many functions migrated to jhcRuns and jhcDist
 
 
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default constructor initializes certain values.
+// scratch images recycle buffers through shared pool when size changes
+
+jhcArea::jhcArea ()
+{
+  a1.pool = 1;
+  b1.pool = 1;
+  a4.pool = 1;
+  b4.pool = 1;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                         Simple Dispatch Forms                         //
 ///////////////////////////////////////////////////////////////////////////
@@ -102,6 +119,219 @@ int jhcArea::BoxAvg16X (jhcImg& dest, const jhcImg& src, int w1, int h2,
 }
 
 
+///////////////////////////////////////////////////////////////////////////
+//                        Integral Image Support                         //
+///////////////////////////////////////////////////////////////////////////
+
+//= Precompute integral images so later box statistics on source are fast.
+// afterwards BoxAvg, BoxStd, BoxAvgStd, BoxAvgInv, NotBoxAvg, NZBoxAvg, and
+//   LocalAGC with any window size take constant time per pixel (same results)
+// sq > 0 also covers standard deviations, bg >= 0 covers NotBoxAvg with that bg
+// stays valid until source pixels are written (e.g. PxlDest) or ROI changes
+// cheap to call again if nothing changed, useful for multi-scale statistics
+// returns 1 if okay, 0 or negative for error
+
+int jhcArea::BoxSums (const jhcImg& src, int sq, int bg)
+{
+  if (!src.Valid(1))
+    return Fatal("Bad image to jhcArea::BoxSums");
+  return((sums.Build(src, sq, __min(bg, 255)) > 0) ? 1 : 0);
+}
+
+
+//= Compute some box statistic for all pixels using cached integral images.
+// d2 is second output for BoxAvgStd (op 3) and BoxAvgInv (op 4)
+// ops: 0 = BoxAvg, 1 = box_avg0, 2 = BoxStd, 5 = NotBoxAvg (i_bg, i_def, i_n)
+// normalization copies expressions in the running sum versions exactly
+// assumes sizes already checked, output ROIs match source, and sums valid
+
+int jhcArea::int_box (jhcImg& dest, jhcImg *d2, int dx, int dy, double sc, int op)
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+  int area = dx * dy;
+
+  // window and normalization factors
+  i_dx = dx;
+  i_dy = dy;
+  i_op = op;
+  i_norm = (UL32)(65536.0 * sc / area);
+  i_norm24 = (unsigned __int64)(0x01000000 * sc / area);
+  i_sc = 1.0 / (double) area;
+  if (op == 2)
+    i_nsc = sc / (double) area;
+  else if (op == 3)
+    i_nsc = sc * i_sc;
+  else
+    i_nsc = 256.0 * area / sc;
+
+  // scratch rows for window sums (and squares or counts)
+  a4.SetSize(dest, 4);
+  i_s = (UL32 *) a4.PxlDest();
+  i_q = NULL;
+  if (op >= 2)
+  {
+    b4.SetSize(dest, 4);
+    i_q = (UL32 *) b4.PxlDest();
+  }
+  i_ln4 = a4.Line() >> 2;
+
+  // outputs then process bands of lines
+  i_d = dest.RoiDest();
+  i_d2 = ((d2 != NULL) ? d2->RoiDest() : NULL);
+  i_ln = dest.Line();
+  bp->Run(int_rows, this, bp->Bands(dest.RoiH()));
+  return 1;
+}
+
+
+//= Compute output values for a horizontal band of lines using integral images.
+
+void jhcArea::int_rows (void *ctx, int band, int nb)
+{
+  jhcArea *me = (jhcArea *) ctx;
+  int x, y, xa, xb, nr, area = me->i_dx * me->i_dy, op = me->i_op, bg = me->i_bg;
+  int rw = me->sums.XDim(), rh = me->sums.YDim(), nx = me->i_dx / 2, ny = me->i_dy / 2;
+  int y0 = (band * rh) / nb, y1 = ((band + 1) * rh) / nb;
+  double fval, norm = me->i_sc, nsc = me->i_nsc;
+  UL32 sum, ssq, cnt, val, n = me->i_n, pnorm = me->i_norm;
+  unsigned __int64 norm24 = me->i_norm24;
+  UC8 bdef = (UC8) me->i_def;
+  UL32 *s, *q;
+  UC8 *d, *d2;
+
+  for (y = y0; y < y1; y++)
+  {
+    // get window sums for whole line
+    s = me->i_s + y * me->i_ln4;
+    q = ((me->i_q != NULL) ? me->i_q + y * me->i_ln4 : NULL);
+    d = me->i_d + y * me->i_ln;
+    d2 = ((me->i_d2 != NULL) ? me->i_d2 + y * me->i_ln : NULL);
+    me->int_sums(s, q, y, ((op == 5) ? 2 : ((op >= 2) ? 1 : 0)));
+
+    // convert to final values
+    if (op == 0)
+      for (x = 0; x < rw; x++)
+      {
+        sum = pnorm * s[x];
+        d[x] = (((sum >> 24) != 0) ? 255 : (UC8)(sum >> 16));
+      }
+    else if (op == 1)
+      for (x = 0; x < rw; x++)
+      {
+        val = (UL32)((s[x] * norm24) >> 24);
+        d[x] = (UC8) __min(255, val);
+      }
+    else if (op == 2)
+      for (x = 0; x < rw; x++)
+      {
+        sum = s[x];
+        ssq = q[x];
+        fval = area * (double) ssq - sum * (double) sum;
+        val = (UL32)(nsc * sqrt(fval) + 0.5);
+        d[x] = (UC8) __min(255, val);
+      }
+    else if (op == 3)
+      for (x = 0; x < rw; x++)
+      {
+        sum = s[x];
+        ssq = q[x];
+        fval = area * (double) ssq - sum * (double) sum;
+        val = (UL32)(nsc * sqrt(fval) + 0.5);
+        d2[x] = (UC8) __min(255, val);
+        d[x] = (UC8)(norm * sum + 0.5);
+      }
+    else if (op == 4)
+      for (x = 0; x < rw; x++)
+      {
+        sum = s[x];
+        ssq = q[x];
+        fval = area * (double) ssq - sum * (double) sum;
+        val = (UL32)(nsc / sqrt(fval) + 0.5);
+        d2[x] = (UC8) __min(255, val);
+        d[x] = (UC8)(norm * sum + 0.5);
+      }
+    else
+    {
+      // background pixels are part of sum (count of window inside ROI)
+      nr = __min(y - ny + me->i_dy, rh) - __max(y - ny, 0);
+      for (x = 0; x < rw; x++)
+      {
+        cnt = q[x];
+        if (cnt < n)
+        {
+          d[x] = bdef;
+          continue;
+        }
+        xa = __max(x - nx, 0);
+        xb = __min(x - nx + me->i_dx, rw);
+        sum = s[x] - bg * (nr * (xb - xa) - cnt);
+        d[x] = (UC8)((cnt == 1) ? sum : sum / cnt);
+      }
+    }
+  }
+}
+
+
+//= Get box sums for all pixels in some line of the ROI.
+// mode 0 = edge replicated sums, 1 = also squares in aux, 2 = clipped with counts
+// fast four corner lookup when window is inside ROI, else uses more general form
+
+void jhcArea::int_sums (UL32 *sum, UL32 *aux, int y, int mode) const
+{
+  const UL32 *lo, *hi;
+  const unsigned __int64 *qlo, *qhi;
+  int x, xa, xb, rw = sums.XDim(), rh = sums.YDim();
+  int nx = i_dx / 2, px = i_dx - nx, y0 = y - i_dy / 2, y1 = y0 + i_dy;
+  int xlo = 0, xhi = 0;
+
+  // interior pixels have whole window inside ROI
+  if ((y0 >= 0) && (y1 <= rh))
+  {
+    xlo = nx;
+    xhi = __max(nx, rw - px + 1);
+    lo = sums.Sums(y0);
+    hi = sums.Sums(y1);
+    for (x = xlo; x < xhi; x++)
+      sum[x] = hi[x + px] - hi[x - nx] - lo[x + px] + lo[x - nx];
+    if (mode == 1)
+    {
+      qlo = sums.Squares(y0);
+      qhi = sums.Squares(y1);
+      for (x = xlo; x < xhi; x++)
+        aux[x] = (UL32)(qhi[x + px] - qhi[x - nx] - qlo[x + px] + qlo[x - nx]);
+    }
+    else if (mode == 2)
+    {
+      lo = sums.Counts(y0);
+      hi = sums.Counts(y1);
+      for (x = xlo; x < xhi; x++)
+        aux[x] = hi[x + px] - hi[x - nx] - lo[x + px] + lo[x - nx];
+    }
+  }
+
+  // border pixels (possibly whole line)
+  for (x = 0; x < rw; x++)
+  {
+    if (x == xlo)
+      if ((x = xhi) >= rw)
+        break;
+    xa = x - nx;
+    xb = x + px;
+    if (mode == 2)
+    {
+      sum[x] = sums.RectSum(xa, y0, xb, y1);
+      aux[x] = sums.RectCnt(xa, y0, xb, y1);
+    }
+    else
+    {
+      sum[x] = sums.EdgeSum(xa, y0, xb, y1);
+      if (mode == 1)
+        aux[x] = (UL32) sums.EdgeSq(xa, y0, xb, y1);
+    }
+  }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                          Local Area Averages                          //
 ///////////////////////////////////////////////////////////////////////////
@@ -142,6 +372,8 @@ int jhcArea::BoxAvg (jhcImg &dest, const jhcImg& src, int wid, int ht,
   if ((dx == 3) && (dy == 3) && !dest.SameImg(src))
     return BoxAvg3(dest, src, sc);
   dest.CopyRoi(src);
+  if (sums.Cached(src))
+    return int_box(dest, NULL, dx, dy, sc, (((area * sc) >= 66051.0) ? 1 : 0));
   if ((area * sc) >= 66051.0)
     return box_avg0(dest, src, dx, dy, sc, vic);
 
@@ -969,6 +1201,13 @@ int jhcArea::NotBoxAvg (jhcImg &dest, const jhcImg& src, int wid, int ht,
   if ((dx == 1) && (dy == 1))
     return dest.CopyArr(src);
   dest.CopyRoi(src);  
+  if ((bg >= 0) && (bg <= 255) && sums.Cached(src, 0, bg))
+  {
+    i_bg = bg;
+    i_def = BOUND(def);
+    i_n = n;
+    return int_box(dest, NULL, dx, dy, 1.0, 5);
+  }
 
   // generic ROI case
   int x, y, rsk4;
@@ -1687,6 +1926,8 @@ int jhcArea::BoxStd (jhcImg &dest, const jhcImg& src, int wid, int ht, double sc
   dest.CopyRoi(src);
   if ((area == 1) && (sc == 1.0))
     return dest.FillArr(0);
+  if (sums.Cached(src, 1))
+    return int_box(dest, NULL, dx, dy, sc, 2);
 
   // generic ROI case
   double nsc = sc / (double) area;
@@ -1928,6 +2169,8 @@ int jhcArea::BoxAvgStd (jhcImg &avg, jhcImg& std, const jhcImg& src,
     std.FillArr(1);
     return avg.CopyArr(src);
   }
+  if (sums.Cached(src, 1))
+    return int_box(avg, &std, dx, dy, dsc, 3);
 
   // generic ROI case
   double fval, norm = 1.0 / (double) area, nsc = dsc * norm;
@@ -2164,6 +2407,8 @@ int jhcArea::BoxAvgInv (jhcImg &avg, jhcImg& isd, const jhcImg& src,
     isd.FillArr(255);
     return avg.CopyArr(src);
   }
+  if (sums.Cached(src, 1))
+    return int_box(avg, &isd, dx, dy, dsc, 4);
 
   // generic ROI case
   double fval, norm = 1.0 / (double) area, nsc = 256.0 * area / dsc;
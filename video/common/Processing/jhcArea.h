@@ -29,11 +29,14 @@
 #include <stdlib.h>
 
 #include "Data/jhcImg.h"
+#include "Data/jhcIntegral.h"
 
 
 //= Computes averages, etc. over blocks of pixels.
 // Note: many functions migrated to jhcRuns and jhcDist
 // NOTE: keeps private internal state so copies must be made for OpenMP
+// if BoxSums called first then later box statistics on the same unaltered
+//   source use integral images instead of running sums (same answers)
 
 class jhcArea
 {
@@ -41,10 +44,22 @@ class jhcArea
 private:
   US16 v0[256], vals[256];
   jhcImg a1, b1, a4, b4;
+  jhcIntegral sums;
+
+  // integral image band processing
+  UC8 *i_d, *i_d2;
+  UL32 *i_s, *i_q;
+  int i_ln, i_ln4, i_dx, i_dy, i_op, i_bg, i_def;
+  UL32 i_n, i_norm;
+  unsigned __int64 i_norm24;
+  double i_sc, i_nsc;
 
 
 // PUBLIC MEMBER FUNCTIONS
 public:
+  // creation and initialization
+  jhcArea ();
+
   // simple dispatch forms
   int BoxAvgX (jhcImg& dest, const jhcImg& src, int w1, int h2 =0, 
                double sc =1.0, int diag =0);
@@ -55,6 +70,9 @@ public:
   int BoxAvg16X (jhcImg& dest, const jhcImg& src, int w1, int h2 =0, 
                  double sc =1.0, int diag =0);
 
+  // integral image support
+  int BoxSums (const jhcImg& src, int sq =1, int bg =-1);
+
   // local area averages
   int BoxAvg (jhcImg &dest, const jhcImg& src, int wid, int ht =0, 
               double sc =1.0, jhcImg *vic =NULL);
@@ -125,6 +143,9 @@ public:
 // PRIVATE MEMBER FUNCTIONS
 private:
   int box_avg0 (jhcImg &dest, const jhcImg& src, int dx, int dy, double sc, jhcImg *vic);
+  int int_box (jhcImg& dest, jhcImg *d2, int dx, int dy, double sc, int op);
+  static void int_rows (void *ctx, int band, int nb);
+  void int_sums (UL32 *sum, UL32 *aux, int y, int mode) const;
   void cdiff (jhcImg& dest, const jhcImg& imga, const jhcImg& imgb, double sc) const;
   void ldiff (jhcImg& dest, const jhcImg& imga, const jhcImg& imgb, double sc) const;
   void thresh (jhcImg& dest, const jhcImg& src, int th, int over, int under) const;
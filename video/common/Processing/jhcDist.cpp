@@ -21,11 +21,36 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <math.h>
+#include "Interface/jhcBandPool.h"
 #include "Interface/jhcMessage.h"
 
 #include "Processing/jhcDist.h"
 
 
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcDist::~jhcDist ()
+{
+  env_size(0, 0);
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcDist::jhcDist ()
+{
+  e_v = NULL;
+  e_f = NULL;
+  e_z = NULL;
+  e_env = 0;
+  e_cnt = 0;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                         Manhattan Distance                            //
 ///////////////////////////////////////////////////////////////////////////
@@ -940,3 +965,373 @@ int jhcDist::Voronoi8 (jhcImg& label, const jhcImg& seed, int bg, jhcImg *rng,
 }
 
 
+///////////////////////////////////////////////////////////////////////////
+//                       Exact Euclidean Distance                        //
+///////////////////////////////////////////////////////////////////////////
+
+//= Exact Euclidean version of nearest seed claims with optional distances.
+// when two seeds are equidistant, higher label dominates
+// default version for labels of 16 bits (2 fields) and 16 bit distances
+// same outputs as Voronoi but no errors near obstacle corners
+// linear in number of pixels, rows then columns processed in parallel bands
+
+int jhcDist::Euclid (jhcImg& label, const jhcImg& seed, int bg, jhcImg *rng, 
+                     jhcImg *xrng, jhcImg *yrng, jhcImg *rng2)
+{
+  // check image sizes
+  if (label.Valid(1))
+    return Euclid8(label, seed, bg, rng, xrng, yrng, rng2);
+  if (!label.Valid(2) || !label.SameFormat(seed) || label.SameImg(seed))
+    return Fatal("Bad images to jhcDist::Euclid");
+  if (((rng != NULL) && !label.SameFormat(*rng)) ||
+      ((xrng != NULL) && !label.SameFormat(*xrng)) ||
+      ((yrng != NULL) && !label.SameFormat(*yrng)) ||
+      ((rng2 != NULL) && !label.SameSize(*rng2, 4)))
+    return Fatal("Bad auxilliary images to jhcDist::Euclid");
+  return euclid_core(label, seed, bg, rng, xrng, yrng, rng2);
+}
+
+
+//= Same as Euclid but specialized for 8 bit labels and distances (saturated).
+// when two seeds are equidistant, higher label dominates
+
+int jhcDist::Euclid8 (jhcImg& label, const jhcImg& seed, int bg, jhcImg *rng, 
+                      jhcImg *xrng, jhcImg *yrng, jhcImg *rng2)
+{
+  // check image sizes
+  if (!label.Valid(1) || !label.SameFormat(seed) || label.SameImg(seed))
+    return Fatal("Bad images to jhcDist::Euclid8");
+  if (((rng != NULL) && !label.SameFormat(*rng)) ||
+      ((xrng != NULL) && !label.SameFormat(*xrng)) ||
+      ((yrng != NULL) && !label.SameFormat(*yrng)) ||
+      ((rng2 != NULL) && !label.SameSize(*rng2, 2)))
+    return Fatal("Bad auxilliary images to jhcDist::Euclid8");
+  return euclid_core(label, seed, bg, rng, xrng, yrng, rng2);
+}
+
+
+//= Extend each blob over background regions by Euclidean distance dmax at most.
+
+int jhcDist::EuclidExpand (jhcImg& label, const jhcImg& seed, int dmax, int bg)
+{
+  if (!label.Valid(1, 2) || !label.SameFormat(seed) || (dmax < 0) || (dmax > 255))
+    return Fatal("Bad range image to jhcDist::EuclidExpand");
+
+  // get claims and ranges 
+  b2.SetSize(label);
+  Euclid(label, seed, bg, &b2);
+  a1.SetSize(seed, 1); 
+  if (label.Valid(2))
+    a1.Sat8(b2);
+  else
+    a1.CopyArr(b2);
+
+  // local variables
+  int x, y, rw = label.RoiW(), rh = label.RoiH();
+  int nsk = label.RoiSkip() / label.Fields(), dsk = a1.RoiSkip(label);
+  const UC8 *d = a1.RoiSrc(label);
+
+  // invalidate any labels that are too far away
+  if (label.Valid(2))
+  {
+    US16 *n = (US16 *) label.RoiDest();
+
+    for (y = rh; y > 0; y--, n += nsk, d += dsk)
+      for (x = rw; x > 0; x--, n++, d++)
+        if (*d > dmax)
+          *n = (US16) bg;
+  }
+  else
+  {
+    UC8 *n = label.RoiDest();
+
+    for (y = rh; y > 0; y--, n += nsk, d += dsk)
+      for (x = rw; x > 0; x--, n++, d++)
+        if (*d > dmax)
+          *n = BOUND(bg);
+  }
+  return 1;
+}
+
+
+//= Common part of exact transform for both label sizes (images already checked).
+// PASS 1: each row finds nearest seed column in that row (threaded by rows)
+// PASS 2: each column finds lower envelope of row distance parabolas (threaded by columns)
+
+int jhcDist::euclid_core (jhcImg& label, const jhcImg& seed, int bg, jhcImg *dist, 
+                          jhcImg *xdist, jhcImg *ydist, jhcImg *sqdist)
+{
+  jhcBandPool *pool = jhcBandPool::Shared();
+  int nr, nc;
+
+  // get scratch array for row claims and set output ROIs 
+  sx4.SetSize(seed, 4);
+  label.CopyRoi(seed);
+  if (dist != NULL)
+    dist->CopyRoi(seed);
+  if (xdist != NULL)
+    xdist->CopyRoi(seed);
+  if (ydist != NULL)
+    ydist->CopyRoi(seed);
+  if (sqdist != NULL)
+    sqdist->CopyRoi(seed);
+
+  // record geometry for band functions
+  e_rw  = seed.RoiW();
+  e_rh  = seed.RoiH();
+  e_lf  = seed.Fields();
+  e_sln = seed.Line();
+  e_lln = label.Line();
+  e_xln = sx4.Line() >> 2;
+  e_qln = ((sqdist != NULL) ? sqdist->Line() : 0);
+  e_bg  = bg;
+
+  // record source and destination arrays (ROI origin)
+  e_src = seed.RoiSrc();
+  e_sx  = (int *) sx4.RoiDest(seed);
+  e_lab = label.RoiDest();
+  e_rng = ((dist != NULL) ? dist->RoiDest() : NULL);
+  e_dx  = ((xdist != NULL) ? xdist->RoiDest() : NULL);
+  e_dy  = ((ydist != NULL) ? ydist->RoiDest() : NULL);
+  e_sq  = ((sqdist != NULL) ? sqdist->RoiDest() : NULL);
+
+  // find horizontal claims then resolve vertically
+  nr = pool->Bands(e_rh);
+  nc = pool->Bands(e_rw);
+  env_size(nc, e_rh + 1);
+  pool->Run(euclid_rows, this, nr);
+  pool->Run(euclid_cols, this, nc);
+  return 1;
+}
+
+
+//= Make sure there are enough parabola envelope arrays for nb bands of length n.
+
+void jhcDist::env_size (int nb, int n)
+{
+  if ((nb <= e_cnt) && (n <= e_env))
+    return;
+
+  // get rid of old arrays
+  delete [] e_z;
+  delete [] e_f;
+  delete [] e_v;
+  e_v = NULL;
+  e_f = NULL;
+  e_z = NULL;
+  e_env = 0;
+  e_cnt = 0;
+  if ((nb <= 0) || (n <= 0))
+    return;
+
+  // one chunk per band with extra slot for final boundary
+  e_v = new int [nb * n];
+  e_f = new double [nb * n];
+  e_z = new double [nb * (n + 1)];
+  e_env = n;
+  e_cnt = nb;
+}
+
+
+//= Read seed label at ROI-relative position.
+
+int jhcDist::seed_lab (int x, int y) const
+{
+  if (e_lf == 1)
+    return e_src[y * e_sln + x];
+  return *((const US16 *)(e_src + y * e_sln) + x);
+}
+
+
+//= Band function for horizontal pass.
+
+void jhcDist::euclid_rows (void *me, int band, int nb)
+{
+  jhcDist *d = (jhcDist *) me;
+
+  d->row_pass((band * d->e_rh) / nb, ((band + 1) * d->e_rh) / nb);
+}
+
+
+//= Band function for vertical pass.
+
+void jhcDist::euclid_cols (void *me, int band, int nb)
+{
+  jhcDist *d = (jhcDist *) me;
+
+  d->col_pass((band * d->e_rw) / nb, ((band + 1) * d->e_rw) / nb, band);
+}
+
+
+//= Record column of nearest seed within same row (or -1 if none) for rows y0 to y1-1.
+// picks higher label when seeds to left and right are equally far
+
+void jhcDist::row_pass (int y0, int y1)
+{
+  int x, y, last, lab, rlab, dl, dr;
+  int *sx;
+
+  for (y = y0; y < y1; y++)
+  {
+    sx = e_sx + y * e_xln;
+
+    // right wipe, remember most recent seed to the left
+    last = -1;
+    for (x = 0; x < e_rw; x++)
+    {
+      if (seed_lab(x, y) != e_bg)
+        last = x;
+      sx[x] = last;
+    }
+
+    // left wipe, switch to seed on right if closer (or same and higher)
+    last = -1;
+    for (x = e_rw - 1; x >= 0; x--)
+    {
+      if (sx[x] == x)
+        last = x;
+      else if (last >= 0)
+      {
+        if (sx[x] < 0)
+          sx[x] = last;
+        else
+        {
+          dl = x - sx[x];
+          dr = last - x;
+          if (dr < dl)
+            sx[x] = last;
+          else if (dr == dl)
+          {
+            lab = seed_lab(sx[x], y);
+            rlab = seed_lab(last, y);
+            if (rlab > lab)
+              sx[x] = last;
+          }
+        }
+      }
+    }
+  }
+}
+
+
+//= Find nearest seed for all pixels in columns x0 to x1-1 using scratch arrays for band.
+// builds lower envelope of parabolas f(y) = dx^2 + (y - y')^2 for each row y'
+// keeps parabolas touching envelope at just one point so ties are not lost
+// ties at exact integer crossings go to the higher label
+
+void jhcDist::col_pass (int x0, int x1, int band)
+{
+  int *v = e_v + band * e_env;
+  double *f = e_f + band * e_env, *z = e_z + band * (e_env + 1);
+  double fq, s;
+  int x, y, q, i, j, k, c, dx, lab, lab2;
+
+  for (x = x0; x < x1; x++)
+  {
+    // build lower envelope from all rows having some seed
+    k = -1;
+    for (q = 0; q < e_rh; q++)
+    {
+      if ((c = e_sx[q * e_xln + x]) < 0)
+        continue;
+      dx = x - c;
+      fq = (double) dx * dx;
+      s = 0.0;
+      while (k >= 0)
+      {
+        s = ((fq + (double) q * q) - (f[k] + (double) v[k] * v[k])) / (2.0 * (q - v[k]));
+        if (s >= z[k])
+          break;
+        k--;
+      }
+      k++;
+      v[k] = q;
+      f[k] = fq;
+      z[k] = ((k > 0) ? s : -1.0e30);
+      z[k + 1] = 1.0e30;
+    }
+
+    // no seeds anywhere in column
+    if (k < 0)
+    {
+      for (y = 0; y < e_rh; y++)
+        set_pxl(x, y, x, y, e_bg, -1.0);
+      continue;
+    }
+
+    // read off nearest parabola for each row
+    j = 0;
+    for (y = 0; y < e_rh; y++)
+    {
+      while (z[j + 1] < y)
+        j++;
+      q = v[j];
+      c = e_sx[q * e_xln + x];
+      lab = seed_lab(c, q);
+      for (i = j + 1; (i <= k) && (z[i] == y); i++)
+      {
+        // exact tie with following parabola
+        c = e_sx[v[i] * e_xln + x];
+        lab2 = seed_lab(c, v[i]);
+        if (lab2 > lab)
+        {
+          q = v[i];
+          lab = lab2;
+        }
+      }
+      c = e_sx[q * e_xln + x];
+      set_pxl(x, y, c, q, lab, (double)(x - c) * (x - c) + (double)(y - q) * (y - q));
+    }
+  }
+}
+
+
+//= Write claim and range values at ROI-relative pixel (x y) for seed at (sx sy).
+// d2 < 0 means no seed at all, all outputs saturate at their field size
+
+void jhcDist::set_pxl (int x, int y, int sx, int sy, int lab, double d2)
+{
+  int off = y * e_lln, dx = abs(x - sx), dy = abs(y - sy), r;
+  UL32 sq;
+
+  // no seed claims this pixel 
+  if (d2 < 0.0)
+  {
+    lab = e_bg;
+    dx = 0;
+    dy = 0;
+    d2 = 0.0;
+  }
+  r = ROUND(sqrt(d2));
+
+  // 8 bit labels and distances, 16 bit squared distance
+  if (e_lf == 1)
+  {
+    off += x;
+    e_lab[off] = (UC8) lab;
+    if (e_dx != NULL)
+      e_dx[off] = (UC8) __min(dx, 255);
+    if (e_dy != NULL)
+      e_dy[off] = (UC8) __min(dy, 255);
+    if (e_rng != NULL)
+      e_rng[off] = (UC8) __min(r, 255);
+    if (e_sq != NULL)
+      *((US16 *)(e_sq + y * e_qln) + x) = (US16) __min(d2, 65535.0);
+    return;
+  }
+
+  // 16 bit labels and distances, 32 bit squared distance
+  off += (x << 1);
+  *((US16 *)(e_lab + off)) = (US16) lab;
+  if (e_dx != NULL)
+    *((US16 *)(e_dx + off)) = (US16) __min(dx, 65535);
+  if (e_dy != NULL)
+    *((US16 *)(e_dy + off)) = (US16) __min(dy, 65535);
+  if (e_rng != NULL)
+    *((US16 *)(e_rng + off)) = (US16) __min(r, 65535);
+  if (e_sq != NULL)
+  {
+    sq = (UL32) __min(d2, 4294967295.0);
+    *((UL32 *)(e_sq + y * e_qln) + x) = sq;
+  }
+}
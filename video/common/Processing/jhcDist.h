@@ -32,16 +32,29 @@
 
 
 //= Spreading activation like space claiming. 
+// Euclid functions give exact distances using separable lower envelope method
+// of Felzenszwalb and Huttenlocher, rows then columns split across threads
 
 class jhcDist
 {
 // PRIVATE MEMBER VARIABLES
 private:
-  jhcImg a1, b1, a2, b2, a4;
+  jhcImg a1, b1, a2, b2, a4, sx4;
+
+  // exact transform state shared with band functions
+  const UC8 *e_src;
+  UC8 *e_lab, *e_dx, *e_dy, *e_rng, *e_sq;
+  int *e_sx, *e_v;
+  double *e_f, *e_z;
+  int e_rw, e_rh, e_lf, e_sln, e_lln, e_qln, e_xln, e_bg, e_env, e_cnt;
 
 
 // PUBLIC MEMBER FUNCTIONS
 public:
+  // creation and initialization
+  ~jhcDist ();
+  jhcDist ();
+
   // Manhattan distance
   int Nearest (jhcImg& label, const jhcImg& seed, int bg =0, jhcImg *rng =NULL);
   int Nearest8 (jhcImg& label, const jhcImg& seed, int bg =0, jhcImg *rng =NULL);
@@ -53,6 +66,27 @@ public:
   int Voronoi8 (jhcImg& label, const jhcImg& seed, int bg =0, jhcImg *rng =NULL, 
                 jhcImg *xrng =NULL, jhcImg *yrng =NULL, jhcImg *rng2 =NULL);
 
+  // exact Euclidean distance
+  int Euclid (jhcImg& label, const jhcImg& seed, int bg =0, jhcImg *rng =NULL, 
+              jhcImg *xrng =NULL, jhcImg *yrng =NULL, jhcImg *rng2 =NULL);
+  int Euclid8 (jhcImg& label, const jhcImg& seed, int bg =0, jhcImg *rng =NULL, 
+               jhcImg *xrng =NULL, jhcImg *yrng =NULL, jhcImg *rng2 =NULL);
+  int EuclidExpand (jhcImg& label, const jhcImg& seed, int dmax, int bg =0); 
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // exact Euclidean distance
+  int euclid_core (jhcImg& label, const jhcImg& seed, int bg, jhcImg *dist, 
+                   jhcImg *xdist, jhcImg *ydist, jhcImg *sqdist);
+  void env_size (int nb, int n);
+  int seed_lab (int x, int y) const;
+  static void euclid_rows (void *me, int band, int nb);
+  static void euclid_cols (void *me, int band, int nb);
+  void row_pass (int y0, int y1);
+  void col_pass (int x0, int x1, int band);
+  void set_pxl (int x, int y, int sx, int sy, int lab, double d2);
+
 };
 
 
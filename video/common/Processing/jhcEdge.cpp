@@ -21,11 +21,24 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <math.h>
+
+#include "Data/jhcImgPool.h"
+#include "Interface/jhcBandPool.h"
 #include "Interface/jhcMessage.h"
 
 #include "Processing/jhcEdge.h"
 
 
+//= Description of a banded edge job.
+
+typedef struct jhc_edge_job
+{
+  const UC8 *s0;
+  UC8 *m0, *d0;
+  int kind, sln, dln, rw, rh, sf, nz, m2, mod180;
+} jhc_edge_job;
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                         Creation and Destruction                      //
 ///////////////////////////////////////////////////////////////////////////
@@ -124,33 +137,16 @@ jhcEdge::~jhcEdge ()
 
 int jhcEdge::RobEdge (jhcImg& dest, const jhcImg& src, double sc) const 
 {
+  jhc_edge_job job;
+
   if (!dest.Valid(1) || !dest.SameFormat(src) || dest.SameImg(src))
     return Fatal("Bad images to jhcEdge::RobEdge");
   dest.CopyRoi(src);
 
-  // general ROI case
-  int val, sf = ROUND(sc * 256.0);
-  int x, y, dx, dy, rw = dest.RoiW(), rh = dest.RoiH();
-  int dsk = dest.RoiSkip(), ssk = dsk + 1;
-  UC8 *d = dest.RoiDest();
-  const UC8 *s = src.RoiSrc(), *a = s + src.Line();
-
-  // compute in interior (except for left border)
-  for (y = rh - 1; y > 0; y--, d += dsk, a += ssk, s += ssk) 
-  {
-    *d++ = 0;
-    for (x = rw - 1; x > 0; x--, d++, a++, s++)
-    {
-      dx = abs(s[1] - s[0]);
-      dy = abs(a[1] - s[1]);
-      val = sf * root[dy][dx];
-      *d = BOUND(val >> 16);
-    }
-  }
-
-  // cannot compute value for top line of image
-  for (x = rw; x > 0; x--, d++)
-    *d = 0;
+  // compute in bands (left border and top line are zero)
+  edge_job(job, &dest, NULL, src, 0);
+  job.sf = ROUND(sc * 256.0);
+  edge_run(job);
   return 1;
 }
 
@@ -338,57 +334,17 @@ int jhcEdge::SobelDir (jhcImg& dest, const jhcImg& src, int nz) const
 
 int jhcEdge::SobelAng (jhcImg& dest, const jhcImg& src, int mth, int mod180) const
 {
+  jhc_edge_job job;
+
   if (!dest.Valid(1) || !dest.SameFormat(src) || dest.SameImg(src))
     return Fatal("Bad images to jhcEdge::SobelAng");
   dest.CopyRoi(src);
 
-  // general ROI case
-  int x, y, dx, dy, val, rw = dest.RoiW(), rh = dest.RoiH(), m2 = mth * mth;
-  int ln = src.Line(), dsk = dest.RoiSkip() + 1, ssk = dsk + 1;
-  UC8 *d = dest.RoiDest();
-  const UC8 *b = src.RoiSrc(), *s = b + ln, *a = s + ln;
-
-  // cannot compute value for bottom line of image
-  for (x = rw; x > 0; x--, d++)
-    *d = 0;
-  d += dsk - 1;
-
-  // compute in interior (except for left and right border)
-  for (y = rh - 2; y > 0; y--, d += dsk, a += ssk, s += ssk, b += ssk) 
-  {
-    *d++ = 0;
-    for (x = rw - 2; x > 0; x--, d++, a++, s++, b++)
-    {
-      // compute mask convolution results
-      dy = ((a[0] + (a[1] << 1) + a[2]) - (b[0] + (b[1] << 1) + b[2])) >> 2;
-      dx = ((a[2] + (s[2] << 1) + b[2]) - (a[0] + (s[0] << 1) + b[0])) >> 2;
-
-      // check edge strength
-      if ((dx * dx + dy * dy) < m2)
-	    {
-        *d = 0;
-        continue;
-	    }
-
-      // resolve angle
-      if ((dx >= -128) && (dx < 128) && (dy >= -128) && (dy < 128))
-        val = arct[128 + dy][128 + dx];
-      else
-        val = arct[(256 + dy) >> 1][(256 + dx) >> 1];
-
-      // adjust range and guarantee non-zero
-      if (mod180 > 0)
-        val = (val >> 7) & 0xFF;
-	    else
-        val >>= 8;
-      *d = (UC8) __max(1, val);
-    }
-    *d = 0;
-  }
-
-  // cannot compute value for top line of image
-  for (x = rw; x > 0; x--, d++)
-    *d = 0;
+  // compute in bands (all borders are zero)
+  edge_job(job, NULL, &dest, src, 1);
+  job.m2 = mth * mth;
+  job.mod180 = mod180;
+  edge_run(job);
   return 1;
 }
 
@@ -404,64 +360,19 @@ int jhcEdge::SobelAng (jhcImg& dest, const jhcImg& src, int mth, int mod180) con
 
 int jhcEdge::SobelFull (jhcImg& mag, jhcImg& dir, const jhcImg& src, double sc, int nz) const 
 {
+  jhc_edge_job job;
+
   if (!mag.Valid(1) || !mag.SameFormat(dir) || !mag.SameFormat(src) || 
       mag.SameImg(src) || dir.SameImg(src))
     return Fatal("Bad images to jhcEdge::SobelFull");
   mag.CopyRoi(src);
   dir.CopyRoi(src);
 
-  // general ROI case
-  int val, sf = ROUND(sc * 256.0);
-  int x, y, dx, dy, rw = mag.RoiW(), rh = mag.RoiH();
-  int ln = src.Line(), dsk = mag.RoiSkip() + 1, ssk = dsk + 1;
-  UC8 *m = mag.RoiDest(), *d = dir.RoiDest();
-  const UC8 *b = src.RoiSrc(), *s = b + ln, *a = s + ln;
-
-  // cannot compute value for bottom line of image
-  for (x = rw; x > 0; x--, m++, d++)
-  {
-    *m = 0;
-    *d = 0;
-  }
-  m += dsk - 1;
-  d += dsk - 1;
-
-  // compute in interior (except for left and right border)
-  for (y = rh - 2; y > 0; y--, d += dsk, m += dsk, a += ssk, s += ssk) 
-  {
-    *m++ = 0;
-    *d++ = 0;
-    for (x = rw - 2; x > 0; x--, m++, d++, a++, s++)
-    {
-      // basic mask convolution results
-      dy = ((a[0] + (a[1] << 1) + a[2]) - (b[0] + (b[1] << 1) + b[2])) >> 2;
-      dx = ((a[2] + (s[2] << 1) + b[2]) - (a[0] + (s[0] << 1) + b[0])) >> 2;
-
-      // figure out direction (preserve small difference for better accuracy)
-      if ((dx >= -128) && (dx < 128) && (dy >= -128) && (dy < 128))
-        val = arct[128 + dy][128 + dx];
-      else
-        val = arct[(256 + dy) >> 1][(256 + dx) >> 1];
-      val >>= 8;
-      if ((nz > 0) && (val == 0))
-        *d = 1;
-	    else
-        *d = (UC8) val;
-
-      // figure out magnitude
-      val = (sf * root[abs(dy)][abs(dx)]) >> 16;
-      *m = (UC8) __min(val, 255);
-    }
-    *m = 0;
-    *d = 0;
-  }
-
-  // cannot compute value for top line of image
-  for (x = rw; x > 0; x--, m++, d++)
-  {
-    *m = 0;
-    *d = 0;
-  }
+  // compute in bands (all borders are zero)
+  edge_job(job, &mag, &dir, src, 2);
+  job.sf = ROUND(sc * 256.0);
+  job.nz = nz;
+  edge_run(job);
   return 1;
 }
 
@@ -778,84 +689,41 @@ int jhcEdge::SobelAngRGB2 (jhcImg& dest, const jhcImg& src, int mth) const
 
 int jhcEdge::SobelFullRGB (jhcImg& mag, jhcImg& dir, const jhcImg& src, double sc, int nz) const
 {
+  jhc_edge_job job;
+
   if (!mag.Valid(1) || !mag.SameFormat(dir) || !mag.SameSize(src, 3))
     return Fatal("Bad images to jhcEdge::SobelFullRGB");
   mag.CopyRoi(src);
   dir.CopyRoi(src);
 
-  // general ROI case
-  int val, sf = ROUND(sc * 256.0);
-  int x, y, f, dx, dy, d1, d2, rw = mag.RoiW(), rh = mag.RoiH();
-  int ln = src.Line(), dsk = mag.RoiSkip() + 1, ssk = src.RoiSkip() + 6;
-  UC8 *m = mag.RoiDest(), *d = dir.RoiDest();
-  const UC8 *b = src.RoiSrc(), *s = b + ln, *a = s + ln;
-
-  // cannot compute value for bottom line of image
-  for (x = rw; x > 0; x--, m++, d++)
-  {
-    *m = 0;
-    *d = 0;
-  }
-  m += dsk - 1;
-  d += dsk - 1;
-
-  // compute in interior (except for left and right border)
-  for (y = rh - 2; y > 0; y--, m += dsk, d += dsk, a += ssk, s += ssk, b += ssk) 
-  {
-    *m++ = 0;                                     // left border
-    *d++ = 0;  
-    for (x = rw - 2; x > 0; x--, m++, d++)
-    {
-      // combine basic mask convolution results from each field
-      dx = 0;
-      dy = 0;
-      for (f = 3; f > 0; f--, a++, s++, b++)
-      {
-        dy += abs((a[0] + (a[3] << 1) + a[6]) - (b[0] + (b[3] << 1) + b[6]));
-        dx += abs((a[6] + (s[6] << 1) + b[6]) - (a[0] + (s[0] << 1) + b[0]));
-      }
+  // compute in bands (all borders are zero)
+  edge_job(job, &mag, &dir, src, 3);
+  job.sf = ROUND(sc * 256.0);
+  job.nz = nz;
+  edge_run(job);
+  return 1;
+}
 
-      // figure out magnitude
-      val = (sf * root[dy][dx]) >> 16;
-      *m = (UC8) __min(val, 255);
 
-      // resolve basic angle (0-90) and guarantee non-zero
-      if ((dx < 128) && (dy < 128))
-        val = arct[128 + dy][128 + dx];
-      else
-        val = arct[(256 + dy) >> 1][(256 + dx) >> 1];
-      val = (val >> 7) & 0xFF;
+//= Computes magnitude and direction using the color channel with the strongest edge.
+// picks channel with biggest Sobel response then proceeds as for monochrome
+// direction covers full circle: 1 = 1.4 degs, 255 = 358.6 degs (360/256)
+// can optionally prevent angle from being 0 (forced to 1 instead)
 
-      // compute diagonal convolution results 
-      a -= 3;
-      s -= 3;
-      b -= 3;
-      d1 = 0;
-      d2 = 0;
-      for (f = 3; f > 0; f--, a++, s++, b++)
-      {
-        d1 += abs(((a[0] << 1) + a[3] + s[0]) - (s[6] + b[3] + (b[6] << 1)));
-        d2 += abs((a[3] + (a[6] << 1) + s[6]) - (s[0] + (b[0] << 1) + b[3]));
-      }
+int jhcEdge::SobelMaxRGB (jhcImg& mag, jhcImg& dir, const jhcImg& src, double sc, int nz) const
+{
+  jhc_edge_job job;
 
-      // possibly adjust quadrant
-      if (d1 > d2)
-        val = 256 - val;
-      if ((nz > 0) && (val == 0))
-        *d = 1;
-	    else
-        *d = (UC8) val;
-    }
-    *m = 0;                                       // right border
-    *d = 0;
-  }
+  if (!mag.Valid(1) || !mag.SameFormat(dir) || !mag.SameSize(src, 3))
+    return Fatal("Bad images to jhcEdge::SobelMaxRGB");
+  mag.CopyRoi(src);
+  dir.CopyRoi(src);
 
-  // cannot compute value for top line of image
-  for (x = rw; x > 0; x--, m++, d++)
-  {
-    *m = 0;
-    *d = 0;
-  }
+  // compute in bands (all borders are zero)
+  edge_job(job, &mag, &dir, src, 4);
+  job.sf = ROUND(sc * 256.0);
+  job.nz = nz;
+  edge_run(job);
   return 1;
 }
 
@@ -2659,6 +2527,272 @@ int jhcEdge::Angle (jhcImg &dest, const jhcImg& dx, const jhcImg& dy) const
 }
 
 
+///////////////////////////////////////////////////////////////////////////
+//                        Arithmetic Gradients                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Describe images and basic style for some banded edge job.
+// kind: 0 = RobEdge, 1 = SobelAng, 2 = SobelFull, 3 = SobelFullRGB, 4 = SobelMaxRGB
+
+void jhcEdge::edge_job (jhc_edge_job& job, jhcImg *mag, jhcImg *dir, const jhcImg& src, int kind) const
+{
+  const jhcImg *ref = ((mag != NULL) ? mag : dir);
+
+  job.kind = kind;
+  job.s0 = src.RoiSrc();
+  job.sln = src.Line();
+  job.m0 = ((mag != NULL) ? mag->RoiDest() : NULL);
+  job.d0 = ((dir != NULL) ? dir->RoiDest() : NULL);
+  job.dln = ref->Line();
+  job.rw = ref->RoiW();
+  job.rh = ref->RoiH();
+  job.sf = 256;
+  job.nz = 0;
+  job.m2 = 0;
+  job.mod180 = 0;
+}
+
+
+//= Process all lines of some edge job in bands.
+
+void jhcEdge::edge_run (jhc_edge_job& job) const
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+
+  bp->Run(edge_rows, &job, bp->Bands(job.rh, 16));
+}
+
+
+//= Compute magnitude and direction for a band of lines.
+// first gets gradient components for a whole line then converts them
+// all in simple loops the compiler can vectorize (no table lookups)
+
+void jhcEdge::edge_rows (void *ctx, int band, int nb)
+{
+  const jhc_edge_job *job = (const jhc_edge_job *) ctx;
+  const UC8 *s;
+  UC8 *m, *d;
+  int *gx, *gy, *d1, *d2, *ang;
+  int i, y, v, kind = job->kind, nz = job->nz, rw = job->rw, rh = job->rh;
+  int n = ((kind <= 0) ? rw - 1 : rw - 2), lo = ((kind <= 0) ? 0 : 1);
+  int y0 = (band * rh) / nb, y1 = ((band + 1) * rh) / nb;
+
+  // scratch lines for components and angles (recycled by thread)
+  gx = (int *) jhcImgPool::Shared()->Get(5 * rw * sizeof(int));
+  gy = gx + rw;
+  d1 = gy + rw;
+  d2 = d1 + rw;
+  ang = d2 + rw;
+
+  for (y = y0; y < y1; y++)
+  {
+    m = ((job->m0 != NULL) ? job->m0 + y * job->dln : NULL);
+    d = ((job->d0 != NULL) ? job->d0 + y * job->dln : NULL);
+
+    // cannot compute values for bottom or top line of image
+    if ((y < lo) || (y >= rh - 1) || (n <= 0))
+    {
+      for (i = 0; i < rw; i++)
+      {
+        if (m != NULL)
+          m[i] = 0;
+        if (d != NULL)
+          d[i] = 0;
+      }
+      continue;
+    }
+
+    // get components for line (left and right borders are zero)
+    s = job->s0 + y * job->sln;
+    if (kind <= 0)
+      rob_grad(gx, gy, s, s + job->sln, n);
+    else if (kind == 3)
+      sobel_sum(gx, gy, d1, d2, s - job->sln, s, s + job->sln, n);
+    else if (kind == 4)
+      sobel_max(gx, gy, s - job->sln, s, s + job->sln, n);
+    else
+      sobel_grad(gx, gy, s - job->sln, s, s + job->sln, n);
+    if (m != NULL)
+    {
+      m[0] = 0;
+      grad_mag(m + 1, gx, gy, n, job->sf);
+      if (kind > 0)
+        m[rw - 1] = 0;
+    }
+    if (d == NULL)
+      continue;
+    d[0] = 0;
+    d[rw - 1] = 0;
+    grad_ang(ang, gx, gy, n);
+
+    // encode direction for particular function
+    d++;
+    if (kind == 1)
+      for (i = 0; i < n; i++)
+      {
+        if ((gx[i] * gx[i] + gy[i] * gy[i]) < job->m2)
+          d[i] = 0;
+        else
+        {
+          v = ((job->mod180 > 0) ? (ang[i] >> 7) & 0xFF : ang[i] >> 8);
+          d[i] = (UC8) __max(1, v);
+        }
+      }
+    else if (kind == 3)
+      for (i = 0; i < n; i++)
+      {
+        v = (ang[i] >> 7) & 0xFF;
+        if (d1[i] > d2[i])
+          v = 256 - v;
+        d[i] = (UC8)(((nz > 0) && (v == 0)) ? 1 : v);
+      }
+    else
+      for (i = 0; i < n; i++)
+      {
+        v = ang[i] >> 8;
+        d[i] = (UC8)(((nz > 0) && (v == 0)) ? 1 : v);
+      }
+  }
+  jhcImgPool::Shared()->Put((UC8 *) gx);
+}
+
+
+//= Get adjacent orthogonal differences for n pixels of a line.
+// s is the line itself and a is the line above it
+
+void jhcEdge::rob_grad (int *gx, int *gy, const UC8 *s, const UC8 *a, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+  {
+    gx[i] = s[i + 1] - s[i];
+    gy[i] = a[i + 1] - s[i + 1];
+  }
+}
+
+
+//= Get standard Sobel components (divided by 4) for n pixels of a line.
+// b is the line below, s is the line itself, and a is the line above
+
+void jhcEdge::sobel_grad (int *gx, int *gy, const UC8 *b, const UC8 *s, const UC8 *a, int n)
+{
+  int i;
+
+  for (i = 0; i < n; i++)
+  {
+    gy[i] = ((a[i] + (a[i + 1] << 1) + a[i + 2]) - (b[i] + (b[i + 1] << 1) + b[i + 2])) >> 2;
+    gx[i] = ((a[i + 2] + (s[i + 2] << 1) + b[i + 2]) - (a[i] + (s[i] << 1) + b[i])) >> 2;
+  }
+}
+
+
+//= Get sums of absolute Sobel components over all color channels.
+// also gets diagonal mask sums to resolve quadrant (not divided by 4)
+
+void jhcEdge::sobel_sum (int *gx, int *gy, int *d1, int *d2, 
+                         const UC8 *b, const UC8 *s, const UC8 *a, int n)
+{
+  int i, f, j, dx, dy, p1, p2;
+
+  for (i = 0; i < n; i++)
+  {
+    dx = 0;
+    dy = 0;
+    p1 = 0;
+    p2 = 0;
+    for (f = 0; f < 3; f++)
+    {
+      j = 3 * i + f;
+      dy += abs((a[j] + (a[j + 3] << 1) + a[j + 6]) - (b[j] + (b[j + 3] << 1) + b[j + 6]));
+      dx += abs((a[j + 6] + (s[j + 6] << 1) + b[j + 6]) - (a[j] + (s[j] << 1) + b[j]));
+      p1 += abs(((a[j] << 1) + a[j + 3] + s[j]) - (s[j + 6] + b[j + 3] + (b[j + 6] << 1)));
+      p2 += abs((a[j + 3] + (a[j + 6] << 1) + s[j + 6]) - (s[j] + (b[j] << 1) + b[j + 3]));
+    }
+    gx[i] = dx;
+    gy[i] = dy;
+    d1[i] = p1;
+    d2[i] = p2;
+  }
+}
+
+
+//= Get Sobel components (divided by 4) from strongest color channel.
+// picks channel with largest squared magnitude (earliest if tied)
+
+void jhcEdge::sobel_max (int *gx, int *gy, const UC8 *b, const UC8 *s, const UC8 *a, int n)
+{
+  int i, f, j, dx, dy, e, best;
+
+  for (i = 0; i < n; i++)
+  {
+    best = -1;
+    for (f = 0; f < 3; f++)
+    {
+      j = 3 * i + f;
+      dy = ((a[j] + (a[j + 3] << 1) + a[j + 6]) - (b[j] + (b[j + 3] << 1) + b[j + 6])) >> 2;
+      dx = ((a[j + 6] + (s[j + 6] << 1) + b[j + 6]) - (a[j] + (s[j] << 1) + b[j])) >> 2;
+      e = dx * dx + dy * dy;
+      if (e > best)
+      {
+        gx[i] = dx;
+        gy[i] = dy;
+        best = e;
+      }
+    }
+  }
+}
+
+
+//= Convert gradient components into scaled edge magnitudes.
+// same as old root table: (sf * round(256 * sqrt((dx^2 + dy^2) / 2))) >> 16
+
+void jhcEdge::grad_mag (UC8 *m, const int *gx, const int *gy, int n, int sf)
+{
+  float rt2 = (float)(256.0 / sqrt(2.0));
+  int i, r, val;
+
+  for (i = 0; i < n; i++)
+  {
+    r = (int)(rt2 * sqrtf((float)(gx[i] * gx[i] + gy[i] * gy[i])) + 0.5f);
+    val = (sf * __min(r, 65535)) >> 16;
+    m[i] = BOUND(val);
+  }
+}
+
+
+//= Convert gradient components into 16 bit angles like old arct table.
+// result is atan2(-dx, dy) mapped to 0-65535 for a full circle
+// finds octant by sign and size comparisons then uses a polynomial for the
+// arctangent of the ratio (max error 0.001 degs) so rarely differs by one step
+
+void jhcEdge::grad_ang (int *ang, const int *gx, const int *gy, int n)
+{
+  float pi = 3.14159265f, sc = 65536.0f / (2.0f * pi);
+  float u, v, au, av, r, r2, t;
+  int i, val;
+
+  for (i = 0; i < n; i++)
+  {
+    // angle within first octant
+    u = (float) gy[i];
+    v = (float) -gx[i];
+    au = fabsf(u);
+    av = fabsf(v);
+    r = __min(au, av) / __max(__max(au, av), 1.0f);
+    r2 = r * r;
+    t = r * (0.9998660f + r2 * (-0.3302995f + r2 * (0.1801410f + r2 * (-0.0851330f + r2 * 0.0208351f))));
+
+    // unfold to full circle
+    t = ((av > au) ? 0.5f * pi - t : t);
+    t = ((u < 0.0f) ? pi - t : t);
+    t = ((v < 0.0f) ? 2.0f * pi - t : t);
+    val = (int)(sc * t + 0.5f);
+    ang[i] = ((val >= 65536) ? val - 65536 : val);
+  }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                             Bar Finding                               //
 ///////////////////////////////////////////////////////////////////////////
@@ -29,6 +29,11 @@
 #include "Data/jhcImg.h"
 
 
+// description of banded job (defined in jhcEdge.cpp)
+
+struct jhc_edge_job;
+
+
 //= Standard edge finders and some others.
 
 class jhcEdge
@@ -67,6 +72,7 @@ public:
   int SobelAngRGB2 (jhcImg& dest, const jhcImg& src, int mth =40) const;
   int SobelFullRGB (jhcImg& mag, jhcImg& dir, const jhcImg& src, double sc =1.0, int nz =0) const;
   int SobelFullRGB2 (jhcImg& mag, jhcImg& dir, const jhcImg& src, double sc =1.0, int nz =0) const;
+  int SobelMaxRGB (jhcImg& mag, jhcImg& dir, const jhcImg& src, double sc =1.0, int nz =0) const;
 
   // categorized directions
   int SobelHV (jhcImg& mag, jhcImg& dir, const jhcImg& src, double hi =15.0, double lo =10.0) const;
@@ -109,6 +115,18 @@ private:
   int Sobel22_RGB (jhcImg& mag, jhcImg& dir, const jhcImg& src, double hi =15.0, double lo =10.0) const;
   int SobelQuad_RGB (jhcImg& mag, jhcImg& hv, jhcImg& d12, const jhcImg& src, double hi =15.0, double lo =10.0) const;
 
+  // arithmetic gradients
+  void edge_job (jhc_edge_job& job, jhcImg *mag, jhcImg *dir, const jhcImg& src, int kind) const;
+  void edge_run (jhc_edge_job& job) const;
+  static void edge_rows (void *ctx, int band, int nb);
+  static void rob_grad (int *gx, int *gy, const UC8 *s, const UC8 *a, int n);
+  static void sobel_grad (int *gx, int *gy, const UC8 *b, const UC8 *s, const UC8 *a, int n);
+  static void sobel_sum (int *gx, int *gy, int *d1, int *d2, 
+                         const UC8 *b, const UC8 *s, const UC8 *a, int n);
+  static void sobel_max (int *gx, int *gy, const UC8 *b, const UC8 *s, const UC8 *a, int n);
+  static void grad_mag (UC8 *m, const int *gx, const int *gy, int n, int sf);
+  static void grad_ang (int *ang, const int *gx, const int *gy, int n);
+
 
 };
 
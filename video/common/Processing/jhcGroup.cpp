@@ -25,6 +25,19 @@
 #include "Processing/jhcGroup.h"
 
 
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default constructor initializes certain values.
+// scratch image recycles buffers through shared pool when size changes
+
+jhcGroup::jhcGroup ()
+{
+  tmp.pool = 1;
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                     Basic Connected Components                        //
 ///////////////////////////////////////////////////////////////////////////
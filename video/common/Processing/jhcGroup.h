@@ -43,6 +43,9 @@ protected:
 
 // PUBLIC MEMBER FUNCTIONS
 public:
+  // creation and initialization
+  jhcGroup ();
+
   // basic CC
   int CComps4 (jhcImg& dest, const jhcImg& src, int amin =0, int th =0, int label0 =0);
   int CComps8 (jhcImg& dest, const jhcImg& src, int amin =0, int th =0, int label0 =0);
@@ -21,11 +21,39 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <math.h>
+#include <string.h>
+
+#include "Interface/jhcBandPool.h"
 #include "Interface/jhcMessage.h"
 
 #include "Processing/jhcResize.h"
 
 
+//= Description of a resizing job shared by all bands of lines.
+
+typedef struct jhc_rsz_job
+{
+  // images
+  const UC8 *s0;
+  UC8 *d0;
+  int kind, sln, dln, sw, sh, dw, dh, nf;
+
+  // bi-cubic tap tables and temporary lines
+  const int *xtab, *ytab;
+  int *tmp;
+  int tln;
+
+  // bilinear column offsets and mixes
+  const int *pos, *mix;
+  int n, cnt0, cnt1, cnt;
+
+  // rigid transform start and steps (16.16 fixed point or per line)
+  int isx0, isy0, ixc, ixs, iyc, iys, def[3];
+  const double *rs;
+  double xc, xs;
+} jhc_rsz_job;
+
+
 //////////////////////////////////////////////////////////////////////////////
 //                     Basic creation and deletion                          //
 //////////////////////////////////////////////////////////////////////////////
@@ -42,6 +70,7 @@ jhcResize::~jhcResize ()
 
 jhcResize::jhcResize ()
 {
+  t2.pool = 1;
   temp = NULL;
   tsize = 0;
 }
@@ -1079,11 +1108,12 @@ int jhcResize::Resample (jhcImg& dest, const jhcImg &src, double cx, double cy,
   double dy0, dy1, dx0, dx1, sx0, sy0, sx, sy, xstep = 1.0 / magx, ystep = 1.0 / magy;
   int dw = dest.XDim(), dh = dest.YDim(), dsk = dest.Skip(), nf = dest.Fields();
   int sw = src.XDim(), sh = src.YDim(), sln = src.Line();
-  int y0, y1, x0, x1, cnt0, cnt1, x0b, x1b, y0b, y1b, n, i, j, cnt = dw * nf;
-  int x, y, ix, iy, up, dn, lf, rt, swf, sef, nwf, nef, v;
+  int y0, y1, x0, x1, cnt0, cnt1, n, i, cnt = dw * nf;
+  int x, y, ix, iy;
   UC8 *d = dest.PxlDest();
-  const UC8 *s0, *s;
-  int *pos, *mix;
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhc_rsz_job job;
+  int *pos, *mix, *rows;
 
   // determine destination y limits for interpolation (inclusive)
   dy0 = 0.5 * (dh - 1) - cy * magy;
@@ -1099,12 +1129,6 @@ int jhcResize::Resample (jhcImg& dest, const jhcImg &src, double cx, double cy,
   cnt0 = x0 * nf;
   cnt1 = (x1 + 1) * nf;
 
-  // find border regions of image
-  y0b = __max(0, y0 - ROUND(0.5 * magy));
-  y1b = __min(y1 + ROUND(0.5 * magy), dh - 1);
-  x0b = __max(0, x0 - ROUND(0.5 * magx));
-  x1b = __min(x1 + ROUND(0.5 * magx), dw - 1);
-
   // allocate arrays for sampling control
   n = x1 - x0 + 1;
   pos = (int *) new int[n];
@@ -1132,50 +1156,36 @@ int jhcResize::Resample (jhcImg& dest, const jhcImg &src, double cx, double cy,
   // right corner pixel duplication
 
   // -----------------MIDDLE--------------------
-  // valid portion for sampling
-  sy0 = cy + (y0 - 0.5 * (dh - 1)) * ystep;
-  for (y = y0, sy = sy0; y <= y1; y++, sy += ystep, d += dsk)
+  // get source line and mixing coefficient for each valid line
+  if (y1 >= y0)
   {
-    // possible blank pixels at beginning of line
-    for (i = 0; i < cnt0; i++, d++)
-      *d = 0;
-
-    // get mixing coefficients for adjacent lines
-    iy = (int) floor(sy);
-    up = ROUND(256.0 * (sy - iy));
-    dn = 256 - up;
-
-    // left edge pixels
-
-    // interpolate in the middle
-    s0 = src.PxlSrc() + iy * sln;
-    for (i = 0; i < n; i++, d += nf)
-    { 
-      // figure out cascaded coefficients 
-      rt = mix[i];
-      lf = 256 - rt;
-      swf = dn * lf;
-      sef = dn * rt;
-      nwf = up * lf;
-      nef = up * rt;
-
-      // mix all fields
-      s = s0 + pos[i];
-      for (j = 0; j < nf; j++)
-      {
-        v =  swf * s[j];
-        v += sef * s[j + nf];  
-        v += nwf * s[j + sln];  
-        v += nef * s[j + sln + nf];  
-        d[j] = (UC8)(v >> 16);
-      }
+    rows = (int *) new int[2 * (y1 - y0 + 1)];
+    sy0 = cy + (y0 - 0.5 * (dh - 1)) * ystep;
+    for (i = 0, sy = sy0; i <= (y1 - y0); i++, sy += ystep)
+    {
+      iy = (int) floor(sy);
+      rows[i + i] = iy * sln;
+      rows[i + i + 1] = ROUND(256.0 * (sy - iy));
     }
 
-    // right edge pixels
-
-    // possible blank pixels at end of line
-    for (i = cnt1; i < cnt; i++, d++)
-      *d = 0;
+    // interpolate bands of valid lines in parallel
+    job.kind = 0;
+    job.s0 = src.PxlSrc();
+    job.d0 = d;
+    job.sln = sln;
+    job.dln = dest.Line();
+    job.nf = nf;
+    job.dh = y1 - y0 + 1;
+    job.n = n;
+    job.pos = pos;
+    job.mix = mix;
+    job.ytab = rows;
+    job.cnt0 = cnt0;
+    job.cnt1 = cnt1;
+    job.cnt = cnt;
+    bp->Run(resamp_rows, &job, bp->Bands(job.dh, 8));
+    d += job.dh * job.dln;
+    delete [] rows;
   }
 
   // -------------------TOP---------------------
@@ -1212,10 +1222,11 @@ int jhcResize::Resample_16 (jhcImg& dest, const jhcImg &src, double cx, double c
   int dw = dest.XDim(), dh = dest.YDim(), dsk = dest.Skip() >> 1;
   int sw = src.XDim(), sh = src.YDim(), sln = src.Line() >> 1;
   int y0, y1, x0, x1, cnt0, cnt1, x0b, x1b, y0b, y1b, n, i; 
-  int x, y, ix, iy, up, dn, lf, rt, swf, sef, nwf, nef, v;
+  int x, y, ix, iy;
   US16 *d = (US16 *) dest.PxlDest();
-  const US16 *s0, *s;
-  int *pos, *mix;
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhc_rsz_job job;
+  int *pos, *mix, *rows;
 
   // determine destination y limits for interpolation (inclusive)
   dy0 = 0.5 * (dh - 1) - cy * magy;
@@ -1264,24 +1275,110 @@ int jhcResize::Resample_16 (jhcImg& dest, const jhcImg &src, double cx, double c
   // right corner pixel duplication
 
   // -----------------MIDDLE--------------------
-  // valid portion for sampling
-  sy0 = cy + (y0 - 0.5 * (dh - 1)) * ystep;
-  for (y = y0, sy = sy0; y <= y1; y++, sy += ystep, d += dsk)
+  // get source line and mixing coefficient for each valid line
+  if (y1 >= y0)
   {
-    // possible blank pixels at beginning of line
-    for (i = 0; i < cnt0; i++, d++)
+    rows = (int *) new int[2 * (y1 - y0 + 1)];
+    sy0 = cy + (y0 - 0.5 * (dh - 1)) * ystep;
+    for (i = 0, sy = sy0; i <= (y1 - y0); i++, sy += ystep)
+    {
+      iy = (int) floor(sy);
+      rows[i + i] = iy * sln;
+      rows[i + i + 1] = ROUND(256.0 * (sy - iy));
+    }
+
+    // interpolate bands of valid lines in parallel
+    job.kind = 1;
+    job.s0 = src.PxlSrc();
+    job.d0 = (UC8 *) d;
+    job.sln = sln;
+    job.dln = dest.Line();
+    job.nf = 1;
+    job.dh = y1 - y0 + 1;
+    job.n = n;
+    job.pos = pos;
+    job.mix = mix;
+    job.ytab = rows;
+    job.cnt0 = cnt0;
+    job.cnt1 = cnt1;
+    job.cnt = dw;
+    bp->Run(resamp_rows, &job, bp->Bands(job.dh, 8));
+    d += job.dh * (job.dln >> 1);
+    delete [] rows;
+  }
+
+  // -------------------TOP---------------------
+  // left corner pixel duplication
+
+  // interpolation of border pixels
+
+  // right corner pixel duplication
+
+  // possible blank lines at top of image
+  for (y = y1 + 1; y < dh; y++, d += dsk)
+    for (x = 0; x < dw; x++, d++)
       *d = 0;
 
+  // clean up
+  delete [] mix;
+  delete [] pos;
+  return 1;
+}
+
+
+//= Bilinear interpolation for a band of valid lines in Resample or Resample_16.
+// source line offset and vertical mix for each line precomputed in ytab
+
+void jhcResize::resamp_rows (void *ctx, int band, int nb)
+{
+  const jhc_rsz_job *job = (const jhc_rsz_job *) ctx;
+  const int *pos = job->pos, *mix = job->mix;
+  int i, j, y, iy, up, dn, lf, rt, swf, sef, nwf, nef, v;
+  int nf = job->nf, sln = job->sln, n = job->n, cnt0 = job->cnt0, cnt1 = job->cnt1, cnt = job->cnt;
+  int y0 = (band * job->dh) / nb, y1 = ((band + 1) * job->dh) / nb;
+  const UC8 *s, *s0;
+  const US16 *w, *w0;
+  UC8 *d;
+  US16 *d16;
+
+  for (y = y0; y < y1; y++)
+  {
     // get mixing coefficients for adjacent lines
-    iy = (int) floor(sy);
-    up = ROUND(256.0 * (sy - iy));
+    iy = job->ytab[y + y];
+    up = job->ytab[y + y + 1];
     dn = 256 - up;
 
-    // left edge pixels
+    // 16 bit version
+    if (job->kind > 0)
+    {
+      w0 = (const US16 *) job->s0 + iy;
+      d16 = (US16 *)(job->d0 + y * job->dln);
+      for (i = 0; i < cnt0; i++)
+        d16[i] = 0;
+      for (i = 0; i < n; i++)
+      {
+        rt = mix[i];
+        lf = 256 - rt;
+        w = w0 + pos[i];
+        v =  (dn * lf) * w[0];
+        v += (dn * rt) * w[1];  
+        v += (up * lf) * w[sln];  
+        v += (up * rt) * w[sln + 1];  
+        d16[cnt0 + i] = (US16)(v >> 16);
+      }
+      for (i = cnt1; i < cnt; i++)
+        d16[i] = 0;
+      continue;
+    }
+
+    // possible blank pixels at beginning of line
+    s0 = job->s0 + iy;
+    d = job->d0 + y * job->dln;
+    for (i = 0; i < cnt0; i++)
+      *d++ = 0;
 
     // interpolate in the middle
-    s0 = ((US16 *) src.PxlSrc()) + iy * sln;
-    for (i = 0; i < n; i++, d++)
+    for (i = 0; i < n; i++, d += nf)
     { 
       // figure out cascaded coefficients 
       rt = mix[i];
@@ -1291,38 +1388,22 @@ int jhcResize::Resample_16 (jhcImg& dest, const jhcImg &src, double cx, double c
       nwf = up * lf;
       nef = up * rt;
 
-      // mix fields
+      // mix all fields
       s = s0 + pos[i];
-      v =  swf * s[0];
-      v += sef * s[1];  
-      v += nwf * s[sln];  
-      v += nef * s[sln + 1];  
-      d[0] = (US16)(v >> 16);
+      for (j = 0; j < nf; j++)
+      {
+        v =  swf * s[j];
+        v += sef * s[j + nf];  
+        v += nwf * s[j + sln];  
+        v += nef * s[j + sln + nf];  
+        d[j] = (UC8)(v >> 16);
+      }
     }
 
-    // right edge pixels
-
     // possible blank pixels at end of line
-    for (i = cnt1; i < dw; i++, d++)
-      *d = 0;
+    for (i = cnt1; i < cnt; i++)
+      *d++ = 0;
   }
-
-  // -------------------TOP---------------------
-  // left corner pixel duplication
-
-  // interpolation of border pixels
-
-  // right corner pixel duplication
-
-  // possible blank lines at top of image
-  for (y = y1 + 1; y < dh; y++, d += dsk)
-    for (x = 0; x < dw; x++, d++)
-      *d = 0;
-
-  // clean up
-  delete [] mix;
-  delete [] pos;
-  return 1;
 }
 
 
@@ -1513,157 +1594,40 @@ int jhcResize::Bicubic (jhcImg& dest, const jhcImg& src, int conform)
 
 int jhcResize::Bicubic_BW (jhcImg& dest, const jhcImg& src, int conform)
 {
-  double stepx, stepy, xf, yf;
-  int dw = dest.XDim(), dh = dest.YDim(), sw = src.XDim(), sh = src.YDim();
-  int dsk = dest.Skip(), sln = src.Line(), xlim = sw - 2, ylim = sh - 2;
-  int x, y, v, xi, yi, xp, yp, dx, dy, p0, p1, p2, p3, a, b, c, d;
-  int *t, *t0;
-  const UC8 *s, *s0 = src.PxlSrc();
-  UC8 *r = dest.PxlDest();
-
-  // scales with single factor so full source image will fit into destination
-  stepx = sw / (double)(dw + 1);
-  stepy = sh / (double)(dh + 1);
-  if (conform <= 0)
-  {
-    stepx = __max(stepx, stepy);
-    stepy = stepx;
-  }
-
-  // set up temporary array (32 bit signed integer)
-  alloc(sln * dh);
-
-  // PASS 1 - do vertical interpolation of source into temporary array
-  t0 = temp;
-  for (x = 0; x < sw; x++, s0++, t0++)
-  {
-    // set up bottom side values (will be shuffled down)
-    s = s0;
-    t = t0;
-    p2 = s[0];
-    p3 = s[sln];
-    p1 = (p2 << 1) - p3;
-    s += (sln + sln);
-
-    // start generating output pixels
-    yp = -1;
-    yf = 0.0;
-    for (y = 0; y < dh; y++, t += sw, yf += stepy)
-    {
-      // see if moved into next gap between pixels
-      yi = (int) yf;
-      if (yp < yi)
-      {
-        // get new local window
-        while (yp < yi)
-        {
-          // shuffle points
-          p0 = p1;
-          p1 = p2;
-          p2 = p3;
-
-          // check for top side
-          if (yi < ylim)
-            p3 = *s;
-          else
-            p3 = (p2 << 1) - p1;
-
-          // advance source pointer
-          s += sln;
-          yp++;
-        }
-
-        // recompute coefficients
-        a = -p0 + 3 * (p1 - p2) + p3;                     // a * 2
-        b = ((p0 << 1) - 5 * p1 + (p2 << 2) - p3) << 8;   // b * 2^9
-        c = (p2 - p0) << 8;                               // c * 2^9
-        d = p1 << 8;                                      // d * 2^8
-      }
+  return cubic_all(dest, src, conform, 0);
+}
 
-      // compute new roughly 16 bit signed intermediate pixel values
-      // Note: really should only be 0-65535 but much slower to clamp
-      // v = a * y^3 + b * y^2 + c * y + d
-      //   = ((a * y + b) * y + c) * y + d
-      dy = ROUND(256.0 * (yf - yi));
-      v = a * dy + b;               
-      v = ((v * dy) >> 8) + c;
-      v = ((v * dy) >> 9) + d;
-      *t = v;
-    }
-  }
 
-  // PASS 2 - do horizontal interpolation of temporary array into destination
-  t0 = temp;
-  for (y = 0; y < dh; y++, r += dsk, t0 += sw)
-  {
-    // set up far left side values (will be shuffled down)
-    t = t0;
-    p2 = t[0];
-    p3 = t[1];
-    p1 = (p2 << 1) - p3;
-    t += 2;
+//= Use bi-cubic convolution to give high-quality resampling of 16 bit image.
+// uses separate x and y scaling factors if conform is positive
 
-    // start generating intermediate pixels
-    xp = -1;
-    xf = 0.0;
-    for (x = 0; x < dw; x++, r++, xf += stepx)
-    {
-      // see if moved into next gap between pixels
-      xi = (int) xf;
-      if (xp < xi)
-      {
-        // get new local window
-        while (xp < xi)
-        {
-          // shuffle points
-          p0 = p1;
-          p1 = p2;
-          p2 = p3;
-
-          // check for far right side
-          if (xi < xlim)
-            p3 = *t;
-          else
-            p3 = (p2 << 1) - p1;
+int jhcResize::Bicubic_16 (jhcImg& dest, const jhcImg& src, int conform)
+{
+  return cubic_all(dest, src, conform, 1);
+}
 
-          // advance source pointer
-          t++;
-          xp++;
-        }
 
-        // recompute coefficients (with pixels * 2^8)
-        a = (-p0 + 3 * (p1 - p2) + p3) >> 8;        // a * 2
-        b = (p0 << 1) - 5 * p1 + (p2 << 2) - p3;    // b * 2^9
-        c = p2 - p0;                                // c * 2^9
-        d = p1;                                     // d * 2^8
-      }
+//= Use bi-cubic convolution to give high-quality resampling of color image.
+// uses separate x and y scaling factors if conform is positive
 
-      // compute new 8 bit unsigned output pixel values
-      // v = a * x^3 + b * x^2 + c * x + d
-      //   = ((a * x + b) * x + c) * x + d
-      dx = ROUND(256.0 * (xf - xi));
-      v = a * dx + b;               
-      v = ((v * dx) >> 8) + c;
-      v = ((v * dx) >> 9) + d;
-      *r = BOUND(v >> 8);
-    }
-  }
-  return 1;
+int jhcResize::Bicubic_RGB (jhcImg& dest, const jhcImg& src, int conform)
+{
+  return cubic_all(dest, src, conform, 2);
 }
 
 
-//= Use bi-cubic convolution to give high-quality resampling of 16 bit image.
-// uses separate x and y scaling factors if conform is positive
+//= Common bi-cubic resampling for monochrome (kind 0), 16 bit (1), or color (2).
+// source window and fraction for every output line and column are found first
+// then bands of lines are done in parallel, vertically into an integer line
+// followed by horizontally into the destination (same arithmetic as before)
 
-int jhcResize::Bicubic_16 (jhcImg& dest, const jhcImg& src, int conform)
+int jhcResize::cubic_all (jhcImg& dest, const jhcImg& src, int conform, int kind)
 {
-  double stepx, stepy, xf, yf;
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhc_rsz_job job;
+  double stepx, stepy;
   int dw = dest.XDim(), dh = dest.YDim(), sw = src.XDim(), sh = src.YDim();
-  int dsk = dest.Skip() >> 1, sln = src.Line() >> 1, xlim = sw - 2, ylim = sh - 2;
-  int x, y, v, xi, yi, xp, yp, dx, dy, p0, p1, p2, p3, a, b, c, d;
-  int *t, *t0;
-  const US16 *s, *s0 = (const US16 *) src.PxlSrc();
-  US16 *r = (US16 *) dest.PxlDest();
+  int nf = ((kind == 2) ? 3 : 1), tln = sw * nf;
 
   // scales with single factor so full source image will fit into destination
   stepx = sw / (double)(dw + 1);
@@ -1674,294 +1638,264 @@ int jhcResize::Bicubic_16 (jhcImg& dest, const jhcImg& src, int conform)
     stepy = stepx;
   }
 
-  // set up temporary array (32 bit signed integer)
-  alloc(sln * dh);
+  // set up temporary lines (32 bit signed integer) and tap tables
+  alloc(tln * dh + 17 * (dw + dh));
+  job.tmp  = temp;
+  job.xtab = temp + tln * dh;
+  job.ytab = job.xtab + 17 * dw;
+  cubic_taps(temp + tln * dh, dw, stepx, sw);
+  cubic_taps(temp + tln * dh + 17 * dw, dh, stepy, sh);
+
+  // describe images then process bands of lines
+  job.kind = kind;
+  job.s0 = src.PxlSrc();
+  job.d0 = dest.PxlDest();
+  job.sln = src.Line();
+  job.dln = dest.Line();
+  job.sw = sw;
+  job.dw = dw;
+  job.dh = dh;
+  job.nf = nf;
+  job.tln = tln;
+  bp->Run(cubic_rows, &job, bp->Bands(dh, 8));
+  return 1;
+}
 
-  // PASS 1 - do vertical interpolation of source into temporary array
-  t0 = temp;
-  for (x = 0; x < sw; x++, s0++, t0++)
-  {
-    // set up bottom side values (will be shuffled down)
-    s = s0;
-    t = t0;
-    p2 = s[0];
-    p3 = s[sln];
-    p1 = (p2 << 1) - p3;
-    s += (sln + sln);
-
-    // start generating output pixels
-    yp = -1;
-    yf = 0.0;
-    for (y = 0; y < dh; y++, t += sw, yf += stepy)
-    {
-      // see if moved into next gap between pixels
-      yi = (int) yf;
-      if (yp < yi)
-      {
-        // get new local window
-        while (yp < yi)
-        {
-          // shuffle points
-          p0 = p1;
-          p1 = p2;
-          p2 = p3;
-
-          // check for top side
-          if (yi < ylim)
-            p3 = *s;
-          else
-            p3 = (p2 << 1) - p1;
 
-          // advance source pointer
-          s += sln;
-          yp++;
-        }
+//= Find source window and fraction for each of n outputs along some axis.
+// each output gets 17 values: 8 bit fraction then 4 taps of (i0 c0 i1 c1)
+// where tap value = c0 * src[i0] + c1 * src[i1] (c1 = 0 if a real pixel)
+// mimics original shuffling so extrapolations past the ends are identical
 
-        // recompute coefficients
-        a = -p0 + 3 * (p1 - p2) + p3;              // a * 2
-        b = (p0 << 1) - 5 * p1 + (p2 << 2) - p3;   // b * 2
-        c = p2 - p0;                               // c * 2
-        d = p1;                                    // d
-      }
+void jhcResize::cubic_taps (int *tab, int n, double step, int ns) const
+{
+  int p0[4], p1[4], p2[4], p3[4];
+  double f = 0.0;
+  int i, fi, fp = -1, lim = ns - 2, nxt = 2;
+  int *t = tab;
 
-      // compute new roughly 16 bit signed intermediate pixel values
-      // Note: really should only be 0-65535 but much slower to clamp
-      // v = a * y^3 + b * y^2 + c * y + d
-      //   = ((a * y + b) * y + c) * y + d
-      dy = ROUND(256.0 * (yf - yi));
-      v = (a * dy + b) >> 8;               
-      v = ((v * dy) >> 8) + c;
-      v = ((v * dy) >> 9) + d;
-      *t = v;
+  // set up far left side values (will be shuffled down)
+  set_tap(p2, 0);
+  set_tap(p3, 1);
+  ext_tap(p1, p2, p3);
+
+  // find window for each output
+  for (i = 0; i < n; i++, t += 17, f += step)
+  {
+    // see if moved into next gap between pixels
+    fi = (int) f;
+    while (fp < fi)
+    {
+      // shuffle points
+      memcpy(p0, p1, 4 * sizeof(int));
+      memcpy(p1, p2, 4 * sizeof(int));
+      memcpy(p2, p3, 4 * sizeof(int));
+
+      // check for far side
+      if (fi < lim)
+        set_tap(p3, nxt);
+      else
+        ext_tap(p3, p2, p1);
+      nxt++;
+      fp++;
     }
+
+    // record window
+    t[0] = ROUND(256.0 * (f - fi));
+    memcpy(t + 1,  p0, 4 * sizeof(int));
+    memcpy(t + 5,  p1, 4 * sizeof(int));
+    memcpy(t + 9,  p2, 4 * sizeof(int));
+    memcpy(t + 13, p3, 4 * sizeof(int));
   }
+}
 
-  // PASS 2 - do horizontal interpolation of temporary array into destination
-  t0 = temp;
-  for (y = 0; y < dh; y++, r += dsk, t0 += sw)
-  {
-    // set up far left side values (will be shuffled down)
-    t = t0;
-    p2 = t[0];
-    p3 = t[1];
-    p1 = (p2 << 1) - p3;
-    t += 2;
 
-    // start generating intermediate pixels
-    xp = -1;
-    xf = 0.0;
-    for (x = 0; x < dw; x++, r++, xf += stepx)
-    {
-      // see if moved into next gap between pixels
-      xi = (int) xf;
-      if (xp < xi)
-      {
-        // get new local window
-        while (xp < xi)
-        {
-          // shuffle points
-          p0 = p1;
-          p1 = p2;
-          p2 = p3;
-
-          // check for far right side
-          if (xi < xlim)
-            p3 = *t;
-          else
-            p3 = (p2 << 1) - p1;
+//= Make a tap which is just some real source pixel.
+
+void jhcResize::set_tap (int *p, int i) const
+{
+  p[0] = i;
+  p[1] = 1;
+  p[2] = i;
+  p[3] = 0;
+}
 
-          // advance source pointer
-          t++;
-          xp++;
-        }
 
-        // recompute coefficients (with pixels * 2^8)
-        a = (-p0 + 3 * (p1 - p2) + p3) >> 8;        // a * 2
-        b = (p0 << 1) - 5 * p1 + (p2 << 2) - p3;    // b * 2^9
-        c = p2 - p0;                                // c * 2^9
-        d = p1;                                     // d * 2^8
+//= Make a tap which is the linear extrapolation 2 * a - b.
+// all taps come from at most 2 adjacent source pixels so result does also
+
+void jhcResize::ext_tap (int *p, const int *a, const int *b) const
+{
+  int ix[4] = {a[0], a[2], b[0], b[2]}, cf[4] = {2 * a[1], 2 * a[3], -b[1], -b[3]};
+  int i, j, n = 0;
+
+  // merge coefficients for the same pixel
+  for (i = 0; i < 4; i++)
+    for (j = i + 1; j < 4; j++)
+      if (ix[j] == ix[i])
+      {
+        cf[i] += cf[j];
+        cf[j] = 0;
       }
 
-      // compute new 16 bit unsigned output pixel values
-      // v = a * x^3 + b * x^2 + c * x + d
-      //   = ((a * x + b) * x + c) * x + d
-      dx = ROUND(256.0 * (xf - xi));
-      v = a * dx + b;               
-      v = ((v * dx) >> 8) + c;
-      v = ((v * dx) >> 9) + d;
-      *r = (US16) __max(0, __min(v, 65535));
+  // keep first two non-zero terms
+  set_tap(p, ix[0]);
+  p[1] = 0;
+  for (i = 0; i < 4; i++)
+    if (cf[i] != 0)
+    {
+      p[n]     = ix[i];
+      p[n + 1] = cf[i];
+      if ((n += 2) >= 4)
+        break;
     }
-  }
-  return 1;
+  if (n == 2)
+    p[2] = p[0];
 }
 
 
-//= Use bi-cubic convolution to give high-quality resampling of color image.
-// uses separate x and y scaling factors if conform is positive
+//= Do vertical then horizontal bi-cubic interpolation for a band of lines.
+// uses fast loops where all 4 taps are real pixels, general form elsewhere
 
-int jhcResize::Bicubic_RGB (jhcImg& dest, const jhcImg& src, int conform)
+void jhcResize::cubic_rows (void *ctx, int band, int nb)
 {
-  int p0[3], p1[3], p2[3], p3[3], a[3], b[3], c[3], d[3];
-  double stepx, stepy, xf, yf;
-  int dw = dest.XDim(), dh = dest.YDim(), sw = src.XDim(), sh = src.YDim();
-  int dsk = dest.Skip(), sln = src.Line(), tln = 3 * sw, xlim = sw - 2, ylim = sh - 2;
-  int x, y, f, v, xi, yi, xp, yp, dx, dy;
-  int *t, *t0;
-  const UC8 *s, *s0 = src.PxlSrc();
-  UC8 *r = dest.PxlDest();
-
-  // scales with single factor so full source image will fit into destination
-  stepx = sw / (double)(dw + 1);
-  stepy = sh / (double)(dh + 1);
-  if (conform <= 0)
-  {
-    stepx = __max(stepx, stepy);
-    stepy = stepx;
-  }
+  const jhc_rsz_job *job = (const jhc_rsz_job *) ctx;
+  const int *tab, *tap, *xtab = job->xtab;
+  const UC8 *r[4], *r1[4];
+  const US16 *w[4], *w1[4];
+  int c0[4], c1[4], p[4];
+  int k, x, y, v, a, b, c, d, dx, dy, f, pure, xlo, xhi;
+  int dh = job->dh, dw = job->dw, nf = job->nf, m = job->tln, kind = job->kind;
+  int y0 = (band * dh) / nb, y1 = ((band + 1) * dh) / nb;
+  int *t;
+  UC8 *out;
+  US16 *out16;
 
-  // set up temporary array (32 bit signed integer)
-  alloc(sln * dh);
+  // find span of columns where all taps are real pixels
+  for (xlo = 0; xlo < dw; xlo++)
+    if (cubic_pure(xtab + 17 * xlo))
+      break;
+  for (xhi = dw; xhi > xlo; xhi--)
+    if (cubic_pure(xtab + 17 * (xhi - 1)))
+      break;
 
-  // PASS 1 - do vertical interpolation of source into temporary array
-  t0 = temp;
-  for (x = 0; x < sw; x++, s0 += 3, t0 += 3)
+  for (y = y0; y < y1; y++)
   {
-    // set up bottom side values (will be shuffled down)
-    s = s0;
-    t = t0;
-    for (f = 0; f < 3; f++, s++)
+    // PASS 1 - vertical interpolation of source lines into temporary line
+    tab = job->ytab + 17 * y;
+    dy = tab[0];
+    pure = cubic_pure(tab);
+    for (k = 0, tap = tab + 1; k < 4; k++, tap += 4)
     {
-      p2[f] = s[0];
-      p3[f] = s[sln];
-      p1[f] = (p2[f] << 1) - p3[f];
+      r[k]  = job->s0 + tap[0] * job->sln;
+      r1[k] = job->s0 + tap[2] * job->sln;
+      c0[k] = tap[1];
+      c1[k] = tap[3];
     }
-    s += (sln + sln - 3);
-
-    // start generating output pixels
-    yp = -1;
-    yf = 0.0;
-    for (y = 0; y < dh; y++, t += tln, yf += stepy)
+    t = job->tmp + y * m;
+    if (kind != 1)
     {
-      // see if moved into next gap between pixels
-      yi = (int) yf;
-      if (yp < yi)
-      {
-        // get new local window
-        while (yp < yi)
+      // 8 bit values (pixels * 2^8)
+      if (pure)
+        for (x = 0; x < m; x++)
         {
-          for (f = 0; f < 3; f++)
-          {
-            // shuffle points
-            p0[f] = p1[f];
-            p1[f] = p2[f];
-            p2[f] = p3[f];
-
-            // check for top side
-            if (yi < ylim)
-              p3[f] = s[f];
-            else
-              p3[f] = (p2[f] << 1) - p1[f];
-          }
-
-          // advance source pointer
-          s += sln;
-          yp++;
+          a = -r[0][x] + 3 * (r[1][x] - r[2][x]) + r[3][x];                   // a * 2
+          b = ((r[0][x] << 1) - 5 * r[1][x] + (r[2][x] << 2) - r[3][x]) << 8; // b * 2^9
+          c = (r[2][x] - r[0][x]) << 8;                                       // c * 2^9
+          d = r[1][x] << 8;                                                   // d * 2^8
+          v = a * dy + b;               
+          v = ((v * dy) >> 8) + c;
+          t[x] = ((v * dy) >> 9) + d;
         }
-
-        // recompute coefficients
-        for (f = 0; f < 3; f++)
+      else
+        for (x = 0; x < m; x++)
         {
-          a[f] = -p0[f] + 3 * (p1[f] - p2[f]) + p3[f];                     // a * 2
-          b[f] = ((p0[f] << 1) - 5 * p1[f] + (p2[f] << 2) - p3[f]) << 8;   // b * 2^9
-          c[f] = (p2[f] - p0[f]) << 8;                                     // c * 2^9
-          d[f] = p1[f] << 8;                                               // d * 2^8
+          for (k = 0; k < 4; k++)
+            p[k] = c0[k] * r[k][x] + c1[k] * r1[k][x];
+          a = -p[0] + 3 * (p[1] - p[2]) + p[3];
+          b = ((p[0] << 1) - 5 * p[1] + (p[2] << 2) - p[3]) << 8;
+          c = (p[2] - p[0]) << 8;
+          d = p[1] << 8;
+          v = a * dy + b;               
+          v = ((v * dy) >> 8) + c;
+          t[x] = ((v * dy) >> 9) + d;
         }
-      }
-
-      // compute new roughly 16 bit signed intermediate pixel values
-      // Note: really should only be 0-65535 but much slower to clamp
-      dy = ROUND(256.0 * (yf - yi));
-      for (f = 0; f < 3; f++)
-      {
-        // v = a * y^3 + b * y^2 + c * y + d
-        //   = ((a * y + b) * y + c) * y + d
-        v = a[f] * dy + b[f];               
-        v = ((v * dy) >> 8) + c[f];
-        v = ((v * dy) >> 9) + d[f];
-        t[f] = v;
-      }
-    }
-  }
-
-  // PASS 2 - do horizontal interpolation of temporary array into destination
-  t0 = temp;
-  for (y = 0; y < dh; y++, r += dsk, t0 += tln)
-  {
-    // set up far left side values (will be shuffled down)
-    t = t0;
-    for (f = 0; f < 3; f++, t++)
-    {
-      p2[f] = t[0];
-      p3[f] = t[3];
-      p1[f] = (p2[f] << 1) - p3[f];
     }
-    t += 3;
-
-    // start generating intermediate pixels
-    xp = -1;
-    xf = 0.0;
-    for (x = 0; x < dw; x++, r += 3, xf += stepx)
+    else
     {
-      // see if moved into next gap between pixels
-      xi = (int) xf;
-      if (xp < xi)
+      // 16 bit values
+      for (k = 0; k < 4; k++)
       {
-        // get new local window
-        while (xp < xi)
+        w[k]  = (const US16 *) r[k];
+        w1[k] = (const US16 *) r1[k];
+      }
+      if (pure)
+        for (x = 0; x < m; x++)
         {
-          for (f = 0; f < 3; f++)
-          {
-            // shuffle points
-            p0[f] = p1[f];
-            p1[f] = p2[f];
-            p2[f] = p3[f];
-
-            // check for far right side
-            if (xi < xlim)
-              p3[f] = t[f];
-            else
-              p3[f] = (p2[f] << 1) - p1[f];
-          }
-
-          // advance source pointer
-          t += 3;
-          xp++;
+          a = -w[0][x] + 3 * (w[1][x] - w[2][x]) + w[3][x];               // a * 2
+          b = (w[0][x] << 1) - 5 * w[1][x] + (w[2][x] << 2) - w[3][x];    // b * 2
+          c = w[2][x] - w[0][x];                                          // c * 2
+          d = w[1][x];                                                    // d
+          v = (a * dy + b) >> 8;               
+          v = ((v * dy) >> 8) + c;
+          t[x] = ((v * dy) >> 9) + d;
         }
-
-        // recompute coefficients (with pixels * 2^8)
-        for (f = 0; f < 3; f++)
+      else
+        for (x = 0; x < m; x++)
         {
-          a[f] = (-p0[f] + 3 * (p1[f] - p2[f]) + p3[f]) >> 8;        // a * 2
-          b[f] = (p0[f] << 1) - 5 * p1[f] + (p2[f] << 2) - p3[f];    // b * 2^9
-          c[f] = p2[f] - p0[f];                                      // c * 2^9
-          d[f] = p1[f];                                              // d * 2^8
+          for (k = 0; k < 4; k++)
+            p[k] = c0[k] * w[k][x] + c1[k] * w1[k][x];
+          a = -p[0] + 3 * (p[1] - p[2]) + p[3];
+          b = (p[0] << 1) - 5 * p[1] + (p[2] << 2) - p[3];
+          c = p[2] - p[0];
+          d = p[1];
+          v = (a * dy + b) >> 8;               
+          v = ((v * dy) >> 8) + c;
+          t[x] = ((v * dy) >> 9) + d;
         }
-      }
+    }
 
-      // compute new 8 bit unsigned output pixel values
-      dx = ROUND(256.0 * (xf - xi));
-      for (f = 0; f < 3; f++)
+    // PASS 2 - horizontal interpolation of temporary line into destination
+    out = job->d0 + y * job->dln;
+    out16 = (US16 *) out;
+    for (x = 0; x < dw; x++)
+    {
+      tab = xtab + 17 * x;
+      dx = tab[0];
+      for (f = 0; f < nf; f++)
       {
-        // v = a * x^3 + b * x^2 + c * x + d
-        //   = ((a * x + b) * x + c) * x + d
-        v = a[f] * dx + b[f];               
-        v = ((v * dx) >> 8) + c[f];
-        v = ((v * dx) >> 9) + d[f];
-        r[f] = BOUND(v >> 8);
+        // get tap values (pixels * 2^8)
+        if ((x >= xlo) && (x < xhi))
+          for (k = 0, tap = tab + 1; k < 4; k++, tap += 4)
+            p[k] = t[tap[0] * nf + f];
+        else
+          for (k = 0, tap = tab + 1; k < 4; k++, tap += 4)
+            p[k] = tap[1] * t[tap[0] * nf + f] + tap[3] * t[tap[2] * nf + f];
+
+        // compute new output pixel values
+        a = (-p[0] + 3 * (p[1] - p[2]) + p[3]) >> 8;        // a * 2
+        b = (p[0] << 1) - 5 * p[1] + (p[2] << 2) - p[3];    // b * 2^9
+        c = p[2] - p[0];                                    // c * 2^9
+        d = p[1];                                           // d * 2^8
+        v = a * dx + b;               
+        v = ((v * dx) >> 8) + c;
+        v = ((v * dx) >> 9) + d;
+        if (kind == 1)
+          out16[x] = (US16) __max(0, __min(v, 65535));
+        else
+          out[x * nf + f] = BOUND(v >> 8);
       }
     }
   }
-  return 1;
+}
+
+
+//= Tell if all 4 taps for some output are just copies of real pixels.
+
+int jhcResize::cubic_pure (const int *tab)
+{
+  return((tab[2] == 1) && (tab[4] == 0) && (tab[6] == 1) && (tab[8] == 0) &&
+         (tab[10] == 1) && (tab[12] == 0) && (tab[14] == 1) && (tab[16] == 0));
 }
 
 
@@ -1985,33 +1919,24 @@ int jhcResize::Rigid (jhcImg& dest, const jhcImg& src, double degs, double cx, d
 {
   double rads = D2R * degs, c = cos(rads), s = sin(rads);
   double xcos = xsc * c, ycos = ysc * c, xsin = xsc * s, ysin = ysc * s;
-  int iyc = ROUND(65536.0 * ycos), iys = ROUND(65536.0 * ysin);
-  int ixc = ROUND(65536.0 * xcos), ixs = ROUND(65536.0 * xsin);
-  int isx, isx0 = ROUND(65536.0 * (px - cx * xcos - cy * ysin));
-  int isy, isy0 = ROUND(65536.0 * (py + cx * xsin - cy * ycos));
-  int w = dest.XDim(), h = dest.YDim(), dln = dest.Line();
-  int x, y, ix, iy, sw = src.XDim(), sh = src.YDim();
-  UC8 *d, *d0 = dest.PxlDest();
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhc_rsz_job job;
 
   if (!dest.Valid(1) || !src.Valid(1) || dest.SameImg(src))
     return Fatal("Bad images to jhcResize::Rigid");
   dest.FillArr(def);
 
-  // copy closest source pixel
-  for (y = h; y > 0; y--, d0 += dln, isx0 += iys, isy0 += iyc)
-  {
-    isx = isx0;
-    isy = isy0;
-    d = d0;
-    for (x = w; x > 0; x--, d++, isx += ixc, isy -= ixs)
-    {
-      // make sure valid source pixel
-      ix = (isx + 32768) >> 16;
-      iy = (isy + 32768) >> 16;
-      if ((ix >= 0) && (iy >= 0) && (ix < sw) && (iy < sh))
-        *d = (UC8) src.ARef(ix, iy);
-    }
-  }
+  // 16.16 fixed point sampling steps and start
+  job.ixc = ROUND(65536.0 * xcos);
+  job.ixs = ROUND(65536.0 * xsin);
+  job.iyc = ROUND(65536.0 * ycos);
+  job.iys = ROUND(65536.0 * ysin);
+  job.isx0 = ROUND(65536.0 * (px - cx * xcos - cy * ysin));
+  job.isy0 = ROUND(65536.0 * (py + cx * xsin - cy * ycos));
+
+  // copy closest source pixel for bands of lines
+  rigid_job(job, dest, src, 0);
+  bp->Run(rigid_rows, &job, bp->Bands(job.dh, 8));
   return 1;
 }
 
@@ -2026,41 +1951,22 @@ int jhcResize::RigidRGB (jhcImg& dest, const jhcImg& src, double degs, double cx
 {
   double rads = D2R * degs, c = cos(rads), s = sin(rads);
   double xcos = xsc * c, ycos = ysc * c, xsin = xsc * s, ysin = ysc * s;
-  double sx, sy, sx0 = px - cx * xcos - cy * ysin, sy0 = py + cx * xsin - cy * ycos;
-  int w = dest.XDim(), h = dest.YDim(), dln = dest.Line();
-  int x, y, ix, iy, sw = src.XDim(), sh = src.YDim(), sln = src.Line();
-  const UC8 *p, *p0 = src.PxlSrc();
-  UC8 *d, *d0 = dest.PxlDest();
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhc_rsz_job job;
+  double *rs;
 
   if (!dest.Valid(3) || !src.Valid(3) || dest.SameImg(src))
     return Fatal("Bad images to jhcResize::RigidRGB");
 
-  // copy closest source pixel
-  for (y = 0; y < h; y++, d0 += dln, sx0 += ysin, sy0 += ycos)
-  {
-    sx = sx0;
-    sy = sy0;
-    d = d0;
-    for (x = 0; x < w; x++, d += 3, sx += xcos, sy -= xsin)
-    {
-      // make sure valid source pixel
-      ix = (int)(sx);
-      iy = (int)(sy);
-      if ((ix >= 0) && (iy >= 0) && (ix < sw) && (iy < sh))
-      {
-        p = p0 + (ix + ix + ix) + iy * sln;
-        d[0] = p[0];
-        d[1] = p[1];
-        d[2] = p[2];
-      }
-      else
-      {
-        d[0] = (UC8) b;
-        d[1] = (UC8) g;
-        d[2] = (UC8) r;
-      }
-    }
-  }
+  // copy closest source pixel for bands of lines
+  rigid_job(job, dest, src, 1);
+  rs = rigid_start(job, px - cx * xcos - cy * ysin, py + cx * xsin - cy * ycos, 
+                   xcos, xsin, ycos, ysin, 1.0);
+  job.def[0] = b;
+  job.def[1] = g;
+  job.def[2] = r;
+  bp->Run(rigid_rows, &job, bp->Bands(job.dh, 8));
+  delete [] rs;
   return 1;
 }
 
@@ -2075,77 +1981,20 @@ int jhcResize::RigidMix (jhcImg& dest, const jhcImg& src, double degs, double cx
 {
   double rads = D2R * degs, c = cos(rads), s = sin(rads);
   double xcos = xsc * c, ycos = ysc * c, xsin = xsc * s, ysin = ysc * s;
-  double sx, sy, sx0 = px - cx * xcos - cy * ysin, sy0 = py + cx * xsin - cy * ycos;
-  int sum, off, f, w = dest.XDim(), h = dest.YDim(), dln = dest.Line();
-  int x, y, ix, iy, fx, fy, xlim = src.XLim(), ylim = src.YLim(), sln = src.Line();
-  const UC8 *p0 = src.PxlSrc();
-  UC8 *d, *d0 = dest.PxlDest();
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhc_rsz_job job;
+  double *rs;
 
   if (!dest.Valid(1) || !src.Valid(1) || dest.SameImg(src))
     return Fatal("Bad images to jhcResize::RigidMix");
 
-  // shift sx and sy up by 8 bits
-  sx0  *= 256.0;
-  sy0  *= 256.0;
-  xcos *= 256.0;
-  ycos *= 256.0;
-  xsin *= 256.0;
-  ysin *= 256.0;
-
-  // copy closest source pixel
-  for (y = 0; y < h; y++, d0 += dln, sx0 += ysin, sy0 += ycos)
-  {
-    sx = sx0;
-    sy = sy0;
-    d = d0;
-    for (x = 0; x < w; x++, d++, sx += xcos, sy -= xsin)
-    {
-      // get integer pixel address and fraction (for mixing)
-      ix = ((int) sx) >> 8;
-      iy = ((int) sy) >> 8;
-      fx = (int)(sx - (ix << 8));
-      fy = (int)(sy - (iy << 8));
-      
-      // find corner of lower row for 4 pixel patch in source
-      off = ix + iy * sln;
-      sum = 0;                         // truncate, not round
-
-      // add in SW pixel if it exists
-      f = (256 - fx) * (256 - fy);
-      if ((ix >= 0) && (ix <= xlim) && (iy >= 0) && (iy <= ylim))
-        sum += f * (*(p0 + off));
-      else
-        sum += f * def;
-
-      // add in SE pixel if it exists
-      f = fx * (256 - fy);
-      if ((ix >= -1) && (ix < xlim) && (iy >= 0) && (iy <= ylim))
-        sum += f * (*(p0 + off + 1));
-      else
-        sum += f * def;
-
-      // adjust to upper row of 4 pixel patch in source
-      off += sln;
-      iy++;
-
-      // add in NW pixel if it exists
-      f = (256 - fx) * fy;
-      if ((ix >= 0) && (ix <= xlim) && (iy >= 0) && (iy <= ylim))
-        sum += f * (*(p0 + off));
-      else
-        sum += f * def;
-
-      // add in NE pixel if it exists
-      f = fx * fy;
-      if ((ix >= -1) && (ix < xlim) && (iy >= 0) && (iy <= ylim))
-        sum += f * (*(p0 + off + 1));
-      else
-        sum += f * def;
-
-      // normalize to complete mix
-      *d = (UC8)(sum >> 16);
-    }
-  }
+  // interpolate source pixels for bands of lines
+  rigid_job(job, dest, src, 2);
+  rs = rigid_start(job, px - cx * xcos - cy * ysin, py + cx * xsin - cy * ycos, 
+                   xcos, xsin, ycos, ysin, 256.0);
+  job.def[0] = def;
+  bp->Run(rigid_rows, &job, bp->Bands(job.dh, 8));
+  delete [] rs;
   return 1;
 }
 
@@ -2160,117 +2009,22 @@ int jhcResize::RigidMixRGB (jhcImg& dest, const jhcImg& src, double degs, double
 {
   double rads = D2R * degs, c = cos(rads), s = sin(rads);
   double xcos = xsc * c, ycos = ysc * c, xsin = xsc * s, ysin = ysc * s;
-  double sx, sy, sx0 = px - cx * xcos - cy * ysin, sy0 = py + cx * xsin - cy * ycos;
-  int rsum, gsum, bsum, f, w = dest.XDim(), h = dest.YDim(), dln = dest.Line();
-  int x, y, ix, iy, fx, fy, off, xlim = src.XLim(), ylim = src.YLim(), sln = src.Line();
-  const UC8 *p, *p0 = src.PxlSrc();
-  UC8 *d, *d0 = dest.PxlDest();
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhc_rsz_job job;
+  double *rs;
 
   if (!dest.Valid(3) || !src.Valid(3) || dest.SameImg(src))
     return Fatal("Bad images to jhcResize::RigidMixRGB");
 
-  // shift sx and sy up by 8 bits
-  sx0  *= 256.0;
-  sy0  *= 256.0;
-  xcos *= 256.0;
-  ycos *= 256.0;
-  xsin *= 256.0;
-  ysin *= 256.0;
-
-  // copy closest source pixel
-  for (y = 0; y < h; y++, d0 += dln, sx0 += ysin, sy0 += ycos)
-  {
-    sx = sx0;
-    sy = sy0;
-    d = d0;
-    for (x = 0; x < w; x++, d += 3, sx += xcos, sy -= xsin)
-    {
-      // get integer pixel address and fraction (for mixing)
-      ix = ((int) sx) >> 8;
-      iy = ((int) sy) >> 8;
-      fx = (int)(sx - (ix << 8));
-      fy = (int)(sy - (iy << 8));
-      
-      // find corner of lower row for 4 pixel patch in source
-      off = (ix + ix + ix) + iy * sln;
-      bsum = 0;                        // truncate, not round
-      gsum = 0;
-      rsum = 0;
-
-      // add in SW pixel if it exists
-      f = (256 - fx) * (256 - fy);
-      if ((ix >= 0) && (ix <= xlim) && (iy >= 0) && (iy <= ylim))
-      {
-        p = p0 + off;
-        bsum += f * p[0];
-        gsum += f * p[1];
-        rsum += f * p[2];
-      }
-      else
-      {
-        bsum += f * b;
-        gsum += f * g;
-        rsum += f * r;
-      }
-
-      // add in SE pixel if it exists
-      f = fx * (256 - fy);
-      if ((ix >= -1) && (ix < xlim) && (iy >= 0) && (iy <= ylim))
-      {
-        p = p0 + off + 3;
-        bsum += f * p[0];
-        gsum += f * p[1];
-        rsum += f * p[2];
-      }
-      else
-      {
-        bsum += f * b;
-        gsum += f * g;
-        rsum += f * r;
-      }
-
-      // adjust to upper row of 4 pixel patch in source
-      off += sln;
-      iy++;
-
-      // add in NW pixel if it exists
-      f = (256 - fx) * fy;
-      if ((ix >= 0) && (ix <= xlim) && (iy >= 0) && (iy <= ylim))
-      {
-        p = p0 + off;
-        bsum += f * p[0];
-        gsum += f * p[1];
-        rsum += f * p[2];
-      }
-      else
-      {
-        bsum += f * b;
-        gsum += f * g;
-        rsum += f * r;
-      }
-
-      // add in NE pixel if it exists
-      f = fx * fy;
-      if ((ix >= -1) && (ix < xlim) && (iy >= 0) && (iy <= ylim))
-      {
-        p = p0 + off + 3;
-        bsum += f * p[0];
-        gsum += f * p[1];
-        rsum += f * p[2];
-      }
-      else
-      {
-        bsum += f * b;
-        gsum += f * g;
-        rsum += f * r;
-      }
-
-      // normalize to complete mix
-      d[0] = (UC8)(bsum >> 16);
-      d[1] = (UC8)(gsum >> 16);
-      d[2] = (UC8)(rsum >> 16);
-    }
-  }
+  // interpolate source pixels for bands of lines
+  rigid_job(job, dest, src, 3);
+  rs = rigid_start(job, px - cx * xcos - cy * ysin, py + cx * xsin - cy * ycos, 
+                   xcos, xsin, ycos, ysin, 256.0);
+  job.def[0] = b;
+  job.def[1] = g;
+  job.def[2] = r;
+  bp->Run(rigid_rows, &job, bp->Bands(job.dh, 8));
+  delete [] rs;
   return 1;
 }
 
@@ -2284,90 +2038,176 @@ int jhcResize::RigidMixNZ (jhcImg& dest, const jhcImg& src, double degs, double
 {
   double rads = D2R * degs, c = cos(rads), s = sin(rads);
   double xcos = xsc * c, ycos = ysc * c, xsin = xsc * s, ysin = ysc * s;
-  double sx, sy, sx0 = px - cx * xcos - cy * ysin, sy0 = py + cx * xsin - cy * ycos;
-  int sum, norm, v, off, f, w = dest.XDim(), h = dest.YDim(), dln = dest.Line();
-  int x, y, ix, iy, fx, fy, xlim = src.XLim(), ylim = src.YLim(), sln = src.Line();
-  const UC8 *p0 = src.PxlSrc();
-  UC8 *d, *d0 = dest.PxlDest();
+  jhcBandPool *bp = jhcBandPool::Shared();
+  jhc_rsz_job job;
+  double *rs;
 
   if (!dest.Valid(1) || !src.Valid(1) || dest.SameImg(src))
     return Fatal("Bad images to jhcResize::RigidMixNZ");
 
-  // shift sx and sy up by 8 bits
-  sx0  *= 256.0;
-  sy0  *= 256.0;
-  xcos *= 256.0;
-  ycos *= 256.0;
-  xsin *= 256.0;
-  ysin *= 256.0;
+  // interpolate non-zero source pixels for bands of lines
+  rigid_job(job, dest, src, 4);
+  rs = rigid_start(job, px - cx * xcos - cy * ysin, py + cx * xsin - cy * ycos, 
+                   xcos, xsin, ycos, ysin, 256.0);
+  bp->Run(rigid_rows, &job, bp->Bands(job.dh, 8));
+  delete [] rs;
+  return 1;
+}
+
+
+//= Find sampling start for every destination line of a rigid transform.
+// accumulates serially exactly like a single pass so bands give same answers
+// all positions and steps are scaled by sc (e.g. 256 for 8 bit fractions)
+// returns array of (sx sy) pairs which caller must delete
 
-  // copy closest source pixel
-  for (y = 0; y < h; y++, d0 += dln, sx0 += ysin, sy0 += ycos)
+double *jhcResize::rigid_start (jhc_rsz_job& job, double sx0, double sy0, double xcos, 
+                                double xsin, double ycos, double ysin, double sc) const
+{
+  double *rs = new double [2 * job.dh];
+  double sx = sc * sx0, sy = sc * sy0, ys = sc * ysin, yc = sc * ycos;
+  int y;
+
+  for (y = 0; y < job.dh; y++, sx += ys, sy += yc)
   {
-    sx = sx0;
-    sy = sy0;
-    d = d0;
-    for (x = 0; x < w; x++, d++, sx += xcos, sy -= xsin)
+    rs[y + y] = sx;
+    rs[y + y + 1] = sy;
+  }
+  job.rs = rs;
+  job.xc = sc * xcos;
+  job.xs = sc * xsin;
+  return rs;
+}
+
+
+//= Fill in image descriptions for some rigid transform job.
+
+void jhcResize::rigid_job (jhc_rsz_job& job, jhcImg& dest, const jhcImg& src, int kind) const
+{
+  job.kind = kind;
+  job.s0 = src.PxlSrc();
+  job.d0 = dest.PxlDest();
+  job.sln = src.Line();
+  job.dln = dest.Line();
+  job.sw = src.XDim();
+  job.sh = src.YDim();
+  job.dw = dest.XDim();
+  job.dh = dest.YDim();
+  job.nf = src.Fields();
+}
+
+
+//= Sample or interpolate source for a band of destination lines.
+// kind: 0 = Rigid, 1 = RigidRGB, 2 = RigidMix, 3 = RigidMixRGB, 4 = RigidMixNZ
+// mixing kinds skip all edge tests when whole 4 pixel patch is inside source
+
+void jhcResize::rigid_rows (void *ctx, int band, int nb)
+{
+  const jhc_rsz_job *job = (const jhc_rsz_job *) ctx;
+  const UC8 *p, *p0 = job->s0;
+  int wt[4], sum[3];
+  int x, y, i, k, n, ix, iy, fx, fy, isx, isy, v, norm, off, ok;
+  int w = job->dw, sw = job->sw, sh = job->sh, sln = job->sln, nf = job->nf, kind = job->kind;
+  int xlim = sw - 1, ylim = sh - 1, y0 = (band * job->dh) / nb, y1 = ((band + 1) * job->dh) / nb;
+  double sx, sy, xc = job->xc, xs = job->xs;
+  UC8 *d;
+
+  for (y = y0; y < y1; y++)
+  {
+    d = job->d0 + y * job->dln;
+
+    // copy closest source pixel with 16.16 fixed point
+    if (kind == 0)
     {
+      isx = job->isx0 + y * job->iys;
+      isy = job->isy0 + y * job->iyc;
+      for (x = w; x > 0; x--, d++, isx += job->ixc, isy -= job->ixs)
+      {
+        ix = (isx + 32768) >> 16;
+        iy = (isy + 32768) >> 16;
+        if ((ix >= 0) && (iy >= 0) && (ix < sw) && (iy < sh))
+          *d = p0[iy * sln + ix];
+      }
+      continue;
+    }
+
+    // others step from precomputed line start
+    sx = job->rs[y + y];
+    sy = job->rs[y + y + 1];
+    for (x = 0; x < w; x++, d += nf, sx += xc, sy -= xs)
+    {
+      // closest color pixel
+      if (kind == 1)
+      {
+        ix = (int)(sx);
+        iy = (int)(sy);
+        if ((ix >= 0) && (iy >= 0) && (ix < sw) && (iy < sh))
+        {
+          p = p0 + (ix + ix + ix) + iy * sln;
+          d[0] = p[0];
+          d[1] = p[1];
+          d[2] = p[2];
+        }
+        else
+          for (i = 0; i < 3; i++)
+            d[i] = (UC8) job->def[i];
+        continue;
+      }
+
       // get integer pixel address and fraction (for mixing)
       ix = ((int) sx) >> 8;
       iy = ((int) sy) >> 8;
       fx = (int)(sx - (ix << 8));
       fy = (int)(sy - (iy << 8));
-      
-      // find corner of lower row for 4 pixel patch in source
-      off = ix + iy * sln;
-      sum = 0;
-      norm = 0;
-
-      // add in SW pixel if it exists
-      f = (256 - fx) * (256 - fy);
-      if ((ix >= 0) && (ix <= xlim) && (iy >= 0) && (iy <= ylim))
-        if ((v = *(p0 + off)) > 0)
-        {
-          sum += f * v;
-          norm += f;
-        }
+      off = ix * nf + iy * sln;
+      wt[0] = (256 - fx) * (256 - fy);
+      wt[1] = fx * (256 - fy);
+      wt[2] = (256 - fx) * fy;
+      wt[3] = fx * fy;
+      ok = (((ix >= 0) && (ix < xlim) && (iy >= 0) && (iy < ylim)) ? 1 : 0);
+
+      // mix non-zero pixels only
+      if (kind == 4)
+      {
+        n = 0;
+        norm = 0;
+        for (k = 0; k < 4; k++)
+          if ((ok > 0) || mix_ok(ix + (k & 1), iy + (k >> 1), xlim, ylim))
+            if ((v = p0[off + (k & 1) + (k >> 1) * sln]) > 0)
+            {
+              n += wt[k] * v;
+              norm += wt[k];
+            }
+        *d = (UC8)((norm <= 0) ? 0 : n / norm);
+        continue;
+      }
 
-      // add in SE pixel if it exists
-      f = fx * (256 - fy);
-      if ((ix >= -1) && (ix < xlim) && (iy >= 0) && (iy <= ylim))
-        if ((v = *(p0 + off + 1)) > 0)
+      // mix all fields of patch (truncate, not round)
+      for (i = 0; i < nf; i++)
+        sum[i] = 0;
+      for (k = 0; k < 4; k++)
+      {
+        if ((ok > 0) || mix_ok(ix + (k & 1), iy + (k >> 1), xlim, ylim))
         {
-          sum += f * v;
-          norm += f;
+          p = p0 + off + (k & 1) * nf + (k >> 1) * sln;
+          for (i = 0; i < nf; i++)
+            sum[i] += wt[k] * p[i];
         }
+        else
+          for (i = 0; i < nf; i++)
+            sum[i] += wt[k] * job->def[i];
+      }
+      for (i = 0; i < nf; i++)
+        d[i] = (UC8)(sum[i] >> 16);
+    }
+  }
+}
 
-      // adjust to upper row of 4 pixel patch in source
-      off += sln;
-      iy++;
-
-      // add in NW pixel if it exists
-      f = (256 - fx) * fy;
-      if ((ix >= 0) && (ix <= xlim) && (iy >= 0) && (iy <= ylim))
-        if ((v = *(p0 + off)) > 0) 
-        {
-          sum += f * v;
-          norm += f;
-        }
 
-      // add in NE pixel if it exists
-      f = fx * fy;
-      if ((ix >= -1) && (ix < xlim) && (iy >= 0) && (iy <= ylim))
-        if ((v = *(p0 + off + 1)) > 0)
-        {
-          sum += f * v;
-          norm += f;
-        }
+//= Tell whether some pixel is inside source image for mixing.
 
-      // normalize to complete mix (truncate, not round)
-      if (norm <= 0)
-        *d = 0;
-      else
-        *d = (UC8)(sum / norm);
-    }
-  }
-  return 1;
+int jhcResize::mix_ok (int ix, int iy, int xlim, int ylim)
+{
+  return((ix >= 0) && (ix <= xlim) && (iy >= 0) && (iy <= ylim));
 }
 
 
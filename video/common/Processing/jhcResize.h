@@ -29,6 +29,11 @@
 #include "Data/jhcImg.h"
 
 
+// description of parallel job (defined in jhcResize.cpp)
+
+struct jhc_rsz_job;
+
+
 //= Library functions for changing the size of an image.
 
 class jhcResize
@@ -159,6 +164,20 @@ protected:
   int Bicubic_16 (jhcImg& dest, const jhcImg& src, int conform =0);
   int Bicubic_RGB (jhcImg& dest, const jhcImg& src, int conform =0);
 
+  // parallel bands
+  static void resamp_rows (void *ctx, int band, int nb);
+  int cubic_all (jhcImg& dest, const jhcImg& src, int conform, int kind);
+  void cubic_taps (int *tab, int n, double step, int ns) const;
+  void set_tap (int *p, int i) const;
+  void ext_tap (int *p, const int *a, const int *b) const;
+  static void cubic_rows (void *ctx, int band, int nb);
+  static int cubic_pure (const int *tab);
+  double *rigid_start (jhc_rsz_job& job, double sx0, double sy0, double xcos, 
+                       double xsin, double ycos, double ysin, double sc) const;
+  void rigid_job (jhc_rsz_job& job, jhcImg& dest, const jhcImg& src, int kind) const;
+  static void rigid_rows (void *ctx, int band, int nb);
+  static int mix_ok (int ix, int iy, int xlim, int ylim);
+
 };
 
 
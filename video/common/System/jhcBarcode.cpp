@@ -20,7 +20,11 @@
 // 
 ///////////////////////////////////////////////////////////////////////////
 
+#include <windows.h>                 // for Interlocked
 #include <stdlib.h>                  // for NULL
+#include <string.h>
+
+#include "Interface/jhcBandPool.h"
 
 #include "jhcBarcode.h"
 
@@ -38,9 +42,19 @@ jhcBarcode::jhcBarcode ()
   h = 0;
   f = 0;
   ln = 0;
+  resid = 0;
 
   // no local arrays allocated yet
   proj = NULL;
+  tmp = NULL;
+  psz = 0;
+
+  // no parallel helpers yet
+  crew = NULL;
+  nw = 0;
+  kgot = -1;
+  *got = '\0';
+  par = 1;
 
   // set up processing parameters
   build_tables();
@@ -153,6 +167,7 @@ void jhcBarcode::build_tables ()
 jhcBarcode::~jhcBarcode ()
 {
   dealloc();
+  delete [] crew;
 }
 
 
@@ -160,8 +175,11 @@ jhcBarcode::~jhcBarcode ()
 
 void jhcBarcode::dealloc ()
 {
+  delete [] tmp;
   delete [] proj;
+  tmp = NULL;
   proj = NULL;
+  psz = 0;
 }
 
 
@@ -171,16 +189,30 @@ void jhcBarcode::SetSize (int x, int y, int z)
 {
   if ((x == w) && (y == h) && (z == f))
     return;
+  set_area(x, y, z, ((x * z) + 3) & 0xFFFC);
+}
 
-  // remember sizes and compute line length
+
+//= Set size of area to analyze and the line length of the enclosing image.
+// only reallocates slice arrays if they need to get bigger
+
+void jhcBarcode::set_area (int x, int y, int z, int line)
+{
+  int sz = __max(x, y);
+
+  // remember sizes 
   w = x; 
   h = y;
   f = z;
-  ln = ((w * f) + 3) & 0xFFFC;
+  ln = line;
 
   // set projection slice sizes
+  if (sz <= psz)
+    return;
   dealloc();
-  proj = new int[__max(w, h)];
+  proj = new int[sz];
+  tmp = new int[sz];
+  psz = sz;
 }
 
 
@@ -288,33 +320,246 @@ int jhcBarcode::HorizCode (char *code, const unsigned char *src, int yv12)
 // normally Microsoft DIB/BMP buffer in BGR order with line padded to 4 bytes
 // alternate yv12 format is full-sized Y followed by half-sized U and half-size V
 // fills character string with full code when successful
+// slices are split between helpers (if par > 0) but the answer is always
+// the one from the first successful slice in the serial scan order
 // returns 1 if found and decoded, 0 if nothing seen anywhere or unreadable
 // takes about 2.2ms for 640x480 on a 1.7GHz PentiumM (8x slower than HorizCode)
 
 int jhcBarcode::SlowCode (char *code, const unsigned char *src, int yv12)
 {
-  int c, d, i, fld, dist;
+  jhcBandPool *bp = jhcBandPool::Shared();
+  int i, k, nb, total = scan_total();
   
+  // possibly try each slice in order on this decoder
   scans = 0;
-  for (d = 0; d < dirs; d++)              // multiple slice orientations
-    for (c = 0; c < __min(cols, f); c++)  // multiple color fields
+  nb = ((par > 0) ? __min(__min(total, bp->Lanes()), wmax) : 1);
+  if (nb <= 1)
+  {
+    for (k = 0; k < total; k++)
     {
-      // try green then red then blue
-      fld = ((c == 0) ? 1 : ((c == 1) ? 2 : 0));
-      for (i = 0; i < steps; i++)         // multiple slices in current direction
-      {
-        // search from the center then up and down by constant amounts
-        dist = ((i + 1) >> 1) * off;
-        if ((i & 0x01) != 0)
-          dist = -dist;
-        scans++;
+      scans++;
+      if (scan_one(code, src, k, yv12) > 0)
+        return 1;
+    }
+    return 0;
+  }
 
-        // as soon as one valid read happens stop searching
-        if (SliceCode(code, src, d, dist, fld, yv12) > 0)
-          return 1;
+  // set up helpers with same parameters and image size
+  get_crew(nb);
+  for (i = 0; i < nb; i++)
+  {
+    crew[i].copy_params(*this);
+    crew[i].set_area(w, h, f, ln);
+    crew[i].kgot = -1;
+  }
+
+  // interleave slices across bands (lowest success wins)
+  jsrc = src;
+  jyv = yv12;
+  jtot = total;
+  win = total;
+  bp->Run(scan_band, this, nb);
+  if (win >= total)
+  {
+    // state from very last slice (band that did it never stopped early)
+    scans = total;
+    take_state(crew[(total - 1) % nb]);
+    return 0;
+  }
+
+  // copy answer and state from helper that found it
+  scans = (int) win + 1;
+  for (i = 0; i < nb; i++)
+    if (crew[i].kgot == win)
+      break;
+  take_state(crew[i]);
+  strcpy_s(code, 11, crew[i].got);
+  return 1;
+}
+
+
+//= Look for barcodes in several candidate regions of the same image at once.
+// source must be a BGR bitmap (not YV12), box holds x, y, w, h for each region
+// each region is scanned like SlowCode and the regions are spread over helpers
+// codes receives n strings each of ssz characters (at least 11), empty if failed
+// sets scans to the total number of slices examined across all regions
+// returns number of regions successfully decoded
+
+int jhcBarcode::BatchCode (char *codes, int ssz, const unsigned char *src, const int *box, int n)
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+  int r, nb;
+
+  scans = 0;
+  if ((codes == NULL) || (ssz < 11) || (src == NULL) || (box == NULL) || (n <= 0) || (w <= 0))
+    return 0;
+  for (r = 0; r < n; r++)
+    codes[r * ssz] = '\0';
+
+  // set up helpers with same parameters (sizes set for each region)
+  nb = ((par > 0) ? __min(__min(n, bp->Lanes()), wmax) : 1);
+  get_crew(nb);
+  for (r = 0; r < nb; r++)
+    crew[r].copy_params(*this);
+
+  // decode regions in bands
+  jsrc = src;
+  jbox = box;
+  jcodes = codes;
+  jsz = ssz;
+  jtot = n;
+  win = 0;
+  tried = 0;
+  bp->Run(batch_band, this, nb);
+  scans = (int) tried;
+  return((int) win);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Parallel Scanning                          //
+///////////////////////////////////////////////////////////////////////////
+
+//= Try the k'th slice in the standard SlowCode ordering.
+// order is directions, then colors (G, R, B), then offsets (center out)
+// returns 1 if okay, 0 if confused, fills character string with full code
+
+int jhcBarcode::scan_one (char *code, const unsigned char *src, int k, int yv12)
+{
+  int nc = __min(cols, f), i = k % steps, c = (k / steps) % nc, d = k / (steps * nc);
+  int fld = ((c == 0) ? 1 : ((c == 1) ? 2 : 0)), dist = ((i + 1) >> 1) * off;
+
+  // search from the center then up and down by constant amounts
+  if ((i & 0x01) != 0)
+    dist = -dist;
+  return SliceCode(code, src, d, dist, fld, yv12);
+}
+
+
+//= Make sure there are at least n helper decoders available.
+
+void jhcBarcode::get_crew (int n)
+{
+  if (n <= nw)
+    return;
+  delete [] crew;
+  crew = new jhcBarcode[n];
+  nw = n;
+}
+
+
+//= Copy all control parameters from some other decoder.
+
+void jhcBarcode::copy_params (const jhcBarcode& ref)
+{
+  steps = ref.steps;
+  off   = ref.off;
+  cols  = ref.cols;
+  dirs  = ref.dirs;
+  mode  = ref.mode;
+  sm    = ref.sm;
+  dmax  = ref.dmax;
+  wmin  = ref.wmin;
+  bmin  = ref.bmin;
+  dbar  = ref.dbar;
+  bdiff = ref.bdiff;
+  badj  = ref.badj;
+  eadj  = ref.eadj;
+  est   = ref.est;
+  pod   = ref.pod;
+  cvt   = ref.cvt;
+}
+
+
+//= Copy intermediate processing state for last slice from some helper.
+// makes LastSlice and debugging displays work as if slice was done here
+
+void jhcBarcode::take_state (const jhcBarcode& ref)
+{
+  sdir = ref.sdir;
+  soff = ref.soff;
+  sfld = ref.sfld;
+  sx0  = ref.sx0;
+  sy0  = ref.sy0;
+  sdx  = ref.sdx;
+  sdy  = ref.sdy;
+  slen = ref.slen;
+  i0   = ref.i0;
+  i1   = ref.i1;
+  ecnt = ref.ecnt;
+  bcnt = ref.bcnt;
+  bw16 = ref.bw16;
+  lo16 = ref.lo16;
+  hi16 = ref.hi16;
+  eth  = ref.eth;
+  memcpy(ejs, ref.ejs, sizeof(ejs));
+  memcpy(bits, ref.bits, sizeof(bits));
+  memcpy(proj, ref.proj, __min(slen, psz) * sizeof(int));
+}
+
+
+//= Try every nb'th slice starting with the band number.
+// gives up as soon as some other band succeeds on an earlier slice
+
+void jhcBarcode::scan_band (void *ctx, int band, int nb)
+{
+  jhcBarcode *me = (jhcBarcode *) ctx;
+  jhcBarcode *hp = me->crew + band;
+  long k, best;
+
+  for (k = band; k < me->jtot; k += nb)
+  {
+    if (k > me->win)
+      return;
+    if (hp->scan_one(hp->got, me->jsrc, k, me->jyv) > 0)
+    {
+      // lower winning slice index unless already beaten
+      hp->kgot = k;
+      while (k < (best = me->win))
+        if (InterlockedCompareExchange(&(me->win), k, best) == best)
+          break;
+      return;
+    }
+  }
+}
+
+
+//= Decode every nb'th candidate region starting with the band number.
+// regions are clipped to the image and skipped if too small
+
+void jhcBarcode::batch_band (void *ctx, int band, int nb)
+{
+  jhcBarcode *me = (jhcBarcode *) ctx;
+  jhcBarcode *hp = me->crew + band;
+  const int *b;
+  int r, k, x0, y0, x1, y1, total, cnt = 0;
+
+  for (r = band; r < me->jtot; r += nb)
+  {
+    // get region limits within full image
+    b = me->jbox + 4 * r;
+    x0 = __max(0, b[0]);
+    y0 = __max(0, b[1]);
+    x1 = __min(b[0] + b[2], me->w);
+    y1 = __min(b[1] + b[3], me->h);
+    if (((x1 - x0) < 16) || ((y1 - y0) < 16))
+      continue;
+
+    // scan region like a small image with a long line length
+    hp->set_area(x1 - x0, y1 - y0, me->f, me->ln);
+    total = hp->scan_total();
+    for (k = 0; k < total; k++)
+    {
+      cnt++;
+      if (hp->scan_one(hp->got, me->jsrc + y0 * me->ln + x0 * me->f, k, 0) > 0)
+      {
+        strcpy_s(me->jcodes + r * me->jsz, me->jsz, hp->got);
+        InterlockedIncrement(&(me->win));
+        break;
       }
+    }
   }
-  return 0;
+  InterlockedExchangeAdd(&(me->tried), cnt);
 }
 
 
@@ -335,10 +580,11 @@ int jhcBarcode::SliceCode (char *code, const unsigned char *src,
 {
   int i, sf = ((f == 1) ? 0 : fld);
 
-  // remember calling parameters
+  // remember calling parameters (no residual from other slices)
   sdir = dir;
   soff = cdist;
   sfld = sf;
+  resid = 0;
 
   // get a nice intensity profile
   if (yv12 <= 0)
@@ -415,9 +661,16 @@ int jhcBarcode::slice_h (int *slice, const unsigned char *src, int cdist, int fl
   sdx = 1;
   sdy = 0;
 
-  // collect pixels
-  for (dx = 0; dx < w; dx++, p++, s += f)
-    *p = *s;
+  // collect pixels (fixed strides so loops can be vectorized)
+  if (f == 1)
+    for (dx = 0; dx < w; dx++)
+      p[dx] = s[dx];
+  else if (f == 3)
+    for (dx = 0; dx < w; dx++)
+      p[dx] = s[3 * dx];
+  else
+    for (dx = 0; dx < w; dx++)
+      p[dx] = s[dx * f];
 
   // clean up and return length
   smooth(slice, w, sm);
@@ -504,8 +757,8 @@ int jhcBarcode::slice_d2 (int *slice, const unsigned char *src, int cdist, int f
     *p = *s;
 
   // clean up and return length
-  smooth(slice, h, sm);
-  return h;
+  smooth(slice, len, sm);
+  return len;
 }
 
 
@@ -514,7 +767,7 @@ int jhcBarcode::slice_d2 (int *slice, const unsigned char *src, int cdist, int f
 void jhcBarcode::smooth (int *slice, int len, int n)
 {
   int xlim = len - 1, w25 = len / 4, w75 = 3 * w25;
-  int i, x, lo, hi, sc, v, left, mid; 
+  int i, x, lo, hi, sc, v; 
 
   // find min and max for central portion
   lo = slice[w25];
@@ -538,15 +791,13 @@ void jhcBarcode::smooth (int *slice, int len, int n)
 
   // smooth array using [0.25 0.5 0.25] mask several times.
   // values in first and last bins never changed
+  // goes through scratch array so loops have no carried dependency
   for (i = 0; i < n; i++)
   {
-    left = slice[0];
     for (x = 1; x < xlim; x++)
-    {
-      mid = slice[x];
-      slice[x] = (left + (mid << 1) + slice[x + 1] + 2) >> 2;
-      left = mid;
-    }
+      tmp[x] = (slice[x - 1] + (slice[x] << 1) + slice[x + 1] + 2) >> 2;
+    for (x = 1; x < xlim; x++)
+      slice[x] = tmp[x];
   }
 }
 
@@ -638,7 +889,7 @@ int jhcBarcode::slice_d1_yuv (int *slice, const unsigned char *src, int cdist, i
   int w2 = w >> 1, h2 = h >> 1, skip = w + 1, sksk = skip << 1, skip2 = w2 + 1; 
   int coff = (cdist * 181) >> 8, xc = w2 + coff, yc = h2 - coff;  // adjust by 0.7071
   int i, val, base, bot = __min(xc, yc), top = __min(w - 1 - xc, h - 1 - yc);
-  int x0 = (xc - bot) & 0xFFFE, y0 = (yc - bot) & 0xFFEE, len = bot + top + 1;
+  int x0 = (xc - bot) & 0xFFFE, y0 = (yc - bot) & 0xFFFE, len = bot + top + 1;
   int off = y0 * w + x0, off2 = (y0 >> 1) * w2 + (x0 >> 1);
   const unsigned char *y = src + off, *u = src + w * h + off2, *v = u + w2 * h2;
   int *p = slice;
@@ -661,8 +912,8 @@ int jhcBarcode::slice_d1_yuv (int *slice, const unsigned char *src, int cdist, i
   }
 
   // clean up and return length
-  smooth(slice, h, sm);
-  return h;
+  smooth(slice, len, sm);
+  return len;
 }
 
 
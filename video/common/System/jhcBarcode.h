@@ -25,6 +25,8 @@
 #define _JHCBARCODE_
 /* CPPDOC_END_EXCLUDE */
 
+#include "jhcGlobal.h"
+
 
 //= Reads barcodes centered in image.
 // there several bit width estimation modes:
@@ -36,6 +38,8 @@
 //   pod = 1 aligns decoding to pairs of bars to combat frame drift
 //   pod = 2 decodes digits as a lattice of preferred possibilities
 // system can also automatically refine barcode position and edge threshold
+// SlowCode and BatchCode spread slices over helper decoders in parallel bands
+// but always report the same result (and scans count) as a serial search
 
 class jhcBarcode
 {
@@ -43,10 +47,28 @@ friend class CUPCDoc;  // for debugging
 
 // PRIVATE MEMBER VARIABLES
 private:
+  static const int wmax = 16;          /** Maximum number of helper decoders. */
+
   int w, h, f, ln, resid;
   int ejs[100], bits[200], lattice[12][4];
   int ymult[256], vmult[3][256], umult[3][256];
-  int *proj;
+  int *proj, *tmp;
+  int psz;
+
+  // parallel helpers
+  jhcBarcode *crew;
+  int nw;
+
+  // current parallel job
+  const unsigned char *jsrc;
+  const int *jbox;
+  char *jcodes;
+  int jyv, jtot, jsz;
+  volatile long win, tried;
+
+  // result from helper
+  char got[20];
+  int kgot;
 
 
 // PUBLIC MEMBER VARIABLES
@@ -59,6 +81,7 @@ public:
   int steps, off, cols, dirs, mode;
   int sm, dmax, wmin, bmin, dbar, bdiff;
   int badj, eadj, est, pod, cvt;
+  int par;
 
 
 // PUBLIC MEMBER FUNCTIONS
@@ -75,6 +98,7 @@ public:
   int FastCode (char *code, const unsigned char *src, int yv12 =0);
   int HorizCode (char *code, const unsigned char *src, int yv12 =0);
   int SlowCode (char *code, const unsigned char *src, int yv12 =0);
+  int BatchCode (char *codes, int ssz, const unsigned char *src, const int *box, int n);
 
   // low level details and operation
   int SliceCode (char *code, const unsigned char *src, 
@@ -85,6 +109,16 @@ public:
 private:
   void build_tables ();
   void dealloc ();
+  void set_area (int x, int y, int z, int line);
+
+  // parallel scanning
+  int scan_one (char *code, const unsigned char *src, int k, int yv12);
+  int scan_total () const {return(dirs * __min(cols, f) * steps);}
+  void get_crew (int n);
+  void copy_params (const jhcBarcode& ref);
+  void take_state (const jhcBarcode& ref);
+  static void scan_band (void *ctx, int band, int nb);
+  static void batch_band (void *ctx, int band, int nb);
 
   // normal image slicing
   int slice_h (int *slice, const unsigned char *src, int cdist, int fld);
@@ -20,8 +20,11 @@
 // 
 ///////////////////////////////////////////////////////////////////////////
 
+#include <windows.h>
 #include <math.h>
 
+#include "Interface/jhcBandPool.h"
+
 #include "System/jhcBgSub.h"
 
 
@@ -510,7 +513,7 @@ int jhcBgSub::MergeBG (jhcImg& now)
 
   // update noise values and slowly change background 
   EstNoise(sfix, &bg, NULL);
-  MixToward(bg, sfix, bg, bmix, 1);
+  mix_bg(sfix, NULL, 0, bmix);
   n++;
   return Status();
 }
@@ -618,6 +621,7 @@ int jhcBgSub::FindFG (jhcImg& now, jhcImg *fgmsk, int cc)
 
 
 //= Check for repeated frames.
+// image is split into bands which all stop once enough changes are found
 
 int jhcBgSub::check_repeat (jhcImg& now)
 {
@@ -629,48 +633,58 @@ int jhcBgSub::check_repeat (jhcImg& now)
   if (FracOver(diff, 2) < 0.01)
     return 1;
 */
+  jhcBandPool *bp = jhcBandPool::Shared();
   double dth = 0.01;
-  int diff, cnt = ROUND(dth * now.RoiArea()), th = 2;  // 2 * 3 = 6
-  int x, y, rw = now.RoiW(), rh = now.RoiH(), rsk = now.RoiSkip();
-  const UC8 *a = now.RoiSrc(), *b = last->RoiSrc(now);
+  int cnt = ROUND(dth * now.RoiArea()), th = 2;  // 2 * 3 = 6
 
   // new versions use early termination
-  if (now.Fields() == 3)
-  {
-    th *= 3;
-    for (y = rh; y > 0; y--)
-    {
-      for (x = rw; x > 0; x--, a += 3, b += 3)
-      {
-        // see if difference above threshold
-        diff =  abs(a[0] - b[0]);
-        diff += abs(a[1] - b[1]);
-        diff += abs(a[2] - b[2]);
-        if (diff <= th)
-          continue;
-        
-        // if all allowed pixels used up then report non-duplicate
-        if (--cnt <= 0)
-          return 0;
-      } 
-      a += rsk;
-      b += rsk;
-    }
-    return 1;
-  }
+  f_s = now.RoiSrc();
+  f_r = last->RoiSrc(now);
+  f_w = now.RoiW();
+  f_h = now.RoiH();
+  f_ln = now.Line();
+  f_nf = now.Fields();
+  f_th = ((f_nf == 3) ? 3 * th : th);
+  f_cnt = __max(1, cnt);
+  bp->Run(rpt_rows, this, bp->Bands(f_h));
+
+  // if all allowed pixels used up then report non-duplicate
+  return((f_cnt > 0) ? 1 : 0);
+}
+
+
+//= Count pixels in a band of rows that differ from the last frame.
+// removes them from the shared allowance and quits when it is gone
 
-  // monochrome version
-  for (y = rh; y > 0; y--)
+void jhcBgSub::rpt_rows (void *ctx, int band, int nb)
+{
+  jhcBgSub *me = (jhcBgSub *) ctx;
+  int x, y, diff, n, th = me->f_th, rw = me->f_w, ln = me->f_ln;
+  int y0 = (band * me->f_h) / nb, y1 = ((band + 1) * me->f_h) / nb;
+  const UC8 *a = me->f_s + y0 * ln, *b = me->f_r + y0 * ln;
+
+  for (y = y0; y < y1; y++, a += ln, b += ln)
   {
-    for (x = rw; x > 0; x--, a++, b++)
-      if (abs(*a - *b) <= th)
-        continue;
-      else if (--cnt <= 0)
-        return 0;
-    a += rsk;
-    b += rsk;
+    // see if some band already found enough differences
+    if (me->f_cnt <= 0)
+      return;
+
+    // count pixels with difference above threshold
+    n = 0;
+    if (me->f_nf == 3)
+      for (x = 3 * (rw - 1); x >= 0; x -= 3)
+      {
+        diff =  abs(a[x]     - b[x]);
+        diff += abs(a[x + 1] - b[x + 1]);
+        diff += abs(a[x + 2] - b[x + 2]);
+        n += ((diff > th) ? 1 : 0);
+      }
+    else
+      for (x = rw - 1; x >= 0; x--)
+        n += ((abs(a[x] - b[x]) > th) ? 1 : 0);
+    if (n > 0)
+      InterlockedExchangeAdd(&(me->f_cnt), -n);
   }
-  return 1;
 }
 
 
@@ -1018,18 +1032,41 @@ int jhcBgSub::salience (jhcImg& dest, jhcImg& src, jhcImg& ref)
 
 int jhcBgSub::fg_motion (jhcImg& dest, jhcImg& src)
 {
+  jhcBandPool *bp = jhcBandPool::Shared();
   double r = QuietR(), g = QuietG(), b = QuietB();
   double norm = 1.0 / (r + g + b);
   double rn = norm * r, gn = norm * g, bn = norm * b;
   double nmono = rn / (r * sqrt((double)(src.Fields()))), sc = 255.0 / rng; 
-  double nmot = nmono * sqrt(2.0), motf = mf * sc / nmot;
+  double nmot = nmono * sqrt(2.0), motf = mf * sc / nmot, sc2 = motf * motf / 255.0;
+  int i;
+
+  if (!src.Valid(3) || !src.SameSize(dest, 1) || !dest.SameFormat(map))
+    return Fatal("Bad images to jhcBgSub::fg_motion");
 
   // create monochrome version and difference from last frame
+  // then combine two differences (i.e. motion over 3 frames) and 
+  // scale motion difference as part of salience sum (all in one pass)
+  wts_rgb(rn, gn, bn);
+  for (i = 0; i <= 255; i++)
+    f_lut[i] = ((mf > 0.0) ? BOUND(ROUND(sc2 * i * i)) : 0);
+  f_s = src.PxlSrc();
+  f_r = prev->PxlSrc();
+  f_g = map.PxlSrc();
+  f_d = gmot->PxlDest();
+  f_d2 = mot->PxlDest();
+  f_d3 = pmot->PxlDest();
+  f_d4 = dest.PxlDest();
+  f_w = dest.XDim();
+  f_h = dest.YDim();
+  f_ln = dest.Line();
+  f_ln3 = src.Line();
+  f_th = thmap;                       // no motion energy in known noisy areas
+  f_on = first;
+  bp->Run(mot_rows, this, bp->Bands(f_h));
+
   // skip update (and rest of salience) if a repeat frame 
-  WtdSumRGB(*gmot, src, rn, gn, bn);
   if (first <= 0)
   {
-    AbsDiff(*mot, *gmot, *prev, 1.0);
     if (mot->YDim() > 200)            // some noise reduction
       BoxAvg(rmot, *mot, 5);
     else 
@@ -1040,23 +1077,65 @@ int jhcBgSub::fg_motion (jhcImg& dest, jhcImg& src)
   }
   swap_imgs(&prev, &gmot);
   first = 0;
-
-  // combine two differences (i.e. motion over 3 frames)
-  MinFcn(*pmot, *mot, *pmot);   // so background gets written
   swap_imgs(&pmot, &mot);       // pmot = diff of 2, mot = diff of 3
-
-  // scale motion difference as part of salience sum
-  if (mf > 0.0)
-    Square(dest, *mot, motf);  
-  else
-    dest.FillArr(0);
-  OverGate(dest, dest, map, thmap);  // no motion energy in known noisy areas
   if (steps > 0)
     mv.Clone(dest);
   return 0;
 }
 
 
+//= Build tables for weighted sum of color channels like jhcVect::WtdSumRGB.
+
+void jhcBgSub::wts_rgb (double rsc, double gsc, double bsc)
+{
+  UL32 rinc, ginc, binc, rsum = 0, gsum = 0, bsum = 0;
+  int i;
+
+  rinc = (UL32)(rsc * 65536.0 + 0.5);
+  ginc = (UL32)(gsc * 65536.0 + 0.5);
+  binc = (UL32)(bsc * 65536.0 + 0.5);
+  for (i = 0; i < 256; i++)
+  {
+    f_bwt[i] = bsum;
+    f_gwt[i] = gsum;
+    f_rwt[i] = rsum;
+    bsum += binc;
+    gsum += ginc;
+    rsum += rinc;
+  }
+}
+
+
+//= Do monochrome conversion, frame differencing, and motion salience for some rows.
+// same as WtdSumRGB, AbsDiff, MinFcn, Square, and OverGate in sequence 
+
+void jhcBgSub::mot_rows (void *ctx, int band, int nb)
+{
+  jhcBgSub *me = (jhcBgSub *) ctx;
+  const UL32 *rwt = me->f_rwt, *gwt = me->f_gwt, *bwt = me->f_bwt;
+  const UC8 *sq = me->f_lut;
+  int x, y, v, rw = me->f_w, ln = me->f_ln, ln3 = me->f_ln3, th = me->f_th, init = me->f_on;
+  int y0 = (band * me->f_h) / nb, y1 = ((band + 1) * me->f_h) / nb;
+  const UC8 *s = me->f_s + y0 * ln3, *p = me->f_r + y0 * ln, *m = me->f_g + y0 * ln;
+  UC8 *g = me->f_d + y0 * ln, *d = me->f_d2 + y0 * ln;
+  UC8 *pd = me->f_d3 + y0 * ln, *sal = me->f_d4 + y0 * ln;
+
+  for (y = y0; y < y1; y++, s += ln3, p += ln, m += ln, g += ln, d += ln, pd += ln, sal += ln)
+    for (x = 0; x < rw; x++)
+    {
+      // intensity and change from last frame (unless first)
+      v = (int)((bwt[s[3 * x]] + gwt[s[3 * x + 1]] + rwt[s[3 * x + 2]] + 32768) >> 16);
+      g[x] = BOUND(v);
+      if (init <= 0)
+        d[x] = (UC8) abs((int) g[x] - (int) p[x]);
+
+      // keep smaller of two differences and score if background known
+      pd[x] = __min(d[x], pd[x]);
+      sal[x] = ((m[x] > th) ? sq[pd[x]] : 0);
+    }
+}
+
+
 //= Look for texture changes and add to salience.
 // uses grayscale image computed by fg_motion
 
@@ -1102,17 +1181,46 @@ void jhcBgSub::fg_texture (jhcImg& dest, jhcImg& src, jhcImg& ref)
 
 void jhcBgSub::fg_color (jhcImg& dest, jhcImg& src, jhcImg& ref)
 {
+  jhcBandPool *bp = jhcBandPool::Shared();
   double r = QuietR(), g = QuietG(), b = QuietB();
   double sc = 255.0 / rng; 
   double rsc = cf * sc * r, gsc = cf * sc * g, bsc = cf * sc * b;
+  double r256 = 256.0 * rsc, g256 = 256.0 * gsc, b256 = 256.0 * bsc;
+  int diff, v;
 
   if (cf <= 0.0)
     return;
+  if (!src.Valid(3) || !src.SameFormat(ref) || !src.SameSize(dest, 1) || !dest.SameFormat(map))
+  {
+    Fatal("Bad images to jhcBgSub::fg_color");
+    return;
+  }
+
+  // tables for weighted sum of squared channel differences (as WtdSSD_RGB)
+  for (diff = 0; diff <= 255; diff++)
+  {
+    v = diff * diff;
+    f_rsq[255 - diff] = ROUND(r256 * v);
+    f_rsq[255 + diff] = f_rsq[255 - diff];
+    f_gsq[255 - diff] = ROUND(g256 * v);
+    f_gsq[255 + diff] = f_gsq[255 - diff];
+    f_bsq[255 - diff] = ROUND(b256 * v);
+    f_bsq[255 + diff] = f_bsq[255 - diff];
+  }
 
   // get differences at basic pixel level after removing shadows
-  fix_shadows(ctmp, src, ref);                
-  WtdSSD_RGB(tmp, ctmp, ref, rsc, gsc, bsc);
-  OverGate(tmp, tmp, map, thmap);
+  fix_shadows();
+  f_s = src.PxlSrc();
+  f_r = ref.PxlSrc();
+  f_g = map.PxlSrc();
+  f_d = tmp.PxlDest();
+  f_d2 = ((steps > 0) ? ctmp.PxlDest() : NULL);
+  f_w = dest.XDim();
+  f_h = dest.YDim();
+  f_ln = dest.Line();
+  f_ln3 = src.Line();
+  f_th = thmap;
+  bp->Run(col_rows, this, bp->Bands(f_h));
   BoxAvg(tmp2, tmp, 3);               // extra noise suppression
   MinFcn(*col, tmp, tmp2);
 
@@ -1127,36 +1235,119 @@ void jhcBgSub::fg_color (jhcImg& dest, jhcImg& src, jhcImg& ref)
 }
 
 
-//= Multiplies channel values so overall pixel intensity matches reference.
+//= Set up to multiply channel values so overall pixel intensity matches reference.
 // assumes any AGC/AWB adjustment and limiting has already been done
+// actual correction is done in col_rows as part of color difference
 
-int jhcBgSub::fix_shadows (jhcImg& sfix, jhcImg& src, jhcImg& ref)
+void jhcBgSub::fix_shadows ()
 {
   double rsc = QuietR(), gsc = QuietG(), bsc = QuietB();
   double sum = rsc + gsc + bsc;
+  int i;
 
-  // check sizes and handle simple cases
-  if (!sfix.SameFormat(src) || !sfix.SameFormat(ref))
-    return Fatal("Bad images to jhcBgSub::FixShadows");
+  // check for simple case
+  f_on = 1;
   if ((df == 1.0) && (bf == 1.0))
-    return sfix.CopyArr(src);
+  {
+    f_on = 0;
+    return;
+  }
 
   // compute ratios again and throw out any pixel with any estimate beyond bounds
-  // tmp2 holds valid pixels
-  double mid = 0.5, mval = mid * 256.0;
+  double mid = 0.5, mval = mid * 256.0, sc16 = 65536.0 * mid;
   int unity = ROUND(mval), brite = BOUND(ROUND(df * mval)), dark = ROUND(bf * mval);
 
-  // get ratio estimate and keep places where all are within bounds
-  NormBy(ctmp, ref, src, mid);
-  AllWithin(tmp2, ctmp, dark, brite);
+  // ratio estimate (as NormBy) and validity range (as AllWithin)
+  f_inv[0] = 65536;
+  for (i = 1; i <= 255; i++)
+    f_inv[i] = ROUND(sc16 / i);
+  f_mid = BOUND(ROUND(mid * 255.0));
+  f_lo = BOUND(dark);
+  f_hi = BOUND(brite);
+
+  // combine channel estimates into single gain or use default
+  wts_rgb(rsc / sum, gsc / sum, bsc / sum);
+  f_def = BOUND(unity);
+}
+
 
-  // combine channel estimates into single gain and gate where valid
-  WtdSumRGB(tmp, ctmp, rsc / sum, gsc / sum, bsc / sum);  
-  OverGate(tmp, tmp, tmp2, 128, unity); 
+//= Remove shadows then find color differences from background for some rows.
+// same as NormBy, AllWithin, WtdSumRGB, OverGate, MultRGB, WtdSSD_RGB, and OverGate 
+// can also save shadow corrected image if f_d2 is not NULL
 
-  // fix image by applying gains
-  MultRGB(sfix, src, tmp);
-  return 1;
+void jhcBgSub::col_rows (void *ctx, int band, int nb)
+{
+  jhcBgSub *me = (jhcBgSub *) ctx;
+  const UL32 *rwt = me->f_rwt, *gwt = me->f_gwt, *bwt = me->f_bwt;
+  const int *inv = me->f_inv;
+  const int *rsq = me->f_rsq + 255, *gsq = me->f_gsq + 255, *bsq = me->f_bsq + 255;
+  int x, y, i, v, ok, gain, rat[3], fix[3];
+  int rw = me->f_w, ln = me->f_ln, ln3 = me->f_ln3, th = me->f_th, shad = me->f_on;
+  int lo = me->f_lo, hi = me->f_hi, mid = me->f_mid, unity = me->f_def;
+  int y0 = (band * me->f_h) / nb, y1 = ((band + 1) * me->f_h) / nb;
+  const UC8 *s, *r, *m, *div;
+  UC8 *d, *c = NULL;
+
+  for (y = y0; y < y1; y++)
+  {
+    div = me->f_s + y * (ln3 - 2 * rw);
+    s = me->f_s + y * ln3;
+    r = me->f_r + y * ln3;
+    m = me->f_g + y * ln;
+    d = me->f_d + y * ln;
+    if (me->f_d2 != NULL)
+      c = me->f_d2 + y * ln3;
+    for (x = 0; x < rw; x++, s += 3, r += 3)
+    {
+      if (shad > 0)
+      {
+        // get ratio estimate and see if all are within bounds
+        // divisor steps through source one byte per pixel just like NormBy
+        ok = 1;
+        for (i = 0; i < 3; i++)
+        {
+          if (div[x] > 0)
+          {
+            v = (r[i] * inv[div[x]] + 128) >> 8;
+            rat[i] = BOUND(v);
+          }
+          else
+            rat[i] = ((r[i] > 0) ? 255 : mid);
+          if ((rat[i] < lo) || (rat[i] > hi))
+            ok = 0;
+        }
+
+        // combine channel estimates into single gain 
+        gain = unity;
+        if (ok > 0)
+        {
+          v = (int)((bwt[rat[0]] + gwt[rat[1]] + rwt[rat[2]] + 32768) >> 16);
+          gain = BOUND(v);
+        }
+
+        // fix pixel by applying gain
+        for (i = 0; i < 3; i++)
+        {
+          v = (gain * s[i]) >> 7;
+          fix[i] = __min(v, 255);
+        }
+      }
+      else
+        for (i = 0; i < 3; i++)
+          fix[i] = s[i];
+
+      // weighted color difference only where background valid
+      v = (bsq[fix[0] - r[0]] + gsq[fix[1] - r[1]] + rsq[fix[2] - r[2]]) >> 8;
+      d[x] = ((m[x] > th) ? (UC8) __min(v, 255) : 0);
+      if (c != NULL)
+      {
+        c[0] = (UC8) fix[0];
+        c[1] = (UC8) fix[1];
+        c[2] = (UC8) fix[2];
+        c += 3;
+      }
+    }
+  }
 }
 
 
@@ -1333,12 +1524,49 @@ void jhcBgSub::bg_heal ()
 
 void jhcBgSub::bg_push ()
 {
+  jhcBandPool *bp = jhcBandPool::Shared();
   int dec = 1 + (stable / 256), st = stable / dec;
  
   Threshold(tmp, qfg, st - 1);          // was "stable - 1"
   BoxAvg(tmp, tmp, fat, fat, 4.0);
-  UnderGate(quiet, quiet, tmp, 1, st);  // was "stable" 
-  SubstOver(bg, former, tmp, st - 1);   // was "stable - 1"
+
+  // reset stillness and copy in new background in same pass
+  f_s = former.PxlSrc();
+  f_g = tmp.PxlSrc();
+  f_d = quiet.PxlDest();
+  f_d2 = bg.PxlDest();
+  f_w = bg.XDim();
+  f_h = bg.YDim();
+  f_ln = tmp.Line();
+  f_ln3 = bg.Line();
+  f_nf = bg.Fields();
+  f_def = BOUND(st);                    // was "stable" 
+  f_th = BOUND(st - 1);                 // was "stable - 1"
+  bp->Run(push_rows, this, bp->Bands(f_h));
+}
+
+
+//= Erase healed regions from background for some rows.
+// same as UnderGate(quiet, quiet, tmp, 1, st) then SubstOver(bg, former, tmp, st - 1)
+
+void jhcBgSub::push_rows (void *ctx, int band, int nb)
+{
+  jhcBgSub *me = (jhcBgSub *) ctx;
+  int x, y, i, nf = me->f_nf, rw = me->f_w, ln = me->f_ln, ln3 = me->f_ln3, th = me->f_th;
+  int y0 = (band * me->f_h) / nb, y1 = ((band + 1) * me->f_h) / nb;
+  const UC8 *g = me->f_g + y0 * ln, *a = me->f_s + y0 * ln3;
+  UC8 *q = me->f_d + y0 * ln, *b = me->f_d2 + y0 * ln3;
+  UC8 st = (UC8) me->f_def;
+
+  for (y = y0; y < y1; y++, g += ln, q += ln, a += ln3, b += ln3)
+    for (x = 0; x < rw; x++)
+    {
+      if (g[x] > 0)
+        q[x] = st;
+      if (g[x] > th)
+        for (i = x * nf; i < (x + 1) * nf; i++)
+          b[i] = a[i];
+    }
 }
 
 
@@ -1349,12 +1577,87 @@ void jhcBgSub::bg_smooth ()
   if (--w <= 0)
   {
     w = wait;
-    MixToward(ctmp, former, bg, 0.1, 1);  
-    SubstOver(bg, ctmp, quiet, still);
+    mix_bg(former, &quiet, still, 0.1);
   }
 }
 
 
+//= Alter background to be more like the goal image where gate is over threshold.
+// alters by some fraction of difference with minimum step of one enforced
+// same as MixToward into a temporary image then SubstOver, but in a single pass
+// if no gate is given then all pixels are updated
+
+void jhcBgSub::mix_bg (const jhcImg& goal, const jhcImg *gate, int th, double f)
+{
+  jhcBandPool *bp = jhcBandPool::Shared();
+  int i, diff;
+
+  if (!bg.SameFormat(goal) || ((gate != NULL) && !bg.SameSize(*gate, 1)))
+  {
+    Fatal("Bad images to jhcBgSub::mix_bg");
+    return;
+  }
+
+  // precompute component scaling table
+  f_lut[0] = 0;
+  for (i = 1; i <= 255; i++)
+  {
+    diff = ROUND(f * i);
+    f_lut[i] = (UC8) __min(i, __max(1, diff));
+  }
+
+  // adjust all pixels or just ones that are quiet
+  f_s = goal.PxlSrc();
+  f_g = ((gate != NULL) ? gate->PxlSrc() : NULL);
+  f_d = bg.PxlDest();
+  f_w = bg.XDim();
+  f_h = bg.YDim();
+  f_ln = ((gate != NULL) ? gate->Line() : 0);
+  f_ln3 = bg.Line();
+  f_nf = bg.Fields();
+  f_th = BOUND(th);
+  bp->Run(mix_rows, this, bp->Bands(f_h));
+}
+
+
+//= Move background toward goal for some rows (possibly gated).
+
+void jhcBgSub::mix_rows (void *ctx, int band, int nb)
+{
+  jhcBgSub *me = (jhcBgSub *) ctx;
+  const UC8 *dsc = me->f_lut;
+  int x, y, i, nf = me->f_nf, rw = me->f_w, ln = me->f_ln, ln3 = me->f_ln3, th = me->f_th;
+  int y0 = (band * me->f_h) / nb, y1 = ((band + 1) * me->f_h) / nb;
+  const UC8 *g = me->f_s + y0 * ln3, *q = NULL;
+  UC8 *b = me->f_d + y0 * ln3;
+
+  if (me->f_g != NULL)
+    q = me->f_g + y0 * ln;
+  for (y = y0; y < y1; y++, g += ln3, b += ln3)
+    if (q == NULL)
+    {
+      // add in fractional difference everywhere
+      for (i = rw * nf - 1; i >= 0; i--)
+        if (g[i] >= b[i])
+          b[i] += dsc[g[i] - b[i]];
+        else
+          b[i] -= dsc[b[i] - g[i]];
+    }
+    else
+    {
+      // only change pixels where gate is high enough
+      for (x = 0; x < rw; x++)
+        if (q[x] > th)
+          for (i = x * nf; i < (x + 1) * nf; i++)
+            if (g[i] >= b[i])
+              b[i] += dsc[g[i] - b[i]];
+            else
+              b[i] -= dsc[b[i] - g[i]];
+      q += ln;
+    }
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                          Size Changing Functions                      //
 ///////////////////////////////////////////////////////////////////////////
@@ -114,6 +114,15 @@ private:
   int off;                             // contrast adjustment used
   double sc;
 
+  // fused pixel passes (shared with band functions)
+  const UC8 *f_s, *f_r, *f_g;
+  UC8 *f_d, *f_d2, *f_d3, *f_d4;
+  int f_w, f_h, f_ln, f_ln3, f_nf, f_th, f_def, f_lo, f_hi, f_mid, f_on;
+  UL32 f_rwt[256], f_gwt[256], f_bwt[256];
+  int f_rsq[512], f_gsq[512], f_bsq[512], f_inv[256];
+  UC8 f_lut[256];
+  volatile long f_cnt;
+
 public:
   //= Preprocessing image fix-up parameter set.
   // includes boost, wind, wob, ntsc, ksm, and agc
@@ -233,7 +242,7 @@ private:
   int fg_motion (jhcImg& dest, jhcImg& src);
   void fg_texture (jhcImg& dest, jhcImg& src, jhcImg& ref);
   void fg_color (jhcImg& dest, jhcImg& src, jhcImg& ref);
-  int fix_shadows (jhcImg& sfix, jhcImg& src, jhcImg& ref);
+  void fix_shadows ();
   int clean_mask (jhcImg& dest, jhcImg& src, int th =128);
 
   int update_bg_0 (jhcImg& fgmsk);
@@ -244,6 +253,14 @@ private:
   void bg_push ();
   void bg_smooth ();
 
+  void wts_rgb (double rsc, double gsc, double bsc);
+  void mix_bg (const jhcImg& goal, const jhcImg *gate, int th, double f);
+  static void rpt_rows (void *ctx, int band, int nb);
+  static void mot_rows (void *ctx, int band, int nb);
+  static void col_rows (void *ctx, int band, int nb);
+  static void mix_rows (void *ctx, int band, int nb);
+  static void push_rows (void *ctx, int band, int nb);
+
 };
 
 
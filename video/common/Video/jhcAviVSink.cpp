@@ -264,6 +264,10 @@ int jhcAviVSink::iOpen ()
   long sz;
   int rc;
 
+  // cannot store 16 bit depth images
+  if (d == 2)
+    return 0;
+
   // open the AVI file for writing and bind file pointer
   // then create the raw stream with given image size
   if (AVIFileOpen(&pfile, fn.Txt(), OF_CREATE, NULL) != 0)
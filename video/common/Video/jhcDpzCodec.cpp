@@ -0,0 +1,483 @@
+// jhcDpzCodec.cpp : lossless compression of 16 bit depth images
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "Interface/jhcBandPool.h"
+#include "Interface/jhcMessage.h"
+
+#include "Video/jhcDpzCodec.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcDpzCodec::~jhcDpzCodec ()
+{
+  dealloc();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcDpzCodec::jhcDpzCodec ()
+{
+  code = NULL;
+  csz = NULL;
+  bok = NULL;
+  w = 0;
+  h = 0;
+  ln = 0;
+  nb = 0;
+  src = NULL;
+  data = NULL;
+  dsz = NULL;
+  rimg = NULL;
+  key = 1;
+}
+
+
+//= Get rid of all band buffers.
+
+void jhcDpzCodec::dealloc ()
+{
+  int b;
+
+  if (code != NULL)
+    for (b = 0; b < nb; b++)
+      delete [] code[b];
+  delete [] code;
+  delete [] bok;
+  delete [] csz;
+  code = NULL;
+  csz = NULL;
+  bok = NULL;
+  nb = 0;
+}
+
+
+//= Set image dimensions and number of independent bands.
+// worst case code is 3 bytes per pixel plus mode byte and final run
+// reference frame is cleared so next frame must be a key frame
+
+int jhcDpzCodec::SetSize (int wid, int ht, int bands)
+{
+  int b, n = __max(1, __min(bands, ht));
+
+  if ((wid <= 0) || (ht <= 0) || (bands <= 0))
+    return Fatal("Bad size to jhcDpzCodec::SetSize");
+
+  // see if anything changed
+  ref.SetSize(wid, ht, 2);
+  ref.FillArr(0);
+  if ((wid == w) && (ht == h) && (n == nb))
+    return 1;
+
+  // make new band buffers
+  dealloc();
+  w = wid;
+  h = ht;
+  ln = ref.Line();
+  nb = n;
+  code = new UC8 * [nb];
+  csz = new int [nb];
+  bok = new int [nb];
+  for (b = 0; b < nb; b++)
+  {
+    code[b] = new UC8 [3 * w * (((b + 1) * h) / nb - (b * h) / nb) + 16];
+    csz[b] = 0;
+    bok[b] = 0;
+  }
+  return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Main Functions                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Compress a depth image into band codes (kf > 0 for key frame).
+// also makes image the reference for temporal prediction of next frame
+// returns total number of code bytes generated
+
+int jhcDpzCodec::Encode (const jhcImg& img, int kf)
+{
+  int b, sum = 0;
+
+  if ((nb <= 0) || !img.Valid(2) || !img.SameFormat(ref))
+    return Fatal("Bad image to jhcDpzCodec::Encode");
+
+  // code all bands in parallel
+  src = img.PxlSrc();
+  rimg = ref.PxlDest();
+  key = kf;
+  jhcBandPool::Shared()->Run(enc_band, this, nb);
+  src = NULL;
+  rimg = NULL;
+
+  // get overall size
+  for (b = 0; b < nb; b++)
+    sum += csz[b];
+  return sum;
+}
+
+
+//= Rebuild next depth image from band codes (kf > 0 for key frame).
+// non-key frames must follow the previous frame decoded (or encoded)
+// result is available through Frame until next call
+// returns 1 if okay, 0 if some band was corrupt
+
+int jhcDpzCodec::Decode (const UC8 * const *bdata, const UL32 *bsize, int kf)
+{
+  int b;
+
+  if ((nb <= 0) || (bdata == NULL) || (bsize == NULL))
+    return Fatal("Bad input to jhcDpzCodec::Decode");
+
+  // expand all bands in parallel
+  data = bdata;
+  dsz = bsize;
+  rimg = ref.PxlDest();
+  key = kf;
+  jhcBandPool::Shared()->Run(dec_band, this, nb);
+  data = NULL;
+  dsz = NULL;
+  rimg = NULL;
+
+  // check that every band was complete
+  for (b = 0; b < nb; b++)
+    if (bok[b] <= 0)
+      return 0;
+  return 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Parallel Bands                             //
+///////////////////////////////////////////////////////////////////////////
+
+//= Compress one band of rows (nb always matches number of codec bands).
+
+void jhcDpzCodec::enc_band (void *ctx, int band, int nb)
+{
+  ((jhcDpzCodec *) ctx)->enc_rows(band);
+}
+
+
+//= Expand one band of rows (nb always matches number of codec bands).
+
+void jhcDpzCodec::dec_band (void *ctx, int band, int nb)
+{
+  ((jhcDpzCodec *) ctx)->dec_rows(band);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                               Encoding                                //
+///////////////////////////////////////////////////////////////////////////
+
+//= Generate code for rows in band b then copy them to reference frame.
+// first byte of code is prediction mode: 0 = median, 1 = temporal, 2 = planar
+
+void jhcDpzCodec::enc_rows (int b)
+{
+  int y0 = (b * h) / nb, y1 = ((b + 1) * h) / nb;
+  int x, y, v, zz, mode, run = 0, pend = 0;
+  const US16 *c, *u, *p;
+  UC8 *r0 = rimg + y0 * ln, *out = code[b];
+
+  // pick predictor for whole band
+  mode = pick_mode(y0, y1);
+  *out++ = (UC8) mode;
+
+  // compute residuals for all pixels
+  for (y = y0; y < y1; y++)
+  {
+    c = (const US16 *)(src + y * ln);
+    u = (const US16 *)(src + (y - 1) * ln);
+    p = (const US16 *)(r0 + (y - y0) * ln);
+    for (x = 0; x < w; x++)
+    {
+      // predict value from neighbors or last frame
+      if (mode == 1)
+        v = p[x];
+      else if (y == y0)
+        v = ((x > 0) ? c[x - 1] : 0);
+      else if (x == 0)
+        v = u[0];
+      else if (mode == 2)
+        v = c[x - 1] + u[x] - u[x - 1];
+      else
+        v = med(c[x - 1], u[x], u[x - 1]);
+
+      // zigzag map signed 16 bit difference
+      v = (short)(c[x] - v);
+      zz = ((v << 1) ^ (v >> 15)) & 0xFFFF;
+
+      // try to pair with previous small value
+      if (pend > 0)
+      {
+        if (zz < 8)
+        {
+          *out++ = (UC8)(0x40 | (pend << 3) | zz);
+          pend = 0;
+          continue;
+        }
+        out = put_val(out, pend);
+        pend = 0;
+      }
+
+      // accumulate zeroes, hold small value, or emit value
+      if (zz == 0)
+      {
+        run++;
+        continue;
+      }
+      if (run > 0)
+        out = put_run(out, run);
+      run = 0;
+      if (zz < 8)
+        pend = zz;
+      else
+        out = put_val(out, zz);
+    }
+  }
+  if (pend > 0)
+    out = put_val(out, pend);
+  if (run > 0)
+    out = put_run(out, run);
+  csz[b] = (int)(out - code[b]);
+
+  // remember image for next frame
+  for (y = y0; y < y1; y++, r0 += ln)
+    memcpy(r0, src + y * ln, 2 * w);
+}
+
+
+//= Guess which predictor gives the shortest code for a band.
+// samples every fourth line and scores approximate code length
+// temporal prediction is only considered if not a key frame
+// returns 0 for median edge, 1 for temporal, 2 for planar
+
+int jhcDpzCodec::pick_mode (int y0, int y1) const
+{
+  const US16 *c, *u, *p;
+  int x, y, mc = 0, tc = 0, pc = 0;
+
+  for (y = y0 + 1; y < y1; y += 4)
+  {
+    c = (const US16 *)(src + y * ln);
+    u = (const US16 *)(src + (y - 1) * ln);
+    p = (const US16 *)(rimg + y * ln);
+    for (x = 1; x < w; x++)
+    {
+      mc += cost(c[x] - med(c[x - 1], u[x], u[x - 1]));
+      pc += cost(c[x] - (c[x - 1] + u[x] - u[x - 1]));
+      if (key <= 0)
+        tc += cost(c[x] - p[x]);
+    }
+  }
+  if ((key <= 0) && (tc < mc) && (tc < pc))
+    return 1;
+  return((pc < mc) ? 2 : 0);
+}
+
+
+//= Approximate code length (in quarter bytes) for some prediction error.
+
+int jhcDpzCodec::cost (int err) const
+{
+  int d = abs((short) err);
+
+  if (d == 0)
+    return 1;
+  if (d <= 3)
+    return 2;
+  if (d < 32)
+    return 4;
+  return((d < 8192) ? 8 : 12);
+}
+
+
+//= Emit code for some number of zero residuals.
+
+UC8 *jhcDpzCodec::put_run (UC8 *out, int n) const
+{
+  int m, left = n;
+
+  while (left > 0)
+  {
+    if (left < 64)
+    {
+      *out++ = (UC8)(0x80 | (left - 1));
+      break;
+    }
+    m = __min(left - 64, 0xFFFF);
+    *out++ = 0xBF;
+    *out++ = (UC8)(m & 0xFF);
+    *out++ = (UC8)(m >> 8);
+    left -= m + 64;
+  }
+  return out;
+}
+
+
+//= Emit code for a single non-zero mapped residual.
+
+UC8 *jhcDpzCodec::put_val (UC8 *out, int zz) const
+{
+  int v = zz - 64;
+
+  if (zz < 64)
+    *out++ = (UC8) zz;
+  else if (v < 0x4000)
+  {
+    *out++ = (UC8)(0xC0 | (v >> 8));
+    *out++ = (UC8)(v & 0xFF);
+  }
+  else
+  {
+    *out++ = 0x00;
+    *out++ = (UC8)(zz & 0xFF);
+    *out++ = (UC8)(zz >> 8);
+  }
+  return out;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                               Decoding                                //
+///////////////////////////////////////////////////////////////////////////
+
+//= Rebuild rows in band b of reference frame from code.
+// prediction exactly mirrors enc_rows, temporal value is read before overwrite
+// sets bok[b] to zero if code is too short or has the wrong mode
+
+void jhcDpzCodec::dec_rows (int b)
+{
+  int y0 = (b * h) / nb, y1 = ((b + 1) * h) / nb;
+  const UC8 *in = data[b], *end = in + dsz[b];
+  int x, y, v, zz, mode, run = 0, pend = -1;
+  US16 *c, *u;
+
+  // check for valid prediction mode
+  bok[b] = 0;
+  if ((in == NULL) || (dsz[b] < 1))
+    return;
+  mode = *in++;
+  if ((mode > 2) || ((mode == 1) && (key > 0)))
+    return;
+
+  // reconstruct all pixels in place
+  for (y = y0; y < y1; y++)
+  {
+    c = (US16 *)(rimg + y * ln);
+    u = (US16 *)((UC8 *) c - ln);
+    for (x = 0; x < w; x++)
+    {
+      // get next mapped residual
+      if (pend >= 0)
+      {
+        zz = pend;
+        pend = -1;
+      }
+      else if (run > 0)
+      {
+        zz = 0;
+        run--;
+      }
+      else
+      {
+        if (in >= end)
+          return;
+        v = *in++;
+        if ((v == 0x00) || (v == 0xBF) || (v >= 0xC0))
+          if ((end - in) < ((v >= 0xC0) ? 1 : 2))
+            return;
+        if (v == 0x00)
+        {
+          zz = in[0] | (in[1] << 8);
+          in += 2;
+        }
+        else if (v < 0x40)
+          zz = v;
+        else if (v < 0x80)
+        {
+          zz = (v >> 3) & 0x07;
+          pend = v & 0x07;
+        }
+        else if (v >= 0xC0)
+          zz = 64 + (((v & 0x3F) << 8) | *in++);
+        else
+        {
+          if (v == 0xBF)
+          {
+            run = 64 + (in[0] | (in[1] << 8));
+            in += 2;
+          }
+          else
+            run = (v & 0x3F) + 1;
+          zz = 0;
+          run--;
+        }
+      }
+
+      // predict value and add residual
+      if (mode == 1)
+        v = c[x];
+      else if (y == y0)
+        v = ((x > 0) ? c[x - 1] : 0);
+      else if (x == 0)
+        v = u[0];
+      else if (mode == 2)
+        v = c[x - 1] + u[x] - u[x - 1];
+      else
+        v = med(c[x - 1], u[x], u[x - 1]);
+      c[x] = (US16)(v + ((zz >> 1) ^ -(zz & 1)));
+    }
+  }
+  bok[b] = (((run == 0) && (pend < 0)) ? 1 : 0);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                              Prediction                               //
+///////////////////////////////////////////////////////////////////////////
+
+//= Median edge detector prediction from left (a), up (b), and up-left (c).
+
+int jhcDpzCodec::med (int a, int b, int c) const
+{
+  int lo = __min(a, b), hi = __max(a, b);
+
+  if (c >= hi)
+    return lo;
+  if (c <= lo)
+    return hi;
+  return(a + b - c);
+}
+
+
@@ -0,0 +1,115 @@
+// jhcDpzCodec.h : lossless compression of 16 bit depth images
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCDPZCODEC_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCDPZCODEC_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"
+
+
+//= Lossless compression of 16 bit depth images.
+// image is cut into horizontal bands which are coded independently in parallel
+// each band uses median edge, planar (good for sloped floors), or temporal
+// (previous frame) prediction, whichever looks cheapest, then residuals are
+// zigzag mapped and written as a byte code with zero run-lengths:
+// <pre>
+//   0x01-0x3F         = residual 1 to 63
+//   0x40-0x7F         = pair of residuals (bits 5:3 then bits 2:0), first non-zero
+//   0x80-0xBE         = run of 1 to 63 zero residuals
+//   0xBF lo hi        = run of 64 + (hi:lo) zero residuals
+//   0xC0-0xFF lo      = residual 64 + (6 bits:lo)
+//   0x00 lo hi        = residual (hi:lo) given directly
+// </pre>
+// all arithmetic is modulo 2^16 so any depth value is reproduced exactly
+// key frames use only spatial prediction so they can be decoded alone
+
+class jhcDpzCodec
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  // sizes and reference frame
+  jhcImg ref;
+  UC8 **code;
+  int *csz, *bok;
+  int w, h, ln, nb;
+
+  // current job
+  const UC8 *src;
+  const UC8 * const *data;
+  const UL32 *dsz;
+  UC8 *rimg;
+  int key;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcDpzCodec ();
+  jhcDpzCodec ();
+  int SetSize (int wid, int ht, int bands);
+  int XDim () const  {return w;}
+  int YDim () const  {return h;}
+  int Bands () const {return nb;}
+
+  // main functions
+  int Encode (const jhcImg& img, int kf);
+  const UC8 *Code (int b) const {return(((b < 0) || (b >= nb)) ? NULL : code[b]);}
+  int CodeSize (int b) const    {return(((b < 0) || (b >= nb)) ? 0 : csz[b]);}
+  int Decode (const UC8 * const *bdata, const UL32 *bsize, int kf);
+  const jhcImg *Frame () const {return &ref;}
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  void dealloc ();
+
+  // parallel bands
+  static void enc_band (void *ctx, int band, int nb);
+  static void dec_band (void *ctx, int band, int nb);
+
+  // encoding
+  void enc_rows (int b);
+  int pick_mode (int y0, int y1) const;
+  int cost (int err) const;
+  UC8 *put_run (UC8 *out, int n) const;
+  UC8 *put_val (UC8 *out, int zz) const;
+
+  // decoding
+  void dec_rows (int b);
+
+  // prediction
+  int med (int a, int b, int c) const;
+
+
+};
+
+
+#endif  // once
+
+
+
+
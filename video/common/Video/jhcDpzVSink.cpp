@@ -0,0 +1,308 @@
+// jhcDpzVSink.cpp : saves 16 bit depth images with lossless compression
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "Interface/jms_x.h"
+#include "Video/jhcVidReg.h"
+
+#include "Video/jhcDpzVSink.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                        Register File Extensions                       //
+///////////////////////////////////////////////////////////////////////////
+
+JREG_VSINK(jhcDpzVSink, "dpz");
+
+
+///////////////////////////////////////////////////////////////////////////
+//                       Creation and Configuration                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcDpzVSink::~jhcDpzVSink ()
+{
+  iClose();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcDpzVSink::jhcDpzVSink (const char *fname)
+{
+  // no file yet opened and no index
+  out = NULL;
+  offs = NULL;
+  stamp = NULL;
+  rlen = NULL;
+  fmax = 0;
+  frames = 0;
+  fpos = 0;
+  raw = 0;
+  packed = 0;
+
+  // default characteristics (Kinect depth)
+  if (fname != NULL)
+    SetSink(fname);
+  SetSize(640, 480, 2);
+  SetSpeed(30.0);
+  SetCoding();
+}
+
+
+//= Get rid of frame index.
+
+void jhcDpzVSink::dealloc ()
+{
+  delete [] rlen;
+  delete [] stamp;
+  delete [] offs;
+  offs = NULL;
+  stamp = NULL;
+  rlen = NULL;
+  fmax = 0;
+}
+
+
+//= Set key frame interval and number of independently coded bands.
+// more bands allow more parallelism but cost a little compression
+// stream must be closed for this to take effect
+
+int jhcDpzVSink::SetCoding (int kf, int bands)
+{
+  if (bound == 1)
+    return 0;
+  if ((kf <= 0) || (kf > 0xFFFF) || (bands <= 0) || (bands > 0xFFFF))
+    return 0;
+  kint = kf;
+  nb = bands;
+  return 1;
+}
+
+
+//= Compression achieved so far (raw size over file size).
+
+double jhcDpzVSink::Ratio () const
+{
+  if (packed <= 0)
+    return 0.0;
+  return(raw / (double) packed);
+}
+
+
+//= Write file header (see jhcDpzVSrc) at current position.
+// index offset is zero until file is closed
+
+int jhcDpzVSink::write_hdr (__int64 ioff)
+{
+  UL32 fk = (UL32)(1000.0 * freq + 0.5);
+  int i;
+
+  // marker and version
+  fputc('D', out);
+  fputc('P', out);
+  fputc('Z', out);
+  fputc('1', out);
+
+  // 16 bit sizes and coding parameters
+  put32(w | (h << 16));
+  put32(zc.Bands() | (kint << 16));
+
+  // rate, frame count, and index location
+  put32(fk);
+  put32(frames);
+  put32((UL32)(ioff & 0xFFFFFFFF));
+  put32((UL32)(ioff >> 32));
+  for (i = 28; i < 64; i++)
+    fputc(0, out);
+  return((ferror(out) != 0) ? 0 : 1);
+}
+
+
+//= Write a 32 bit value in little-endian order.
+
+void jhcDpzVSink::put32 (UL32 v)
+{
+  fputc( v        & 0xFF, out);
+  fputc((v >>  8) & 0xFF, out);
+  fputc((v >> 16) & 0xFF, out);
+  fputc((v >> 24) & 0xFF, out);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                         Time Stamped Recording                        //
+///////////////////////////////////////////////////////////////////////////
+
+//= Save depth image along with the time (ms) it was acquired.
+// opens file with size of image if not already done
+// returns: 1 = successful, 0 = was good but just failed, -1 = bad stream
+
+int jhcDpzVSink::PutStamp (const jhcImg& src, UL32 tstamp)
+{
+  if (bound == 0)
+  {
+    SetSize(src);
+    Open();
+  }
+  if (ok < 0)
+    return -1;
+  if (!src.SameFormat(w, h, d))
+    return 0;
+  if (put_frame(src, tstamp) > 0)
+    return 1;
+  ok = 0;
+  return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                              Main Functions                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Append frame index then fill in header.
+
+void jhcDpzVSink::iClose ()
+{
+  __int64 ioff = fpos;
+  int i;
+
+  if (out == NULL)
+    return;
+  for (i = 0; i < frames; i++)
+  {
+    put32((UL32)(offs[i] & 0xFFFFFFFF));
+    put32((UL32)(offs[i] >> 32));
+    put32(stamp[i]);
+    put32(rlen[i]);
+  }
+  fseek(out, 0, SEEK_SET);
+  write_hdr(ioff);
+  fclose(out);
+  out = NULL;
+  dealloc();
+}
+
+
+//= Create file for specified image size and framerate.
+// only accepts 16 bit (2 field) images
+
+int jhcDpzVSink::iOpen ()
+{
+  if (d != 2)
+    return 0;
+  if (fopen_s(&out, FileName, "wb") != 0)
+  {
+    out = NULL;
+    return 0;
+  }
+  zc.SetSize(w, h, nb);
+  frames = 0;
+  raw = 0;
+  packed = 0;
+  if (write_hdr(0) <= 0)
+    return 0;
+  fpos = 64;
+  return 1;
+}
+
+
+//= Record next depth image using the current time.
+
+int jhcDpzVSink::iPut (const jhcImg& src)
+{
+  return put_frame(src, 0);
+}
+
+
+//= Compress image then append a complete frame record and note where it is.
+// uses current time if tstamp is zero
+// returns 1 if okay, 0 if write failed
+
+int jhcDpzVSink::put_frame (const jhcImg& src, UL32 tstamp)
+{
+  UL32 t = ((tstamp != 0) ? tstamp : jms_now());
+  int b, n, kf = (((frames % kint) == 0) ? 1 : 0), len = 12 + 4 * zc.Bands();
+
+  // code all bands (in parallel)
+  zc.Encode(src, kf);
+
+  // record header
+  fputc('D', out);
+  fputc('P', out);
+  fputc('Z', out);
+  fputc('F', out);
+  put32(t);
+  put32(kf);
+  for (b = 0; b < zc.Bands(); b++)
+    put32(zc.CodeSize(b));
+
+  // band codes
+  for (b = 0; b < zc.Bands(); b++)
+  {
+    n = zc.CodeSize(b);
+    fwrite(zc.Code(b), 1, n, out);
+    len += n;
+  }
+  if (ferror(out) != 0)
+    return 0;
+
+  // add to index
+  if (frames >= fmax)
+    grow();
+  offs[frames] = fpos;
+  stamp[frames] = t;
+  rlen[frames] = len;
+  fpos += len;
+  frames++;
+  raw += 2 * w * h;
+  packed += len;
+  return 1;
+}
+
+
+//= Double the size of the frame index.
+
+void jhcDpzVSink::grow ()
+{
+  __int64 *o2;
+  UL32 *s2;
+  int *r2;
+  int i, n = __max(1024, 2 * fmax);
+
+  o2 = new __int64 [n];
+  s2 = new UL32 [n];
+  r2 = new int [n];
+  for (i = 0; i < frames; i++)
+  {
+    o2[i] = offs[i];
+    s2[i] = stamp[i];
+    r2[i] = rlen[i];
+  }
+  dealloc();
+  offs = o2;
+  stamp = s2;
+  rlen = r2;
+  fmax = n;
+}
+
+
@@ -0,0 +1,104 @@
+// jhcDpzVSink.h : saves 16 bit depth images with lossless compression
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCDPZVSINK_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCDPZVSINK_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include <stdio.h>
+
+#include "Data/jhcImg.h"
+#include "Video/jhcDpzCodec.h"
+#include "Video/jhcVideoSink.h"
+
+
+//= Saves 16 bit depth images with lossless compression.
+// DPZ = DePth Zipped (see jhcDpzVSrc for header format)
+// each frame record is:
+//   DPZF  = record marker (ASCII)
+//   tttt  = time stamp in ms (unsigned long)
+//   ffff  = flags, bit 0 set for key frame (unsigned long)
+//   <S>   = code size for each band (unsigned long each)
+//   <B>   = code for each band (see jhcDpzCodec)
+// every "kint" frames is a key frame which needs no previous frame
+// index of record offsets, times, and lengths is appended by Close
+// bands are compressed in parallel so encoding is much faster than real time
+
+class jhcDpzVSink : public jhcVideoSink
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  jhcDpzCodec zc;
+  FILE *out;
+  __int64 *offs;
+  UL32 *stamp;
+  int *rlen;
+  __int64 fpos, raw, packed;
+  int kint, nb, frames, fmax;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and configuration
+  ~jhcDpzVSink ();
+  jhcDpzVSink (const char *fname =NULL);
+  int SetCoding (int kf =30, int bands =16);
+  int KeyRate () const {return kint;}
+  int Bands () const   {return nb;}
+  double Ratio () const;
+
+  // time stamped recording
+  int PutStamp (const jhcImg& src, UL32 tstamp);
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and configuration
+  void dealloc ();
+  int write_hdr (__int64 ioff);
+  void put32 (UL32 v);
+
+  // main functions
+  void iClose ();
+  int iOpen ();
+  int iPut (const jhcImg& src);
+  int put_frame (const jhcImg& src, UL32 tstamp);
+  void grow ();
+
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+
+// part of mechanism for automatically associating class with file extensions
+
+extern int jvreg_jhcDpzVSink;
+
+
+#endif  // once
+
+
+
+
@@ -0,0 +1,383 @@
+// jhcDpzVSrc.cpp : plays back losslessly compressed 16 bit depth recordings
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "Video/jhcDpzVSrc.h"
+
+
+//////////////////////////////////////////////////////////////////////////////
+//                        Register File Extensions                          //
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef JHC_GVID
+
+#include "Video/jhcVidReg.h"
+
+JREG_VSRC(jhcDpzVSrc, "dpz");
+
+#endif  // JHC_GVID
+
+
+///////////////////////////////////////////////////////////////////////////
+//                       Creation and Configuration                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcDpzVSrc::~jhcDpzVSrc ()
+{
+  delete [] rlen;
+  delete [] stamp;
+  delete [] offs;
+  delete [] bsz;
+  delete [] bdat;
+  mf.Close();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcDpzVSrc::jhcDpzVSrc (const char *name, int index)
+{
+  __int64 ioff;
+
+  // save details of source
+  strcpy_s(kind, "jhcDpzVSrc");
+  ParseName(name);
+  bdat = NULL;
+  bsz = NULL;
+  offs = NULL;
+  stamp = NULL;
+  rlen = NULL;
+  tnow = 0;
+  kint = 1;
+  nb = 0;
+  pos = 1;
+  last = 0;
+  lend = 0;
+
+  // try mapping file then get sizes and frame locations
+  if (mf.Open(FileName) <= 0)
+    return;
+  if (read_hdr(ioff) <= 0)
+    return;
+  if (read_index(ioff) <= 0)
+    if (scan_frames() <= 0)
+      return;
+
+  // set up decoder and view for Lend
+  zc.SetSize(w, h, nb);
+  view.SetSize(w, h, 2);
+  bdat = new const UC8 * [nb];
+  bsz = new UL32 [nb];
+  ok = 1;
+}
+
+
+//= Pull out video details from front of file.
+// format (all values little-endian):
+//   DPZ1  = type marker and version (ASCII)
+//   640   = image width (unsigned short)
+//   480   = image height (unsigned short)
+//   16    = number of independent bands (unsigned short)
+//   30    = key frame interval (unsigned short)
+//   30000 = frames per second (x1000 = unsigned long)
+//   nnnn  = total count of frames in file (unsigned long)
+//   iiii  = byte offset of frame index (64 bits, 0 if never closed)
+//   <pad> = zeroes out to 64 bytes
+// returns 0 if bad markings or unreasonable sizes
+
+int jhcDpzVSrc::read_hdr (__int64& ioff)
+{
+  const UC8 *hdr;
+
+  // check marker
+  if ((hdr = mf.Span(0, 64)) == NULL)
+    return 0;
+  if ((hdr[0] != 'D') || (hdr[1] != 'P') || (hdr[2] != 'Z') || (hdr[3] != '1'))
+    return 0;
+
+  // get image dimensions and coding
+  w    = hdr[4]  | (hdr[5] << 8);
+  h    = hdr[6]  | (hdr[7] << 8);
+  nb   = hdr[8]  | (hdr[9] << 8);
+  kint = hdr[10] | (hdr[11] << 8);
+  if ((w < 1) || (w > 20000) || (h < 1) || (h > 15000) || (nb < 1) || (nb > h) || (kint < 1))
+    return 0;
+  d = 2;
+
+  // get framerate, frame count, and index location
+  freq = 0.001 * le32(hdr + 12);
+  if ((freq < 0.0) || (freq > 1000.0))
+    return 0;
+  nframes = (int) le32(hdr + 16);
+  ioff = (__int64) le32(hdr + 20) | ((__int64) le32(hdr + 24) << 32);
+  aspect = 1.0;
+  return 1;
+}
+
+
+//= Load frame locations, times, and lengths from index at end of file.
+// each entry is 16 bytes: record offset (64 bits), time (ms), record length
+// returns 1 if okay, 0 if no index present
+
+int jhcDpzVSrc::read_index (__int64 ioff)
+{
+  const UC8 *e;
+  int i;
+
+  if ((ioff <= 0) || (nframes <= 0))
+    return 0;
+  if ((e = mf.Span(ioff, 16 * nframes)) == NULL)
+    return 0;
+  offs  = new __int64 [nframes];
+  stamp = new UL32 [nframes];
+  rlen  = new int [nframes];
+  for (i = 0; i < nframes; i++, e += 16)
+  {
+    offs[i]  = (__int64) le32(e) | ((__int64) le32(e + 4) << 32);
+    stamp[i] = le32(e + 8);
+    rlen[i]  = (int) le32(e + 12);
+  }
+  return 1;
+}
+
+
+//= Rebuild index by walking all complete frame records (e.g. if not closed).
+// returns number of frames found
+
+int jhcDpzVSrc::scan_frames ()
+{
+  const UC8 *r;
+  __int64 off = 64;
+  int len, n = 0, nmax = 1024;
+
+  offs  = new __int64 [nmax];
+  stamp = new UL32 [nmax];
+  rlen  = new int [nmax];
+  while (1)
+  {
+    // check for record header and band sizes
+    if ((r = mf.Span(off, 12 + 4 * nb)) == NULL)
+      break;
+    if ((len = rec_len(r, mf.Size() - off)) <= 0)
+      break;
+
+    // possibly enlarge index
+    if (n >= nmax)
+    {
+      __int64 *o2 = new __int64 [2 * nmax];
+      UL32 *s2 = new UL32 [2 * nmax];
+      int *r2 = new int [2 * nmax];
+
+      memcpy(o2, offs, nmax * sizeof(__int64));
+      memcpy(s2, stamp, nmax * sizeof(UL32));
+      memcpy(r2, rlen, nmax * sizeof(int));
+      delete [] rlen;
+      delete [] stamp;
+      delete [] offs;
+      offs = o2;
+      stamp = s2;
+      rlen = r2;
+      nmax *= 2;
+    }
+
+    // save record details
+    offs[n]  = off;
+    stamp[n] = le32(r + 4);
+    rlen[n]  = len;
+    off += len;
+    n++;
+  }
+  nframes = n;
+  return n;
+}
+
+
+//= Find total length of a frame record given its header and band sizes.
+// header and band sizes are only read if that many bytes are available
+// returns 0 if bad marker or record extends past available bytes
+
+int jhcDpzVSrc::rec_len (const UC8 *rec, __int64 avail) const
+{
+  const UC8 *s = rec + 12;
+  __int64 len = 12 + 4 * nb;
+  int b;
+
+  if (avail < len)
+    return 0;
+  if ((rec[0] != 'D') || (rec[1] != 'P') || (rec[2] != 'Z') || (rec[3] != 'F'))
+    return 0;
+  for (b = 0; b < nb; b++, s += 4)
+    len += le32(s);
+  if (len > avail)
+    return 0;
+  return((int) len);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Recorded Times                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Recorded time (ms) of some frame (numbered from 1).
+
+UL32 jhcDpzVSrc::FrameTime (int n) const
+{
+  if ((ok <= 0) || (n < 1) || (n > nframes))
+    return 0;
+  return stamp[n - 1];
+}
+
+
+//= Find last frame recorded at or before some time (ms).
+// assumes times increase through file (binary search)
+// returns 1 if time is before first frame, 0 if no frames
+
+int jhcDpzVSrc::FrameAt (UL32 ms) const
+{
+  int lo = 0, hi, mid;
+
+  if ((ok <= 0) || (nframes <= 0))
+    return 0;
+  hi = nframes - 1;
+  while (lo < hi)
+  {
+    mid = (lo + hi + 1) >> 1;
+    if ((int)(stamp[mid] - ms) <= 0)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return(lo + 1);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Zero-Copy Access                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get next frame as an image pointing at the internal decoded frame.
+// obeys frame selection, looping, and Increment exactly like Get
+// returned image must not be altered and is only valid until next Get or Lend
+// returns NULL if at end of selection or some error
+
+const jhcImg *jhcDpzVSrc::Lend (int block)
+{
+  int ans;
+
+  lend = 1;
+  ans = Get(view, 0, block);
+  lend = 0;
+  return((ans > 0) ? &view : NULL);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                           Core Functions                              //
+///////////////////////////////////////////////////////////////////////////
+
+//= Make some frame (numbered from 1) be the codec's current frame.
+// continues from last frame if possible, else starts at preceding key frame
+// returns 1 if okay, 0 for error
+
+int jhcDpzVSrc::decode (int n)
+{
+  int i, k = n - (n - 1) % kint;
+
+  if ((n < 1) || (n > nframes))
+    return 0;
+  if (n == last)
+    return 1;
+  if ((last >= k) && (last < n))
+    k = last + 1;
+  for (i = k; i <= n; i++)
+    if (unpack(i) <= 0)
+    {
+      last = 0;
+      return 0;
+    }
+  last = n;
+  return 1;
+}
+
+
+//= Decode a single frame record given that previous frame is in the codec.
+// returns 1 if okay, 0 for error
+
+int jhcDpzVSrc::unpack (int n)
+{
+  const UC8 *rec, *s, *p;
+  int b, i = n - 1;
+
+  if ((rec = mf.Span(offs[i], rlen[i])) == NULL)
+    return 0;
+  if (rec_len(rec, rlen[i]) != rlen[i])
+    return 0;
+
+  // find start of each band code
+  s = rec + 12;
+  p = s + 4 * nb;
+  for (b = 0; b < nb; b++, s += 4)
+  {
+    bsz[b] = le32(s);
+    bdat[b] = p;
+    p += bsz[b];
+  }
+  tnow = stamp[i];
+  return zc.Decode(bdat, bsz, le32(rec + 8) & 0x01);
+}
+
+
+//= Set up to read some particular frame next.
+// actual decoding is deferred until frame is requested
+
+int jhcDpzVSrc::iSeek (int number)
+{
+  if ((number < 1) || (number > nframes))
+    return 0;
+  pos = number;
+  return 1;
+}
+
+
+//= Get depth image by copying or pointing at decoded frame.
+// returns 1 if successful
+
+int jhcDpzVSrc::iGet (jhcImg& dest, int *advance, int src, int block)
+{
+  const jhcImg *f = zc.Frame();
+
+  if (src > 0)
+    return -1;
+  if (decode(pos) <= 0)
+    return 0;
+  if (lend > 0)
+    dest.Wrap((UC8 *) f->PxlSrc(), w, h, 2);
+  else
+    dest.CopyArr(*f);
+  pos += Increment;
+  return 1;
+}
+
+
@@ -0,0 +1,106 @@
+// jhcDpzVSrc.h : plays back losslessly compressed 16 bit depth recordings
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCDPZVSRC_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCDPZVSRC_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"
+#include "Interface/jhcMapFile.h"
+#include "Video/jhcDpzCodec.h"
+#include "Video/jhcVideoSrc.h"
+
+
+//= Plays back losslessly compressed 16 bit depth recordings (see jhcDpzVSink).
+// file is memory mapped and bands of each frame are decoded in parallel
+// seeking decodes forward from the nearest key frame, sequential reads
+// only decode one frame, Lend gives the decoded image without a copy
+// if recording was never closed the index is rebuilt by scanning records
+// TimeStamp gives recorded time of last frame, FrameAt finds frame for a time
+
+class jhcDpzVSrc : public jhcVideoSrc
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  jhcMapFile mf;
+  jhcDpzCodec zc;
+  jhcImg view;
+  const UC8 **bdat;
+  UL32 *bsz;
+  __int64 *offs;
+  UL32 *stamp;
+  int *rlen;
+  UL32 tnow;
+  int kint, nb, pos, last, lend;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and configuration
+  ~jhcDpzVSrc ();
+  jhcDpzVSrc (const char *name, int index =0);
+  int KeyRate () const {return kint;}
+
+  // recorded times
+  int TimeStamp () {return((int) tnow);}
+  UL32 FrameTime (int n) const;
+  int FrameAt (UL32 ms) const;
+
+  // zero-copy access
+  const jhcImg *Lend (int block =1);
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and configuration
+  int read_hdr (__int64& ioff);
+  int read_index (__int64 ioff);
+  int scan_frames ();
+  int rec_len (const UC8 *rec, __int64 avail) const;
+  UL32 le32 (const UC8 *p) const
+    {return(p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));}
+
+  // core functionality
+  int decode (int n);
+  int unpack (int n);
+  int iSeek (int number);
+  int iGet (jhcImg& dest, int *advance, int src, int block);
+
+
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+
+// part of mechanism for automatically associating class with file extensions
+
+extern int jvreg_jhcDpzVSrc;
+
+
+#endif  // once
+
+
+
+
@@ -0,0 +1,334 @@
+// jhcMbiVSink.cpp : saves color, depth, and aux data as an indexed recording
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include "Interface/jms_x.h"
+#include "Video/jhcVidReg.h"
+
+#include "Video/jhcMbiVSink.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                        Register File Extensions                       //
+///////////////////////////////////////////////////////////////////////////
+
+JREG_VSINK(jhcMbiVSink, "mbi");
+
+
+///////////////////////////////////////////////////////////////////////////
+//                       Creation and Configuration                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcMbiVSink::~jhcMbiVSink ()
+{
+  iClose();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcMbiVSink::jhcMbiVSink (const char *fname)
+{
+  // no file yet opened and no index
+  out = NULL;
+  offs = NULL;
+  stamp = NULL;
+  alen = NULL;
+  fmax = 0;
+  frames = 0;
+  fpos = 0;
+  bsize = 0;
+  bsize2 = 0;
+
+  // default characteristics (no depth)
+  if (fname != NULL)
+    SetSink(fname);
+  SetSize(320, 240, 3);
+  w2 = 0;
+  h2 = 0;
+  d2 = 0;
+  SetSpeed(30.0);
+}
+
+
+//= Get rid of frame index.
+
+void jhcMbiVSink::dealloc ()
+{
+  delete [] alen;
+  delete [] stamp;
+  delete [] offs;
+  offs = NULL;
+  stamp = NULL;
+  alen = NULL;
+  fmax = 0;
+}
+
+
+//= Set size of secondary (depth) stream, f = 0 for none.
+// stream must be closed for this to take effect
+
+int jhcMbiVSink::SetSize2 (int x, int y, int f)
+{
+  if (bound == 1)
+    return 0;
+  if ((f < 0) || (f > 8) || ((f > 0) && ((x <= 0) || (y <= 0))))
+    return 0;
+  w2 = ((f > 0) ? x : 0);
+  h2 = ((f > 0) ? y : 0);
+  d2 = f;
+  return 1;
+}
+
+
+//= Write file header (see jhcMbiVSrc) at current position.
+// index offset is zero until file is closed
+
+int jhcMbiVSink::write_hdr (__int64 ioff)
+{
+  UL32 fk = (UL32)(1000.0 * freq + 0.5);
+
+  // marker and version
+  fputc('M', out);
+  fputc('B', out);
+  fputc('I', out);
+  fputc('1', out);
+
+  // 16 bit sizes of both streams
+  put32(w | (h << 16));
+  put32(d | (w2 << 16));
+  put32(h2 | (d2 << 16));
+
+  // rate, frame count, and index location
+  put32(fk);
+  put32(frames);
+  put32((UL32)(ioff & 0xFFFFFFFF));
+  put32((UL32)(ioff >> 32));
+  pad16(32);
+  return((ferror(out) != 0) ? 0 : 1);
+}
+
+
+//= Write a 32 bit value in little-endian order.
+
+void jhcMbiVSink::put32 (UL32 v)
+{
+  fputc( v        & 0xFF, out);
+  fputc((v >>  8) & 0xFF, out);
+  fputc((v >> 16) & 0xFF, out);
+  fputc((v >> 24) & 0xFF, out);
+}
+
+
+//= Write some number of zero bytes.
+
+void jhcMbiVSink::pad16 (int n)
+{
+  static const UC8 zero[256] = {0};
+  int i, chunk;
+
+  for (i = n; i > 0; i -= chunk)
+  {
+    chunk = __min(i, 256);
+    fwrite(zero, 1, chunk, out);
+  }
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                         Multi-Stream Recording                        //
+///////////////////////////////////////////////////////////////////////////
+
+//= Save color and depth images plus optional aux data for one frame.
+// opens file with sizes of these images if not already done
+// uses current time if tstamp is zero
+// returns: 1 = successful, 0 = was good but just failed, -1 = bad stream
+
+int jhcMbiVSink::PutDual (const jhcImg& src, const jhcImg& src2, UL32 tstamp, const UC8 *aux, int naux)
+{
+  if (bound == 0)
+  {
+    SetSize(src);
+    SetSize2(src2);
+    Open();
+  }
+  if (ok < 0)
+    return -1;
+  if (!src.SameFormat(w, h, d) || !src2.SameFormat(w2, h2, d2))
+    return 0;
+  if (put_frame(src, &src2, tstamp, aux, naux) > 0)
+    return 1;
+  ok = 0;
+  return 0;
+}
+
+
+//= Save color image plus optional aux data for one frame.
+// depth stream (if any) is recorded as all zero
+// returns: 1 = successful, 0 = was good but just failed, -1 = bad stream
+
+int jhcMbiVSink::PutAux (const jhcImg& src, UL32 tstamp, const UC8 *aux, int naux)
+{
+  if (bound == 0)
+  {
+    SetSize(src);
+    Open();
+  }
+  if (ok < 0)
+    return -1;
+  if (!src.SameFormat(w, h, d))
+    return 0;
+  if (put_frame(src, NULL, tstamp, aux, naux) > 0)
+    return 1;
+  ok = 0;
+  return 0;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                              Main Functions                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Append frame index then fill in header.
+
+void jhcMbiVSink::iClose ()
+{
+  __int64 ioff = fpos;
+  int i;
+
+  if (out == NULL)
+    return;
+  for (i = 0; i < frames; i++)
+  {
+    put32((UL32)(offs[i] & 0xFFFFFFFF));
+    put32((UL32)(offs[i] >> 32));
+    put32(stamp[i]);
+    put32(alen[i]);
+  }
+  fseek(out, 0, SEEK_SET);
+  write_hdr(ioff);
+  fclose(out);
+  out = NULL;
+  dealloc();
+}
+
+
+//= Create file for specified image sizes and framerate.
+
+int jhcMbiVSink::iOpen ()
+{
+  if (fopen_s(&out, FileName, "wb") != 0)
+  {
+    out = NULL;
+    return 0;
+  }
+  frames = 0;
+  bsize = h * ((w * d + 3) & 0xFFFC);
+  bsize2 = ((d2 > 0) ? h2 * ((w2 * d2 + 3) & 0xFFFC) : 0);
+  if (write_hdr(0) <= 0)
+    return 0;
+  fpos = 64;
+  return 1;
+}
+
+
+//= Record color image (and blank depth) for next frame.
+
+int jhcMbiVSink::iPut (const jhcImg& src)
+{
+  return put_frame(src, NULL, 0, NULL, 0);
+}
+
+
+//= Append a complete frame record and note where it is.
+// returns 1 if okay, 0 if write failed
+
+int jhcMbiVSink::put_frame (const jhcImg& src, const jhcImg *src2, UL32 tstamp, const UC8 *aux, int naux)
+{
+  UL32 t = ((tstamp != 0) ? tstamp : jms_now());
+  int n = (((aux != NULL) && (naux > 0)) ? naux : 0);
+  int p = (bsize + 15) & ~15, p2 = (bsize2 + 15) & ~15, pa = (n + 15) & ~15;
+
+  // record header
+  fputc('M', out);
+  fputc('B', out);
+  fputc('I', out);
+  fputc('F', out);
+  put32(t);
+  put32(n);
+  put32(frames + 1);
+
+  // image data and aux bytes (all padded)
+  fwrite(src.PxlSrc(), 1, bsize, out);
+  pad16(p - bsize);
+  if ((bsize2 > 0) && (src2 != NULL))
+  {
+    fwrite(src2->PxlSrc(), 1, bsize2, out);
+    pad16(p2 - bsize2);
+  }
+  else
+    pad16(p2);
+  if (n > 0)
+    fwrite(aux, 1, n, out);
+  pad16(pa - n);
+  if (ferror(out) != 0)
+    return 0;
+
+  // add to index
+  if (frames >= fmax)
+    grow();
+  offs[frames] = fpos;
+  stamp[frames] = t;
+  alen[frames] = n;
+  fpos += 16 + p + p2 + pa;
+  frames++;
+  return 1;
+}
+
+
+//= Double the size of the frame index.
+
+void jhcMbiVSink::grow ()
+{
+  __int64 *o2;
+  UL32 *s2;
+  int *a2;
+  int i, n = __max(1024, 2 * fmax);
+
+  o2 = new __int64 [n];
+  s2 = new UL32 [n];
+  a2 = new int [n];
+  for (i = 0; i < frames; i++)
+  {
+    o2[i] = offs[i];
+    s2[i] = stamp[i];
+    a2[i] = alen[i];
+  }
+  dealloc();
+  offs = o2;
+  stamp = s2;
+  alen = a2;
+  fmax = n;
+}
+
+
@@ -0,0 +1,107 @@
+// jhcMbiVSink.h : saves color, depth, and aux data as an indexed recording
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCMBIVSINK_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCMBIVSINK_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include <stdio.h>
+
+#include "Data/jhcImg.h"
+#include "Video/jhcVideoSink.h"
+
+
+//= Saves color, depth, and aux data as an indexed recording.
+// MBI = Motion BitMap Indexed (see jhcMbiVSrc for header format)
+// each frame record is:
+//   MBIF  = record marker (ASCII)
+//   tttt  = time stamp in ms (unsigned long)
+//   aaaa  = number of aux data bytes (unsigned long)
+//   nnnn  = frame number starting at 1 (unsigned long)
+//   <C>   = color image (lines padded to 4 bytes, block padded to 16)
+//   <D>   = depth image if any (same padding)
+//   <A>   = aux data bytes if any (padded to 16)
+// index of record offsets, times, and aux sizes is appended by Close
+// frames are found by scanning records if file was never closed
+// depth stream must be set up with SetSize2 before opening (else just color)
+
+class jhcMbiVSink : public jhcVideoSink
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  FILE *out;
+  __int64 *offs;
+  UL32 *stamp;
+  int *alen;
+  __int64 fpos;
+  int w2, h2, d2, bsize, bsize2, frames, fmax;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and configuration
+  ~jhcMbiVSink ();
+  jhcMbiVSink (const char *fname =NULL);
+  int SetSize2 (int x, int y, int f =2);
+  int SetSize2 (const jhcImg& ref) {return SetSize2(ref.XDim(), ref.YDim(), ref.Fields());}
+  int XDim2 () const   {return w2;}
+  int YDim2 () const   {return h2;}
+  int Fields2 () const {return d2;}
+
+  // multi-stream recording
+  int PutDual (const jhcImg& src, const jhcImg& src2, UL32 tstamp =0, const UC8 *aux =NULL, int naux =0);
+  int PutAux (const jhcImg& src, UL32 tstamp, const UC8 *aux =NULL, int naux =0);
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and configuration
+  void dealloc ();
+  int write_hdr (__int64 ioff);
+  void put32 (UL32 v);
+  void pad16 (int n);
+
+  // main functions
+  void iClose ();
+  int iOpen ();
+  int iPut (const jhcImg& src);
+  int put_frame (const jhcImg& src, const jhcImg *src2, UL32 tstamp, const UC8 *aux, int naux);
+  void grow ();
+
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+
+// part of mechanism for automatically associating class with file extensions
+
+extern int jvreg_jhcMbiVSink;
+
+
+#endif  // once
+
+
+
+
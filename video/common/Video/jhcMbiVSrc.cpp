@@ -0,0 +1,399 @@
+// jhcMbiVSrc.cpp : plays back indexed multi-stream bitmap recordings
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+
+#include "Interface/jhcMessage.h"
+
+#include "Video/jhcMbiVSrc.h"
+
+
+//////////////////////////////////////////////////////////////////////////////
+//                        Register File Extensions                          //
+//////////////////////////////////////////////////////////////////////////////
+
+#ifdef JHC_GVID
+
+#include "Video/jhcVidReg.h"
+
+JREG_VSRC(jhcMbiVSrc, "mbi");
+
+#endif  // JHC_GVID
+
+
+///////////////////////////////////////////////////////////////////////////
+//                       Creation and Configuration                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+
+jhcMbiVSrc::~jhcMbiVSrc ()
+{
+  delete [] alen;
+  delete [] stamp;
+  delete [] offs;
+  mf.Close();
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcMbiVSrc::jhcMbiVSrc (const char *name, int index)
+{
+  __int64 ioff;
+
+  // save details of source
+  strcpy_s(kind, "jhcMbiVSrc");
+  ParseName(name);
+  offs = NULL;
+  stamp = NULL;
+  alen = NULL;
+  tnow = 0;
+  bsize = 0;
+  bsize2 = 0;
+  pos = 1;
+  lend = 0;
+
+  // try mapping file then get sizes and frame locations
+  if (mf.Open(FileName) <= 0)
+    return;
+  if (read_hdr(ioff) <= 0)
+    return;
+  if (read_index(ioff) <= 0)
+    if (scan_frames() <= 0)
+      return;
+
+  // make views for Lend
+  view.SetSize(w, h, d);
+  if (d2 > 0)
+    view2.SetSize(w2, h2, d2);
+  ok = 1;
+}
+
+
+//= Pull out video details from front of file.
+// format (all values little-endian):
+//   MBI1  = type marker and version (ASCII)
+//   640   = color width (unsigned short)
+//   480   = color height (unsigned short)
+//   3     = color bytes per pixel (unsigned short)
+//   640   = depth width (unsigned short, 0 if none)
+//   480   = depth height (unsigned short)
+//   2     = depth bytes per pixel (unsigned short, 0 if none)
+//   30000 = frames per second (x1000 = unsigned long)
+//   nnnn  = total count of frames in file (unsigned long)
+//   iiii  = byte offset of frame index (64 bits, 0 if never closed)
+//   <pad> = zeroes out to 64 bytes
+// returns 0 if bad markings or unreasonable sizes
+
+int jhcMbiVSrc::read_hdr (__int64& ioff)
+{
+  const UC8 *hdr;
+
+  // check marker
+  if ((hdr = mf.Span(0, 64)) == NULL)
+    return 0;
+  if ((hdr[0] != 'M') || (hdr[1] != 'B') || (hdr[2] != 'I') || (hdr[3] != '1'))
+    return 0;
+
+  // get image dimensions
+  w  = hdr[4]  | (hdr[5] << 8);
+  h  = hdr[6]  | (hdr[7] << 8);
+  d  = hdr[8]  | (hdr[9] << 8);
+  w2 = hdr[10] | (hdr[11] << 8);
+  h2 = hdr[12] | (hdr[13] << 8);
+  d2 = hdr[14] | (hdr[15] << 8);
+  if ((w < 1) || (w > 20000) || (h < 1) || (h > 15000) || (d < 1) || (d > 8))
+    return 0;
+  if ((d2 < 0) || (d2 > 8) || ((d2 > 0) && ((w2 < 1) || (w2 > 20000) || (h2 < 1) || (h2 > 15000))))
+    return 0;
+
+  // get framerate, frame count, and index location
+  freq = 0.001 * le32(hdr + 16);
+  if ((freq < 0.0) || (freq > 1000.0))
+    return 0;
+  nframes = (int) le32(hdr + 20);
+  ioff = (__int64) le32(hdr + 24) | ((__int64) le32(hdr + 28) << 32);
+
+  // success
+  bsize = h * ((w * d + 3) & 0xFFFC);
+  bsize2 = ((d2 > 0) ? h2 * ((w2 * d2 + 3) & 0xFFFC) : 0);
+  aspect = 1.0;
+  aspect2 = 1.0;
+  return 1;
+}
+
+
+//= Load frame locations, times, and aux sizes from index at end of file.
+// each entry is 16 bytes: record offset (64 bits), time (ms), aux byte count
+// returns 1 if okay, 0 if no index present or some entry is corrupt
+
+int jhcMbiVSrc::read_index (__int64 ioff)
+{
+  const UC8 *e;
+  int i;
+
+  if ((ioff <= 0) || (nframes <= 0))
+    return 0;
+  if ((e = mf.Span(ioff, 16 * nframes)) == NULL)
+    return 0;
+  offs  = new __int64 [nframes];
+  stamp = new UL32 [nframes];
+  alen  = new int [nframes];
+  for (i = 0; i < nframes; i++, e += 16)
+  {
+    offs[i]  = (__int64) le32(e) | ((__int64) le32(e + 4) << 32);
+    stamp[i] = le32(e + 8);
+    alen[i]  = (int) le32(e + 12);
+    if ((alen[i] < 0) || (offs[i] < 64) || (offs[i] + alen[i] > mf.Size()) ||
+        ((offs[i] + rec_size(alen[i])) > mf.Size()))
+      break;
+  }
+
+  // fall back to scanning records if any entry is corrupt
+  if (i < nframes)
+  {
+    delete [] alen;
+    delete [] stamp;
+    delete [] offs;
+    alen = NULL;
+    stamp = NULL;
+    offs = NULL;
+    return 0;
+  }
+  return 1;
+}
+
+
+//= Rebuild index by walking all complete frame records (e.g. if not closed).
+// returns number of frames found
+
+int jhcMbiVSrc::scan_frames ()
+{
+  const UC8 *r;
+  __int64 off = 64;
+  int n = 0, nmax = (int)((mf.Size() - 64) / rec_size(0));
+
+  if (nmax <= 0)
+    return 0;
+  offs  = new __int64 [nmax];
+  stamp = new UL32 [nmax];
+  alen  = new int [nmax];
+  while (n < nmax)
+  {
+    // check for record header
+    if ((r = mf.Span(off, 16)) == NULL)
+      break;
+    if ((r[0] != 'M') || (r[1] != 'B') || (r[2] != 'I') || (r[3] != 'F'))
+      break;
+
+    // make sure whole record is present
+    offs[n]  = off;
+    stamp[n] = le32(r + 4);
+    alen[n]  = (int) le32(r + 8);
+    if ((alen[n] < 0) || (alen[n] > (mf.Size() - off)))
+      break;
+    off += rec_size(alen[n]);
+    if (off > mf.Size())
+      break;
+    n++;
+  }
+  nframes = n;
+  return n;
+}
+
+
+//= Total size of a frame record with some amount of aux data.
+// 16 byte header then color, depth, and aux each padded to 16 bytes
+
+int jhcMbiVSrc::rec_size (int n) const
+{
+  return(16 + ((bsize + 15) & ~15) + ((bsize2 + 15) & ~15) + ((n + 15) & ~15));
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Recorded Times                            //
+///////////////////////////////////////////////////////////////////////////
+
+//= Recorded time (ms) of some frame (numbered from 1).
+
+UL32 jhcMbiVSrc::FrameTime (int n) const
+{
+  if ((ok <= 0) || (n < 1) || (n > nframes))
+    return 0;
+  return stamp[n - 1];
+}
+
+
+//= Find last frame recorded at or before some time (ms).
+// assumes times increase through file (binary search)
+// returns 1 if time is before first frame, 0 if no frames
+
+int jhcMbiVSrc::FrameAt (UL32 ms) const
+{
+  int lo = 0, hi, mid;
+
+  if ((ok <= 0) || (nframes <= 0))
+    return 0;
+  hi = nframes - 1;
+  while (lo < hi)
+  {
+    mid = (lo + hi + 1) >> 1;
+    if ((int)(stamp[mid] - ms) <= 0)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+  return(lo + 1);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Zero-Copy Access                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get next frame (src = 1 for depth) as an image pointing into the file mapping.
+// obeys frame selection, looping, and Increment exactly like Get
+// returned image must not be altered and is only valid until next Get or Lend
+// returns NULL if at end of selection or some error
+
+const jhcImg *jhcMbiVSrc::Lend (int src, int block)
+{
+  jhcImg *v = ((src > 0) ? &view2 : &view);
+  int ans;
+
+  if ((src > 0) && (d2 <= 0))
+    return NULL;
+  lend = 1;
+  ans = Get(*v, src, block);
+  lend = 0;
+  return((ans > 0) ? v : NULL);
+}
+
+
+//= Get next pair of frames (color and depth) pointing into the file mapping.
+// returns result of DualGet, pointers are set to NULL if nothing read
+
+int jhcMbiVSrc::LendDual (const jhcImg **f, const jhcImg **f2)
+{
+  int ans;
+
+  if ((f == NULL) || (f2 == NULL) || (d2 <= 0))
+    return Fatal("Bad input to jhcMbiVSrc::LendDual");
+  *f = NULL;
+  *f2 = NULL;
+  lend = 1;
+  ans = DualGet(view, view2);
+  lend = 0;
+  if (ans > 0)
+  {
+    *f = &view;
+    *f2 = &view2;
+  }
+  return ans;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                           Core Functions                              //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get pointer to complete record for some frame (numbered from 1).
+// also binds aux data and time stamp for this frame
+
+const UC8 *jhcMbiVSrc::record (int n)
+{
+  const UC8 *rec;
+  int i = n - 1;
+
+  if ((n < 1) || (n > nframes))
+    return NULL;
+  if ((rec = mf.Span(offs[i], rec_size(alen[i]))) == NULL)
+    return NULL;
+  naux = alen[i];
+  daux = ((naux > 0) ? (UC8 *)(rec + 16 + ((bsize + 15) & ~15) + ((bsize2 + 15) & ~15)) : NULL);
+  tnow = stamp[i];
+  return rec;
+}
+
+
+//= Set up to read some particular frame next (constant time).
+
+int jhcMbiVSrc::iSeek (int number)
+{
+  if ((number < 1) || (number > nframes))
+    return 0;
+  pos = number;
+  return 1;
+}
+
+
+//= Get color (src = 0) or depth (src = 1) image by copying or pointing at it.
+// returns 1 + number of aux bytes if successful
+
+int jhcMbiVSrc::iGet (jhcImg& dest, int *advance, int src, int block)
+{
+  const UC8 *rec;
+
+  if ((src > 0) && (d2 <= 0))
+    return -1;
+  if ((rec = record(pos)) == NULL)
+    return 0;
+  rec += 16;
+  if (src > 0)
+    rec += (bsize + 15) & ~15;
+  if (lend > 0)
+    dest.Wrap((UC8 *) rec, ((src > 0) ? w2 : w), ((src > 0) ? h2 : h), ((src > 0) ? d2 : d));
+  else
+    dest.CopyArr(rec);
+  pos += Increment;
+  return(naux + 1);
+}
+
+
+//= Get color and depth images for the same frame.
+// only called if file has depth, returns 2 for both images
+
+int jhcMbiVSrc::iDual (jhcImg& dest, jhcImg& dest2)
+{
+  const UC8 *rec, *rec2;
+
+  if ((rec = record(pos)) == NULL)
+    return 0;
+  rec += 16;
+  rec2 = rec + ((bsize + 15) & ~15);
+  if (lend > 0)
+  {
+    dest.Wrap((UC8 *) rec, w, h, d);
+    dest2.Wrap((UC8 *) rec2, w2, h2, d2);
+  }
+  else
+  {
+    dest.CopyArr(rec);
+    dest2.CopyArr(rec2);
+  }
+  pos += Increment;
+  return 2;
+}
+
+
@@ -0,0 +1,102 @@
+// jhcMbiVSrc.h : plays back indexed multi-stream bitmap recordings
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCMBIVSRC_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCMBIVSRC_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"
+#include "Interface/jhcMapFile.h"
+#include "Video/jhcVideoSrc.h"
+
+
+//= Plays back indexed multi-stream bitmap recordings (see jhcMbiVSink).
+// MBI = Motion BitMap Indexed, holds color, optional depth, and aux data
+// file is memory mapped and frame index is read once so any frame can be
+// reached in constant time, Lend and LendDual give images in place
+// if recording was never closed the index is rebuilt by scanning records
+// TimeStamp gives recorded time of last frame, FrameAt finds frame for a time
+
+class jhcMbiVSrc : public jhcVideoSrc
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  jhcMapFile mf;
+  jhcImg view, view2;
+  __int64 *offs;
+  UL32 *stamp;
+  int *alen;
+  UL32 tnow;
+  int bsize, bsize2, pos, lend;
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and configuration
+  ~jhcMbiVSrc ();
+  jhcMbiVSrc (const char *name, int index =0);
+
+  // recorded times
+  int TimeStamp () {return((int) tnow);}
+  UL32 FrameTime (int n) const;
+  int FrameAt (UL32 ms) const;
+
+  // zero-copy access
+  const jhcImg *Lend (int src =0, int block =1);
+  int LendDual (const jhcImg **f, const jhcImg **f2);
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and configuration
+  int read_hdr (__int64& ioff);
+  int read_index (__int64 ioff);
+  int scan_frames ();
+  int rec_size (int n) const;
+  UL32 le32 (const UC8 *p) const
+    {return(p[0] | (p[1] << 8) | (p[2] << 16) | (p[3] << 24));}
+
+  // core functionality
+  const UC8 *record (int n);
+  int iSeek (int number);
+  int iGet (jhcImg& dest, int *advance, int src, int block);
+  int iDual (jhcImg& dest, jhcImg& dest2);
+
+
+};
+
+
+/////////////////////////////////////////////////////////////////////////////
+
+// part of mechanism for automatically associating class with file extensions
+
+extern int jvreg_jhcMbiVSrc;
+
+
+#endif  // once
+
+
+
+
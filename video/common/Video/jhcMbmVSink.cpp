@@ -76,6 +76,7 @@ void jhcMbmVSink::iClose ()
   fputc((frames >> 16) & 0xFF, out);
   fputc((frames >> 24) & 0xFF, out);
   fclose(out);
+  out = NULL;
 }               
 
 
@@ -141,7 +142,7 @@ int jhcMbmVSink::write_hdr (FILE *dest)
 
 //= Record next image into file. 
 
-int jhcMbmVSink::iPut (jhcImg& src)
+int jhcMbmVSink::iPut (const jhcImg& src)
 {
   if (fwrite(src.PxlSrc(), 1, bsize, out) != (size_t) bsize)
     return 0;
@@ -65,7 +65,7 @@ public:
 private:
   void iClose ();             
   int iOpen ();               
-  int iPut (jhcImg& src);     
+  int iPut (const jhcImg& src);
 
   int write_hdr (FILE *dest);
 
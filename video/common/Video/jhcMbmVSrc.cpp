@@ -21,9 +21,8 @@
 ///////////////////////////////////////////////////////////////////////////
 
 #include <string.h>
-#include <io.h>
 
-#include "jhcMbmVSrc.h"
+#include "Video/jhcMbmVSrc.h"
 
 
 //////////////////////////////////////////////////////////////////////////////
@@ -48,14 +47,18 @@ JREG_VSRC(jhcMbmVSrc, "mbm");
 jhcMbmVSrc::jhcMbmVSrc (const char *name, int index)
 {
   // save details of source
-  strcpy(kind, "jhcMbmVSrc");
+  strcpy_s(kind, "jhcMbmVSrc");
   ParseName(name);
+  bsize = 0;
+  pos = 1;
+  lend = 0;
 
-  // try opening file and finding image size
-  if ((in = fopen(FileName, "rb")) == NULL)
+  // try mapping file and finding image size
+  if (mf.Open(FileName) <= 0)
     return;
-  if (read_hdr(in) <= 0)
+  if (read_hdr() <= 0)
     return;
+  view.SetSize(w, h, d);
   ok = 1;
 }
 
@@ -64,13 +67,11 @@ jhcMbmVSrc::jhcMbmVSrc (const char *name, int index)
 
 jhcMbmVSrc::~jhcMbmVSrc ()
 {
-  if (in != NULL)
-    fclose(in);
+  mf.Close();
 }
 
 
-//= Pull out video details from front of file (assumes rewound).
-// leaves file pointer at start of first frame's data
+//= Pull out video details from front of file.
 // format:
 //   MBM   = type marker (ASCII)
 //   3     = three bytes per pixel (ASCII)
@@ -82,58 +83,71 @@ jhcMbmVSrc::~jhcMbmVSrc ()
 //   <D2>  = second frame data (same fixed size)
 //   ...   = rest of frames
 // all lines are padded to multiples of 4 bytes (e.g. 750 * 3 -> 2252)
+// frame count is limited to what is actually in file (e.g. if never closed)
 // returns 0 if bad markings or unreasonable sizes
 
-int jhcMbmVSrc::read_hdr (FILE *src)
+int jhcMbmVSrc::read_hdr ()
 {
-  char ch;
+  const UC8 *hdr;
   UL32 fk;
+  int avail;
 
-  // read first three letters (ascii)
-  if (getc(in) != 'M')
+  // check first three letters (ascii)
+  if ((hdr = mf.Span(0, 16)) == NULL)
     return 0;
-  if (getc(in) != 'B')
-    return 0;
-  if (getc(in) != 'M')
+  if ((hdr[0] != 'M') || (hdr[1] != 'B') || (hdr[2] != 'M'))
     return 0;
 
   // get number of bytes per pixel (ascii)
-  if ((ch = fgetc(src)) == EOF)
-    return 0;
-  d = (int)(ch - '0');
+  d = (int)(hdr[3] - '0');
   if ((d < 1) || (d > 8))
     return 0;
 
   // get image dimensions (assumes little-endian)
-  w =   getc(in);
-  w |= (getc(in) << 8);
-  h =   getc(in);
-  h |= (getc(in) << 8);
+  w = hdr[4] | (hdr[5] << 8);
+  h = hdr[6] | (hdr[7] << 8);
   if ((w < 1) || (w > 20000) || (h < 1) || (h > 15000))
     return 0;
 
   // get framerate (x1000 little-endian)
-  fk =   getc(in);
-  fk |= (getc(in) << 8);
-  fk |= (getc(in) << 16);
-  fk |= (getc(in) << 24);
+  fk = hdr[8] | (hdr[9] << 8) | (hdr[10] << 16) | (hdr[11] << 24);
   freq = 0.001 * fk;
   if ((freq < 0.0) || (freq > 1000.0))
     return 0;
 
   // determine total number of frames (little-endian)
-  nframes =   getc(in);
-  nframes |= (getc(in) << 8);
-  nframes |= (getc(in) << 16);
-  nframes |= (getc(in) << 24);
+  nframes = hdr[12] | (hdr[13] << 8) | (hdr[14] << 16) | (hdr[15] << 24);
+  bsize = h * ((w * d + 3) & 0xFFFC);
+  avail = (int)((mf.Size() - 16) / bsize);
+  if ((nframes <= 0) || (nframes > avail))
+    nframes = avail;
 
   // success
   aspect = 1.0;
-  bsize = h * ((w * d + 3) & 0xFFFC);
   return 1;
 }
 
 
+///////////////////////////////////////////////////////////////////////////
+//                            Zero-Copy Access                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get next frame as an image pointing directly into the file mapping.
+// obeys frame selection, looping, and Increment exactly like Get
+// returned image must not be altered and is only valid until next Get or Lend
+// returns NULL if at end of selection or some error
+
+const jhcImg *jhcMbmVSrc::Lend (int block)
+{
+  int ans;
+
+  lend = 1;
+  ans = Get(view, 0, block);
+  lend = 0;
+  return((ans > 0) ? &view : NULL);
+}
+
+
 ///////////////////////////////////////////////////////////////////////////
 //                              Main Functions                           //
 ///////////////////////////////////////////////////////////////////////////
@@ -142,21 +156,27 @@ int jhcMbmVSrc::read_hdr (FILE *src)
 
 int jhcMbmVSrc::iSeek (int number)
 {
-  if (_lseeki64(_fileno(in), ((number - 1) * (__int64) bsize) + 16, SEEK_SET) < 0)
+  if ((number < 1) || (number > nframes))
     return 0;
-  fflush(in);
+  pos = number;
   return 1;
 }
 
 
-//= Read next frame from long file.
+//= Get frame from long file either by copying or by pointing at it.
 
-int jhcMbmVSrc::iGet (jhcImg &dest, int *advance, int src)
+int jhcMbmVSrc::iGet (jhcImg& dest, int *advance, int src, int block)
 {
-  if (fread(dest.PxlDest(), 1, bsize, in) != (size_t) bsize)
+  const UC8 *pix;
+
+  if ((pix = mf.Span(16 + (pos - 1) * (__int64) bsize, bsize)) == NULL)
     return 0;
+  if (lend > 0)
+    dest.Wrap((UC8 *) pix, w, h, d);
+  else
+    dest.CopyArr(pix);
+  pos += Increment;
   return 1; 
 }
 
 
-
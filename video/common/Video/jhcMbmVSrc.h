@@ -27,8 +27,8 @@
 
 #include "jhcGlobal.h"
 
-#include <stdio.h>
-
+#include "Data/jhcImg.h"
+#include "Interface/jhcMapFile.h"
 #include "Video/jhcVideoSrc.h"
 
 
@@ -45,13 +45,15 @@
 //   <D2>  = second frame data (same fixed size)
 //   ...   = rest of frames
 // all lines are padded to multiples of 4 bytes (e.g. 750 * 3 -> 2252)
+// file is memory mapped so frames can be handed out in place by Lend
 
 class jhcMbmVSrc : public jhcVideoSrc
 {
 // PRIVATE MEMBER VARIABLES
 private:
-  FILE *in;
-  int bsize;
+  jhcMapFile mf;
+  jhcImg view;
+  int bsize, pos, lend;
 
 
 // PUBLIC MEMBER FUNCTIONS
@@ -59,14 +61,17 @@ public:
   // creation and configuration
   jhcMbmVSrc (const char *name, int index =0);
   ~jhcMbmVSrc ();
+
+  // zero-copy access
+  const jhcImg *Lend (int block =1);
  
 
 // PRIVATE MEMBER FUNCTIONS
 private:
-  int read_hdr (FILE *src);
+  int read_hdr ();
 
   int iSeek (int number);
-  int iGet (jhcImg &dest, int *advance, int src); 
+  int iGet (jhcImg& dest, int *advance, int src, int block); 
 
 };
 
@@ -0,0 +1,681 @@
+// jhcPrefVSrc.cpp : reads frames from any video source ahead of time in background
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#include <windows.h>
+#include <process.h>
+#include <string.h>
+
+#include "Interface/jhcMessage.h"
+
+#include "Video/jhcPrefVSrc.h"
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Creation and Initialization                      //
+///////////////////////////////////////////////////////////////////////////
+
+//= Default destructor does necessary cleanup.
+// must stop reader here since base class destructor cannot
+
+jhcPrefVSrc::~jhcPrefVSrc ()
+{
+  stop(0);
+  dealloc();
+  DeleteCriticalSection((CRITICAL_SECTION *) lock);
+  delete ((CRITICAL_SECTION *) lock);
+}
+
+
+//= Default constructor initializes certain values.
+
+jhcPrefVSrc::jhcPrefVSrc ()
+{
+  null_ptrs();
+  ahead = 4;
+}
+
+
+//= Open file right away and read up to "n" frames in advance.
+
+jhcPrefVSrc::jhcPrefVSrc (const char *name, int n)
+{
+  null_ptrs();
+  ahead = n;
+  SetSource(name);
+}
+
+
+//= Set up empty ring and lock (only called from constructors).
+
+void jhcPrefVSrc::null_ptrs ()
+{
+  strcpy_s(kind, "jhcPrefVSrc");
+
+  // ring and views
+  frame = NULL;
+  frame2 = NULL;
+  fname = NULL;
+  lname = NULL;
+  sname = NULL;
+  aux = NULL;
+  st = NULL;
+  adv = NULL;
+  tstamp = NULL;
+  acnt = NULL;
+  asz = NULL;
+  nslot = 0;
+  mode = 0;
+  cur = -1;
+  lend = 0;
+
+  // reader thread
+  lock = (void *) new CRITICAL_SECTION;
+  InitializeCriticalSection((CRITICAL_SECTION *) lock);
+  fcn = NULL;
+  wake = NULL;
+  got = NULL;
+  run = 0;
+  rd = 0;
+  cnt = 0;
+  held = 0;
+  done = 0;
+  lsel = 0;
+
+  // statistics
+  nread = 0;
+  nwait = 0;
+}
+
+
+//= Get rid of all ring slots.
+
+void jhcPrefVSrc::dealloc ()
+{
+  int i;
+
+  if (aux != NULL)
+    for (i = 0; i < nslot; i++)
+      delete [] aux[i];
+  delete [] asz;
+  delete [] acnt;
+  delete [] tstamp;
+  delete [] adv;
+  delete [] st;
+  delete [] aux;
+  delete [] sname;
+  delete [] lname;
+  delete [] fname;
+  delete [] frame2;
+  delete [] frame;
+  frame = NULL;
+  frame2 = NULL;
+  fname = NULL;
+  lname = NULL;
+  sname = NULL;
+  aux = NULL;
+  st = NULL;
+  adv = NULL;
+  tstamp = NULL;
+  acnt = NULL;
+  asz = NULL;
+  nslot = 0;
+  cur = -1;
+}
+
+
+//= Make sure ring has correct number of slots with images of proper size.
+// one slot more than "ahead" so caller can hold one while reader fills rest
+// m: 0 = color only, 1 = depth only, 2 = both (only call when reader stopped)
+
+void jhcPrefVSrc::ring (int m)
+{
+  int i, n = __max(0, ahead) + 1;
+
+  // reallocate arrays if different number of slots
+  if (n != nslot)
+  {
+    dealloc();
+    frame  = new jhcImg [n];
+    frame2 = new jhcImg [n];
+    fname  = new char [n][500];
+    lname  = new char [n][500];
+    sname  = new char [n][500];
+    aux    = new UC8 * [n];
+    st     = new int [n];
+    adv    = new int [n];
+    tstamp = new int [n];
+    acnt   = new int [n];
+    asz    = new int [n];
+    for (i = 0; i < n; i++)
+    {
+      aux[i] = NULL;
+      asz[i] = 0;
+    }
+    nslot = n;
+  }
+
+  // size images for kind of request
+  mode = m;
+  for (i = 0; i < nslot; i++)
+    if (m >= 2)
+    {
+      frame[i].SetSize(w, h, d);
+      frame2[i].SetSize(w2, h2, d2);
+    }
+    else
+      frame[i].SetSize(XDim(m), YDim(m), Fields(m));
+}
+
+
+//= Open a new video source (stops any reading from old one).
+
+int jhcPrefVSrc::SetSource (const char *name)
+{
+  stop(0);
+  cur = -1;
+  return jhcGenVSrc::SetSource(name);
+}
+
+
+//= Start (doit > 0) or pause (doit <= 0) background reading.
+// reading also starts automatically with the next Get if not paused
+
+void jhcPrefVSrc::Prefetch (int doit)
+{
+  if (doit <= 0)
+    stop();
+  if (gvid != NULL)
+    gvid->Prefetch(doit);
+  if ((doit > 0) && (ahead > 0) && (run <= 0) && (gvid != NULL) && (ok > 0))
+  {
+    if (changed(mode) > 0)
+    {
+      ring(mode);
+      resync();
+    }
+    start();
+  }
+}
+
+
+//= Stop reading then release underlying source.
+
+void jhcPrefVSrc::Close ()
+{
+  stop(0);
+  jhcGenVSrc::Close();
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                   Configuration Changes Which Flush                   //
+///////////////////////////////////////////////////////////////////////////
+
+//= Change the number of frames skipped between calls.
+// next frame is previous one plus new increment (as for jhcVideoSrc)
+
+void jhcPrefVSrc::SetStep (int offset, int key)
+{
+  int oldinc = Increment;
+
+  stop(0);
+  jhcGenVSrc::SetStep(offset, key);
+  if (nextread > 0)
+    nextread += Increment - oldinc;
+  resync();
+}
+
+
+//= Change the size and color depth of the image requested.
+
+void jhcPrefVSrc::SetSize (int xmax, int ymax, int bw)
+{
+  stop();
+  jhcGenVSrc::SetSize(xmax, ymax, bw);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                      Properties of Most Recent Frame                  //
+///////////////////////////////////////////////////////////////////////////
+
+//= Name of most recent frame (underlying source may already be further on).
+// only the plain names (idx_wid < 0) are remembered for each frame
+
+const char *jhcPrefVSrc::FrameName (int idx_wid, int full)
+{
+  if ((cur < 0) || (idx_wid >= 0))
+    return jhcVideoSrc::FrameName(idx_wid, full);
+  return((full > 0) ? lname[cur] : sname[cur]);
+}
+
+
+//= Time stamp of most recent frame.
+
+int jhcPrefVSrc::TimeStamp ()
+{
+  return((cur < 0) ? 0 : tstamp[cur]);
+}
+
+
+//= Number of bytes of auxiliary data with most recent frame.
+
+int jhcPrefVSrc::AuxCnt () const
+{
+  return((cur < 0) ? 0 : acnt[cur]);
+}
+
+
+//= Auxiliary data (if any) associated with most recent frame.
+
+const UC8 *jhcPrefVSrc::AuxData () const
+{
+  return(((cur < 0) || (acnt[cur] <= 0)) ? NULL : aux[cur]);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                            Zero-Copy Access                           //
+///////////////////////////////////////////////////////////////////////////
+
+//= Get next frame (src = 1 for depth) without copying it out of the ring.
+// obeys frame selection, looping, and Increment exactly like Get
+// returned image is valid until next Get, Lend, Seek, or configuration change
+// returns NULL if at end of selection or some error (or not ready and block <= 0)
+
+const jhcImg *jhcPrefVSrc::Lend (int src, int block)
+{
+  jhcImg *v = view + ((src > 0) ? 1 : 0);
+  int ans, m = ((src > 0) ? 1 : 0);
+
+  if ((gvid == NULL) || (ok <= 0))
+    return NULL;
+
+  // make view look like a proper destination then read
+  if (changed(m) > 0)
+  {
+    stop(0);
+    ring(m);
+    resync();
+  }
+  v->Wrap((UC8 *) frame[0].PxlSrc(), XDim(m), YDim(m), Fields(m));
+  lend = 1;
+  ans = Get(*v, m, block);
+  lend = 0;
+  return((ans > 0) ? v : NULL);
+}
+
+
+//= Get next pair of frames (color and depth) without copying them.
+// if source only has one stream then both pointers are to the same image
+// returns result of DualGet, pointers are set to NULL if nothing read
+
+int jhcPrefVSrc::LendDual (const jhcImg **f, const jhcImg **f2)
+{
+  int ans;
+
+  if ((f == NULL) || (f2 == NULL))
+    return Fatal("Bad input to jhcPrefVSrc::LendDual");
+  *f = NULL;
+  *f2 = NULL;
+  if ((gvid == NULL) || (ok <= 0))
+    return 0;
+
+  // single stream sources give same image twice
+  if (!Dual())
+  {
+    if ((*f = Lend(0)) == NULL)
+      return 0;
+    *f2 = *f;
+    return 1;
+  }
+
+  // make views look like proper destinations then read
+  if (changed(2) > 0)
+  {
+    stop(0);
+    ring(2);
+    resync();
+  }
+  view[0].Wrap((UC8 *) frame[0].PxlSrc(), w, h, d);
+  view[1].Wrap((UC8 *) frame2[0].PxlSrc(), w2, h2, d2);
+  lend = 1;
+  ans = DualGet(view[0], view[1]);
+  lend = 0;
+  if (ans > 0)
+  {
+    *f = view;
+    *f2 = view + 1;
+  }
+  return ans;
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                             Reader Thread                             //
+///////////////////////////////////////////////////////////////////////////
+
+//= Launch background thread to fill the ring starting at current position.
+// returns 1 if running, 0 if thread could not be created
+
+int jhcPrefVSrc::start ()
+{
+  rd = 0;
+  cnt = 0;
+  held = 0;
+  done = 0;
+  run = 1;
+  wake = (void *) CreateEvent(NULL, FALSE, FALSE, NULL);  // auto-reset
+  got  = (void *) CreateEvent(NULL, FALSE, FALSE, NULL);
+  fcn  = (void *) _beginthreadex(NULL, 0, pref_backg, this, 0, NULL);
+  if (fcn != NULL)
+    return 1;
+  run = 0;
+  CloseHandle((HANDLE) got);
+  CloseHandle((HANDLE) wake);
+  return 0;
+}
+
+
+//= Stop background thread and discard all frames in the ring.
+// if sync > 0 then moves underlying source back to the next frame expected
+
+void jhcPrefVSrc::stop (int sync)
+{
+  if (run <= 0)
+    return;
+
+  // thread only ever waits for events or a single frame read
+  run = 0;
+  SetEvent((HANDLE) wake);
+  WaitForSingleObject((HANDLE) fcn, INFINITE);
+  CloseHandle((HANDLE) fcn);
+  CloseHandle((HANDLE) got);
+  CloseHandle((HANDLE) wake);
+
+  // empty ring and undo read ahead
+  rd = 0;
+  cnt = 0;
+  held = 0;
+  done = 0;
+  if (sync > 0)
+    resync();
+}
+
+
+//= Copy selection and step to underlying source then go to next expected frame.
+// underlying source stops at end of selection or file rather than looping
+// forces the next frame number to be nextread (as after a Seek)
+
+void jhcPrefVSrc::resync ()
+{
+  if (gvid == NULL)
+    return;
+  gvid->FirstFrame = 0;
+  gvid->LastFrame = __max(0, LastFrame);
+  lsel = LastFrame;
+  if ((gvid->Increment != Increment) || (gvid->ByKey != ByKey))
+    gvid->SetStep(Increment, ByKey);
+  gvid->Seek(nextread);
+  ok = gvid->Valid();
+  jumped = 1;
+}
+
+
+//= See if ring must be rebuilt before giving out a frame of type m.
+
+int jhcPrefVSrc::changed (int m) const
+{
+  if ((frame == NULL) || (m != mode) || (nslot != __max(0, ahead) + 1))
+    return 1;
+  if ((gvid->Increment != Increment) || (gvid->ByKey != ByKey) || (lsel != LastFrame))
+    return 1;
+  if (m >= 2)
+    return((frame[0].SameFormat(w, h, d) && frame2[0].SameFormat(w2, h2, d2)) ? 0 : 1);
+  return((frame[0].SameFormat(XDim(m), YDim(m), Fields(m))) ? 0 : 1);
+}
+
+
+//= Reading thread for ring.
+
+unsigned int __stdcall jhcPrefVSrc::pref_backg (void *arg)
+{
+  return((unsigned int) ((jhcPrefVSrc *) arg)->read_loop());
+}
+
+
+//= Keep ring full until told to stop.
+// waits after end of video (or failure) until ring is restarted
+
+int jhcPrefVSrc::read_loop ()
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) lock;
+  int i, n;
+
+  while (run > 0)
+  {
+    // find next free slot (after any waiting or held ones)
+    EnterCriticalSection(cs);
+    n = cnt;
+    i = (rd + cnt) % nslot;
+    LeaveCriticalSection(cs);
+    if ((n >= nslot) || (done > 0))
+    {
+      WaitForSingleObject((HANDLE) wake, INFINITE);
+      continue;
+    }
+
+    // read frame then make it available
+    fill(i);
+    if (st[i] <= 0)
+      done = 1;
+    EnterCriticalSection(cs);
+    cnt++;
+    LeaveCriticalSection(cs);
+    SetEvent((HANDLE) got);
+  }
+  return 1;
+}
+
+
+//= Read next frame from underlying source into some slot along with its properties.
+
+void jhcPrefVSrc::fill (int i)
+{
+  const char *name;
+  const UC8 *data;
+  int n;
+
+  // get image(s)
+  if (mode >= 2)
+    st[i] = gvid->DualGet(frame[i], frame2[i]);
+  else
+    st[i] = gvid->Get(frame[i], mode, 1);
+  adv[i] = gvid->Advance();
+  tstamp[i] = gvid->TimeStamp();
+  nread++;
+
+  // remember names
+  strcpy_s(fname[i], gvid->File());
+  name = gvid->FrameName(-1, 1);
+  strcpy_s(lname[i], ((name != NULL) ? name : ""));
+  name = gvid->FrameName(-1, 0);
+  strcpy_s(sname[i], ((name != NULL) ? name : ""));
+
+  // copy any auxiliary data
+  acnt[i] = 0;
+  if (((n = gvid->AuxCnt()) <= 0) || ((data = gvid->AuxData()) == NULL))
+    return;
+  if (n > asz[i])
+  {
+    delete [] aux[i];
+    aux[i] = new UC8 [n];
+    asz[i] = n;
+  }
+  memcpy(aux[i], data, n);
+  acnt[i] = n;
+}
+
+
+//= Release any frame held by caller then claim the oldest one in the ring.
+// returns slot index, negative if nothing ready and block <= 0
+
+int jhcPrefVSrc::take (int block)
+{
+  CRITICAL_SECTION *cs = (CRITICAL_SECTION *) lock;
+  int i = -1;
+
+  // give back previous slot so reader can refill it
+  EnterCriticalSection(cs);
+  if (held > 0)
+  {
+    rd = (rd + 1) % nslot;
+    cnt--;
+    held = 0;
+  }
+  LeaveCriticalSection(cs);
+  SetEvent((HANDLE) wake);
+
+  // wait for reader to supply next frame
+  while (1)
+  {
+    EnterCriticalSection(cs);
+    if (cnt > 0)
+    {
+      i = rd;
+      held = 1;
+    }
+    LeaveCriticalSection(cs);
+    if ((i >= 0) || (block <= 0))
+      break;
+    nwait++;
+    WaitForSingleObject((HANDLE) got, INFINITE);
+  }
+  return i;
+}
+
+
+//= Get a slot with the next frame of type m (fills it directly if not prefetching).
+// returns slot index, negative if nothing ready and block <= 0
+
+int jhcPrefVSrc::next_slot (int m, int block)
+{
+  if (changed(m) > 0)
+  {
+    stop(0);
+    ring(m);
+    resync();
+  }
+  if ((ahead <= 0) || ((run <= 0) && (start() <= 0)))
+  {
+    fill(0);
+    return(cur = 0);
+  }
+  if ((cur = take(block)) < 0)
+    return -1;
+  return cur;
+}
+
+
+//= Hand ring image to caller, either by copying or by pointing view at it.
+
+void jhcPrefVSrc::deliver (jhcImg& dest, jhcImg& src)
+{
+  if (lend > 0)
+    dest.Wrap((UC8 *) src.PxlSrc(), src.XDim(), src.YDim(), src.Fields());
+  else
+    dest.CopyArr(src);
+}
+
+
+///////////////////////////////////////////////////////////////////////////
+//                           Core Functions                              //
+///////////////////////////////////////////////////////////////////////////
+
+//= Set up so next read is of a particular frame.
+
+int jhcPrefVSrc::iSeek (int number)
+{
+  int ans;
+
+  if (gvid == NULL)
+    return 0;
+  stop(0);
+  ans = gvid->Seek(number);
+  ok = gvid->Valid();
+  return ans;
+}
+
+
+//= Get next image and report how many frames ahead this is.
+// src = 0 for basic color, src = 1 for depth (if dual stream sensor)
+// generally returns 1 for success (or number of aux bytes + 1)
+
+int jhcPrefVSrc::iGet (jhcImg& dest, int *advance, int src, int block)
+{
+  int i, ans;
+
+  if (gvid == NULL)
+    return 0;
+  if ((i = next_slot(((src > 0) ? 1 : 0), block)) < 0)
+    return 0;
+
+  // copy out image or halt reader at end
+  if ((ans = st[i]) > 0)
+  {
+    deliver(dest, frame[i]);
+    *advance = adv[i];
+    ParseName(fname[i]);
+    return ans;
+  }
+  *advance = 0;
+  stop();
+  ok = gvid->Valid();
+  return ans;
+}
+
+
+//= Get next pair of images from source.
+
+int jhcPrefVSrc::iDual (jhcImg& dest, jhcImg& dest2)
+{
+  int i, ans;
+
+  if (gvid == NULL)
+    return 0;
+  if ((i = next_slot(2, 1)) < 0)
+    return 0;
+
+  // copy out images or halt reader at end
+  if ((ans = st[i]) > 0)
+  {
+    deliver(dest, frame[i]);
+    deliver(dest2, frame2[i]);
+    ParseName(fname[i]);
+    return ans;
+  }
+  stop();
+  ok = gvid->Valid();
+  return ans;
+}
+
+
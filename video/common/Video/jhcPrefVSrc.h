@@ -0,0 +1,144 @@
+// jhcPrefVSrc.h : reads frames from any video source ahead of time in background
+//
+// Written by Jonathan H. Connell, jconnell@alum.mit.edu
+//
+///////////////////////////////////////////////////////////////////////////
+//
+// Copyright 2026 IBM Corporation
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//    http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+///////////////////////////////////////////////////////////////////////////
+
+#ifndef _JHCPREFVSRC_
+/* CPPDOC_BEGIN_EXCLUDE */
+#define _JHCPREFVSRC_
+/* CPPDOC_END_EXCLUDE */
+
+#include "jhcGlobal.h"
+
+#include "Data/jhcImg.h"
+#include "Video/jhcGenVSrc.h"
+
+
+//= Reads frames from any video source ahead of time in a background thread.
+// opens underlying source through registry just like jhcGenVSrc, then a
+// reader thread fills a ring of "ahead" preallocated frames while caller works
+// frame selection (FirstFrame, LastFrame, looping) is still done by Get here
+// underlying source just reads sequentially with the current Increment
+// any Seek, SetStep, or change in Increment or LastFrame flushes the ring
+// Lend returns frame in place (no copy), valid until next Get or Lend call
+// setting "ahead" to zero makes it read synchronously like jhcGenVSrc
+// NOTE: other settings (e.g. SetVal) should only be changed after Prefetch(0)
+// <pre>
+// typical use:
+//
+//   jhcPrefVSrc v("imgs.lst");
+//   const jhcImg *f;
+//   while ((f = v.Lend()) != NULL)
+//     ...
+//
+// </pre>
+
+class jhcPrefVSrc : public jhcGenVSrc
+{
+// PRIVATE MEMBER VARIABLES
+private:
+  // frame ring (one slot may be held by caller)
+  jhcImg *frame, *frame2;
+  char (*fname)[500], (*lname)[500], (*sname)[500];
+  UC8 **aux;
+  int *st, *adv, *tstamp, *acnt, *asz;
+  int nslot, mode, rd, cnt, held, cur;
+
+  // zero-copy views of ring slots
+  jhcImg view[2];
+  int lend;
+
+  // reader thread
+  void *fcn, *wake, *got, *lock;
+  volatile int run, done;
+  int lsel;
+
+  // statistics
+  int nread, nwait;
+
+
+// PUBLIC MEMBER VARIABLES
+public:
+  int ahead;  /** Max frames read in advance (0 = none). */
+
+
+// PUBLIC MEMBER FUNCTIONS
+public:
+  // creation and initialization
+  ~jhcPrefVSrc ();
+  jhcPrefVSrc ();
+  jhcPrefVSrc (const char *name, int n =4);
+  int SetSource (const char *name);
+  void Prefetch (int doit =1);
+  void Close ();
+
+  // configuration changes which flush ring
+  void SetStep (int offset, int key =0);
+  void SetSize (int xmax, int ymax, int bw =0);
+
+  // properties of most recent frame
+  const char *FrameName (int idx_wid =-1, int full =0);
+  int TimeStamp ();
+  int AuxCnt () const;
+  const UC8 *AuxData () const;
+
+  // zero-copy access
+  const jhcImg *Lend (int src =0, int block =1);
+  int LendDual (const jhcImg **f, const jhcImg **f2);
+
+  // statistics
+  int Buffered () const {return(cnt - held);}   /** Frames waiting in ring.           */
+  int Fetched () const  {return nread;}         /** Frames read by background thread. */
+  int Waits () const    {return nwait;}         /** Requests that had to wait.        */
+
+
+// PRIVATE MEMBER FUNCTIONS
+private:
+  // creation and initialization
+  void null_ptrs ();
+  void dealloc ();
+  void ring (int m);
+
+  // reader thread
+  int start ();
+  void stop (int sync =1);
+  void resync ();
+  int changed (int m) const;
+  static unsigned int __stdcall pref_backg (void *arg);
+  int read_loop ();
+  void fill (int i);
+  int take (int block);
+  int next_slot (int m, int block);
+  void deliver (jhcImg& dest, jhcImg& src);
+
+  // core functionality
+  int iSeek (int number);
+  int iGet (jhcImg& dest, int *advance, int src, int block);
+  int iDual (jhcImg& dest, jhcImg& dest2);
+
+
+};
+
+
+#endif  // once
+
+
+
+
@@ -48,6 +48,7 @@ jhcVideoSink::jhcVideoSink ()
 
 //= Tell stream what size of images to store.
 // this must be done before the first write to the stream
+// f = 2 is for 16 bit depth images which only some subclasses accept
 // stream must be closed for this to take effect
 
 int jhcVideoSink::SetSize (int x, int y, int f)
@@ -55,7 +56,7 @@ int jhcVideoSink::SetSize (int x, int y, int f)
   if (bound == 1)
     return 0;
 
-  if ((x <= 0) || (y <= 0) || ((f != 1) && (f != 3)))
+  if ((x <= 0) || (y <= 0) || (f < 1) || (f > 3))
     return 0;  
   w = x;
   h = y;
@@ -144,7 +145,7 @@ int jhcVideoSink::Open ()
   ok = -1;
   
   // make sure frame size and rate specifications make sense
-  if ((w <= 0) || (h <= 0) || ((d != 1) && (d != 3)) || (freq <= 0.0))
+  if ((w <= 0) || (h <= 0) || (d < 1) || (d > 3) || (freq <= 0.0))
     return ok;
 
   // clear selected file if it already exists